@@ -88,6 +88,7 @@ AloitusSivu::AloitusSivu(QWidget *parent) :
     connect(ui->varmistaNappi, &QPushButton::clicked, this, &AloitusSivu::varmuuskopioi);
     connect(ui->muistiinpanotNappi, &QPushButton::clicked, this, &AloitusSivu::muistiinpanot);
     connect(ui->poistaNappi, &QPushButton::clicked, this, &AloitusSivu::poistaListalta);
+    connect(ui->tiivistaNappi, &QPushButton::clicked, this, &AloitusSivu::tiivista);
 
     connect( ui->tilikausiCombo, &QComboBox::currentTextChanged, this, &AloitusSivu::haeSaldot);    
 
@@ -265,6 +266,7 @@ void AloitusSivu::kirjanpitoVaihtui()
     ui->varmistaNappi->setEnabled(avoinna && qobject_cast<SQLiteModel*>(kp()->yhteysModel()) );
     ui->muistiinpanotNappi->setEnabled(avoinna);
     ui->poistaNappi->setEnabled( avoinna && qobject_cast<SQLiteModel*>(kp()->yhteysModel()));
+    ui->tiivistaNappi->setEnabled( avoinna && qobject_cast<SQLiteModel*>(kp()->yhteysModel()));
     ui->pilviPoistaButton->setVisible( avoinna &&
                                        qobject_cast<PilviModel*>(kp()->yhteysModel()) &&
                                        kp()->pilvi()->onkoOikeutta(PilviModel::OMISTAJA) );
@@ -489,6 +491,28 @@ void AloitusSivu::poistaListalta()
     kp()->sqlite()->poistaListalta( kp()->sqlite()->tiedostopolku() );
 }
 
+void AloitusSivu::tiivista()
+{
+    if( QMessageBox::question(this, tr("Tiivistä tiedosto"),
+                              tr("Samansisältöiset liitteet yhdistetään ja kirjanpitotiedosto tiivistetään.\n"
+                                 "Suurella kirjanpidolla tämä voi kestää useita minuutteja.\n\n"
+                                 "Haluatko tiivistää tiedoston?"),
+                              QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes)
+        return;
+
+    kp()->odotusKursori(true);
+    const QVariantMap tulos = kp()->sqlite()->tiivistaLiitteet();
+    kp()->odotusKursori(false);
+
+    if( tulos.isEmpty()) {
+        QMessageBox::critical(this, tr("Virhe"), tr("Tiedoston tiivistäminen epäonnistui."));
+        return;
+    }
+    const qlonglong saasto = tulos.value("ennen").toLongLong() - tulos.value("jalkeen").toLongLong();
+    QMessageBox::information(this, tr("Tiivistä tiedosto"),
+                             tr("Tiedoston koko pieneni %1 Mt.").arg( saasto / ( 1024 * 1024 ) ));
+}
+
 void AloitusSivu::poistaPilvesta()
 {
     if( !kp()->onkoHarjoitus()) {
@@ -68,6 +68,7 @@ public slots:
     void muistiinpanot();
 
     void poistaListalta();
+    void tiivista();
     void poistaPilvesta();
 
     /**
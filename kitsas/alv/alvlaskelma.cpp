@@ -16,6 +16,7 @@
 */
 #include "alvlaskelma.h"
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 #include "db/verotyyppimodel.h"
 #include "model/tosite.h"
 #include "model/tositeviennit.h"
@@ -390,8 +391,8 @@ void AlvLaskelma::kasitteleMaksuperusteinen(const QVariantMap &map)
     Tili* tili = kp()->tilit()->tili(map.value("tili").toInt());
     if( tili ) {
         int tositeId = map.value("tosite").toMap().value("id").toInt();
-        qlonglong debet = qRound64( map.value("debet").toDouble() * 100.0 );
-        qlonglong kredit = qRound64( map.value("kredit").toDouble() * 100.0 );
+        qlonglong debet = Euro::fromVariant(map.value("debet")).cents();
+        qlonglong kredit = Euro::fromVariant(map.value("kredit")).cents();
         int era = map.value("era").toMap().value("id").toInt();
 
         if( tili->onko(TiliLaji::MYYNTISAATAVA) || tili->onko(TiliLaji::OSTOVELKA)) {
@@ -479,7 +480,7 @@ void AlvLaskelma::nollaaMaksuperusteisetErat(QVariant *variant, const QDate& pvm
         if( map.value("pvm").toDate() > pvm)
             continue;
         int eraid = map.value("id").toInt();
-        qlonglong saldo = qRound64(map.value("avoin").toDouble() * 100.0);
+        qlonglong saldo = Euro::fromVariant(map.value("avoin")).cents();
         nollattavatErat_.append(qMakePair(eraid, saldo));
     }
     nollattavatHaut_--;
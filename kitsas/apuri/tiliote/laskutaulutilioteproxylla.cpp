@@ -29,7 +29,7 @@ LaskuTauluTilioteProxylla::LaskuTauluTilioteProxylla(QObject *parent, TilioteMod
 QVariant LaskuTauluTilioteProxylla::data(const QModelIndex &index, int role) const
 {
     if( ( role == Qt::DisplayRole || role == Qt::EditRole) && index.column() == MAKSAMATTA)  {        
-        Euro avoinna = Euro(LaskuTauluModel::data(index, Qt::EditRole).toString());
+        Euro avoinna = Euro::fromVariant(LaskuTauluModel::data(index, Qt::EditRole));
         int eraId = LaskuTauluModel::data(index, EraIdRooli).toInt();
 
         if( eraId > 0)  // Huoneistoissa sun muissa voi laskuja tulla enemmänkin ;)
@@ -300,8 +300,8 @@ bool TuloMenoApuri::teeTositteelle()
 
     for( const auto& vienti : qAsConst(viennit)) {
         QVariantMap map = vienti.toMap();
-        summa += qRound64( map.value("kredit",0).toDouble() * 100.0 );
-        summa -= qRound64( map.value("debet",0).toDouble() * 100.0 );
+        summa += Euro::fromVariant(map.value("kredit",0)).cents();
+        summa -= Euro::fromVariant(map.value("debet",0)).cents();
     }
 
     bool menoa = tosite()->tyyppi() == TositeTyyppi::MENO ||
@@ -16,6 +16,7 @@
 */
 #include "jaksottaja.h"
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 
 #include "ui_poistaja.h"
 
@@ -205,8 +206,8 @@ RaportinKirjoittaja Jaksottaja::jaksotusSelvitys(const Tilikausi &kausi, const Q
         rr.lisaa( map.value("kredit").toDouble());
         rk.lisaaRivi(rr);
 
-        debetYht += qRound64(100 * map.value("debet").toDouble());
-        kreditYht += qRound64(100 * map.value("kredit").toDouble());
+        debetYht += Euro::fromVariant(map.value("debet")).cents();
+        kreditYht += Euro::fromVariant(map.value("kredit")).cents();
     }
 
     if( debetYht > 0 || kreditYht > 0) {
@@ -15,6 +15,7 @@
    along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "arkistoija.h"
+#include "arkistokirjoittaja.h"
 
 #include "db/kirjanpito.h"
 #include "arkistohakemistodialogi.h"
@@ -25,6 +26,7 @@
 #include "model/tositevienti.h"
 #include "model/tosite.h"
 #include "sqlite/sqlitemodel.h"
+#include "sqlite/liitelukija.h"
 #include "kieli/kielet.h"
 #include <QFile>
 #include <QTextStream>
@@ -38,6 +40,9 @@
 #include <QJsonDocument>
 #include <QSettings>
 #include <QProgressDialog>
+#include <QTimer>
+#include <QThread>
+#include <QtConcurrent>
 
 
 
@@ -47,11 +52,28 @@ Arkistoija::Arkistoija(const Tilikausi &tilikausi, QObject *parent)
 
 }
 
+Arkistoija::~Arkistoija()
+{
+    // Odotetaan, etteivät tiivistettävät enää lähetä kirjoitettavaa
+    tyovaki_.clear();
+    tyovaki_.waitForDone();
+    delete laite_;
+
+    if( kirjoitusSaie_ ) {
+        kirjoitusSaie_->quit();
+        kirjoitusSaie_->wait();
+        delete kirjoittaja_;
+    }
+    if( progressDlg_ )
+        progressDlg_->deleteLater();
+}
+
 void Arkistoija::arkistoi()
 {
     if( luoHakemistot() ) {
         progressDlg_ = new QProgressDialog(tr("Arkistoidaan kirjanpitoa"), tr("Peruuta"), 0, 6 );
         progressDlg_->setMinimumDuration(250);
+        connect( progressDlg_, &QProgressDialog::canceled, this, &Arkistoija::keskeyta);
 
         QStringList raportit = kp()->asetukset()->asetus(AsetusModel::ArkistoRaportit).split(",");
         raporttilaskuri_ = 9 + raportit.count();
@@ -88,6 +110,7 @@ bool Arkistoija::luoHakemistot()
         return false;
 
     hakemistoPolku_ = hakemisto.absolutePath();
+    kaynnistaKirjoittaja();
 
     hakemisto.mkdir("tositteet");
     hakemisto.mkdir("liitteet");
@@ -117,6 +140,8 @@ void Arkistoija::arkistoiTositteet()
     kysely->lisaaAttribuutti("jarjestys","tosite");
     kysely->lisaaAttribuutti("alkupvm", tilikausi_.alkaa());
     kysely->lisaaAttribuutti("loppupvm", tilikausi_.paattyy());
+    kysely->asetaOsakoko(500);
+    connect( kysely, &KpKysely::osaVastaus, this, &Arkistoija::tositeLuetteloaSaapuu );
     connect( kysely, &KpKysely::vastaus, this, &Arkistoija::tositeLuetteloSaapuu );
     kysely->kysy();
 }
@@ -190,27 +215,141 @@ void Arkistoija::arkistoiTilinpaatos()
     kysely->kysy();
 }
 
+void Arkistoija::kaynnistaKirjoittaja()
+{
+    kirjoitusSaie_ = new QThread(this);
+    kirjoittaja_ = new ArkistoKirjoittaja(hakemistoPolku_);
+    kirjoittaja_->moveToThread(kirjoitusSaie_);
+    connect( kirjoittaja_, &ArkistoKirjoittaja::kirjoitettu, this, &Arkistoija::tiedostoKirjoitettu);
+    connect( kirjoittaja_, &ArkistoKirjoittaja::palaKirjoitettu, this, &Arkistoija::palaKirjoitettu);
+    kirjoitusSaie_->start();
+}
+
 void Arkistoija::arkistoiByteArray(const QString &tiedostonnimi, const QByteArray &array)
 {
-    QDir hakemisto(hakemistoPolku_);
-    QFile tiedosto( hakemisto.absoluteFilePath(tiedostonnimi));
-    tiedosto.open( QIODevice::WriteOnly);
-    tiedosto.write( array );
-    tiedosto.close();
+    jonoon(tiedostonnimi, array.size());
+
+    // Tiiviste lasketaan säiejoukossa, josta tiedosto siirtyy kirjoitussäikeelle
+    ArkistoKirjoittaja* kirjoittaja = kirjoittaja_;
+    QtConcurrent::run(&tyovaki_, [kirjoittaja, tiedostonnimi, array] {
+        const QByteArray tiiviste = QCryptographicHash::hash(array, QCryptographicHash::Sha256).toHex();
+        QMetaObject::invokeMethod(kirjoittaja, [kirjoittaja, tiedostonnimi, array, tiiviste] {
+            kirjoittaja->kirjoita(tiedostonnimi, array, tiiviste); }, Qt::QueuedConnection);
+    });
+}
 
-    shaBytes.append(QCryptographicHash::hash( array, QCryptographicHash::Sha256).toHex());
-    shaBytes.append(" *");
-    shaBytes.append(tiedostonnimi.toLatin1());
-    shaBytes.append("\n");
+void Arkistoija::arkistoiJson(const QString &tiedostonnimi, const QVariantMap &map)
+{
+    jonoon(tiedostonnimi, 0);
+
+    ArkistoKirjoittaja* kirjoittaja = kirjoittaja_;
+    QtConcurrent::run(&tyovaki_, [kirjoittaja, tiedostonnimi, map] {
+        const QByteArray json = QJsonDocument::fromVariant(map).toJson(QJsonDocument::Indented);
+        const QByteArray tiiviste = QCryptographicHash::hash(json, QCryptographicHash::Sha256).toHex();
+        QMetaObject::invokeMethod(kirjoittaja, [kirjoittaja, tiedostonnimi, json, tiiviste] {
+            kirjoittaja->kirjoita(tiedostonnimi, json, tiiviste); }, Qt::QueuedConnection);
+    });
 }
 
-void Arkistoija::kirjoitaHash() const
+void Arkistoija::arkistoiLaite(const QString &tiedostonnimi, QIODevice *laite)
 {
-    QDir hakemisto(hakemistoPolku_);
-    QFile tiedosto( hakemisto.absoluteFilePath( "arkisto.sha256" ));
-    tiedosto.open( QIODevice::WriteOnly );
-    tiedosto.write( shaBytes );
-    tiedosto.close();
+    // Laite siirtyy arkistoijan omistukseen, ja sitä luetaan sitä mukaa
+    // kuin kirjoitusjonoon mahtuu
+    laite_ = laite;
+    laitteenNimi_ = tiedostonnimi;
+    jonoon(tiedostonnimi, 0);
+    jatkaLaitetta();
+}
+
+void Arkistoija::jatkaLaitetta()
+{
+    // Palat siirtyvät kirjoitussäikeelle, joka laskee tiivisteen kirjoittaessaan
+    ArkistoKirjoittaja* kirjoittaja = kirjoittaja_;
+    const QString tiedostonnimi = laitteenNimi_;
+
+    while( !keskeytetty_ && !laite_->atEnd() && kirjoitettavanaTavuja_ < KIRJOITUSJONO_TAVUT) {
+        const QByteArray pala = laite_->read( LiiteLukija::PALAKOKO );
+        if( pala.isEmpty())
+            break;
+        kirjoitettavat_[tiedostonnimi] += pala.size();
+        kirjoitettavanaTavuja_ += pala.size();
+        QMetaObject::invokeMethod(kirjoittaja, [kirjoittaja, tiedostonnimi, pala] {
+            kirjoittaja->kirjoitaPala(tiedostonnimi, pala, false); }, Qt::QueuedConnection);
+    }
+
+    if( !keskeytetty_ && !laite_->atEnd()) {
+        // Raja täyttyi, jatketaan kun kirjoittaja on päässyt perässä
+        if( kirjoitettavanaTavuja_ >= KIRJOITUSJONO_TAVUT)
+            return;
+
+        // Tyhjä luku ennen loppua on lukuvirhe: katkennutta tiedostoa
+        // ei jätetä arkistoon eikä sen tiivistettä luetteloon
+        qWarning() << "Liitteen " << tiedostonnimi << " lukeminen epäonnistui: " << laite_->errorString();
+        QMetaObject::invokeMethod(kirjoittaja, [kirjoittaja, tiedostonnimi] {
+            kirjoittaja->hylkaa(tiedostonnimi); }, Qt::QueuedConnection);
+    } else {
+        QMetaObject::invokeMethod(kirjoittaja, [kirjoittaja, tiedostonnimi] {
+            kirjoittaja->kirjoitaPala(tiedostonnimi, QByteArray(), true); }, Qt::QueuedConnection);
+    }
+    delete laite_;
+    laite_ = nullptr;
+
+    if( !keskeytetty_ )
+        liiteArkistoitu();
+}
+
+void Arkistoija::palaKirjoitettu(const QString &tiedostonnimi, qint64 koko)
+{
+    if( kirjoitettavat_.contains(tiedostonnimi)) {
+        kirjoitettavat_[tiedostonnimi] -= koko;
+        kirjoitettavanaTavuja_ -= koko;
+    }
+    taytaJono();
+}
+
+void Arkistoija::kirjoitaTiedosto(const QString &tiedostonnimi, const QByteArray &array)
+{
+    // Tiedosto, joka ei kuulu arkiston tiivisteluetteloon
+    jonoon(tiedostonnimi, array.size());
+
+    ArkistoKirjoittaja* kirjoittaja = kirjoittaja_;
+    QMetaObject::invokeMethod(kirjoittaja, [kirjoittaja, tiedostonnimi, array] {
+        kirjoittaja->kirjoita(tiedostonnimi, array, QByteArray()); }, Qt::QueuedConnection);
+}
+
+void Arkistoija::jonoon(const QString &tiedostonnimi, qint64 koko)
+{
+    kirjoitettavat_.insert(tiedostonnimi, koko);
+    kirjoitettavanaTavuja_ += koko;
+}
+
+void Arkistoija::tiedostoKirjoitettu(const QString &tiedostonnimi, const QByteArray &tiiviste)
+{
+    kirjoitettavanaTavuja_ -= kirjoitettavat_.take(tiedostonnimi);
+    if( !tiiviste.isEmpty())
+        tiivisteet_.insert(tiedostonnimi, tiiviste);
+
+    if( viimeistelty_ ) {
+        if( kirjoitettavat_.isEmpty())
+            valmis();
+    } else {
+        taytaJono();
+        jotainArkistoitu();
+    }
+}
+
+void Arkistoija::kirjoitaHash()
+{
+    // Luettelo järjestetään tiedostonnimen mukaan, koska tiedostot
+    // valmistuvat rinnakkain vaihtelevassa järjestyksessä
+    shaBytes.clear();
+    for(auto iter = tiivisteet_.constBegin(); iter != tiivisteet_.constEnd(); ++iter) {
+        shaBytes.append(iter.value());
+        shaBytes.append(" *");
+        shaBytes.append(iter.key().toLatin1());
+        shaBytes.append("\n");
+    }
+    kirjoitaTiedosto("arkisto.sha256", shaBytes);
 }
 
 void Arkistoija::merkitseArkistoiduksi()
@@ -266,63 +405,86 @@ void Arkistoija::merkitseArkistoiduksi()
                  "så att det inte går att göra ändringar.",2);
         rk.lisaaRivi(rr);
     }
-    arkistoiByteArray("arkistovarmenne.pdf", rk.pdf());
+    kirjoitaTiedosto("arkistovarmenne.pdf", rk.pdf());
 
     QModelIndex indeksi = kp()->tilikaudet()->index( kp()->tilikaudet()->indeksiPaivalle(tilikausi_.paattyy()) , TilikausiModel::ARKISTOITU );
     emit kp()->tilikaudet()->dataChanged( indeksi, indeksi );
-
-    progressDlg_->close();
-    emit arkistoValmis( hakemistoPolku_ );
-
-    qDebug() << "Arkistoitu";
-    progressDlg_->deleteLater();
-    deleteLater();
 }
 
 void Arkistoija::tositeLuetteloSaapuu(QVariant *data)
 {
-    // Lisätään tositteet luetteloon
+    // Luettelo on saapunut osissa, vastaus päättää sen
     QVariantList lista( data->toList() );
+    tositeLuetteloaSaapuu(&lista);
+
+    progressDlg_->setMaximum(tositeJono_.count() + 50 );
+    tositeluetteloSaapunut_ = true;
+    haettavaTosite_ = 0;
+    arkistoitavaTosite_ = 0;
 
-    progressDlg_->setMaximum(lista.count() + 50 );
+    taytaJono();
+    jotainArkistoitu();
+}
 
-    for( const auto& tosite :  qAsConst( lista) ) {
+void Arkistoija::tositeLuetteloaSaapuu(QVariantList *lista)
+{
+    // Lisätään tositteet luetteloon
+    for( const auto& tosite :  qAsConst( *lista) ) {
         QVariantMap map = tosite.toMap();
         tositeJono_.append( map );
     }
-    tositeluetteloSaapunut_ = true;
-    arkistoitavaTosite_ = 0;
-
-    if( tositeJono_.isEmpty())
-        jotainArkistoitu();
-    else
-        arkistoiSeuraavaTosite();
 }
 
 void Arkistoija::jotainArkistoitu()
 {
-    qDebug() << " Tosite " << arkistoitavaTosite_ << " / " << tositeJono_.count() << " Liitteet " << liitelaskuri_ << " Raportit " << raporttilaskuri_ ;
+    qDebug() << " Tosite " << arkistoitavaTosite_ << " / " << tositeJono_.count() << " Liitteet " << liitelaskuri_ << " Raportit " << raporttilaskuri_ << " Kirjoitettavana " << kirjoitettavat_.count();
 
-    qApp->processEvents();
-    if( !keskeytetty_ && tositeluetteloSaapunut_ && arkistoitavaTosite_ >= tositeJono_.count() && liitelaskuri_ <= 0  && raporttilaskuri_ <= 0 )
-            viimeistele();    
+    if( !keskeytetty_ && !viimeistelty_ && tositeluetteloSaapunut_ && arkistoitavaTosite_ >= tositeJono_.count() &&
+        liitelaskuri_ <= 0  && raporttilaskuri_ <= 0 && kirjoitettavat_.isEmpty() )
+            viimeistele();
 }
 
-void Arkistoija::arkistoiSeuraavaTosite()
+void Arkistoija::taytaJono()
 {
-    // Hae tosite arkistoitavaksi
-    int indeksi = arkistoitavaTosite_;
+    // Omasta tiedostosta vastaukset saapuvat heti, joten silmukka
+    // ei saa käynnistyä uudelleen vastauksen käsittelystä
+    if( tayttamassa_ )
+        return;
+    tayttamassa_ = true;
+
+    if( laite_ && !keskeytetty_ && kirjoitettavanaTavuja_ < KIRJOITUSJONO_TAVUT)
+        jatkaLaitetta();
+
+    // Hakuja jatketaan vain, kun kirjoitus pysyy perässä
+    while( !keskeytetty_ && !viimeistelty_ && haettavana_ < RINNAKKAISET_HAUT &&
+           kirjoitettavat_.count() < KIRJOITUSJONO && kirjoitettavanaTavuja_ < KIRJOITUSJONO_TAVUT) {
+        // Paloittain luettavia liitteitä luetaan yksi kerrallaan
+        if( !liiteJono_.isEmpty() && !laite_)
+            haeLiite();
+        else if( tositeluetteloSaapunut_ && haettavaTosite_ < tositeJono_.count())
+            haeTosite( haettavaTosite_++ );
+        else
+            break;
+    }
+
+    tayttamassa_ = false;
+}
 
+void Arkistoija::haeTosite(int indeksi)
+{
+    haettavana_++;
     KpKysely* kysely = kpk(QString("/tositteet/%1").arg( tositeJono_.value(indeksi).id() ));
     connect( kysely, &KpKysely::vastaus, this,
-             [this, indeksi] (QVariant* data) { this->arkistoiTosite(data, indeksi);} );
-
+             [this, indeksi] (QVariant* data) { this->haettavana_--; this->arkistoiTosite(data, indeksi);} );
+    connect( kysely, &KpKysely::virhe, this,
+             [this, indeksi] () { this->haettavana_--;
+                                  qWarning() << "Tositteen " << tositeJono_.value(indeksi).id() << " arkistointi epäonnistui";
+                                  this->tositeArkistoitu(); });
     kysely->kysy();
 }
 
 void Arkistoija::arkistoiTosite(QVariant *data, int indeksi)
 {
-    qApp->processEvents();
     if( keskeytetty_)
         return;
 
@@ -356,40 +518,59 @@ void Arkistoija::arkistoiTosite(QVariant *data, int indeksi)
     QString nimi = "tositteet/" + tositeJono_.value(indeksi).tiedostonnimi();
 
     arkistoiByteArray( nimi + ".html", tosite(map, indeksi) );
-    arkistoiByteArray(nimi + ".json", QJsonDocument::fromVariant(map).toJson(QJsonDocument::Indented));
-    progressDlg_->setValue( progressDlg_->value() + 1);
+    arkistoiJson(nimi + ".json", map);
 
+    tositeArkistoitu();
+}
+
+void Arkistoija::tositeArkistoitu()
+{
+    progressDlg_->setValue( progressDlg_->value() + 1);
     arkistoitavaTosite_++;
-    if( arkistoitavaTosite_ < tositeJono_.count())
-        arkistoiSeuraavaTosite();
-    else if( !liiteJono_.isEmpty() )
-        arkistoiSeuraavaLiite();
-    else if( raporttilaskuri_ <= 0 && !liitelaskuri_)
-        viimeistele();
 
+    taytaJono();
+    jotainArkistoitu();
 }
 
-void Arkistoija::arkistoiSeuraavaLiite()
+void Arkistoija::haeLiite()
 {
     int liiteid = liiteJono_.dequeue();
     QString tiedosto = liiteNimet_.value(liiteid);
+
+    // Omasta tiedostosta liite luetaan suoraan kirjoitettavaksi
+    SQLiteModel* sqlite = qobject_cast<SQLiteModel*>(kp()->yhteysModel());
+    if( sqlite ) {
+        QIODevice* lukija = sqlite->liiteLukija(liiteid);
+        if( lukija ) {
+            arkistoiLaite("liitteet/" + tiedosto, lukija);
+            return;
+        }
+    }
+
+    haettavana_++;
     KpKysely* kysely = kpk(QString("/liitteet/%1").arg(liiteid));
     connect( kysely, &KpKysely::vastaus, this,
-             [this, tiedosto] (QVariant* data) { this->arkistoiLiite(data, tiedosto);  });
+             [this, tiedosto] (QVariant* data) { this->haettavana_--; this->arkistoiLiite(data, tiedosto);  });
+    connect( kysely, &KpKysely::virhe, this,
+             [this, tiedosto] () { this->haettavana_--;
+                                   qWarning() << "Liitteen " << tiedosto << " arkistointi epäonnistui";
+                                   this->liiteArkistoitu(); });
     kysely->kysy();
 }
 
 void Arkistoija::arkistoiLiite(QVariant *data, const QString tiedosto)
 {
     arkistoiByteArray("liitteet/" + tiedosto, data->toByteArray());
+    liiteArkistoitu();
+}
+
+void Arkistoija::liiteArkistoitu()
+{
     progressDlg_->setValue(progressDlg_->value() + 1);
     liitelaskuri_--;
 
-    if( !liiteJono_.isEmpty())
-        arkistoiSeuraavaLiite();
-    else
-        jotainArkistoitu();
-
+    taytaJono();
+    jotainArkistoitu();
 }
 
 void Arkistoija::arkistoiRaportti(RaportinKirjoittaja rk, const QString &tiedosto)
@@ -414,12 +595,12 @@ void Arkistoija::arkistoiLaadittuRaportti(const RaportinKirjoittaja &kirjoittaja
 
 void Arkistoija::viimeistele()
 {
+    viimeistelty_ = true;
     kirjoitaHash();
 
     QDir hakemisto(hakemistoPolku_);
-    QFile tiedosto( hakemisto.absoluteFilePath("index.html"));
-    tiedosto.open( QIODevice::WriteOnly);
-    QTextStream out( &tiedosto );
+    QByteArray indeksi;
+    QTextStream out( &indeksi );
     out.setCodec("UTF-8");
 
     out << "<html><meta charset=\"UTF-8\"><head><title>";
@@ -475,14 +656,38 @@ void Arkistoija::viimeistele()
 
     out << "</body></html>";
 
-    tiedosto.flush();
-    tiedosto.close();
-
-    qDebug() << " Arkistoitu";
+    out.flush();
+    kirjoitaTiedosto("index.html", indeksi);
 
     merkitseArkistoiduksi();
 }
 
+void Arkistoija::valmis()
+{
+    progressDlg_->close();
+    emit arkistoValmis( hakemistoPolku_ );
+
+    qDebug() << "Arkistoitu";
+    deleteLater();
+}
+
+void Arkistoija::keskeyta()
+{
+    // Dialogin sulkeminen arkistoinnin valmistuttua lähettää myös canceled-signaalin
+    if( viimeistelty_ || keskeytetty_)
+        return;
+
+    keskeytetty_ = true;
+    liiteJono_.clear();
+    delete laite_;
+    laite_ = nullptr;
+    if( kirjoittaja_ )
+        kirjoittaja_->keskeyta();
+
+    qDebug() << "Arkistointi keskeytetty";
+    deleteLater();
+}
+
 RaporttiValinnat Arkistoija::raportti(QString tyyppi)
 {
     RaporttiValinnat valinnat(tyyppi);
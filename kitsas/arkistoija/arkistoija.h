@@ -26,15 +26,27 @@
 #include <QList>
 #include <QMap>
 #include <QQueue>
+#include <QThreadPool>
 
 
 class QProgressDialog;
+class QThread;
+class ArkistoKirjoittaja;
+
+/**
+ * @brief Tilikauden kirjanpidon arkistointi
+ *
+ * Tositteita haetaan useampi samanaikaisesti. Tiivisteet lasketaan
+ * säiejoukossa ja tiedostot kirjoitetaan omassa kirjoitussäikeessään,
+ * joten käyttöliittymäsäikeessä jää vain tositteiden muotoilu.
+ */
 
 class Arkistoija : public QObject
 {
     Q_OBJECT
 public:
     explicit Arkistoija(const Tilikausi& tilikausi, QObject *parent = nullptr);
+    ~Arkistoija() override;
 
     void arkistoi();
     QByteArray tositeRunko(const QVariantMap& tosite, bool tuloste);
@@ -49,23 +61,53 @@ protected:
     void arkistoiTositteet();
     void arkistoiRaportit();
     void arkistoiTilinpaatos();
+    void kaynnistaKirjoittaja();
     void arkistoiByteArray(const QString& tiedostonnimi, const QByteArray& array);
-    void kirjoitaHash() const;
+    void arkistoiJson(const QString& tiedostonnimi, const QVariantMap& map);
+    void arkistoiLaite(const QString& tiedostonnimi, QIODevice* laite);
+    void jatkaLaitetta();
+    void palaKirjoitettu(const QString& tiedostonnimi, qint64 koko);
+    void kirjoitaTiedosto(const QString& tiedostonnimi, const QByteArray& array);
+    void jonoon(const QString& tiedostonnimi, qint64 koko);
+    void tiedostoKirjoitettu(const QString& tiedostonnimi, const QByteArray& tiiviste);
+    void kirjoitaHash();
     void merkitseArkistoiduksi();
     void tositeLuetteloSaapuu(QVariant* data);
+    void tositeLuetteloaSaapuu(QVariantList* lista);
     void jotainArkistoitu();
-    void arkistoiSeuraavaTosite();
+    void taytaJono();
+    void haeTosite(int indeksi);
     void arkistoiTosite(QVariant* data, int indeksi);
-    void arkistoiSeuraavaLiite();
+    void tositeArkistoitu();
+    void haeLiite();
     void arkistoiLiite(QVariant* data, const QString tiedosto);
+    void liiteArkistoitu();
     void arkistoiRaportti(RaportinKirjoittaja rk, const QString& tiedosto);
     void arkistoiLaadittuRaportti(const RaportinKirjoittaja& kirjoittaja, const RaporttiValinnat& valinnat);
     void viimeistele();
+    void valmis();
+    void keskeyta();
 
     RaporttiValinnat raportti(QString tyyppi);
     void tilaaRaportti(RaporttiValinnat& valinnat);
 
 protected:
+    /**
+     * @brief Yhtä aikaa haettavien tositteiden ja liitteiden enimmäismäärä
+     */
+    static const int RINNAKKAISET_HAUT = 8;
+    /**
+     * @brief Kirjoitusjonon enimmäispituus ennen kuin hakuja jatketaan
+     */
+    static const int KIRJOITUSJONO = 32;
+    /**
+     * @brief Kirjoitusjonossa olevien tavujen enimmäismäärä
+     *
+     * Paloittain luettavan liitteen lukeminen pysähtyy, kun raja
+     * täyttyy, ja jatkuu kirjoittajan saatua palat kirjoitetuksi.
+     */
+    static const qint64 KIRJOITUSJONO_TAVUT = 64 * 1024 * 1024;
+
     static QString tiedostonnimi(const QDate& pvm, const QString& sarja, int tunniste);
 
     QString navipalkki(int indeksi = -10) const;
@@ -93,20 +135,32 @@ private:
     QString hakemistoPolku_;
 
     QProgressDialog *progressDlg_ = nullptr;
+    QThread* kirjoitusSaie_ = nullptr;
+    ArkistoKirjoittaja* kirjoittaja_ = nullptr;
+    QThreadPool tyovaki_;
 
     QList<JonoTosite> tositeJono_;
     QHash<int,QString> liiteNimet_;
     QQueue<int> liiteJono_;
     QList<QPair<QString,QString>> raporttiNimet_;
 
+    QMap<QString,QByteArray> tiivisteet_;
     QByteArray shaBytes;
 
+    int haettavaTosite_ = 0;
     int arkistoitavaTosite_ = 0;
+    int haettavana_ = 0;
+    QHash<QString,qint64> kirjoitettavat_;
+    qint64 kirjoitettavanaTavuja_ = 0;
+    QIODevice* laite_ = nullptr;
+    QString laitteenNimi_;
     bool logo_ = false;
     int raporttilaskuri_=0;
     int liitelaskuri_ = 0;
     bool keskeytetty_ = false;
     bool tositeluetteloSaapunut_ = false;
+    bool tayttamassa_ = false;
+    bool viimeistelty_ = false;
 
 };
 
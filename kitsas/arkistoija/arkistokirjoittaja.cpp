@@ -0,0 +1,93 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "arkistokirjoittaja.h"
+
+#include <QDebug>
+
+ArkistoKirjoittaja::ArkistoKirjoittaja(const QString &hakemisto)
+    : hakemisto_(hakemisto), keskeytetty_(false)
+{
+
+}
+
+ArkistoKirjoittaja::~ArkistoKirjoittaja()
+{
+    qDeleteAll(keskeneraiset_);
+}
+
+void ArkistoKirjoittaja::kirjoita(const QString &tiedostonnimi, const QByteArray &sisalto, const QByteArray &tiiviste)
+{
+    if( keskeytetty_ )
+        return;
+
+    QFile tiedosto( hakemisto_.absoluteFilePath(tiedostonnimi));
+    if( !tiedosto.open(QIODevice::WriteOnly) || tiedosto.write(sisalto) != sisalto.size())
+        qWarning() << "Arkistotiedoston " << tiedostonnimi << " kirjoittaminen epäonnistui: " << tiedosto.errorString();
+    tiedosto.close();
+
+    emit kirjoitettu(tiedostonnimi, tiiviste);
+}
+
+void ArkistoKirjoittaja::kirjoitaPala(const QString &tiedostonnimi, const QByteArray &pala, bool viimeinen)
+{
+    if( keskeytetty_ )
+        return;
+
+    Keskenerainen* kesken = keskeneraiset_.value(tiedostonnimi);
+    if( !kesken ) {
+        kesken = new Keskenerainen( hakemisto_.absoluteFilePath(tiedostonnimi) );
+        if( !kesken->tiedosto.open(QIODevice::WriteOnly))
+            qWarning() << "Arkistotiedoston " << tiedostonnimi << " avaaminen epäonnistui: " << kesken->tiedosto.errorString();
+        keskeneraiset_.insert(tiedostonnimi, kesken);
+    }
+
+    if( !pala.isEmpty()) {
+        kesken->tiedosto.write(pala);
+        kesken->laskin.addData(pala);
+        emit palaKirjoitettu(tiedostonnimi, pala.size());
+    }
+
+    if( viimeinen ) {
+        kesken->tiedosto.close();
+        emit kirjoitettu(tiedostonnimi, kesken->laskin.result().toHex());
+        delete keskeneraiset_.take(tiedostonnimi);
+    }
+}
+
+void ArkistoKirjoittaja::hylkaa(const QString &tiedostonnimi)
+{
+    if( keskeytetty_ )
+        return;
+
+    Keskenerainen* kesken = keskeneraiset_.take(tiedostonnimi);
+    if( kesken ) {
+        kesken->tiedosto.remove();
+        delete kesken;
+    }
+    emit kirjoitettu(tiedostonnimi, QByteArray());
+}
+
+void ArkistoKirjoittaja::keskeyta()
+{
+    keskeytetty_ = true;
+}
+
+ArkistoKirjoittaja::Keskenerainen::Keskenerainen(const QString &polku) :
+    tiedosto(polku), laskin(QCryptographicHash::Sha256)
+{
+
+}
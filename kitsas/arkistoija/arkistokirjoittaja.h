@@ -0,0 +1,91 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ARKISTOKIRJOITTAJA_H
+#define ARKISTOKIRJOITTAJA_H
+
+#include <QObject>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QCryptographicHash>
+
+#include <atomic>
+
+/**
+ * @brief Arkiston tiedostojen kirjoittaja
+ *
+ * Elää omassa säikeessään, ja kaikki arkiston tiedostot kirjoitetaan
+ * sen kautta, jotta levylle kirjoittaa kerrallaan vain yksi säie.
+ * Metodeja kutsutaan jonotettuina toisista säikeistä.
+ */
+class ArkistoKirjoittaja : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ArkistoKirjoittaja(const QString& hakemisto);
+    ~ArkistoKirjoittaja() override;
+
+    /**
+     * @brief Kirjoittaa kokonaisen tiedoston
+     * @param tiiviste Valmiiksi laskettu sha256-tiiviste, tyhjä jos
+     *        tiedostoa ei lisätä arkiston tiivisteluetteloon
+     */
+    void kirjoita(const QString& tiedostonnimi, const QByteArray& sisalto, const QByteArray& tiiviste);
+
+    /**
+     * @brief Kirjoittaa tiedoston paloittain
+     *
+     * Tiiviste lasketaan kirjoitettaessa. Jokaisen palan jälkeen
+     * lähetetään palaKirjoitettu- ja viimeisen palan jälkeen
+     * kirjoitettu-signaali.
+     */
+    void kirjoitaPala(const QString& tiedostonnimi, const QByteArray& pala, bool viimeinen);
+
+    /**
+     * @brief Hylkää paloittain kirjoitettavan tiedoston
+     *
+     * Keskeneräinen tiedosto poistetaan, ja kirjoitettu-signaali
+     * lähetetään tyhjällä tiivisteellä, jolloin tiedosto jää
+     * arkiston tiivisteluettelosta pois.
+     */
+    void hylkaa(const QString& tiedostonnimi);
+
+    /**
+     * @brief Jättää jonossa olevat tiedostot kirjoittamatta
+     *
+     * Voidaan kutsua mistä säikeestä tahansa.
+     */
+    void keskeyta();
+
+signals:
+    void kirjoitettu(const QString& tiedostonnimi, const QByteArray& tiiviste);
+    void palaKirjoitettu(const QString& tiedostonnimi, qint64 koko);
+
+protected:
+    class Keskenerainen {
+    public:
+        explicit Keskenerainen(const QString& polku);
+        QFile tiedosto;
+        QCryptographicHash laskin;
+    };
+
+    QDir hakemisto_;
+    QHash<QString, Keskenerainen*> keskeneraiset_;
+    std::atomic_bool keskeytetty_;
+};
+
+#endif // ARKISTOKIRJOITTAJA_H
@@ -45,6 +45,7 @@
 #include "tilimodel.h"
 
 #include "pilvi/pilvimodel.h"
+#include "pilvi/pilviliikenne.h"
 #include "sqlite/sqlitemodel.h"
 #include "tositetyyppimodel.h"
 #include "alv/alvilmoitustenmodel.h"
@@ -93,6 +94,8 @@ Kirjanpito::Kirjanpito(const QString& portableDir) :
         QDir portable(portableDir);
         settings_ = new QSettings(portable.absoluteFilePath("kitsas.ini"),QSettings::IniFormat, this);
     }
+    if( settings_->contains("TiivisSiirto"))
+        PilviLiikenne::asetaKaytossa( settings_->value("TiivisSiirto").toBool() );
 
     // Jos järjestelmässä ei ole yhtään tulostinta, otetaan käyttöön pdf-tulostus jotta
     // saadaan dialogit
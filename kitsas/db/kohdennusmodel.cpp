@@ -25,6 +25,7 @@
 #include "kohdennusmodel.h"
 #include "db/kirjanpito.h"
 #include "db/tilikausi.h"
+#include "kieli/kielet.h"
 
 
 
@@ -121,23 +122,23 @@ QString KohdennusModel::nimi(int id) const
 
 Kohdennus KohdennusModel::kohdennus(const int id) const
 {
-    foreach (Kohdennus projekti, kohdennukset_)
-    {
-        if( projekti.id() == id)
-            return projekti;
-    }
-
-    return Kohdennus();
+    const int indeksi = idIndeksi_.value(id, -1);
+    if( indeksi < 0)
+        return Kohdennus();
+    return kohdennukset_.at(indeksi);
 }
 
 Kohdennus KohdennusModel::kohdennus(const QString &nimi) const
 {
-    foreach (Kohdennus projekti, kohdennukset_)
-    {
-        if( projekti.nimi() == nimi)
-            return projekti;
+    const QString kieli = Kielet::instanssi() ? Kielet::instanssi()->nykyinen() : QString();
+    if( kieli != nimiKieli_ || nimiIndeksi_.isEmpty()) {
+        nimiKieli_ = kieli;
+        indeksoiNimet();
     }
-    return Kohdennus();
+    const int indeksi = nimiIndeksi_.value(nimi, -1);
+    if( indeksi < 0)
+        return Kohdennus();
+    return kohdennukset_.at(indeksi);
 }
 
 QList<Kohdennus> KohdennusModel::kohdennukset() const
@@ -200,6 +201,7 @@ void KohdennusModel::poistaRivi(int riviIndeksi)
     KpKysely *kysely = kpk(QString("/kohdennukset/%1").arg(kohdennus.id()), KpKysely::DELETE);
     kysely->kysy();
     kohdennukset_.removeAt(riviIndeksi);
+    indeksoi();
 
     endRemoveRows();
 }
@@ -214,6 +216,7 @@ void KohdennusModel::lataa(QVariantList lista)
         QVariantMap map = item.toMap();
         kohdennukset_.append( Kohdennus( map ));
     }
+    indeksoi();
     endResetModel();
 }
 
@@ -247,6 +250,24 @@ void KohdennusModel::lataaData(const QVariant *lista)
     lataa(lista->toList());
 }
 
+void KohdennusModel::indeksoi()
+{
+    // Samalla tunnisteella tai nimellä löytyy ensimmäinen kohdennus
+    idIndeksi_.clear();
+    idIndeksi_.reserve(kohdennukset_.count());
+    for(int i = kohdennukset_.count() - 1; i >= 0; i--)
+        idIndeksi_.insert( kohdennukset_.at(i).id(), i);
+    nimiIndeksi_.clear();
+}
+
+void KohdennusModel::indeksoiNimet() const
+{
+    nimiIndeksi_.clear();
+    nimiIndeksi_.reserve(kohdennukset_.count());
+    for(int i = kohdennukset_.count() - 1; i >= 0; i--)
+        nimiIndeksi_.insert( kohdennukset_.at(i).nimi(), i);
+}
+
 
 
 
@@ -21,6 +21,7 @@
 #include <QAbstractTableModel>
 #include <QDate>
 #include <QList>
+#include <QHash>
 #include <QSqlDatabase>
 
 #include "kohdennus.h"
@@ -103,9 +104,25 @@ protected slots:
     void lataaData(const QVariant* lista);    
 
 protected:
+    void indeksoi();
+    void indeksoiNimet() const;
+
     QList<Kohdennus> kohdennukset_;
     QList<int> poistetutIdt_;
 
+    /**
+     * @brief Kohdennuksen indeksi tunnisteen mukaan
+     */
+    QHash<int,int> idIndeksi_;
+    /**
+     * @brief Kohdennuksen indeksi nimen mukaan
+     *
+     * Nimi riippuu käyttöliittymän kielestä, joten hakemisto
+     * rakennetaan uudelleen kielen vaihtuessa.
+     */
+    mutable QHash<QString,int> nimiIndeksi_;
+    mutable QString nimiKieli_;
+
 
 };
 
@@ -54,6 +54,39 @@ QString KpKysely::attribuutti(const QString &avain) const
     return kysely_.queryItemValue(avain);
 }
 
+bool KpKysely::vastaaValimuistista()
+{
+    YhteysModel* model = static_cast<YhteysModel*>( parent() );
+    valimuistiSukupolvi_ = model->valimuisti()->sukupolvi();
+    if( !model->valimuisti()->hae(this, vastaus_))
+        return false;
+
+    jaaOsiin();
+    emit vastaus(&vastaus_);
+    deleteLater();
+    return true;
+}
+
+void KpKysely::kirjaaValimuistiin()
+{
+    YhteysModel* model = static_cast<YhteysModel*>( parent() );
+    model->valimuisti()->kirjaa(this, vastaus_);
+}
+
+void KpKysely::jaaOsiin()
+{
+    if( !osakoko_ || vastaus_.type() != QVariant::List)
+        return;
+
+    QVariantList lista = vastaus_.toList();
+    vastaus_ = QVariantList();
+
+    for(int i=0; i < lista.count(); i += osakoko_) {
+        QVariantList osa = lista.mid(i, osakoko_);
+        emit osaVastaus(&osa);
+    }
+}
+
 QString KpKysely::tiedostotyyppi(const QByteArray &ba)
 {
     QByteArray png ;
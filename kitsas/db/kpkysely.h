@@ -58,12 +58,29 @@ public:
     void lisaaAttribuutti(const QString& avain, int arvo);
 
     QString attribuutti(const QString& avain) const;
+
+    /**
+     * @brief Välimuistin mitätöintilaskuri kyselyn lähtiessä
+     */
+    qlonglong valimuistiSukupolvi() const { return valimuistiSukupolvi_; }
     Metodi metodi() const { return metodi_;}
     Tila tila() const { return tila_;}
     QUrlQuery urlKysely() const { return kysely_;}
 
     static QString tiedostotyyppi(const QByteArray& ba);
 
+    /**
+     * @brief Pyytää listamuotoisen vastauksen osissa
+     *
+     * Rivit toimitetaan osaVastaus-signaalilla enintään annetun
+     * määrän erissä. Lopuksi lähetetään vastaus-signaali, jonka
+     * runkona on tyhjä lista.
+     *
+     * @param rivia Rivien enimmäismäärä yhdessä osassa, 0 koko vastaus kerralla
+     */
+    void asetaOsakoko(int rivia) { osakoko_ = rivia; }
+    int osakoko() const { return osakoko_;}
+
 signals:
     /**
      * @brief Vastaus kyselyyn
@@ -76,6 +93,11 @@ signals:
      * @param lisattyId Vastauksen Location-headerin lopussa oleva numero
      */
     void lisaysVastaus(const QVariant& reply, int lisattyId);
+    /**
+     * @brief Osa listamuotoisesta vastauksesta
+     * @param rivit Osan rivit, käytettävissä vain signaalin käsittelyn ajan
+     */
+    void osaVastaus(QVariantList* rivit);
     void virhe(int virhe, const QString& selitys = QString());
 
 public slots:
@@ -84,11 +106,40 @@ public slots:
 
 
 protected:
+    /**
+     * @brief Vastaa GET-kyselyyn välimuistista
+     *
+     * Kutsutaan kysy-metodin alussa. Jos vastaus löytyy, se lähetetään
+     * heti ja kysely tuhotaan. Muuten otetaan talteen välimuistin
+     * mitätöintilaskuri, jotta myöhemmin saapuvaa vastausta ei tallenneta
+     * sen jälkeen tehdyn muokkauksen ohi.
+     *
+     * @return tosi, jos kyselyyn vastattiin
+     */
+    bool vastaaValimuistista();
+    /**
+     * @brief Kirjaa onnistuneen vastauksen välimuistiin
+     *
+     * Kutsutaan ennen vastaus-signaalia, jotta muokkauksen jälkeen
+     * tehtävät kyselyt eivät saa vanhentunutta vastausta.
+     */
+    void kirjaaValimuistiin();
+
+    /**
+     * @brief Lähettää valmiin listavastauksen osina
+     *
+     * Kun osakoko on asetettu, lähettää vastaus_-listan rivit
+     * osaVastaus-signaaleina ja tyhjentää vastaus_-listan.
+     */
+    void jaaOsiin();
+
     Metodi metodi_;
     QString polku_;
     QUrlQuery kysely_;
     QVariant vastaus_;
     Tila tila_;
+    int osakoko_ = 0;
+    qlonglong valimuistiSukupolvi_ = -1;
 
 };
 
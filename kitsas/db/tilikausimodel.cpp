@@ -18,6 +18,8 @@
 #include <QJsonDocument>
 #include <QSettings>
 
+#include <algorithm>
+
 #include "tilikausimodel.h"
 #include "kirjanpito.h"
 
@@ -161,24 +163,26 @@ QVariant TilikausiModel::data(const QModelIndex &index, int role) const
 
 Tilikausi TilikausiModel::tilikausiPaivalle(const QDate &paiva) const
 {
-    foreach (Tilikausi kausi, kaudet_)
-    {
-        // Osuuko pyydetty päivä kysyttyyn jaksoon
-        if( kausi.alkaa().daysTo(paiva) >= 0 && paiva.daysTo(kausi.paattyy()) >= 0)
-            return kausi;
-    }
-    return Tilikausi(QDate(), QDate()); // Kelvoton tilikausi
-
+    const int indeksi = indeksiPaivalle(paiva);
+    if( indeksi < 0)
+        return Tilikausi(QDate(), QDate()); // Kelvoton tilikausi
+    return kaudet_.at(indeksi);
 }
 
 
 int TilikausiModel::indeksiPaivalle(const QDate &paiva) const
 {
-    for(int i=0; i < kaudet_.count(); i++)
-        if( kaudet_[i].alkaa().daysTo(paiva) >= 0 && paiva.daysTo(kaudet_[i].paattyy()) >= 0)
-            return i;
-    return -1;
-
+    // Kelvoton päivä on aina osunut ensimmäiseen kauteen
+    if( !paiva.isValid())
+        return kaudet_.isEmpty() ? -1 : 0;
+
+    const qint64 paivanumero = paiva.toJulianDay();
+    auto iter = std::upper_bound(valit_.constBegin(), valit_.constEnd(), paivanumero,
+                                 [](qint64 paiva, const Kausivali& vali) { return paiva < vali.alkaa; });
+    if( iter == valit_.constBegin())
+        return -1;
+    --iter;
+    return paivanumero <= iter->paattyy ? iter->indeksi : -1;
 }
 
 bool TilikausiModel::onkoTilikautta(const QDate &paiva) const
@@ -222,6 +226,7 @@ void TilikausiModel::lataa(const QVariantList &lista)
         kaudet_.append( Tilikausi(map) );
     }
     paivitaKausitunnukset();
+    indeksoi();
     endResetModel();
 }
 
@@ -278,6 +283,19 @@ void TilikausiModel::paivitaKausitunnukset()
     }
 }
 
+void TilikausiModel::indeksoi()
+{
+    valit_.clear();
+    valit_.reserve(kaudet_.count());
+    for(int i=0; i < kaudet_.count(); i++) {
+        const Tilikausi& kausi = kaudet_.at(i);
+        if( kausi.alkaa().isValid() && kausi.paattyy().isValid())
+            valit_.append({ kausi.alkaa().toJulianDay(), kausi.paattyy().toJulianDay(), i });
+    }
+    std::stable_sort(valit_.begin(), valit_.end(),
+                     [](const Kausivali& a, const Kausivali& b) { return a.alkaa < b.alkaa; });
+}
+
 void TilikausiModel::lataaData(const QVariant *lista)
 {
     lataa( lista->toList() );
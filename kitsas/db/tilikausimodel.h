@@ -19,6 +19,7 @@
 #define TILIKAUSIMODEL_H
 
 #include <QAbstractTableModel>
+#include <QVector>
 #include "tilikausi.h"
 
 /**
@@ -83,7 +84,25 @@ protected slots:
     void lataaData(const QVariant* lista);
 
 protected:
+    void indeksoi();
+
+    /**
+     * @brief Tilikauden päivät juliaanisina päivinä hakua varten
+     */
+    struct Kausivali {
+        qint64 alkaa;
+        qint64 paattyy;
+        int indeksi;
+    };
+
     QList<Tilikausi> kaudet_;
+    /**
+     * @brief Kausivälit alkupäivän mukaan järjestettynä
+     *
+     * Päivän tilikausi löytyy puolitushaulla. Rakennetaan uudelleen
+     * aina tilikausia ladattaessa.
+     */
+    QVector<Kausivali> valit_;
 };
 
 #endif // TILIKAUSIMODEL_H
@@ -215,6 +215,7 @@ Tili *TiliModel::lisaaTili(int numero, int otsikkotaso)
 
     if( !otsikkotaso)
         nroHash_.insert(numero, tili);
+    indeksoi();
 
     endInsertRows();
     return tili;
@@ -223,6 +224,7 @@ Tili *TiliModel::lisaaTili(int numero, int otsikkotaso)
 void TiliModel::tallenna(Tili* tili)
 {
     int indeksi = tiliLista_.indexOf(tili);
+    indeksoi();
 
     KpKysely* kysely = kpk( tili->otsikkotaso() ?
                                 QString("/tilit/%1/%2").arg(tili->numero()).arg(tili->otsikkotaso())
@@ -246,6 +248,7 @@ void TiliModel::poistaRivi(int riviIndeksi)
     if( !tili->otsikkotaso())
         nroHash_.remove( tili->numero() );
     tiliLista_.removeAt(riviIndeksi);
+    indeksoi();
 
     KpKysely* kysely = kpk( tili->otsikkotaso() ?
                                 QString("/tilit/%1/%2").arg(tili->numero()).arg(tili->otsikkotaso())
@@ -270,6 +273,11 @@ Tili *TiliModel::tili(int numero) const
 
 Tili TiliModel::tiliNumerolla(int numero, int otsikkotaso) const
 {
+    if( !otsikkotaso ) {
+        Tili* tili = nroHash_.value(numero);
+        return tili ? *tili : Tili();
+    }
+
     for(auto tili : tiliLista_)
         if( tili->numero()==numero && tili->otsikkotaso() == otsikkotaso)
             return *tili;
@@ -278,12 +286,8 @@ Tili TiliModel::tiliNumerolla(int numero, int otsikkotaso) const
 
 Tili TiliModel::tiliIbanilla(const QString &iban) const
 {
-    for(Tili* tili: tiliLista_)
-    {
-        if( tili->str("iban") == iban)
-            return *tili;
-    }
-    return Tili();
+    Tili* tili = ibanHash_.value(iban);
+    return tili ? *tili : Tili();
 }
 
 QString TiliModel::nimi(int numero) const
@@ -298,20 +302,14 @@ QString TiliModel::nimi(int numero) const
 
 Tili TiliModel::tiliTyypilla(TiliLaji::TiliLuonne tyyppi) const
 {
-    foreach (Tili* tili, tiliLista_) {
-        if( tili->tyyppi().luonne() == tyyppi)
-            return *tili;
-    }
-    return Tili();
+    Tili* tili = luonneHash_.value(tyyppi);
+    return tili ? *tili : Tili();
 }
 
 Tili TiliModel::tiliTyypilla(const QString &tyyppikoodi) const
 {
-    for( Tili* tili : tiliLista_) {
-       if( tili->tyyppiKoodi() == tyyppikoodi)
-           return *tili;
-    }
-    return Tili();
+    Tili* tili = tyyppiHash_.value(tyyppikoodi);
+    return tili ? *tili : Tili();
 }
 
 void TiliModel::lataa(QVariantList lista)
@@ -346,6 +344,7 @@ void TiliModel::lataa(QVariantList lista)
         tiliLista_.append( tili );
 
     }
+    indeksoi();
 
     piilotetut_.clear();
     suosikit_.clear();
@@ -436,6 +435,26 @@ void TiliModel::tyhjenna()
 
     tiliLista_.clear();
     nroHash_.clear();
+    ibanHash_.clear();
+    luonneHash_.clear();
+    tyyppiHash_.clear();
+}
+
+void TiliModel::indeksoi()
+{
+    ibanHash_.clear();
+    luonneHash_.clear();
+    tyyppiHash_.clear();
+
+    // Käydään lista lopusta alkuun, jotta hakemistoon jää
+    // ensimmäinen tili, kuten listaa läpi käytäessä
+    for(int i = tiliLista_.count() - 1; i >= 0; i--) {
+        Tili* tili = tiliLista_.at(i);
+        const TiliTyyppi tyyppi = tili->tyyppi();
+        ibanHash_.insert( tili->str("iban"), tili);
+        luonneHash_.insert( tyyppi.luonne(), tili);
+        tyyppiHash_.insert( tyyppi.koodi(), tili);
+    }
 }
 
 void TiliModel::paivitaTilat()
@@ -106,11 +106,21 @@ private slots:
 
 protected:
     void tyhjenna();
+    /**
+     * @brief Rakentaa tilien hakemistot uudelleen
+     *
+     * Kutsutaan aina, kun tilejä ladataan, lisätään, poistetaan tai
+     * muokattu tili tallennetaan.
+     */
+    void indeksoi();
 
 
 protected:    
     QList<Tili*> tiliLista_;
     QHash<int,Tili*> nroHash_;
+    QHash<QString,Tili*> ibanHash_;
+    QHash<int,Tili*> luonneHash_;
+    QHash<QString,Tili*> tyyppiHash_;
 
     QString muoto_;
     QSet<int> piilotetut_;
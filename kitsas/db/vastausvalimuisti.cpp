@@ -0,0 +1,171 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vastausvalimuisti.h"
+#include "kpkysely.h"
+
+VastausValimuisti::VastausValimuisti()
+{
+    bool ok = false;
+    const int kaytossa = qEnvironmentVariableIntValue("KITSAS_VALIMUISTI", &ok);
+    if( ok )
+        kaytossa_ = kaytossa != 0;
+}
+
+bool VastausValimuisti::hae(const KpKysely *kysely, QVariant &vastaus)
+{
+    if( !kaytossa_ || kysely->metodi() != KpKysely::GET ||
+        riippuvuudet(kysely->polku()).isEmpty())
+        return false;
+
+    auto iter = vastaukset_.find( avain(kysely) );
+    if( iter == vastaukset_.end()) {
+        ohitukset_++;
+        return false;
+    }
+    if( iter->ika.hasExpired(ikaMs_)) {
+        vastaukset_.erase(iter);
+        vanhentuneet_++;
+        ohitukset_++;
+        return false;
+    }
+    osumat_++;
+    vastaus = iter->data;
+    return true;
+}
+
+void VastausValimuisti::kirjaa(const KpKysely *kysely, const QVariant &vastaus)
+{
+    if( kysely->metodi() != KpKysely::GET) {
+        const QStringList muuttuvat = muutokset(kysely->polku());
+        if( muuttuvat.isEmpty())
+            tyhjenna();
+        for(const QString& tieto : muuttuvat)
+            mitatoi(tieto);
+        return;
+    }
+
+    // Osissa lähetetystä vastauksesta ei ole tallessa koko listaa
+    if( !kaytossa_ || kysely->osakoko())
+        return;
+
+    // Haun ollessa kesken tehty muokkaus on voinut jäädä vastauksesta pois
+    if( kysely->valimuistiSukupolvi() != sukupolvi_)
+        return;
+
+    const QStringList riippuu = riippuvuudet(kysely->polku());
+    if( riippuu.isEmpty())
+        return;
+
+    if( vastaukset_.count() >= VASTAUKSIA_ENINTAAN)
+        vastaukset_.clear();
+
+    Vastaus uusi;
+    uusi.data = vastaus;
+    uusi.riippuvuudet = riippuu;
+    uusi.ika.start();
+    vastaukset_.insert( avain(kysely), uusi);
+}
+
+void VastausValimuisti::mitatoi(const QString &tieto)
+{
+    sukupolvi_++;
+    for(auto iter = vastaukset_.begin(); iter != vastaukset_.end(); ) {
+        if( iter->riippuvuudet.contains(tieto)) {
+            iter = vastaukset_.erase(iter);
+            mitatoidyt_++;
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void VastausValimuisti::tyhjenna()
+{
+    sukupolvi_++;
+    mitatoidyt_ += vastaukset_.count();
+    vastaukset_.clear();
+}
+
+void VastausValimuisti::asetaKaytossa(bool kaytossa)
+{
+    kaytossa_ = kaytossa;
+    if( !kaytossa )
+        tyhjenna();
+}
+
+QVariantMap VastausValimuisti::tilasto() const
+{
+    QVariantMap map;
+    map.insert("kaytossa", kaytossa_);
+    map.insert("vastauksia", vastaukset_.count());
+    map.insert("osumat", osumat_);
+    map.insert("ohitukset", ohitukset_);
+    map.insert("vanhentuneet", vanhentuneet_);
+    map.insert("mitatoidyt", mitatoidyt_);
+    const qlonglong kaikki = osumat_ + ohitukset_;
+    map.insert("osumaprosentti", kaikki ? 100.0 * osumat_ / kaikki : 0.0);
+    return map;
+}
+
+QStringList VastausValimuisti::riippuvuudet(const QString &polku)
+{
+    if( polku == "/saldot")
+        return { "tosite", "vienti", "tili", "tilikausi", "kohdennus", "asetus" };
+    if( juuri(polku) == "/erat")
+        return { "tosite", "vienti", "kumppani", "tili" };
+    if( polku == "/alv")
+        return { "tosite", "vienti" };
+    if( juuri(polku) == "/budjetti")
+        return { "budjetti", "tili", "kohdennus" };
+    return QStringList();
+}
+
+QStringList VastausValimuisti::muutokset(const QString &polku)
+{
+    static const QHash<QString,QStringList> muuttuvat = {
+        { "/tositteet", { "tosite", "vienti" } },
+        { "/viennit", { "tosite", "vienti" } },
+        { "/myyntilaskut", { "tosite", "vienti" } },
+        { "/ostolaskut", { "tosite", "vienti" } },
+        { "/saldot", { "tosite", "vienti" } },
+        { "/kumppanit", { "kumppani" } },
+        { "/asiakkaat", { "kumppani" } },
+        { "/toimittajat", { "kumppani" } },
+        { "/tilit", { "tili" } },
+        { "/tilikaudet", { "tilikausi" } },
+        { "/kohdennukset", { "kohdennus" } },
+        { "/asetukset", { "asetus" } },
+        { "/budjetti", { "budjetti" } },
+        { "/liitteet", { "liite" } },
+        { "/tuotteet", { "tuote" } },
+        { "/ryhmat", { "ryhma" } },
+        { "/vakioviitteet", { "vakioviite" } },
+        { "/tuontitulkki", { "tuonti" } }
+    };
+    return muuttuvat.value( juuri(polku) );
+}
+
+QString VastausValimuisti::avain(const KpKysely *kysely)
+{
+    return kysely->polku() + QChar('?') + kysely->urlKysely().toString(QUrl::FullyEncoded);
+}
+
+QString VastausValimuisti::juuri(const QString &polku)
+{
+    const int kauttaviiva = polku.indexOf(QChar('/'), 1);
+    return kauttaviiva < 0 ? polku : polku.left(kauttaviiva);
+}
@@ -0,0 +1,124 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VASTAUSVALIMUISTI_H
+#define VASTAUSVALIMUISTI_H
+
+#include <QHash>
+#include <QVariant>
+#include <QStringList>
+#include <QElapsedTimer>
+
+class KpKysely;
+
+/**
+ * @brief Toistuvien GET-kyselyiden vastausten välimuisti
+ *
+ * Välimuistiin tallennetaan vain sellaisten polkujen vastaukset, joille
+ * on määritelty riippuvuudet (esim. saldot riippuvat tositteista ja
+ * tileistä). Onnistunut muokkaava kysely mitätöi ne vastaukset, jotka
+ * riippuvat muokatusta tiedosta. Tuntemattomaan polkuun kohdistuva
+ * muokkaus tyhjentää koko välimuistin.
+ *
+ * Koska pilvessä kirjanpitoa voi muokata myös toinen käyttäjä,
+ * vastaukset vanhenevat lisäksi IKA_MS millisekunnissa.
+ *
+ * Välimuistin voi ottaa pois käytöstä kehittäjän työkaluista tai
+ * ympäristömuuttujalla KITSAS_VALIMUISTI=0.
+ */
+class VastausValimuisti
+{
+public:
+    VastausValimuisti();
+
+    /**
+     * @brief Hakee kyselyn vastauksen välimuistista
+     * @return tosi, jos vastaus löytyi
+     */
+    bool hae(const KpKysely* kysely, QVariant& vastaus);
+
+    /**
+     * @brief Kirjaa onnistuneen kyselyn vastauksen
+     *
+     * GET-kyselyn vastaus tallennetaan, jos polulle on riippuvuudet
+     * eikä välimuistia ole mitätöity kyselyn lähettämisen jälkeen.
+     * Muut metodit mitätöivät polkuun liittyvät vastaukset.
+     */
+    void kirjaa(const KpKysely* kysely, const QVariant& vastaus);
+
+    /**
+     * @brief Mitätöi tiedosta riippuvat vastaukset
+     * @param tieto Riippuvuuden nimi, esim. tosite
+     */
+    void mitatoi(const QString& tieto);
+    void tyhjenna();
+
+    /**
+     * @brief Mitätöintien laskuri
+     *
+     * Kasvaa jokaisessa mitätöinnissä. Kysely ottaa laskurin talteen
+     * lähtiessään, eikä vastausta tallenneta, jos laskuri on sen jälkeen
+     * muuttunut: muokkauksen aikana kesken ollut haku on voinut lukea
+     * vanhentuneen tiedon.
+     */
+    qlonglong sukupolvi() const { return sukupolvi_; }
+
+    void asetaIka(int ms) { ikaMs_ = ms; }
+
+    void asetaKaytossa(bool kaytossa);
+    bool kaytossa() const { return kaytossa_; }
+
+    /**
+     * @brief Osumat, ohitukset ja mitätöinnit
+     */
+    QVariantMap tilasto() const;
+
+    /**
+     * @brief Tiedot, joista polun GET-vastaus riippuu
+     * @return Tyhjä lista, jos vastausta ei tallenneta
+     */
+    static QStringList riippuvuudet(const QString& polku);
+    /**
+     * @brief Tiedot, joita polkuun kohdistuva muokkaus muuttaa
+     * @return Tyhjä lista, jos muutosta ei tunneta
+     */
+    static QStringList muutokset(const QString& polku);
+
+    static const int IKA_MS = 60000;
+    static const int VASTAUKSIA_ENINTAAN = 256;
+
+protected:
+    struct Vastaus {
+        QVariant data;
+        QStringList riippuvuudet;
+        QElapsedTimer ika;
+    };
+
+    static QString avain(const KpKysely* kysely);
+    static QString juuri(const QString& polku);
+
+    QHash<QString, Vastaus> vastaukset_;
+    bool kaytossa_ = true;
+    qlonglong sukupolvi_ = 0;
+    int ikaMs_ = IKA_MS;
+
+    qlonglong osumat_ = 0;
+    qlonglong ohitukset_ = 0;
+    qlonglong vanhentuneet_ = 0;
+    qlonglong mitatoidyt_ = 0;
+};
+
+#endif // VASTAUSVALIMUISTI_H
@@ -36,6 +36,11 @@ YhteysModel::YhteysModel(QObject *parent) :
 
 void YhteysModel::alusta()
 {
+    // Kirjanpito vaihtuu, joten aiemmat vastaukset eivät enää kelpaa
+    valimuisti_.tyhjenna();
+    disconnect( kp(), SIGNAL(kirjanpitoaMuokattu()), this, nullptr);
+    connect( kp(), &Kirjanpito::kirjanpitoaMuokattu, this, [this] { valimuisti_.mitatoi("tosite"); });
+
     KpKysely *initkysely = kysely("/init");
     connect( initkysely, &KpKysely::vastaus, this, &YhteysModel::initSaapuu );    
     initkysely->kysy();
@@ -19,6 +19,7 @@
 
 #include <QAbstractListModel>
 #include "kpkysely.h"
+#include "vastausvalimuisti.h"
 
 /**
  * @brief Tietokantayhteyksien kantaluokka
@@ -65,8 +66,16 @@ public:
     virtual qlonglong oikeudet() const = 0;
     bool onkoOikeutta(qlonglong oikeus);
 
+    /**
+     * @brief GET-kyselyiden vastausten välimuisti
+     */
+    VastausValimuisti* valimuisti() { return &valimuisti_; }
+
 private slots:
     void initSaapuu(QVariant* reply);
+
+protected:
+    VastausValimuisti valimuisti_;
 };
 
 #endif // YHTEYSMODEL_H
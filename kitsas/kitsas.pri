@@ -6,6 +6,7 @@ QT += printsupport
 QT += network
 QT += svg
 QT += xml
+QT += concurrent
 
 CONFIG += c++14
 
@@ -11,6 +11,17 @@ LIBS += -lpoppler-qt5
 LIBS += -lpoppler
 LIBS += -lzip
 
+# Kirjanpitoyhteyden SQLite-kahvaa (liitteiden blob-luku, kyselyiden
+# jäljitys ja keskeytys) käytetään vain, kun Qt:n QSQLITE-ajuri on
+# käännetty järjestelmän SQLite-kirjastoa vastaan (-system-sqlite).
+# Qt:n mukana tulevaa SQLiteä käyttävän ajurin kahva kuuluu eri
+# kirjastolle. Jos Qt:n asetuksista ei voi todeta asiaa, sen voi
+# vahvistaa käännettäessä: qmake CONFIG+=kitsas_system_sqlite
+contains(QT.sql_private.enabled_features, system-sqlite)|contains(QT.sqldrivers_private.enabled_features, system-sqlite)|kitsas_system_sqlite {
+    DEFINES += KITSAS_SYSTEM_SQLITE
+    LIBS += -lsqlite3
+}
+
 windows {
     LIBS += -lopenjp2
     LIBS += -lbcrypt
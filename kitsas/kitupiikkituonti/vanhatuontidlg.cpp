@@ -814,12 +814,40 @@ void VanhatuontiDlg::siirraTositteet()
             tosite.viennit()->lisaa(vienti);
 
         }
-        connect(&tosite, &Tosite::tallennusvirhe, [] (int virhe) { qDebug() << "TOSITEVIRHE " << virhe;});
-        tosite.tallenna();
+        // Tositteet tallennetaan erissä alkuperäisessä järjestyksessä.
+        // Täsmäämättömät jäävät luonnoksiksi korjattaviksi.
+        tosite.setData(Tosite::TILA, tosite.viennit()->debetKreditTasmaa() ? Tosite::KIRJANPIDOSSA : Tosite::LUONNOS);
+        tallennettavat_.append( tosite.tallennettava() );
+        vanhatTositteet_.append( tositeid );
+        if( tallennettavat_.count() >= TOSITTEITA_ERASSA )
+            tallennaTositteet();
         ui->progressBar->setValue( ui->progressBar->value() + 1 );
-        siirraLiiteet(tositeid, tosite.id());
         qApp->processEvents();
     }
+    tallennaTositteet();
+}
+
+void VanhatuontiDlg::tallennaTositteet()
+{
+    if( tallennettavat_.isEmpty())
+        return;
+
+    KpKysely* kysely = kp()->sqlite()->kysely("/tositteet/bulk", KpKysely::POST);
+    const QList<int> vanhat = vanhatTositteet_;
+    connect( kysely, &KpKysely::vastaus, this, [this, vanhat] (QVariant* data) {
+        const QVariantList tulokset = data->toList();
+        for(int i=0; i < tulokset.count() && i < vanhat.count(); i++) {
+            const QVariantMap tulos = tulokset.at(i).toMap();
+            if( tulos.contains("id"))
+                siirraLiiteet( vanhat.at(i), tulos.value("id").toInt());
+            else
+                qDebug() << "TOSITEVIRHE " << tulos.value("koodi").toInt() << tulos.value("virhe").toString();
+        }
+    });
+    kysely->kysy( tallennettavat_ );
+
+    tallennettavat_.clear();
+    vanhatTositteet_.clear();
 }
 
 void VanhatuontiDlg::laskuTiedot(const QSqlQuery &vientikysely, Tosite &tosite)
@@ -59,6 +59,10 @@ protected:
     void siirraAsiakkaat();
     void tallennaAsiakasId(QVariant* data);
     void siirraTositteet();    
+    /**
+     * @brief Tallentaa kerätyt tositteet yhdellä kyselyllä
+     */
+    void tallennaTositteet();
     void laskuTiedot(const QSqlQuery& vientikysely, Tosite& tosite);
     void siirraLiiteet(int vanhaTositeId, int uusiTositeId);
     void siirraLiite(int id, int uusiTositeId);
@@ -79,6 +83,10 @@ private:
     QHash<QString,int> asiakasIdt_;
     QHash<QString,QString> tilikausipaivat_;
     bool erisarja_ = false;
+
+    QVariantList tallennettavat_;
+    QList<int> vanhatTositteet_;
+    static const int TOSITTEITA_ERASSA = 500;
 };
 
 #endif // VANHATUONTIDLG_H
@@ -21,7 +21,9 @@
 
 #include "model/tosite.h"
 #include "db/kirjanpito.h"
+#include "sqlite/sqlitemodel.h"
 #include "rivivientigeneroija.h"
+#include "laskutus/tulostus/laskuntulostaja.h"
 
 #include <QMessageBox>
 #include <QTimer>
@@ -63,34 +65,137 @@ void RyhmaLaskuDialogi::tallenna(int /* tilaan */)
     } else {
         ui->tallennaNappi->setEnabled(false);
         tositteelle();
-        connect( tallennusTosite_, &Tosite::laskuTallennettu, this, &RyhmaLaskuDialogi::tallennaSeuraava);
-        tallennaSeuraava();
+        // Paikalliseen kirjanpitoon kaikki laskut tallennetaan yhdellä kyselyllä
+        if( qobject_cast<SQLiteModel*>(kp()->yhteysModel())) {
+            tallennaJoukkona();
+        } else {
+            connect( tallennusTosite_, &Tosite::laskuTallennettu, this, &RyhmaLaskuDialogi::tallennaSeuraava);
+            tallennaSeuraava();
+        }
     }
 }
 
 void RyhmaLaskuDialogi::tallennaSeuraava()
 {
     if( jono_.isEmpty()) {
-        // Kaikki tallennettu
-        emit kp()->onni(tr("Laskut tallennettu Lähtevät-kansioon"));
-        emit kp()->kirjanpitoaMuokattu();
-        QTimer::singleShot(1500, this, [] { emit kp()->kirjanpitoaMuokattu();});
-        QDialog::accept();
+        kaikkiTallennettu();
         return;
     }
-    LaskutettavatModel::Laskutettava nykyinen = jono_.takeLast();
+    valmisteleLasku( jono_.takeLast() );
+    tallennusTosite_->tallennaLasku(Tosite::VALMISLASKU);
+}
+
+void RyhmaLaskuDialogi::tallennaJoukkona()
+{
+    // Laskut muodostetaan samassa järjestyksessä kuin yksitellen
+    // tallennettaessa, jolloin myös laskunumerot menevät samoin
+    QVariantList tallennettavat;
+    joukko_.clear();
+    while( !jono_.isEmpty()) {
+        joukko_.append( jono_.last().id() );
+        valmisteleLasku( jono_.takeLast() );
+        tallennusTosite_->asetaTila(Tosite::VALMISLASKU);
+        QVariantMap map = tallennusTosite_->tallennettava();
+        map.remove("id");
+        tallennettavat.append(map);
+    }
 
+    KpKysely* kysely = kpk("/tositteet/bulk", KpKysely::POST);
+    connect( kysely, &KpKysely::vastaus, this, &RyhmaLaskuDialogi::joukkoTallennettu);
+    connect( kysely, &KpKysely::virhe, this, [this] (int /* koodi */, const QString& viesti) {
+        QMessageBox::critical(this, tr("Ryhmälasku"), tr("Laskujen tallentaminen epäonnistui\n%1").arg(viesti));
+        ui->tallennaNappi->setEnabled(true);
+    });
+    kysely->kysy(tallennettavat);
+}
+
+void RyhmaLaskuDialogi::joukkoTallennettu(QVariant *data)
+{
+    const QVariantList tulokset = data->toList();
+    QSet<int> tallennetut;
+    virheet_.clear();
+    liitteet_.clear();
+    for(int i=0; i < tulokset.count(); i++) {
+        const QVariantMap tulos = tulokset.at(i).toMap();
+        if( tulos.contains("id")) {
+            liitteet_.append( tulos.value("id").toInt() );
+            tallennetut.insert( joukko_.value(i) );
+        } else {
+            virheet_.append( tulos.value("virhe").toString() );
+        }
+    }
+
+    // Tallennetut poistetaan laskutettavista, jolloin epäonnistuneet
+    // voi tallentaa uudelleen ilman, että muille tulee toista laskua
+    LaskutettavatModel* model = ryhmalaskuTab_->model();
+    const QList<LaskutettavatModel::Laskutettava> laskutettavat = model->laskutettavat();
+    for(int i = laskutettavat.count() - 1; i >= 0; i--) {
+        if( tallennetut.contains( laskutettavat.at(i).id()))
+            model->poista(i);
+    }
+
+    tallennaSeuraavaLiite();
+}
+
+void RyhmaLaskuDialogi::tallennaSeuraavaLiite()
+{
+    if( liitteet_.isEmpty()) {
+        joukkoValmis();
+        return;
+    }
+
+    // Laskunumero ja viite on annettu tallennettaessa, joten lasku
+    // haetaan takaisin ennen liitteen muodostamista
+    KpKysely* kysely = kpk(QString("/tositteet/%1").arg( liitteet_.takeFirst() ));
+    connect( kysely, &KpKysely::vastaus, this, [this] (QVariant* data) {
+        tallennusTosite_->lataa( data->toMap() );
+        LaskunTulostaja* tulostaja = new LaskunTulostaja(kp());
+        connect( tulostaja, &LaskunTulostaja::laskuLiiteTallennettu,
+                 this, &RyhmaLaskuDialogi::tallennaSeuraavaLiite, Qt::QueuedConnection);
+        tulostaja->tallennaLaskuLiite( *tallennusTosite_ );
+    });
+    connect( kysely, &KpKysely::virhe, this, [this] (int /* koodi */, const QString& viesti) {
+        virheet_.append(viesti);
+        tallennaSeuraavaLiite();
+    });
+    kysely->kysy();
+}
+
+void RyhmaLaskuDialogi::joukkoValmis()
+{
+    if( virheet_.isEmpty()) {
+        kaikkiTallennettu();
+        return;
+    }
+
+    virheet_.removeDuplicates();
+    emit kp()->kirjanpitoaMuokattu();
+    QMessageBox::critical(this, tr("Ryhmälasku"),
+                          tr("Kaikkia laskuja ei saatu tallennettua")
+                          + "\n" + virheet_.join("\n"));
+    // Dialogi jää auki, ja Laskutettavat-välilehdelle jäävät vain ne,
+    // joiden laskua ei saatu tallennettua
+    ui->tallennaNappi->setEnabled(true);
+}
+
+void RyhmaLaskuDialogi::kaikkiTallennettu()
+{
+    emit kp()->onni(tr("Laskut tallennettu Lähtevät-kansioon"));
+    emit kp()->kirjanpitoaMuokattu();
+    QTimer::singleShot(1500, this, [] { emit kp()->kirjanpitoaMuokattu();});
+    QDialog::accept();
+}
+
+void RyhmaLaskuDialogi::valmisteleLasku(const LaskutettavatModel::Laskutettava &laskutettava)
+{
     tallennusTosite_->lataa(tosite()->tallennettava());
 
-    tallennusTosite_->lasku().setLahetystapa(nykyinen.lahetystapa());
-    tallennusTosite_->lasku().setKieli( nykyinen.kieli() );
-    tallennusTosite_->asetaKumppani( nykyinen.map() );
-    tallennusTosite_->lasku().setEmail( nykyinen.email() );
-    tallennusTosite_->lasku().setOsoite( nykyinen.osoite() );
+    tallennusTosite_->lasku().setLahetystapa(laskutettava.lahetystapa());
+    tallennusTosite_->lasku().setKieli( laskutettava.kieli() );
+    tallennusTosite_->asetaKumppani( laskutettava.map() );
+    tallennusTosite_->lasku().setEmail( laskutettava.email() );
+    tallennusTosite_->lasku().setOsoite( laskutettava.osoite() );
 
     RiviVientiGeneroija rivigeneroija(kp());
     rivigeneroija.generoiViennit(tallennusTosite_);
-
-    tallennusTosite_->tallennaLasku(Tosite::VALMISLASKU);
 }
-
@@ -20,6 +20,7 @@
 #include "rivillinenlaskudialogi.h"
 #include "laskutus/ryhmalasku/laskutettavatmodel.h"
 #include <QList>
+#include <QStringList>
 
 class RyhmalaskuTab;
 
@@ -33,8 +34,26 @@ protected:
     void tallenna(int tilaan) override;
 
     void tallennaSeuraava();
+    /**
+     * @brief Tallentaa kaikki laskut yhdellä /tositteet/bulk -kyselyllä
+     *
+     * Viennit muodostetaan muistissa, ja paikallinen kirjanpito varaa
+     * laskunumerot ja viitteet yhtenä jaksona samassa transaktiossa.
+     */
+    void tallennaJoukkona();
+    void joukkoTallennettu(QVariant* data);
+    /**
+     * @brief Muodostaa ja tallentaa joukkona tallennettujen laskujen liitteet yksi kerrallaan
+     */
+    void tallennaSeuraavaLiite();
+    void joukkoValmis();
+    void kaikkiTallennettu();
+    void valmisteleLasku(const LaskutettavatModel::Laskutettava& laskutettava);
 
     QList<LaskutettavatModel::Laskutettava> jono_;
+    QList<int> joukko_;
+    QList<int> liitteet_;
+    QStringList virheet_;
     RyhmalaskuTab* ryhmalaskuTab_;
     Tosite* tallennusTosite_;
 };
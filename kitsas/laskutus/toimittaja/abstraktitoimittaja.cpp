@@ -42,9 +42,15 @@ void AbstraktiToimittaja::keskeyta()
 
 void AbstraktiToimittaja::merkkaaToimitetuksi()
 {
-    merkkausjono_.enqueue( tositeMap().value("id").toInt() );
+    const int tositeId = tositeMap().value("id").toInt();
     if(!jono_.isEmpty())
         jono_.dequeue();
+    merkkaaToimitetuksi(tositeId);
+}
+
+void AbstraktiToimittaja::merkkaaToimitetuksi(int tositeId)
+{
+    merkkausjono_.enqueue( tositeId );
     tarkastaJono();
 
     if( !merkkausKaynnissa_ && !merkkausjono_.isEmpty())
@@ -31,18 +31,24 @@ public:
     virtual ~AbstraktiToimittaja();
 
     void lisaaLasku(const QVariantMap& tosite);
-    bool vapaa() const { return jono_.isEmpty(); }
+    virtual bool vapaa() const { return jono_.isEmpty(); }
     virtual void keskeyta();
 
 signals:
     void toimitettu();
     void epaonnistui(const QString& kuvaus);
+    void edistyminen(int valmiit, int kaikki);
 
 protected:
     virtual void toimita() = 0;
 
     QVariantMap& tositeMap() { return jono_.head();}
     void merkkaaToimitetuksi();
+    /**
+     * @brief Merkitsee jonosta jo otetun tositteen toimitetuksi
+     */
+    void merkkaaToimitetuksi(int tositeId);
+    QVariantMap otaJonosta() { return jono_.dequeue(); }
 
     void valmis();
     void virhe(const QString& kuvaus);
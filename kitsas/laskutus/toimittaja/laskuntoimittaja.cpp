@@ -160,6 +160,7 @@ void LaskunToimittaja::tarkastaValmis()
 
     if( !kaynnissa) {
         hide();
+        ui->viestiLabel->setText(tr("Laskuja toimitetaan ... "));
         emit kp()->kirjanpitoaMuokattu();
 
         if( onnistuneet_ && !epaonnistuneet_) {
@@ -203,6 +204,9 @@ void LaskunToimittaja::rekisteroiToimittaja(int tyyppi, AbstraktiToimittaja *toi
     toimittajat_.insert(tyyppi, toimittaja);
     connect( toimittaja, &AbstraktiToimittaja::toimitettu, this, &LaskunToimittaja::onnistui);
     connect( toimittaja, &AbstraktiToimittaja::epaonnistui, this, &LaskunToimittaja::virhe);
+    connect( toimittaja, &AbstraktiToimittaja::edistyminen, this, [this] (int valmiit, int kaikki) {
+        ui->viestiLabel->setText(tr("Laskuja toimitetaan %1/%2").arg(valmiit).arg(kaikki));
+    });
 }
 
 
@@ -0,0 +1,132 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "sahkopostiistunto.h"
+
+#include "smtpclient/SmtpMime"
+
+SahkopostiIstunto::SahkopostiIstunto(const Asetukset &asetukset) :
+    asetukset_(asetukset)
+{
+
+}
+
+SahkopostiIstunto::~SahkopostiIstunto()
+{
+    katkaise();
+}
+
+void SahkopostiIstunto::asetaAsetukset(const Asetukset &asetukset)
+{
+    if( asetukset != asetukset_) {
+        lopeta();
+        asetukset_ = asetukset;
+    }
+}
+
+QString SahkopostiIstunto::laheta(const SahkopostiViesti &viesti)
+{
+    EmailAddress lahettaja(viesti.lahettajaOsoite, viesti.lahettajaNimi);
+    EmailAddress vastaanottaja(viesti.vastaanottajaOsoite, viesti.vastaanottajaNimi);
+    EmailAddress piilokopio(viesti.piilokopio);
+
+    MimeMessage message;
+    message.setHeaderEncoding(MimePart::QuotedPrintable);
+    message.setSender(&lahettaja);
+    message.addRecipient(&vastaanottaja);
+    if( !viesti.piilokopio.isEmpty())
+        message.addBcc(&piilokopio);
+    message.setSubject(viesti.otsikko);
+
+    MimeText text(viesti.teksti);
+    message.addPart(&text);
+
+    MimeAttachment attachment(viesti.liite, viesti.liitteenNimi);
+    attachment.setContentType("application/pdf");
+    message.addPart(&attachment);
+
+    // Palvelin on voinut katkaista käyttämättömän yhteyden,
+    // jolloin yritetään kerran uudelleen uudella yhteydellä
+    for(int yritys = 0; yritys < 2; yritys++) {
+        if( !yhdista())
+            return yhteysvirhe_;
+        if( asiakas_->sendMail(message))
+            return QString();
+        const int koodi = asiakas_->getResponseCode();
+        const bool hylatty = yhteydessa() && koodi / 100 == 5;
+        const QString vastaus = asiakas_->getResponseText().trimmed();
+        // Keskeneräisen viestin jälkeen aloitetaan puhtaalta pöydältä
+        katkaise();
+        if( hylatty )
+            return tr("Laskun lähettäminen osoitteeseen %1 epäonnistui: %2")
+                    .arg(viesti.vastaanottajaOsoite, vastaus);
+        // Kun palvelin on jo ottanut sisällön vastaan (354), viesti on
+        // voinut mennä perille, eikä sitä lähetetä toista kertaa
+        if( koodi == 354 )
+            break;
+    }
+    return tr("Laskujen lähettäminen sähköpostillä epäonnistui.");
+}
+
+void SahkopostiIstunto::lopeta()
+{
+    if( yhteydessa())
+        asiakas_->quit();
+    katkaise();
+    yhteysvirhe_.clear();
+}
+
+bool SahkopostiIstunto::yhdista()
+{
+    if( !yhteysvirhe_.isEmpty())
+        return false;
+    if( yhteydessa())
+        return true;
+
+    katkaise();
+    asiakas_ = new SmtpClient(asetukset_.palvelin, asetukset_.portti,
+                              static_cast<SmtpClient::ConnectionType>(asetukset_.yhteystyyppi));
+    if( !asetukset_.salasana.isEmpty()) {
+        asiakas_->setUser(asetukset_.kayttaja);
+        asiakas_->setPassword(asetukset_.salasana);
+    }
+
+    if( !asiakas_->connectToHost()) {
+        yhteysvirhe_ = tr("Sähköpostipalvelimeen %1 yhdistäminen epäonnistui.\nTarkista sähköpostien lähettämisen asetukset.").arg(asetukset_.palvelin);
+    } else if( !asetukset_.salasana.isEmpty() && !asiakas_->login()) {
+        yhteysvirhe_ = tr("Sähköpostipalvelimelle %1 kirjautuminen epäonnistui.\nTarkista sähköpostien lähettämisen asetukset.").arg(asetukset_.palvelin);
+    }
+    if( !yhteysvirhe_.isEmpty()) {
+        katkaise();
+        return false;
+    }
+    yhteyksia_++;
+    return true;
+}
+
+void SahkopostiIstunto::katkaise()
+{
+    if( asiakas_ ) {
+        asiakas_->getSocket()->abort();
+        delete asiakas_;
+        asiakas_ = nullptr;
+    }
+}
+
+bool SahkopostiIstunto::yhteydessa() const
+{
+    return asiakas_ && asiakas_->getSocket()->state() == QAbstractSocket::ConnectedState;
+}
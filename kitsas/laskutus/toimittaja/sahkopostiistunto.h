@@ -0,0 +1,110 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SAHKOPOSTIISTUNTO_H
+#define SAHKOPOSTIISTUNTO_H
+
+#include <QObject>
+#include <QByteArray>
+
+class SmtpClient;
+
+/**
+ * @brief Lähetettävän sähköpostin tiedot
+ *
+ * Viesti kootaan käyttöliittymän säikeessä, ja istunto muodostaa
+ * siitä MIME-viestin omassa säikeessään.
+ */
+struct SahkopostiViesti
+{
+    QString lahettajaNimi;
+    QString lahettajaOsoite;
+    QString vastaanottajaNimi;
+    QString vastaanottajaOsoite;
+    QString piilokopio;
+    QString otsikko;
+    QString teksti;
+    QString liitteenNimi;
+    QByteArray liite;
+};
+
+/**
+ * @brief Pysyvä SMTP-istunto
+ *
+ * Elää omassa säikeessään, ja metodeja kutsutaan jonotettuina.
+ * Yhteys muodostetaan ja kirjaudutaan ensimmäistä viestiä lähetettäessä,
+ * ja samaa yhteyttä käytetään, kunnes lopeta() kutsutaan. Jos yhteys
+ * on katkennut ennen kuin palvelin otti viestin sisällön vastaan,
+ * muodostetaan uusi yhteys ja viesti yritetään lähettää uudelleen kerran.
+ *
+ * Jos yhdistäminen tai kirjautuminen epäonnistuu, loput viestit
+ * hylätään yrittämättä uudelleen, kunnes istunto lopetetaan.
+ */
+class SahkopostiIstunto : public QObject
+{
+    Q_OBJECT
+public:
+    struct Asetukset {
+        QString palvelin;
+        int portti = 25;
+        int yhteystyyppi = 0;   // SmtpClient::ConnectionType
+        QString kayttaja;
+        QString salasana;
+
+        bool operator==(const Asetukset& toinen) const {
+            return palvelin == toinen.palvelin && portti == toinen.portti &&
+                   yhteystyyppi == toinen.yhteystyyppi && kayttaja == toinen.kayttaja &&
+                   salasana == toinen.salasana;
+        }
+        bool operator!=(const Asetukset& toinen) const { return !(*this == toinen); }
+    };
+
+    explicit SahkopostiIstunto(const Asetukset& asetukset = Asetukset());
+    ~SahkopostiIstunto() override;
+
+    /**
+     * @brief Vaihtaa asetukset, muuttuneilla asetuksilla yhteys katkaistaan
+     */
+    void asetaAsetukset(const Asetukset& asetukset);
+
+    /**
+     * @brief Lähettää viestin
+     * @return Virheilmoitus tai tyhjä, jos viesti lähetettiin
+     */
+    QString laheta(const SahkopostiViesti& viesti);
+
+    /**
+     * @brief Päättää istunnon QUIT-komennolla
+     */
+    void lopeta();
+
+    /**
+     * @brief Muodostettujen yhteyksien määrä
+     */
+    int yhteyksia() const { return yhteyksia_; }
+
+protected:
+    bool yhdista();
+    void katkaise();
+    bool yhteydessa() const;
+
+    Asetukset asetukset_;
+    SmtpClient* asiakas_ = nullptr;
+    QString yhteysvirhe_;
+    int yhteyksia_ = 0;
+};
+
+#endif // SAHKOPOSTIISTUNTO_H
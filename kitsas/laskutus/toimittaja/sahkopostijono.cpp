@@ -0,0 +1,118 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "sahkopostijono.h"
+
+SahkopostiJono::SahkopostiJono(const SahkopostiIstunto::Asetukset &asetukset, QObject *parent) :
+    QObject(parent), kerta_(0),
+    istunto_(new SahkopostiIstunto(asetukset))
+{
+    istunto_->moveToThread(&saie_);
+    saie_.start();
+}
+
+SahkopostiJono::~SahkopostiJono()
+{
+    kerta_++;
+    odottavat_.clear();
+
+    SahkopostiIstunto* istunto = istunto_;
+    QMetaObject::invokeMethod(istunto, [istunto] { istunto->lopeta(); }, Qt::BlockingQueuedConnection);
+    saie_.quit();
+    saie_.wait();
+    delete istunto_;
+}
+
+void SahkopostiJono::lisaa(int tunnus, const SahkopostiViesti &viesti, Liite liite)
+{
+    odottavat_.enqueue( Odottava{tunnus, viesti, liite} );
+    kaikki_++;
+    kaynnista();
+}
+
+void SahkopostiJono::asetaAsetukset(const SahkopostiIstunto::Asetukset &asetukset)
+{
+    SahkopostiIstunto* istunto = istunto_;
+    QMetaObject::invokeMethod(istunto, [istunto, asetukset] { istunto->asetaAsetukset(asetukset); }, Qt::QueuedConnection);
+}
+
+void SahkopostiJono::keskeyta()
+{
+    kerta_++;
+    odottavat_.clear();
+    valmiit_ = 0;
+    kaikki_ = 0;
+}
+
+void SahkopostiJono::kaynnista()
+{
+    if( renderoidaan_ || kesken_ >= ENNAKKO || odottavat_.isEmpty())
+        return;
+    // Liitteet muodostetaan yksi kerrallaan omilla kierroksillaan,
+    // jotta käyttöliittymä ehtii päivittyä niiden välissä
+    renderoidaan_ = true;
+    QMetaObject::invokeMethod(this, &SahkopostiJono::renderoi, Qt::QueuedConnection);
+}
+
+void SahkopostiJono::renderoi()
+{
+    renderoidaan_ = false;
+    if( kesken_ >= ENNAKKO || odottavat_.isEmpty())
+        return;
+
+    const Odottava odottava = odottavat_.dequeue();
+    kesken_++;
+
+    SahkopostiViesti viesti = odottava.viesti;
+    viesti.liite = odottava.liite();
+
+    SahkopostiJono* jono = this;
+    SahkopostiIstunto* istunto = istunto_;
+    const int kerta = kerta_;
+    const int tunnus = odottava.tunnus;
+    QMetaObject::invokeMethod(istunto, [jono, istunto, kerta, tunnus, viesti] {
+        // Keskeytetyn erän laskuja ei enää lähetetä
+        const QString syy = kerta == jono->kerta_ ? istunto->laheta(viesti) : QString();
+        QMetaObject::invokeMethod(jono, [jono, kerta, tunnus, syy] {
+            jono->kasittele(kerta, tunnus, syy); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+
+    kaynnista();
+}
+
+void SahkopostiJono::kasittele(int kerta, int tunnus, const QString &syy)
+{
+    kesken_--;
+    if( kerta == kerta_) {
+        valmiit_++;
+        if( syy.isEmpty())
+            emit lahetetty(tunnus);
+        else
+            emit epaonnistui(tunnus, syy);
+        emit edistyminen(valmiit_, kaikki_);
+    }
+    kaynnista();
+
+    if( vapaa()) {
+        SahkopostiIstunto* istunto = istunto_;
+        QMetaObject::invokeMethod(istunto, [istunto] { istunto->lopeta(); }, Qt::QueuedConnection);
+        const bool nykyinen = kerta == kerta_;
+        valmiit_ = 0;
+        kaikki_ = 0;
+        if( nykyinen )
+            emit valmis();
+    }
+}
@@ -0,0 +1,105 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SAHKOPOSTIJONO_H
+#define SAHKOPOSTIJONO_H
+
+#include <QObject>
+#include <QQueue>
+#include <QThread>
+
+#include <functional>
+#include <atomic>
+
+#include "sahkopostiistunto.h"
+
+/**
+ * @brief Sähköpostilaskujen lähetysjono
+ *
+ * Liitteet (laskujen pdf:t) muodostetaan jonon omassa säikeessä yksi
+ * kerrallaan tapahtumasilmukan kierroksilla, koska muodostaminen käyttää
+ * kirjanpidon tietoja. Valmiit viestit lähetetään omassa säikeessään
+ * toimivan pysyvän SMTP-istunnon kautta, joten liitteitä muodostetaan
+ * samalla, kun edellisiä lähetetään. Koko erä lähetetään yhdellä yhteydellä.
+ *
+ * Muodostettuna ja lähetysjonossa on kerrallaan enintään
+ * ENNAKKO laskua, jotta suuri erä ei täytä muistia liitteillä.
+ *
+ * Tulokset ilmoitetaan jonon omistavan säikeen signaaleina.
+ */
+class SahkopostiJono : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<QByteArray()> Liite;
+
+    explicit SahkopostiJono(const SahkopostiIstunto::Asetukset& asetukset,
+                            QObject* parent = nullptr);
+    ~SahkopostiJono() override;
+
+    /**
+     * @brief Lisää laskun jonoon
+     * @param tunnus Tunnus, jolla tulos ilmoitetaan
+     * @param viesti Viesti ilman liitettä
+     * @param liite Liitteen muodostava funktio, suoritetaan jonon säikeessä
+     */
+    void lisaa(int tunnus, const SahkopostiViesti& viesti, Liite liite);
+
+    /**
+     * @brief Vaihtaa seuraavien viestien lähetysasetukset
+     */
+    void asetaAsetukset(const SahkopostiIstunto::Asetukset& asetukset);
+
+    /**
+     * @brief Hylkää lähettämättömät laskut
+     *
+     * Jo lähetettävänä olevan laskun tulosta ei enää ilmoiteta.
+     */
+    void keskeyta();
+
+    bool vapaa() const { return odottavat_.isEmpty() && kesken_ == 0; }
+
+    static const int ENNAKKO = 4;
+
+signals:
+    void lahetetty(int tunnus);
+    void epaonnistui(int tunnus, const QString& syy);
+    void edistyminen(int valmiit, int kaikki);
+    void valmis();
+
+protected:
+    struct Odottava {
+        int tunnus;
+        SahkopostiViesti viesti;
+        Liite liite;
+    };
+
+    void kaynnista();
+    void renderoi();
+    void kasittele(int kerta, int tunnus, const QString& syy);
+
+    QQueue<Odottava> odottavat_;
+    int kesken_ = 0;
+    int valmiit_ = 0;
+    int kaikki_ = 0;
+    bool renderoidaan_ = false;
+    std::atomic_int kerta_;
+
+    QThread saie_;
+    SahkopostiIstunto* istunto_;
+};
+
+#endif // SAHKOPOSTIJONO_H
@@ -15,8 +15,8 @@
    along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "sahkopostitoimittaja.h"
+#include "sahkopostijono.h"
 
-#include "smtpclient/SmtpMime"
 #include "maaritys/emailmaaritys.h"
 
 #include "laskutus/tulostus/laskuntulostaja.h"
@@ -32,83 +32,88 @@ SahkopostiToimittaja::SahkopostiToimittaja(QObject *parent)
 }
 
 
+SahkopostiToimittaja::~SahkopostiToimittaja()
+{
+    delete jono_;
+}
+
+bool SahkopostiToimittaja::vapaa() const
+{
+    return AbstraktiToimittaja::vapaa() && (!jono_ || jono_->vapaa());
+}
+
+void SahkopostiToimittaja::keskeyta()
+{
+    AbstraktiToimittaja::keskeyta();
+    if( jono_ )
+        jono_->keskeyta();
+}
+
+
 void SahkopostiToimittaja::toimita()
 {
     bool kpasetus = !kp()->asetukset()->asetus(AsetusModel::SmtpServer).isEmpty();
-    QString server = kpasetus ? kp()->asetukset()->asetus(AsetusModel::SmtpServer) : kp()->settings()->value("SmtpServer").toString();
-    int port = kpasetus ? kp()->asetukset()->luku(AsetusModel::SmtpPort) : kp()->settings()->value("SmtpPort").toInt();
-    QString user = kpasetus ? kp()->asetukset()->asetus(AsetusModel::SmtpUser) : kp()->settings()->value("SmtpUser").toString();
-    QString password = kpasetus ? kp()->asetukset()->asetus(AsetusModel::SmtpPassword) : kp()->settings()->value("SmtpPassword").toString();
-    int tyyppi = EmailMaaritys::sslIndeksi( kpasetus ? kp()->asetukset()->asetus(AsetusModel::EmailSSL) : kp()->settings()->value("EmailSSL").toString() );
+    SahkopostiIstunto::Asetukset asetukset;
+    asetukset.palvelin = kpasetus ? kp()->asetukset()->asetus(AsetusModel::SmtpServer) : kp()->settings()->value("SmtpServer").toString();
+    asetukset.portti = kpasetus ? kp()->asetukset()->luku(AsetusModel::SmtpPort) : kp()->settings()->value("SmtpPort").toInt();
+    asetukset.kayttaja = kpasetus ? kp()->asetukset()->asetus(AsetusModel::SmtpUser) : kp()->settings()->value("SmtpUser").toString();
+    asetukset.salasana = kpasetus ? kp()->asetukset()->asetus(AsetusModel::SmtpPassword) : kp()->settings()->value("SmtpPassword").toString();
+    asetukset.yhteystyyppi = EmailMaaritys::sslIndeksi( kpasetus ? kp()->asetukset()->asetus(AsetusModel::EmailSSL) : kp()->settings()->value("EmailSSL").toString() );
     QString kenelta = kpasetus ? kp()->asetukset()->asetus(AsetusModel::EmailNimi) : kp()->settings()->value("EmailNimi").toString();
     QString keneltaEmail = kpasetus ? kp()->asetukset()->asetus(AsetusModel::EmailOsoite) : kp()->settings()->value("EmailOsoite").toString();
     QString kopioEmail = kpasetus ? kp()->asetukset()->asetus(AsetusModel::EmailKopio) :
                                     kp()->settings()->value("EmailKopio").toString();
 
-
-    SmtpClient client(server, port, (SmtpClient::ConnectionType) tyyppi);
-    if( !password.isEmpty()) {
-        client.setUser(user);
-        client.setPassword(password);
-    }
-
-    if( !client.connectToHost()) {
-        virhe(tr("Sähköpostipalvelimeen %1 yhdistäminen epäonnistui.\nTarkista sähköpostien lähettämisen asetukset.").arg(server));
-        return;
-    } else if( !password.isEmpty() && !client.login() ) {
-        virhe(tr("Sähköpostipalvelimelle %1 kirjautuminen epäonnistui.\nTarkista sähköpostien lähettämisen asetukset.").arg(server));
-        return;
-    }
-
-    Tosite tosite;
-    tosite.lataa(tositeMap());
-
-
-    QString kenelleNimi = tosite.kumppaninimi();
-    QString kenelleEmail = tosite.lasku().email();
-    QString kieli = tosite.lasku().kieli().toLower();
-
-    LaskunTulostaja tulostaja(kp());
-
-    QString otsikko = QString("%3 %1 %2").arg(tosite.lasku().numero(), kp()->asetukset()->asetus(AsetusModel::OrganisaatioNimi),
-            tosite.tyyppi() == TositeTyyppi::HYVITYSLASKU ? tulkkaa("hlasku", kieli) :
-                           (tosite.tyyppi() == TositeTyyppi::MAKSUMUISTUTUS ? tulkkaa("maksumuistutus", kieli)
-                                                                            : tulkkaa("laskuotsikko", kieli)));
-
-    MimeMessage message;
-    message.setHeaderEncoding(MimePart::QuotedPrintable);
-    message.setSender(new EmailAddress(keneltaEmail, kenelta));
-    message.addRecipient(new EmailAddress(kenelleEmail, kenelleNimi));
-
-    if( !kopioEmail.isEmpty())
-        message.addBcc(new EmailAddress(kopioEmail));
-
-    message.setSubject(otsikko);
-
-    QString viesti = tosite.lasku().saate();
-    if(viesti.isEmpty())
-        viesti = kp()->asetukset()->asetus("EmailSaate");
-
-    if( kp()->asetukset()->luku("EmailMuoto")) {
-        if(!viesti.isEmpty())
-            viesti.append("\n\n");
-        viesti.append( maksutiedot(tosite) );
-    }
-
-    MimeText text(viesti);
-    message.addPart(&text);
-
-    QString filename = tulkkaa("laskuotsikko",kieli).toLower() + tosite.lasku().numero() + ".pdf";
-    MimeAttachment attachment(tulostaja.pdf(tosite), filename);
-    attachment.setContentType("application/pdf");
-    message.addPart(&attachment);
-
-    if(client.sendMail(message)) {
-        merkkaaToimitetuksi();
+    if( !jono_ ) {
+        jono_ = new SahkopostiJono(asetukset);
+        connect( jono_, &SahkopostiJono::lahetetty, this, [this] (int tositeId) { merkkaaToimitetuksi(tositeId); });
+        connect( jono_, &SahkopostiJono::epaonnistui, this, [this] (int /* tositeId */, const QString& syy) { emit epaonnistui(syy); });
+        connect( jono_, &SahkopostiJono::edistyminen, this, &SahkopostiToimittaja::edistyminen);
     } else {
-        virhe(tr("Laskujen lähettäminen sähköpostillä epäonnistui."));
+        jono_->asetaAsetukset(asetukset);
     }
 
+    // Viestit kootaan tässä, liitteet muodostetaan jonossa vuorollaan
+    // ja viestit lähetetään istunnon säikeessä yhden yhteyden kautta
+    while( jonossa()) {
+        const QVariantMap map = otaJonosta();
+
+        Tosite tosite;
+        tosite.lataa(map);
+
+        QString kieli = tosite.lasku().kieli().toLower();
+
+        SahkopostiViesti viesti;
+        viesti.lahettajaNimi = kenelta;
+        viesti.lahettajaOsoite = keneltaEmail;
+        viesti.vastaanottajaNimi = tosite.kumppaninimi();
+        viesti.vastaanottajaOsoite = tosite.lasku().email();
+        viesti.piilokopio = kopioEmail;
+
+        viesti.otsikko = QString("%3 %1 %2").arg(tosite.lasku().numero(), kp()->asetukset()->asetus(AsetusModel::OrganisaatioNimi),
+                tosite.tyyppi() == TositeTyyppi::HYVITYSLASKU ? tulkkaa("hlasku", kieli) :
+                               (tosite.tyyppi() == TositeTyyppi::MAKSUMUISTUTUS ? tulkkaa("maksumuistutus", kieli)
+                                                                                : tulkkaa("laskuotsikko", kieli)));
+
+        viesti.teksti = tosite.lasku().saate();
+        if(viesti.teksti.isEmpty())
+            viesti.teksti = kp()->asetukset()->asetus("EmailSaate");
+
+        if( kp()->asetukset()->luku("EmailMuoto")) {
+            if(!viesti.teksti.isEmpty())
+                viesti.teksti.append("\n\n");
+            viesti.teksti.append( maksutiedot(tosite) );
+        }
+
+        viesti.liitteenNimi = tulkkaa("laskuotsikko",kieli).toLower() + tosite.lasku().numero() + ".pdf";
+
+        jono_->lisaa(map.value("id").toInt(), viesti, [map] {
+            Tosite tosite;
+            tosite.lataa(map);
+            LaskunTulostaja tulostaja(kp());
+            return tulostaja.pdf(tosite);
+        });
+    }
 }
 
 QString SahkopostiToimittaja::maksutiedot(const Tosite &tosite)
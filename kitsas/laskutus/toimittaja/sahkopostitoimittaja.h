@@ -19,17 +19,24 @@
 
 #include "abstraktitoimittaja.h"
 
+class SahkopostiJono;
+
 class SahkopostiToimittaja : public AbstraktiToimittaja
 {
     Q_OBJECT
 public:
     SahkopostiToimittaja(QObject* parent = nullptr);
+    ~SahkopostiToimittaja() override;
 
+    bool vapaa() const override;
+    void keskeyta() override;
 
 protected:
     virtual void toimita() override;
 
     QString maksutiedot(const Tosite& tosite);
+
+    SahkopostiJono* jono_ = nullptr;
 };
 
 #endif // SAHKOPOSTITOIMITTAJA_H
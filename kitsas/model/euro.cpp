@@ -76,6 +76,11 @@ QVariant Euro::toVariant() const
     return QVariant( toString() );
 }
 
+QVariant Euro::toTypedVariant() const
+{
+    return QVariant::fromValue(*this);
+}
+
 Euro Euro::operator+(const Euro &other) const
 {
     qlonglong sum = this->cents() + other.cents();
@@ -124,6 +129,11 @@ Euro Euro::operator/(const Euro &other) const
 
 Euro Euro::fromVariant(const QVariant &variant)
 {
+    if( variant.userType() == qMetaTypeId<Euro>())
+        return *static_cast<const Euro*>(variant.constData());
+    // Liukuluvun merkkijonoesitys voi olla eksponenttimuotoinen
+    if( variant.userType() == QMetaType::Double)
+        return fromDouble( variant.toDouble() );
     return Euro( variant.toString() );
 }
 
@@ -258,3 +268,23 @@ Euro operator/(const Euro& a, const double b) {
 
 const Euro Euro::Zero = Euro(0);
 
+void Euro::registerMetaType()
+{
+    static bool rekisteroity = false;
+    if( rekisteroity )
+        return;
+    rekisteroity = true;
+
+    qRegisterMetaType<Euro>("Euro");
+    QMetaType::registerConverter<Euro,QString>(&Euro::toString);
+    QMetaType::registerConverter<Euro,double>(&Euro::toDouble);
+    QMetaType::registerConverter<QString,Euro>([] (const QString& str) { return Euro(str); });
+    QMetaType::registerComparators<Euro>();
+    QMetaType::registerDebugStreamOperator<Euro>();
+}
+
+static void rekisteroiEuro()
+{
+    Euro::registerMetaType();
+}
+Q_CONSTRUCTOR_FUNCTION(rekisteroiEuro)
@@ -38,6 +38,16 @@ public:
     QString local() const;
     QString display(bool naytaNolla = true) const;
     QVariant toVariant() const;
+    /**
+     * @brief Euro-tyyppinen QVariant
+     *
+     * Paikallisen kirjanpidon reitit palauttavat rahamäärät tässä
+     * muodossa, jolloin sentit säilyvät kokonaislukuina. Rekisteröityjen
+     * muunnosten ansiosta toString() ja toDouble() toimivat kuten
+     * merkkijonoksi muunnetulla rahamäärällä, ja fromVariant() lukee
+     * sentit suoraan.
+     */
+    QVariant toTypedVariant() const;
 
     Euro operator+(const Euro& other) const;
     Euro operator-(const Euro& other) const;
@@ -66,6 +76,13 @@ public:
 
     static const Euro Zero;
 
+    /**
+     * @brief Rekisteröi tyypin muunnokset ja vertailut QVariantille
+     *
+     * Kutsutaan automaattisesti ohjelman käynnistyessä.
+     */
+    static void registerMetaType();
+
 private:
     static qlonglong stringToCents(const QString& euroString);    
 
@@ -22,6 +22,7 @@
 
 #include "model/tosite.h"
 #include "model/lasku.h"
+#include "model/euro.h"
 #include "db/tositetyyppimodel.h"
 
 LaskuTauluModel::LaskuTauluModel(QObject *parent)
@@ -103,28 +104,32 @@ QVariant LaskuTauluModel::data(const QModelIndex &index, int role) const
             case ERAPVM:
                 return map.value("erapvm").toDate();
             case SUMMA:
+            {
+                const Euro summa = Euro::fromVariant(map.value("summa"));
                 if( role == Qt::DisplayRole)
                 {
-                    double summa = map.value("summa").toDouble();
-                    if( qAbs(summa) > 1e-5)
-                        return QString("%L1 €").arg(summa,0,'f',2);
+                    if( summa.cents() )
+                        return summa.display();
                     else
                         return QVariant();  // Nollalle tyhjää
                 }
                 else
-                   return map.value("summa").toDouble();
+                   return summa.toDouble();
+            }
             case MAKSAMATTA:
+            {
+                const Euro avoin = Euro::fromVariant(map.value("avoin"));
                 if( role == Qt::DisplayRole)
-                {                                     
-                    double avoin = map.value("avoin").toDouble();
-                    if( qAbs(avoin) > 1e-5)
-                        return QString("%L1 €").arg( avoin ,0,'f',2);
+                {
+                    if( avoin.cents() )
+                        return avoin.display();
                     else
                         return QVariant();  // Nollalle tyhjää
                 }
                 else {
-                    return map.value("avoin").toDouble();
+                    return avoin.toDouble();
                 }
+            }
             case LAHETYSTAPA:
             {
                 return ToimitustapaDelegaatti::toimitustapa(map.value("laskutapa").toInt());
@@ -155,7 +160,9 @@ QVariant LaskuTauluModel::data(const QModelIndex &index, int role) const
                     return QColor(Qt::red);
             return QVariant();
     case AvoinnaRooli:
-        return map.value("avoin");
+        // Paikallinen kirjanpito palauttaa Euro-tyyppisen arvon, jota
+        // lajittelevat ja suodattavat välityskerrokset eivät tunne
+        return Euro::fromVariant(map.value("avoin")).toDouble();
     case EraIdRooli:
         return map.value("eraid");
     case LaskuPvmRooli:
@@ -250,7 +257,7 @@ QVariant LaskuTauluModel::data(const QModelIndex &index, int role) const
     case TilaRooli:
         return map.value("tila");
     case SummaRooli:
-        return map.value("summa").toDouble();
+        return Euro::fromVariant(map.value("summa")).toDouble();
     case OtsikkoRooli:
         return map.value("otsikko");
     case OstoLaskutTieto:
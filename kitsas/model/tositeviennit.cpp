@@ -67,7 +67,7 @@ int TositeViennit::rowCount(const QModelIndex &parent) const
     if (parent.isValid())
         return 0;
 
-    return viennit_.count();
+    return rivit_.count();
 }
 
 int TositeViennit::columnCount(const QModelIndex &parent) const
@@ -80,40 +80,40 @@ int TositeViennit::columnCount(const QModelIndex &parent) const
 
 QVariant TositeViennit::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid())
+    if (!index.isValid() || index.row() >= rivit_.count())
         return QVariant();
 
-    TositeVienti rivi = vienti(index.row());
+    const VientiRivi& rivi = rivit_.at(index.row());
 
     switch (role) {
     case Qt::DisplayRole :
         switch ( index.column()) {
         case PVM:
-            return rivi.value("pvm").toDate();
+            return rivi.pvm();
         case TILI:
         {
-            Tili *tili = kp()->tilit()->tili( rivi.value("tili").toInt() );
+            Tili *tili = kp()->tilit()->tili( rivi.tili() );
             if( tili )
                 return QString("%1 %2").arg(tili->numero()).arg(tili->nimi());
             return QVariant();
         }
         case DEBET:
         {
-            double debet = rivi.value("debet").toDouble();
+            double debet = rivi.debet();
              if( debet > 1e-5 )
                 return QVariant( QString("%L1 €").arg(debet,0,'f',2));
              return QVariant();
         }
         case KREDIT:
         {
-            double kredit = rivi.value("kredit").toDouble();
+            double kredit = rivi.kredit();
             if( kredit > 1e-5)
                 return QVariant( QString("%L1 €").arg(kredit,0,'f',2));
              return QVariant();
         }
         case ALV:
         {
-            int alvkoodi = rivi.value("alvkoodi").toInt();
+            int alvkoodi = rivi.alvKoodi();
             if( alvkoodi == AlvKoodi::EIALV )
                 return QVariant();
             else
@@ -123,32 +123,33 @@ QVariant TositeViennit::data(const QModelIndex &index, int role) const
                 else if(kp()->alvTyypit()->nollaTyyppi(alvkoodi) )
                     return QString();
                 else
-                    return QVariant( QString("%1 %").arg( qRound64(rivi.value("alvprosentti").toDouble()) ));
+                    return QVariant( QString("%1 %").arg( qRound64(rivi.alvProsentti()) ));
             }
         }
         case KUMPPANI:
-            return rivi.value("kumppani").toMap().value("nimi").toString();
+            return rivi.kumppaniNimi();
         case SELITE:
-            return rivi.value("selite");
+            return rivi.selite();
         case KOHDENNUS:
             QString txt;
-            int kohdennus = rivi.value("kohdennus").toInt();
+            int kohdennus = rivi.kohdennus();
             if( kohdennus )
                 txt.append( kp()->kohdennukset()->kohdennus(kohdennus).nimi() + " " );
-            QVariantList merkkaukset = rivi.value("merkkaukset").toList();
-            for( const auto& merkkaus : qAsConst( merkkaukset ))
+            for( const auto& merkkaus : rivi.merkkaukset())
                 txt.append( kp()->kohdennukset()->kohdennus( merkkaus.toInt() ).nimi() + " " );
             if( rivi.eraId() == -1 || (rivi.eraId() == rivi.id() && rivi.eraId() > 0))
                 txt.append(tr("Uusi erä"));
-            else if( rivi.value("era").toMap().contains("tunniste")  )
+            else if( rivi.era().contains("tunniste")  )
             {
-                if( rivi.value("era").toMap().value("tunniste") != rivi.value("tosite").toMap().value("tunniste") ||
-                    rivi.value("era").toMap().value("pvm") != rivi.value("tosite").toMap().value("pvm")) {
-                    txt.append( kp()->tositeTunnus( rivi.value("era").toMap().value("tunniste").toInt(),
-                                                    rivi.value("era").toMap().value("pvm").toDate(),
-                                                    rivi.value("era").toMap().value("sarja").toString()) );
+                const QVariantMap& era = rivi.era();
+                const QVariantMap tosite = rivi.muut().value("tosite").toMap();
+                if( era.value("tunniste") != tosite.value("tunniste") ||
+                    era.value("pvm") != tosite.value("pvm")) {
+                    txt.append( kp()->tositeTunnus( era.value("tunniste").toInt(),
+                                                    era.value("pvm").toDate(),
+                                                    era.value("sarja").toString()) );
                 }
-            }            
+            }
             return txt;
 
         }
@@ -157,13 +158,13 @@ QVariant TositeViennit::data(const QModelIndex &index, int role) const
         switch ( index.column())
         {
         case PVM:
-            return rivi.value("pvm").toDate();
+            return rivi.pvm();
         case TILI:
-            return rivi.value("tili").toInt();
+            return rivi.tili();
         case DEBET:
-            return rivi.value("debet").toDouble();
+            return rivi.debet();
         case KREDIT:
-            return rivi.value("kredit").toDouble();
+            return rivi.kredit();
         case KOHDENNUS:
             return rivi.kohdennus();
         case SELITE:
@@ -181,13 +182,13 @@ QVariant TositeViennit::data(const QModelIndex &index, int role) const
     case Qt::DecorationRole:
         if( index.column() == ALV )
         {
-            return kp()->alvTyypit()->kuvakeKoodilla( rivi.data(TositeVienti::ALVKOODI).toInt() );
+            return kp()->alvTyypit()->kuvakeKoodilla( rivi.alvKoodi() );
         } else if( index.column() == KOHDENNUS ) {
-            if( rivi.contains("era") && rivi.value("era").toMap().value("saldo") == 0 )
+            if( rivi.onko(TositeVienti::ERA) && rivi.era().value("saldo") == 0 )
                 return QIcon(":/pic/ok.png");
-            Kohdennus kohdennus = kp()->kohdennukset()->kohdennus( rivi.value("kohdennus").toInt() );
+            Kohdennus kohdennus = kp()->kohdennukset()->kohdennus( rivi.kohdennus() );
             if(kohdennus.tyyppi())
-                return kp()->kohdennukset()->kohdennus( rivi.value("kohdennus").toInt()).tyyppiKuvake();
+                return kohdennus.tyyppiKuvake();
             else
                 return QIcon(":/pic/tyhja.png");
         } else if( index.column() == PVM)
@@ -228,7 +229,7 @@ QVariant TositeViennit::data(const QModelIndex &index, int role) const
         return tili.eritellaankoTase();
     }
     case TagiIdListaRooli:
-        return rivi.data(TositeVienti::MERKKAUKSET);
+        return rivi.onko(TositeVienti::MERKKAUKSET) ? QVariant(rivi.merkkaukset()) : QVariant();
     case TyyppiRooli:
         return rivi.tyyppi();
     case Qt::TextColorRole:
@@ -285,7 +286,7 @@ bool TositeViennit::setData(const QModelIndex &index, const QVariant &value, int
                 }
             case SELITE:
                 rivi.setSelite( value.toString());
-                viennit_[index.row()] = rivi;
+                rivit_[index.row()] = VientiRivi(rivi);
                 emit dataChanged(index, index, QVector<int>() << role);
                 paivitaAalv(index.row());
                 return true;
@@ -294,7 +295,7 @@ bool TositeViennit::setData(const QModelIndex &index, const QVariant &value, int
                     rivi.setKredit( 0 - value.toDouble());
                 else
                     rivi.setDebet( value.toDouble() );
-                viennit_[index.row()] = rivi;
+                rivit_[index.row()] = VientiRivi(rivi);
                 emit dataChanged(index, index.sibling(index.row(), TositeViennit::KREDIT), QVector<int>() << Qt::EditRole);
                 paivitaAalv(index.row());
                 return true;
@@ -303,7 +304,7 @@ bool TositeViennit::setData(const QModelIndex &index, const QVariant &value, int
                     rivi.setDebet( 0 - value.toDouble());
                 else
                     rivi.setKredit( value.toDouble() );
-                viennit_[index.row()] = rivi;
+                rivit_[index.row()] = VientiRivi(rivi);
                 emit dataChanged(index.sibling(index.row(), TositeViennit::DEBET), index, QVector<int>() << Qt::EditRole);
                 paivitaAalv(index.row());
                 return true;
@@ -319,7 +320,7 @@ bool TositeViennit::setData(const QModelIndex &index, const QVariant &value, int
 
             }
 
-            viennit_[index.row()] = rivi;
+            rivit_[index.row()] = VientiRivi(rivi);
         } else if( role == TositeViennit::EraMapRooli && index.column() != KUMPPANI) {
             TositeVienti rivi = vienti(index.row());
             rivi.setEra( value.toMap() );
@@ -332,25 +333,25 @@ bool TositeViennit::setData(const QModelIndex &index, const QVariant &value, int
                     rivi.setDebet(avoin);
             }
 
-            viennit_[index.row()] = rivi;
+            rivit_[index.row()] = VientiRivi(rivi);
             emit dataChanged(index.sibling(index.row(), TositeViennit::DEBET), index, QVector<int>() << Qt::EditRole);
             return true;
         } else if( role == TositeViennit::AlvKoodiRooli) {
             TositeVienti rivi = vienti(index.row());            
             rivi.setAlvKoodi( value.toInt());
-            viennit_[index.row()] = rivi;
+            rivit_[index.row()] = VientiRivi(rivi);
             paivitaAalv(index.row());
             emit dataChanged(index, index, QVector<int>() << Qt::EditRole);
         } else if( role == TositeViennit::AlvProsenttiRooli) {
             TositeVienti rivi = vienti(index.row());
             rivi.setAlvProsentti( value.toDouble() );
-            viennit_[index.row()] = rivi;
+            rivit_[index.row()] = VientiRivi(rivi);
             paivitaAalv(index.row());
             emit dataChanged(index, index, QVector<int>() << Qt::EditRole);
         } else if( role == TositeViennit::TagiIdListaRooli) {
             TositeVienti rivi = vienti(index.row());
             rivi.setMerkkaukset(value.toList());
-            viennit_[index.row()] = rivi;
+            rivit_[index.row()] = VientiRivi(rivi);
             emit dataChanged(index, index, QVector<int>() << Qt::EditRole);
         }
         emit dataChanged(index, index, QVector<int>() << role);
@@ -364,7 +365,7 @@ Qt::ItemFlags TositeViennit::flags(const QModelIndex &index) const
     if (!index.isValid())
         return Qt::NoItemFlags;
 
-    TositeVienti rivi = vienti(index.row());
+    const VientiRivi& rivi = rivit_.at(index.row());
 
     if( index.column() == ALV)
         return Qt::ItemIsEnabled;
@@ -395,13 +396,12 @@ bool TositeViennit::insertRows(int row, int count, const QModelIndex & /* parent
 bool TositeViennit::removeRows(int row, int count, const QModelIndex &parent)
 {
     beginRemoveRows(parent, row, row + count - 1);
-    for(int i=0; i < count; i++)
-        viennit_.removeAt(row);
+    rivit_.remove(row, count);
     endRemoveRows();
     while(row < rowCount()) {
-        if(viennit_.at(row).tyyppi() == TositeVienti::ALVKIRJAUS) {
+        if(rivit_.at(row).tyyppi() == TositeVienti::ALVKIRJAUS) {
             beginRemoveRows(parent, row, row);
-            viennit_.removeAt(row);
+            rivit_.remove(row);
             endRemoveRows();
         } else {
             break;
@@ -419,12 +419,12 @@ TositeVienti TositeViennit::uusi(int indeksi) const
 
     if( indeksi > 0){
         indeksi--;
-        TositeVienti edellinen = viennit_.value(indeksi);
+        VientiRivi edellinen = rivit_.value(indeksi);
         while( edellinen.tyyppi() == TositeVienti::ALVKIRJAUS) {
             // Jotta saataisiin selite ja vastatili varsinaisesta kirjauksesta
             // eikä siihen liittyvistä alv-riveistä.
             indeksi--;
-            edellinen = viennit_.value(indeksi);
+            edellinen = rivit_.value(indeksi);
         }
         Tili tili = kp()->tilit()->tiliNumerolla(edellinen.tili());
         if( tili.luku("vastatili"))
@@ -440,10 +440,9 @@ TositeVienti TositeViennit::uusi(int indeksi) const
 
     qlonglong dsumma = 0;
     qlonglong ksumma = 0;
-    for(int i=0; i < rowCount(); i++) {
-        TositeVienti tvienti = viennit_.at(i);
-        dsumma += qRound64( tvienti.debet() * 100 );
-        ksumma += qRound64 ( tvienti.kredit() * 100);
+    for(const auto& rivi : rivit_) {
+        dsumma += rivi.debetSnt();
+        ksumma += rivi.kreditSnt();
     }
     if( dsumma > ksumma )
         uusi.setKredit( dsumma - ksumma);
@@ -456,11 +455,11 @@ TositeVienti TositeViennit::uusi(int indeksi) const
 
 QModelIndex TositeViennit::lisaaVienti(int indeksi)
 {
-    while( viennit_.value(indeksi).tyyppi() == TositeVienti::ALVKIRJAUS)
+    while( rivit_.value(indeksi).tyyppi() == TositeVienti::ALVKIRJAUS)
         indeksi++;
 
     beginInsertRows( QModelIndex(), indeksi, indeksi);
-    viennit_.insert(indeksi, uusi(indeksi));
+    rivit_.insert(indeksi, VientiRivi(uusi(indeksi)));
     endInsertRows();
     paivitaAalv(indeksi);
     return index(indeksi, 0);
@@ -468,12 +467,12 @@ QModelIndex TositeViennit::lisaaVienti(int indeksi)
 
 TositeVienti TositeViennit::vienti(int indeksi) const
 {
-    return viennit_.value(indeksi);
+    return rivit_.value(indeksi).vienti();
 }
 
 void TositeViennit::asetaVienti(int indeksi, const TositeVienti &vienti)
 {
-    viennit_[indeksi] = vienti;
+    rivit_[indeksi] = VientiRivi(vienti);
     if( !vienti.tyyppi() )
         paivitaAalv(indeksi);
 
@@ -482,28 +481,31 @@ void TositeViennit::asetaVienti(int indeksi, const TositeVienti &vienti)
 
 void TositeViennit::lisaa(const TositeVienti &vienti)
 {
-    beginInsertRows(QModelIndex(), viennit_.count(), viennit_.count());
-    viennit_.append(vienti);
+    beginInsertRows(QModelIndex(), rivit_.count(), rivit_.count());
+    rivit_.append(VientiRivi(vienti));
     endInsertRows();
-    paivitaAalv(viennit_.count() - 1);
+    paivitaAalv(rivit_.count() - 1);
 }
 
 
 void TositeViennit::asetaViennit(QVariantList viennit)
 {    
-    QList<TositeVienti> tlista;
+    beginResetModel();
+    rivit_.clear();
+    rivit_.reserve(viennit.count());
     for(const auto& item : viennit) {
-        tlista.append( TositeVienti(item.toMap()) );
+        rivit_.append( VientiRivi(item.toMap()) );
     }
-    asetaViennit(tlista);
-
+    endResetModel();
 }
 
 void TositeViennit::asetaViennit(QList<TositeVienti> viennit)
 {
     beginResetModel();
-    viennit_ = viennit;
-    // Erätietojen siivoaminen ja sijoittaminen välimuistiin
+    rivit_.clear();
+    rivit_.reserve(viennit.count());
+    for(const auto& vienti : viennit)
+        rivit_.append( VientiRivi(vienti));
     endResetModel();
 }
 
@@ -515,7 +517,7 @@ void TositeViennit::tyhjenna()
 void TositeViennit::pohjaksi(const QDate &pvm, const QString &vanhaOtsikko, const QString &uusiOtsikko, bool sailytaErat)
 {
     beginResetModel();
-    for(int i=0; i < viennit_.count(); i++) {
+    for(int i=0; i < rivit_.count(); i++) {
         TositeVienti tvienti =  vienti(i);
         if( !sailytaErat && tvienti.eraId() == tvienti.id())
             tvienti.setEra(-1);
@@ -528,7 +530,7 @@ void TositeViennit::pohjaksi(const QDate &pvm, const QString &vanhaOtsikko, cons
             tvienti.setJaksoloppuu( tvienti.jaksoloppuu().addDays(siirto));
         if( tvienti.selite() == vanhaOtsikko)
             tvienti.setSelite( uusiOtsikko);
-        viennit_[i] = tvienti;
+        rivit_[i] = VientiRivi(tvienti);
     }
     endResetModel();
 }
@@ -537,12 +539,22 @@ void TositeViennit::pohjaksi(const QDate &pvm, const QString &vanhaOtsikko, cons
 QVariantList TositeViennit::tallennettavat() const
 {
     QVariantList ulos;
-    for( const auto& vienti : viennit_) {
-        ulos.append( vienti.tallennettava());
+    ulos.reserve(rivit_.count());
+    for( const auto& rivi : rivit_) {
+        ulos.append( rivi.toMap());
     }
     return ulos;
 }
 
+QList<TositeVienti> TositeViennit::viennit() const
+{
+    QList<TositeVienti> lista;
+    lista.reserve(rivit_.count());
+    for( const auto& rivi : rivit_)
+        lista.append( rivi.vienti());
+    return lista;
+}
+
 void TositeViennit::asetaMuokattavissa(bool muokattavissa)
 {
     muokattavissa_ = muokattavissa;
@@ -570,7 +582,7 @@ QString TositeViennit::alvTarkastus() const
    qlonglong rakennusVero = 0;
    int rakennusMaara = 0;
 
-   for( const auto& tv : viennit_) {
+   for( const auto& tv : rivit_) {
        switch (tv.alvKoodi()) {
        case AlvKoodi::MYYNNIT_NETTO:
            alvPerusteella += qRound64((tv.kredit() - tv.debet()) * tv.alvProsentti());
@@ -629,7 +641,7 @@ QString TositeViennit::alvTarkastus() const
 
 bool TositeViennit::onkoKaanteistaAlvia() const
 {
-    for( const auto& vienti : viennit_) {
+    for( const auto& vienti : rivit_) {
         if(vienti.alvKoodi() == AlvKoodi::RAKENNUSPALVELU_MYYNTI ||
            vienti.alvKoodi() == AlvKoodi::YHTEISOMYYNTI_PALVELUT ||
            vienti.alvKoodi() == AlvKoodi::YHTEISOMYYNTI_TAVARAT)
@@ -640,11 +652,11 @@ bool TositeViennit::onkoKaanteistaAlvia() const
 
 void TositeViennit::paivitaAalv(int rivi)
 {
-    const TositeVienti& lahde = viennit_.value(rivi);
+    const VientiRivi lahde = rivit_.value(rivi);
     int alvkoodi = lahde.alvKoodi();
     double prosentti = lahde.alvProsentti();
 
-    QString aalvtila = lahde.data(TositeVienti::AALV).toString();
+    const QString& aalvtila = lahde.aalv();
     bool verorivi = aalvtila.contains("+") &&
             (alvkoodi == AlvKoodi::MYYNNIT_NETTO ||
              alvkoodi == AlvKoodi::MAKSUPERUSTEINEN_MYYNTI ||
@@ -677,7 +689,7 @@ void TositeViennit::paivitaAalv(int rivi)
     }
 
     rivi++;
-    TositeVienti seuraava = viennit_.value(rivi);
+    VientiRivi seuraava = rivit_.value(rivi);
     bool onjoVerorivi = seuraava.tyyppi() == TositeVienti::ALVKIRJAUS &&
             seuraava.alvKoodi() > AlvKoodi::ALVKIRJAUS &&
             seuraava.alvKoodi() < AlvKoodi::ALVVAHENNYS;
@@ -720,7 +732,7 @@ void TositeViennit::paivitaAalv(int rivi)
             removeRows(rivi, 1);
     }
 
-    seuraava = viennit_.value(rivi);
+    seuraava = rivit_.value(rivi);
     bool onjoVahennysrivi = seuraava.tyyppi() == TositeVienti::ALVKIRJAUS &&
             seuraava.alvKoodi() > AlvKoodi::ALVVAHENNYS &&
             seuraava.alvKoodi() < AlvKoodi::MAKSETTAVAALV;
@@ -764,9 +776,9 @@ Euro TositeViennit::summa() const
     Euro debet;
     Euro kredit;
 
-    for(const auto& vienti : qAsConst( viennit_ )) {
-        debet += vienti.debetEuro();
-        kredit += vienti.kreditEuro();
+    for(const auto& rivi : qAsConst( rivit_ )) {
+        debet += rivi.debetEuro();
+        kredit += rivi.kreditEuro();
     }
     return kredit > debet ? kredit : debet;
 }
@@ -776,9 +788,9 @@ bool TositeViennit::debetKreditTasmaa() const
     Euro debet;
     Euro kredit;
 
-    for(auto vienti : viennit_) {
-        debet += vienti.debetEuro();
-        kredit += vienti.kreditEuro();
+    for(const auto& rivi : qAsConst( rivit_ )) {
+        debet += rivi.debetEuro();
+        kredit += rivi.kreditEuro();
     }
     return kredit == debet;
 }
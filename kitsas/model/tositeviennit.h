@@ -20,6 +20,7 @@
 #include <QAbstractTableModel>
 
 #include "tositevienti.h"
+#include "vientirivi.h"
 
 class TositeViennit : public QAbstractTableModel
 {
@@ -87,7 +88,7 @@ public:
     void tyhjenna();
     void pohjaksi(const QDate& pvm, const QString& vanhaOtsikko, const QString& uusiOtsikko, bool sailytaErat = false);
 
-    QList<TositeVienti> viennit() const { return viennit_;}
+    QList<TositeVienti> viennit() const;
     QVariantList tallennettavat() const;
 
     void asetaMuokattavissa(bool muokattavissa);
@@ -101,7 +102,7 @@ public:
     bool debetKreditTasmaa() const;
 
 private:
-    QList<TositeVienti> viennit_;
+    QVector<VientiRivi> rivit_;
     bool muokattavissa_ = true;
 
 };
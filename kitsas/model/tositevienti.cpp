@@ -28,16 +28,16 @@ TositeVienti::TositeVienti(const QVariantMap &vienti) :
 
 QVariant TositeVienti::data(int kentta) const
 {
-    return value( avaimet__.at(kentta) );
+    return value( avaimet__[kentta] );
 }
 
 void TositeVienti::set(int kentta, const QVariant &arvo)
 {    
     if( (arvo.toString().isEmpty()) && !(arvo.type() == QVariant::Map && !arvo.toMap().isEmpty()) &&
         !(arvo.type() == QVariant::List && !arvo.toList().isEmpty()))
-        remove( avaimet__.at(kentta));
+        remove( avaimet__[kentta]);
     else
-        insert( avaimet__.at(kentta), arvo);
+        insert( avaimet__[kentta], arvo);
 }
 
 QVariant TositeVienti::tallennettava() const
@@ -93,7 +93,7 @@ void TositeVienti::setTili(int tili)
     if(tili)
         set( TILI, tili);
     else
-        remove(avaimet__.at(TILI));
+        remove(avaimet__[TILI]);
 }
 
 void TositeVienti::setDebet(double euroa)
@@ -112,12 +112,12 @@ void TositeVienti::setDebet(const QString &euroa)
 {
     if( euroa.startsWith('-')) {
         set( KREDIT, euroa.mid(1));
-        remove( avaimet__.at(DEBET));
+        remove( avaimet__[DEBET]);
 
     } else {
         set( DEBET, euroa);
         if( euroa.toDouble() > 1e-5)
-            remove( avaimet__.at(KREDIT));
+            remove( avaimet__[KREDIT]);
     }
 }
 
@@ -142,11 +142,11 @@ void TositeVienti::setKredit(const QString &euroa)
 {
     if( euroa.startsWith('-')) {
         set(DEBET, euroa.mid(1));
-        remove( avaimet__.at(KREDIT));
+        remove( avaimet__[KREDIT]);
     } else {
         set( KREDIT, euroa);
         if( euroa.toDouble() > 1e-5)
-            remove( avaimet__.at(DEBET));
+            remove( avaimet__[DEBET]);
     }
 }
 
@@ -164,7 +164,7 @@ void TositeVienti::setAlvKoodi(int koodi)
 {
     set(ALVKOODI, koodi);
     if( kp()->alvTyypit()->nollaTyyppi(koodi) ) {
-        remove( avaimet__.at(ALVPROSENTTI) );
+        remove( avaimet__[ALVPROSENTTI] );
     }
 }
 
@@ -186,9 +186,9 @@ void TositeVienti::setKohdennus(int kohdennus)
 void TositeVienti::setMerkkaukset(QVariantList merkkaukset)
 {
     if( merkkaukset.isEmpty())
-        remove( avaimet__.at(MERKKAUKSET));
+        remove( avaimet__[MERKKAUKSET]);
     else
-        insert( avaimet__.at(MERKKAUKSET), merkkaukset);
+        insert( avaimet__[MERKKAUKSET], merkkaukset);
 }
 
 void TositeVienti::setJaksoalkaa(const QDate &pvm)
@@ -211,9 +211,9 @@ void TositeVienti::setEra(int era)
 void TositeVienti::setEra(const QVariantMap &era)
 {
     if( era.isEmpty() || era.value("id").toInt() == 0)
-        remove(avaimet__.at(ERA));
+        remove(avaimet__[ERA]);
     else
-        insert(avaimet__.at(ERA), era);
+        insert(avaimet__[ERA], era);
 }
 
 void TositeVienti::setArkistotunnus(const QString &tunnus)
@@ -224,7 +224,7 @@ void TositeVienti::setArkistotunnus(const QString &tunnus)
 void TositeVienti::setKumppani(int kumppaniId)
 {
     if(!kumppaniId) {
-        remove(avaimet__.at(KUMPPANI));
+        remove(avaimet__[KUMPPANI]);
     } else {
         QVariantMap kmap;
         kmap.insert("id", kumppaniId);
@@ -259,7 +259,7 @@ void TositeVienti::setTasaerapoisto(int kuukautta)
     if( kuukautta)
         set( TASAERAPOISTO, kuukautta);
     else
-        remove( avaimet__.at(TASAERAPOISTO) );
+        remove( avaimet__[TASAERAPOISTO] );
 }
 
 void TositeVienti::setId(int id)
@@ -282,27 +282,28 @@ void TositeVienti::setOstoPvm(const QDate &pvm)
 
 
 
-std::map<int,QString> TositeVienti::avaimet__ = {
-    { ID, "id" },
-    { PVM, "pvm"},
-    { TILI, "tili"},
-    { DEBET, "debet"},
-    { KREDIT, "kredit"},
-    { SELITE, "selite"},
-    { ALVKOODI, "alvkoodi"},
-    { ALVPROSENTTI, "alvprosentti"},
-    { KOHDENNUS, "kohdennus"},
-    { MERKKAUKSET, "merkkaukset"},
-    { JAKSOALKAA, "jaksoalkaa"},
-    { JAKSOLOPPUU, "jaksoloppuu"},
-    { ERA, "era"},
-    { ARKISTOTUNNUS, "arkistotunnus"},
-    { KUMPPANI, "kumppani"},
-    { TYYPPI, "tyyppi"},
-    { PALKKAKOODI, "palkkakoodi"},
-    { TASAERAPOISTO, "tasaerapoisto"},
-    { ALKUPVIENNIT, "alkupviennit"},
-    { VIITE, "viite"},
-    { AALV, "aalv"},
-    { OSTOPVM, "ostopvm"}
+// Järjestyksen on vastattava Avain-luettelointia
+const QString TositeVienti::avaimet__[TositeVienti::KENTTIA] = {
+    "id",
+    "pvm",
+    "tili",
+    "debet",
+    "kredit",
+    "selite",
+    "alvkoodi",
+    "alvprosentti",
+    "kohdennus",
+    "merkkaukset",
+    "jaksoalkaa",
+    "jaksoloppuu",
+    "era",
+    "arkistotunnus",
+    "kumppani",
+    "tyyppi",
+    "palkkakoodi",
+    "tasaerapoisto",
+    "alkupviennit",
+    "viite",
+    "aalv",
+    "ostopvm"
 };
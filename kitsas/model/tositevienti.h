@@ -19,7 +19,6 @@
 
 #include <QVariant>
 #include <QDate>
-#include <map>
 
 #include "euro.h"
 
@@ -73,6 +72,10 @@ public:
 
     QVariant data(int kentta) const;
     void set(int kentta, const QVariant& arvo);
+    /**
+     * @brief Kentän avain välitettävässä QVariantMapissa
+     */
+    static const QString& avain(int kentta) { return avaimet__[kentta]; }
     QVariant tallennettava() const;
 
     int id() const { return data(ID).toInt();}
@@ -141,8 +144,10 @@ public:
     void setViite(const QString& viite);
     void setOstoPvm(const QDate& pvm);
 
+    static const int KENTTIA = OSTOPVM + 1;
+
 private:
-    static std::map<int,QString> avaimet__;
+    static const QString avaimet__[KENTTIA];
 
 };
 
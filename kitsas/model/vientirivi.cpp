@@ -0,0 +1,184 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vientirivi.h"
+
+#include <QHash>
+
+VientiRivi::VientiRivi(const QVariantMap &map)
+{
+    static const QHash<QString,int> kentat = [] {
+        QHash<QString,int> hash;
+        for(int i=0; i < TositeVienti::KENTTIA; i++)
+            hash.insert( TositeVienti::avain(i), i);
+        return hash;
+    }();
+
+    for(auto iter = map.constBegin(); iter != map.constEnd(); ++iter) {
+        const int kentta = kentat.value(iter.key(), -1);
+        if( kentta >= 0 && lue(kentta, iter.value()))
+            kentat_ |= 1u << kentta;
+        else
+            muut_.insert(iter.key(), iter.value());
+    }
+}
+
+QVariantMap VientiRivi::toMap() const
+{
+    QVariantMap map(muut_);
+    for(int i=0; i < TositeVienti::KENTTIA; i++) {
+        if( onko(i))
+            map.insert( TositeVienti::avain(i), arvo(i));
+    }
+    return map;
+}
+
+bool VientiRivi::lue(int kentta, const QVariant &arvo)
+{
+    bool ok = false;
+    switch (kentta) {
+    case TositeVienti::ID:
+        id_ = kokonaisluku(arvo, &ok);
+        return ok;
+    case TositeVienti::TILI:
+        tili_ = kokonaisluku(arvo, &ok);
+        return ok;
+    case TositeVienti::ALVKOODI:
+        alvkoodi_ = kokonaisluku(arvo, &ok);
+        return ok;
+    case TositeVienti::KOHDENNUS:
+        kohdennus_ = kokonaisluku(arvo, &ok);
+        return ok;
+    case TositeVienti::TYYPPI:
+        tyyppi_ = kokonaisluku(arvo, &ok);
+        return ok;
+    case TositeVienti::TASAERAPOISTO:
+        tasaerapoisto_ = kokonaisluku(arvo, &ok);
+        return ok;
+    case TositeVienti::PVM:
+        pvm_ = arvo.toDate();
+        return pvm_.isValid();
+    case TositeVienti::JAKSOALKAA:
+        jaksoalkaa_ = arvo.toDate();
+        return jaksoalkaa_.isValid();
+    case TositeVienti::JAKSOLOPPUU:
+        jaksoloppuu_ = arvo.toDate();
+        return jaksoloppuu_.isValid();
+    case TositeVienti::OSTOPVM:
+        ostopvm_ = arvo.toDate();
+        return ostopvm_.isValid();
+    case TositeVienti::DEBET:
+    case TositeVienti::KREDIT:
+    {
+        qlonglong sentit = 0;
+        if( arvo.userType() == qMetaTypeId<Euro>()) {
+            sentit = Euro::fromVariant(arvo).cents();
+        } else {
+            const double euroa = arvo.toDouble(&ok);
+            if( !ok )
+                return false;
+            sentit = qRound64( euroa * 100.0 );
+        }
+        if( kentta == TositeVienti::DEBET)
+            debet_ = sentit;
+        else
+            kredit_ = sentit;
+        return true;
+    }
+    case TositeVienti::ALVPROSENTTI:
+        alvprosentti_ = arvo.toDouble(&ok);
+        return ok;
+    case TositeVienti::SELITE:
+        selite_ = merkkijono(arvo, &ok);
+        return ok;
+    case TositeVienti::ARKISTOTUNNUS:
+        arkistotunnus_ = merkkijono(arvo, &ok);
+        return ok;
+    case TositeVienti::PALKKAKOODI:
+        palkkakoodi_ = merkkijono(arvo, &ok);
+        return ok;
+    case TositeVienti::VIITE:
+        viite_ = merkkijono(arvo, &ok);
+        return ok;
+    case TositeVienti::AALV:
+        aalv_ = merkkijono(arvo, &ok);
+        return ok;
+    case TositeVienti::MERKKAUKSET:
+        if( arvo.type() != QVariant::List)
+            return false;
+        merkkaukset_ = arvo.toList();
+        return true;
+    case TositeVienti::ERA:
+        if( arvo.type() != QVariant::Map)
+            return false;
+        era_ = arvo.toMap();
+        eraId_ = era_.value("id").toInt();
+        return true;
+    case TositeVienti::KUMPPANI:
+        if( arvo.type() != QVariant::Map)
+            return false;
+        kumppani_ = arvo.toMap();
+        kumppaniId_ = kumppani_.value("id").toInt();
+        return true;
+    default:
+        return false;
+    }
+}
+
+QVariant VientiRivi::arvo(int kentta) const
+{
+    switch (kentta) {
+    case TositeVienti::ID: return id_;
+    case TositeVienti::TILI: return tili_;
+    case TositeVienti::ALVKOODI: return alvkoodi_;
+    case TositeVienti::KOHDENNUS: return kohdennus_;
+    case TositeVienti::TYYPPI: return tyyppi_;
+    case TositeVienti::TASAERAPOISTO: return tasaerapoisto_;
+    case TositeVienti::PVM: return pvm_;
+    case TositeVienti::JAKSOALKAA: return jaksoalkaa_;
+    case TositeVienti::JAKSOLOPPUU: return jaksoloppuu_;
+    case TositeVienti::OSTOPVM: return ostopvm_;
+    case TositeVienti::DEBET: return Euro(debet_).toString();
+    case TositeVienti::KREDIT: return Euro(kredit_).toString();
+    case TositeVienti::ALVPROSENTTI: return QString("%1").arg(alvprosentti_, 0, 'f', 2);
+    case TositeVienti::SELITE: return selite_;
+    case TositeVienti::ARKISTOTUNNUS: return arkistotunnus_;
+    case TositeVienti::PALKKAKOODI: return palkkakoodi_;
+    case TositeVienti::VIITE: return viite_;
+    case TositeVienti::AALV: return aalv_;
+    case TositeVienti::MERKKAUKSET: return merkkaukset_;
+    case TositeVienti::ERA: return era_;
+    case TositeVienti::KUMPPANI: return kumppani_;
+    default: return QVariant();
+    }
+}
+
+int VientiRivi::kokonaisluku(const QVariant &arvo, bool *ok)
+{
+    if( arvo.isNull()) {
+        *ok = false;
+        return 0;
+    }
+    return arvo.toInt(ok);
+}
+
+QString VientiRivi::merkkijono(const QVariant &arvo, bool *ok)
+{
+    *ok = arvo.type() == QVariant::String ||
+          ( !arvo.isNull() && arvo.type() != QVariant::Map &&
+            arvo.type() != QVariant::List && arvo.canConvert<QString>());
+    return *ok ? arvo.toString() : QString();
+}
@@ -0,0 +1,130 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VIENTIRIVI_H
+#define VIENTIRIVI_H
+
+#include "tositevienti.h"
+
+/**
+ * @brief Viennin tiedot tyypitettyinä jäseninä
+ *
+ * TositeVienti pitää kaikki tiedot QVariantMapissa, jolloin jokainen
+ * luku vaatii merkkijonoavaimen haun ja QVariant-muunnoksen. VientiRivi
+ * jäsentää vakiokentät kerran: rahamäärät sentteinä, päivämäärät
+ * QDate-olioina ja tunnisteet kokonaislukuina. Harvinaiset lisätiedot
+ * (esim. alkuperäiset viennit) säilytetään ylivuotokartassa.
+ *
+ * Muunnos QVariantMapista ja takaisin säilyttää kaikki kentät. Vakiokentät
+ * palautetaan samassa muodossa kuin TositeViennin asetusfunktiot ne
+ * tallentavat. Arvo, jota ei voi jäsentää kentän tyyppiin, säilytetään
+ * sellaisenaan ylivuotokartassa.
+ *
+ * Rivi on tarkoitettu luettavaksi. Muokkaus tehdään TositeViennillä,
+ * josta muodostetaan uusi rivi.
+ */
+class VientiRivi
+{
+public:
+    VientiRivi() = default;
+    explicit VientiRivi(const QVariantMap& map);
+
+    QVariantMap toMap() const;
+    TositeVienti vienti() const { return TositeVienti(toMap()); }
+
+    /**
+     * @brief Onko vakiokenttä jäsennetty riville
+     * @param kentta TositeVienti::Avain
+     */
+    bool onko(int kentta) const { return kentat_ & (1u << kentta); }
+
+    int id() const { return id_; }
+    QDate pvm() const { return pvm_; }
+    int tili() const { return tili_; }
+
+    qlonglong debetSnt() const { return debet_; }
+    qlonglong kreditSnt() const { return kredit_; }
+    Euro debetEuro() const { return Euro(debet_); }
+    Euro kreditEuro() const { return Euro(kredit_); }
+    double debet() const { return debet_ / 100.0; }
+    double kredit() const { return kredit_ / 100.0; }
+
+    const QString& selite() const { return selite_; }
+    int alvKoodi() const { return alvkoodi_; }
+    double alvProsentti() const { return alvprosentti_; }
+    int kohdennus() const { return kohdennus_; }
+    const QVariantList& merkkaukset() const { return merkkaukset_; }
+    QDate jaksoalkaa() const { return jaksoalkaa_; }
+    QDate jaksoloppuu() const { return jaksoloppuu_; }
+    const QVariantMap& era() const { return era_; }
+    int eraId() const { return eraId_; }
+    const QString& arkistotunnus() const { return arkistotunnus_; }
+    const QVariantMap& kumppaniMap() const { return kumppani_; }
+    int kumppaniId() const { return kumppaniId_; }
+    QString kumppaniNimi() const { return kumppani_.value("nimi").toString(); }
+    int tyyppi() const { return tyyppi_; }
+    const QString& palkkakoodi() const { return palkkakoodi_; }
+    int tasaerapoisto() const { return tasaerapoisto_; }
+    const QString& viite() const { return viite_; }
+    const QString& aalv() const { return aalv_; }
+    QDate ostopvm() const { return ostopvm_; }
+
+    /**
+     * @brief Kentät, joille ei ole omaa jäsentä
+     */
+    const QVariantMap& muut() const { return muut_; }
+
+protected:
+    bool lue(int kentta, const QVariant& arvo);
+    QVariant arvo(int kentta) const;
+
+    static int kokonaisluku(const QVariant& arvo, bool* ok);
+    static QString merkkijono(const QVariant& arvo, bool* ok);
+
+    quint32 kentat_ = 0;
+
+    qlonglong debet_ = 0;
+    qlonglong kredit_ = 0;
+    double alvprosentti_ = 0.0;
+
+    int id_ = 0;
+    int tili_ = 0;
+    int alvkoodi_ = 0;
+    int kohdennus_ = 0;
+    int tyyppi_ = 0;
+    int tasaerapoisto_ = 0;
+    int eraId_ = 0;
+    int kumppaniId_ = 0;
+
+    QDate pvm_;
+    QDate jaksoalkaa_;
+    QDate jaksoloppuu_;
+    QDate ostopvm_;
+
+    QString selite_;
+    QString arkistotunnus_;
+    QString palkkakoodi_;
+    QString viite_;
+    QString aalv_;
+
+    QVariantMap era_;
+    QVariantMap kumppani_;
+    QVariantList merkkaukset_;
+
+    QVariantMap muut_;
+};
+
+#endif // VIENTIRIVI_H
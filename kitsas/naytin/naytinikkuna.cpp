@@ -19,6 +19,7 @@
 #include "db/kirjanpito.h"
 
 #include "model/tosite.h"
+#include "sqlite/sqlitemodel.h"
 #include "laskutus/tulostus/laskuntulostaja.h"
 
 #include <QAction>
@@ -98,6 +99,16 @@ void NaytinIkkuna::naytaTiedosto(const QString &tiedostonnimi)
 
 void NaytinIkkuna::naytaLiite(const int liiteId)
 {
+    // Omasta tiedostosta liitettä ei tarvitse ladata kerralla muistiin
+    SQLiteModel* sqlite = qobject_cast<SQLiteModel*>(kp()->yhteysModel());
+    QIODevice* lukija = sqlite ? sqlite->liiteLukija(liiteId) : nullptr;
+    if( lukija ) {
+        NaytinIkkuna *ikkuna = new NaytinIkkuna;
+        ikkuna->show();
+        ikkuna->view()->nayta(lukija);
+        return;
+    }
+
     naytaLiite( QString::number(liiteId));
 }
 
@@ -125,6 +125,15 @@ void NaytinView::nayta(const QByteArray &data, bool salliPudotus)
     }
 }
 
+void NaytinView::nayta(QIODevice *laite)
+{
+    // Sisältö luetaan heti muistiin, jotta laitteen lukutapahtuma ei jää
+    // auki näkymän ajaksi eikä tietokannan sulkeminen vanhenna näkymää
+    const QByteArray data = laite->readAll();
+    delete laite;
+    nayta( data );
+}
+
 void NaytinView::nayta(RaportinKirjoittaja raportti)
 {
     qDebug() << "Näytin " << this << " Näytä raportti " << raportti.otsikko();
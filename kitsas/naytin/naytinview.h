@@ -24,6 +24,7 @@
 
 class QAction;
 class QVBoxLayout;
+class QIODevice;
 class Esikatseltava;
 
 namespace Naytin {
@@ -57,6 +58,7 @@ public:
 
 public slots:
     void nayta(const QByteArray& data, bool salliPudotus = false);
+    void nayta(QIODevice* laite);
     void nayta(RaportinKirjoittaja raportti);
     void nayta(const RaporttiValinnat& valinnat);
     void nayta(const QString& teksti);
@@ -20,6 +20,8 @@
 #include <QPrinter>
 #include <QPainter>
 #include <QGraphicsSimpleTextItem>
+#include <QMutexLocker>
+#include <QtConcurrent>
 #include "db/kirjanpito.h"
 #include <QSettings>
 
@@ -29,6 +31,15 @@ Naytin::PdfView::PdfView(const QByteArray &pdf) :
     data_(pdf)
 {
     skaala_ = kp()->settings()->value("LiiteZoom",100).toInt() / 100.0;
+    valimuisti_.setMaxCost(VALIMUISTI_KT);
+    renderoijat_.setMaxThreadCount(1);
+}
+
+Naytin::PdfView::~PdfView()
+{
+    // Jonossa olevat renderöinnit käyttävät dokumenttia
+    renderoijat_.clear();
+    renderoijat_.waitForDone();
 }
 
 QByteArray Naytin::PdfView::data() const
@@ -38,6 +49,7 @@ QByteArray Naytin::PdfView::data() const
 
 QString Naytin::PdfView::otsikko() const
 {
+    QMutexLocker lukko(&dokumenttiLukko_);
     PdfAnalyzerDocument *pdfDoc = PdfToolkit::analyzer(data_);
     QString otsikkoni = pdfDoc->title();
     delete pdfDoc;
@@ -49,69 +61,61 @@ void Naytin::PdfView::paivita() const
 
     scene()->setBackgroundBrush(QBrush(Qt::gray));
     scene()->clear();
+    sivut_.clear();
+    alueet_.clear();
+
+    // Edellisen koon renderöinnit, joita ei vielä ole aloitettu, jätetään tekemättä
+    sukupolvi_.ref();
+    kesken_.clear();
+
+    if( !dokumentti_ ) {
+        // Renderöintejä ei vielä ole käynnissä, joten lukitusta ei tarvita
+        dokumentti_.reset( PdfToolkit::renderer(data_) );
+        lukittu_ = dokumentti_->locked();
+        const int sivuja = lukittu_ ? 0 : dokumentti_->pageCount();
+        for(int sivu = 0; sivu < sivuja; sivu++)
+            sivukoot_.append( dokumentti_->pageSize(sivu) );
+    }
 
-    PdfRendererDocument* renderer = PdfToolkit::renderer(data_);
-
-//    Poppler::Document *pdfDoc = Poppler::Document::loadFromData( data_ );
-//    if(!pdfDoc)
-//        return;
-
-    if( renderer->locked() ) {
+    if( lukittu_ ) {
         QGraphicsSimpleTextItem *text = scene()->addSimpleText(tr("Tiedosto on salakirjoitettu"), QFont("FreeSans",14));
         text->setBrush(QBrush(Qt::yellow));
-        delete renderer;
         return;
     }
 
+    leveys_ = qMax( 1, qRound( width() * skaala_ - 20.0 ));
     double ypos = 0.0;
-    double leveys = 0.0;
-    double leveyteen = width() * skaala_ - 20.0;
-
-    int sivut = renderer->pageCount();
-    int naytettavat = sivut < 20 ? sivut : 20;
 
-    if( naytettavat != sivut) {
-        QGraphicsSimpleTextItem *text = scene()->addSimpleText(tr("Tiedostossa on %1 sivua, joista näytetään 20 ensimmäistä. Paina hiiren oikeaa nappia ja valitse Avaa nähdäksesi kokonaan.").arg(sivut), QFont("FreeSans",14));
-        text->setBrush(QBrush(Qt::yellow));
-        ypos += text->boundingRect().height() + 5;
-    }
-
-    // Monisivuisen pdf:n sivut pinotaan päällekkäin
-    for( int sivu = 0; sivu < naytettavat; sivu++)
-    {        
-        QImage image = renderer->renderPageToWidth(sivu, leveyteen);
-        QPixmap kuva = QPixmap::fromImage( image, Qt::DiffuseAlphaDither);
+    // Monisivuisen pdf:n sivut pinotaan päällekkäin. Sivuille varataan
+    // paikka heti, ja kuvat lisätään sitä mukaa kuin ne valmistuvat.
+    for( int sivu = 0; sivu < sivukoot_.count(); sivu++)
+    {
+        const QSizeF& koko = sivukoot_.at(sivu);
+        const double korkeus = koko.width() > 0 ? koko.height() * leveys_ / koko.width() : leveys_ * 1.414;
+        const QRectF alue(0, ypos, leveys_, korkeus);
 
-        scene()->addRect(2, ypos+2, kuva.width(), kuva.height(), QPen(Qt::NoPen), QBrush(Qt::black) );
+        scene()->addRect(alue.translated(2, 2), QPen(Qt::NoPen), QBrush(Qt::black) );
+        scene()->addRect(alue, QPen(Qt::NoPen), QBrush(Qt::white));
 
-        QGraphicsPixmapItem *item = scene()->addPixmap(kuva);
+        QGraphicsPixmapItem *item = scene()->addPixmap(QPixmap());
         item->setY( ypos );
-        scene()->addRect(0, ypos, kuva.width(), kuva.height(), QPen(Qt::black), Qt::NoBrush );
-
-        if( kuva.width() > leveys)
-            leveys = kuva.width();
+        scene()->addRect(alue, QPen(Qt::black), Qt::NoBrush );
 
-        ypos += kuva.height() + 10.0;
-
-    }
-
-    if( naytettavat != sivut) {
-        QGraphicsSimpleTextItem *text = scene()->addSimpleText(tr("Tiedostossa on %1 sivua, joista näytetään 20 ensimmäistä.  Paina hiiren oikeaa nappia ja valitse Avaa nähdäksesi kokonaan.").arg(sivut), QFont("FreeSans",16));
-        text->setBrush(QBrush(Qt::yellow));
-        text->setY(ypos);
-        ypos += text->boundingRect().height() + 5;
+        sivut_.append(item);
+        alueet_.append(alue);
+        ypos += korkeus + 10.0;
     }
 
-    scene()->setSceneRect(-5.0, -5.0, leveys + 10.0, ypos + 5.0  );
-
-    delete renderer;
+    scene()->setSceneRect(-5.0, -5.0, leveys_ + 10.0, ypos + 5.0  );
 
+    renderoiNakyvat();
 }
 
 void Naytin::PdfView::tulosta(QPrinter *printer) const
 {
+    QMutexLocker lukko(&dokumenttiLukko_);
     QPainter painter(printer);
-    PdfRendererDocument *document = PdfToolkit::renderer(data_);
+    PdfRendererDocument *document = renderoija();
 
     int pageCount = document->pageCount();
     for(int i=0; i < pageCount; i++)
@@ -153,4 +157,75 @@ void Naytin::PdfView::zoomFit()
     paivita();
 }
 
+PdfRendererDocument *Naytin::PdfView::renderoija() const
+{
+    return PdfToolkit::renderer(data_);
+}
+
+void Naytin::PdfView::scrollContentsBy(int dx, int dy)
+{
+    AbstraktiView::scrollContentsBy(dx, dy);
+    renderoiNakyvat();
+}
+
+void Naytin::PdfView::renderoiNakyvat() const
+{
+    if( sivut_.isEmpty())
+        return;
 
+    // Renderöidään näkyvien lisäksi viereiset sivut, jotta vierittäminen
+    // ei heti paljasta tyhjää sivua
+    QRectF nakyva = mapToScene( viewport()->rect() ).boundingRect();
+    nakyva.adjust(0, -nakyva.height(), 0, nakyva.height());
+
+    const int leveys = leveys_;
+    const int sukupolvi = sukupolvi_.loadAcquire();
+    const PdfView* view = this;
+
+    for(int sivu = 0; sivu < sivut_.count(); sivu++) {
+        QGraphicsPixmapItem* item = sivut_.at(sivu);
+
+        // Kaukana olevien sivujen kuvat vapautetaan, välimuistiin ne jäävät
+        if( !alueet_.at(sivu).intersects(nakyva)) {
+            if( !item->pixmap().isNull())
+                item->setPixmap(QPixmap());
+            continue;
+        }
+        if( !item->pixmap().isNull())
+            continue;
+
+        const QPair<int,int> avain(sivu, leveys);
+        QPixmap* tallennettu = valimuisti_.object(avain);
+        if( tallennettu ) {
+            item->setPixmap( *tallennettu );
+            continue;
+        }
+        if( kesken_.contains(avain))
+            continue;
+        kesken_.insert(avain);
+
+        QtConcurrent::run(&renderoijat_, [view, sivu, leveys, sukupolvi] {
+            QImage kuva;
+            if( view->sukupolvi_.loadAcquire() == sukupolvi) {
+                QMutexLocker lukko(&view->dokumenttiLukko_);
+                kuva = view->dokumentti_->renderPageToWidth(sivu, leveys);
+            }
+            QMetaObject::invokeMethod(const_cast<PdfView*>(view), [view, sivu, leveys, kuva] {
+                view->sivuRenderoitu(sivu, leveys, kuva); }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void Naytin::PdfView::sivuRenderoitu(int sivu, int leveys, const QImage &kuva) const
+{
+    const QPair<int,int> avain(sivu, leveys);
+    kesken_.remove(avain);
+    if( kuva.isNull())
+        return;
+
+    const QPixmap pixmap = QPixmap::fromImage( kuva, Qt::DiffuseAlphaDither);
+    valimuisti_.insert(avain, new QPixmap(pixmap), qMax(1, kuva.bytesPerLine() * kuva.height() / 1024));
+
+    if( leveys == leveys_ && sivu < sivut_.count())
+        sivut_.at(sivu)->setPixmap(pixmap);
+}
@@ -19,13 +19,31 @@
 
 #include "abstraktiview.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+#include <QScopedPointer>
+
+class PdfRendererDocument;
+class QGraphicsPixmapItem;
+
 namespace Naytin {
 
+/**
+ * @brief Pdf-tiedoston näkymä
+ *
+ * Sivut asetellaan sivukokojen perusteella, ja vain näkyvissä olevat
+ * sivut renderöidään taustasäikeessä. Renderöidyt sivut säilytetään
+ * välimuistissa leveyksittäin, joten zoomaus takaisin aiempaan
+ * kokoon ei renderöi sivuja uudelleen.
+ */
 class PdfView : public AbstraktiView
 {
     Q_OBJECT
 public:
     PdfView(const QByteArray& pdf);
+    ~PdfView() override;
 
     virtual QString tiedostonMuoto() const override { return tr("pdf-tiedosto (*.pdf)");}
     virtual QString tiedostonPaate() const override { return "pdf"; }
@@ -43,8 +61,33 @@ public slots:
     virtual void zoomFit() override;
 
 protected:
-    QByteArray data_;    
+    /**
+     * @brief Välimuistin enimmäiskoko kilotavuina
+     */
+    static const int VALIMUISTI_KT = 96 * 1024;
+
+    PdfRendererDocument* renderoija() const;
+    void scrollContentsBy(int dx, int dy) override;
+
+    void renderoiNakyvat() const;
+    void sivuRenderoitu(int sivu, int leveys, const QImage& kuva) const;
+
+    QByteArray data_;
     qreal skaala_;
+
+    // Dokumentti avataan kerran ja sitä käyttää vain yksi säie kerrallaan
+    mutable QScopedPointer<PdfRendererDocument> dokumentti_;
+    mutable QMutex dokumenttiLukko_;
+    mutable QVector<QSizeF> sivukoot_;
+    mutable bool lukittu_ = false;
+
+    mutable QVector<QGraphicsPixmapItem*> sivut_;
+    mutable QVector<QRectF> alueet_;
+    mutable int leveys_ = 0;
+    mutable QAtomicInt sukupolvi_;
+    mutable QSet<QPair<int,int>> kesken_;
+    mutable QCache<QPair<int,int>, QPixmap> valimuisti_;
+    mutable QThreadPool renderoijat_;
 };
 
 
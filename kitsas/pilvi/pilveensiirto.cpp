@@ -94,7 +94,9 @@ void PilveenSiirto::alustaAlkusivu()
         ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
     }
 
-    kysely.exec("SELECT pvm, sarja, tunniste, nimi, LENGTH(data) AS koko FROM Liite LEFT OUTER JOIN Tosite ON Liite.tosite=Tosite.id WHERE LENGTH(data) > 10 * 1024 * 1024");
+    kysely.exec("SELECT pvm, sarja, tunniste, nimi, LENGTH(COALESCE(LiiteData.data, Liite.data)) AS koko FROM Liite "
+                "LEFT OUTER JOIN LiiteData ON Liite.sha=LiiteData.sha LEFT OUTER JOIN Tosite ON Liite.tosite=Tosite.id "
+                "WHERE LENGTH(COALESCE(LiiteData.data, Liite.data)) > 10 * 1024 * 1024");
     while( kysely.next())
     {
         qlonglong koko = kysely.value("koko").toLongLong();
@@ -314,7 +316,8 @@ void PilveenSiirto::tallennaLiitteet()
     ui->vaihe3->setEnabled(true);
 
     liitekysely = QSqlQuery( kp()->sqlite()->tietokanta() );
-    liitekysely.exec("SELECT id, nimi, tyyppi, data, tosite, roolinimi FROM Liite "
+    liitekysely.exec("SELECT id, nimi, tyyppi, COALESCE(LiiteData.data, Liite.data) AS data, tosite, roolinimi FROM Liite "
+                     "LEFT OUTER JOIN LiiteData ON Liite.sha=LiiteData.sha "
                      "WHERE tosite IS NOT NULL OR roolinimi IS NOT NULL");
     tallennaSeuraavaLiite();
 
@@ -17,6 +17,8 @@
 #include "pilvikysely.h"
 #include "db/kirjanpito.h"
 #include "pilvimodel.h"
+#include "pilviliikenne.h"
+#include "pilvinippu.h"
 
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -28,8 +30,6 @@
 
 #include "tuonti/csvtuonti.h"
 
-#include <iostream>
-
 PilviKysely::PilviKysely(PilviModel *parent, KpKysely::Metodi metodi, QString polku)
     : KpKysely (parent, metodi, polku)
 {
@@ -37,6 +37,16 @@ PilviKysely::PilviKysely(PilviModel *parent, KpKysely::Metodi metodi, QString po
 }
 
 void PilviKysely::kysy(const QVariant &data)
+{
+    if( vastaaValimuistista() )
+        return;
+
+    PilviModel *model = qobject_cast<PilviModel*>( parent() );
+    const QString avain = metodi() == GET ? polku() + QChar('?') + urlKysely().toString(QUrl::FullyEncoded) : QString();
+    model->nippu()->jonota(this, avain, [this, data] { laheta(data); });
+}
+
+void PilviKysely::laheta(const QVariant &data)
 {
     PilviModel *model = qobject_cast<PilviModel*>( parent() );
     QString osoite = polku().contains("//") ? polku() : model->pilviosoite() + polku();
@@ -47,12 +57,16 @@ void PilviKysely::kysy(const QVariant &data)
 
     request.setRawHeader("Authorization", QString("bearer %1").arg( model->token() ).toLatin1());
     request.setRawHeader("User-Agent", QString(qApp->applicationName() + " " + qApp->applicationVersion() ).toLatin1()  );
+    PilviLiikenne::valmistele(request);
 
     QNetworkReply *reply = nullptr;
 
-    std::cerr << "===========" << url.toString().toStdString() << "================\n";
-    std::cerr << QString::fromUtf8(QJsonDocument::fromVariant(data).toJson(QJsonDocument::Indented)).toStdString();
-
+    if( pilviLoki().isDebugEnabled()) {
+        qCDebug(pilviLoki) << "===========" << url.toString() << "================";
+        if( !data.isNull())
+            qCDebug(pilviLoki).noquote() << QString::fromUtf8(QJsonDocument::fromVariant(data).toJson(QJsonDocument::Indented));
+    }
+    ajastin_.start();
 
     if( metodi() == GET)    {
         reply = kp()->networkManager()->get( request );
@@ -60,7 +74,7 @@ void PilviKysely::kysy(const QVariant &data)
         reply = kp()->networkManager()->deleteResource( request );
     } else  {
         request.setRawHeader("Content-Type","application/json");
-        QByteArray ba = QJsonDocument::fromVariant(data).toJson(QJsonDocument::Compact);
+        QByteArray ba = PilviLiikenne::runko(request, QJsonDocument::fromVariant(data).toJson(QJsonDocument::Compact));
 
         if( metodi() == POST )
             reply = kp()->networkManager()->post(request, ba);
@@ -85,6 +99,8 @@ void PilviKysely::lahetaTiedosto(const QByteArray &ba, const QMap<QString,QStrin
     PilviModel *model = qobject_cast<PilviModel*>( parent() );
     QString osoite = polku().contains("//") ? polku() : model->pilviosoite() + polku();    
 
+    model->nippu()->katkaise();
+
     QUrl url( osoite );
     url.setQuery( urlKysely() );
     QNetworkRequest request( url );
@@ -102,6 +118,9 @@ void PilviKysely::lahetaTiedosto(const QByteArray &ba, const QMap<QString,QStrin
         iter.next();
         request.setRawHeader(iter.key().toLatin1(), iter.value().toLatin1());
     }
+    // Liitteet ovat yleensä valmiiksi pakattuja, joten runkoa ei pakata
+    PilviLiikenne::valmistele(request);
+    ajastin_.start();
 
     QNetworkReply *reply = metodi()==KpKysely::POST ?
                 kp()->networkManager()->post(request, ba) :
@@ -114,16 +133,23 @@ void PilviKysely::lahetaTiedosto(const QByteArray &ba, const QMap<QString,QStrin
 void PilviKysely::vastausSaapuu()
 {
     QNetworkReply *reply = qobject_cast<QNetworkReply*>( sender());
+    PilviLiikenne::kirjaa(reply, ajastin_.elapsed());
+    PilviModel *model = qobject_cast<PilviModel*>( parent() );
+    const QList<QObject*> odottajat = model->nippu()->valmis(this);
+
     if( reply->error()) {
         QByteArray vastaus = reply->readAll();
 
         qCritical() << " (VIRHE!) " << reply->error() << " " << reply->request().url().toString() ;
 
         qCritical() <<  QString::fromUtf8(vastaus);
-        std::cerr << vastaus.toStdString();
 
         QString selite = QJsonDocument::fromJson(vastaus).object().value("virhe").toString();
         emit virhe( reply->error(), selite);
+        for(QObject* odottaja : odottajat) {
+            emit qobject_cast<PilviKysely*>(odottaja)->virhe( reply->error(), selite);
+            odottaja->deleteLater();
+        }
 
         return;
     } else {
@@ -135,7 +161,10 @@ void PilviKysely::vastausSaapuu()
             vastaus_ = QJsonDocument::fromJson(luettu).toVariant();
         } else {
             vastaus_ = luettu;
-        }        
+        }
+        kirjaaValimuistiin();
+        const QVariant kokonainen = odottajat.isEmpty() ? QVariant() : vastaus_;
+        jaaOsiin();
         emit vastaus( &vastaus_ );
         if( metodi() == KpKysely::POST) {
             QString location = QString::fromLatin1(reply->rawHeader("Location"));
@@ -143,11 +172,21 @@ void PilviKysely::vastausSaapuu()
             int lisattyid = location.midRef( location.lastIndexOf('/') + 1 ).toInt();
             emit lisaysVastaus(vastaus_, lisattyid);
         }
+        for(QObject* odottaja : odottajat)
+            qobject_cast<PilviKysely*>(odottaja)->vastaaJaettuna(kokonainen);
     }
 
     this->deleteLater();
 }
 
+void PilviKysely::vastaaJaettuna(const QVariant &vastaus)
+{
+    vastaus_ = vastaus;
+    jaaOsiin();
+    emit this->vastaus( &vastaus_ );
+    deleteLater();
+}
+
 void PilviKysely::verkkovirhe(QNetworkReply::NetworkError koodi)
 {
     if( koodi == QNetworkReply::ConnectionRefusedError)
@@ -21,6 +21,7 @@
 #include "pilvimodel.h"
 
 #include <QNetworkReply>
+#include <QElapsedTimer>
 
 class YhteysModel;
 
@@ -37,6 +38,18 @@ public slots:
 protected slots:
     void vastausSaapuu();
     void verkkovirhe(QNetworkReply::NetworkError koodi);
+
+protected:
+    /**
+     * @brief Lähettää kyselyn verkkoon, kutsutaan nipun lähetyksessä
+     */
+    void laheta(const QVariant& data);
+    /**
+     * @brief Välittää yhdistetylle kyselylle toisen kyselyn vastauksen
+     */
+    void vastaaJaettuna(const QVariant& vastaus);
+
+    QElapsedTimer ajastin_;
 };
 
 #endif // PILVIKYSELY_H
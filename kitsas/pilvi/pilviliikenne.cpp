@@ -0,0 +1,78 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "pilviliikenne.h"
+
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QtEndian>
+
+Q_LOGGING_CATEGORY(pilviLoki, "kitsas.pilvi", QtWarningMsg)
+
+bool PilviLiikenne::kaytossa__ = qEnvironmentVariableIntValue("KITSAS_TIIVIS_SIIRTO") != 0;
+
+void PilviLiikenne::asetaKaytossa(bool kaytossa)
+{
+    kaytossa__ = kaytossa;
+}
+
+void PilviLiikenne::valmistele(QNetworkRequest &request)
+{
+    if( kaytossa__ )
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+}
+
+QByteArray PilviLiikenne::runko(QNetworkRequest &request, const QByteArray &data)
+{
+    if( !kaytossa__ || data.size() <= PAKKAUSRAJA)
+        return data;
+
+    QByteArray pakattu = tiivista(data);
+    if( pakattu.size() >= data.size())
+        return data;
+
+    request.setRawHeader("Content-Encoding", "deflate");
+    qCDebug(pilviLoki) << "Runko pakattu" << data.size() << "->" << pakattu.size();
+    return pakattu;
+}
+
+void PilviLiikenne::kirjaa(QNetworkReply *reply, qint64 kesto)
+{
+    if( !pilviLoki().isDebugEnabled())
+        return;
+    qCDebug(pilviLoki) << reply->operation() << reply->url().toString()
+                       << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()
+                       << (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool() ? "HTTP/2" : "HTTP/1.1")
+                       << kesto << "ms";
+}
+
+QByteArray PilviLiikenne::tiivista(const QByteArray &data)
+{
+    // qCompress lisää zlib-virran alkuun neljän tavun pituuden
+    return qCompress(data).mid(4);
+}
+
+QByteArray PilviLiikenne::pura(const QByteArray &data)
+{
+    if( data.isEmpty())
+        return QByteArray();
+
+    // qUncompress kasvattaa puskuria tarvittaessa, joten pituus on vain arvio
+    QByteArray pituus(4, '\0');
+    qToBigEndian<quint32>( static_cast<quint32>(qMin<qint64>(qint64(data.size()) * 4, 0x3fffffff)),
+                           reinterpret_cast<uchar*>(pituus.data()));
+    return qUncompress(pituus + data);
+}
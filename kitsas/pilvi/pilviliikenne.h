@@ -0,0 +1,81 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PILVILIIKENNE_H
+#define PILVILIIKENNE_H
+
+#include <QByteArray>
+#include <QLoggingCategory>
+
+class QNetworkRequest;
+class QNetworkReply;
+
+Q_DECLARE_LOGGING_CATEGORY(pilviLoki)
+
+/**
+ * @brief Pilvikyselyiden tiivis siirtotapa
+ *
+ * Tiiviissä siirrossa pyynnöt sallitaan lähettää HTTP/2-yhteydellä,
+ * jolloin saman palvelimen kyselyt jakavat yhden yhteyden. Suuret
+ * pyyntörungot lähetetään deflate-pakattuina. Vastausten gzip- ja
+ * deflate-pakkaus pyydetään ja puretaan QNetworkAccessManagerin
+ * omalla Accept-Encoding -otsakkeella.
+ *
+ * Siirtotavan voi valita asetuksella TiivisSiirto tai ympäristömuuttujalla
+ * KITSAS_TIIVIS_SIIRTO. Kyselyiden yksityiskohdat kirjoitetaan lokiin
+ * kategoriassa kitsas.pilvi, esim. QT_LOGGING_RULES="kitsas.pilvi.debug=true"
+ */
+class PilviLiikenne
+{
+public:
+    static bool kaytossa() { return kaytossa__; }
+    static void asetaKaytossa(bool kaytossa);
+
+    /**
+     * @brief Asettaa pyynnölle siirtotavan määritteet
+     */
+    static void valmistele(QNetworkRequest& request);
+
+    /**
+     * @brief Pyynnön runko lähetettäväksi
+     *
+     * Pakkaa yli PAKKAUSRAJA tavun rungon ja asettaa pyyntöön
+     * Content-Encoding -otsakkeen, jos tiivis siirto on käytössä.
+     */
+    static QByteArray runko(QNetworkRequest& request, const QByteArray& data);
+
+    /**
+     * @brief Kirjaa lokiin vastauksen siirtotiedot
+     */
+    static void kirjaa(QNetworkReply* reply, qint64 kesto);
+
+    /**
+     * @brief Pakkaa datan HTTP:n deflate-muotoon (zlib)
+     */
+    static QByteArray tiivista(const QByteArray& data);
+    /**
+     * @brief Purkaa deflate-muotoon (zlib) pakatun datan
+     * @return Tyhjä, jos data ei ole kelvollista
+     */
+    static QByteArray pura(const QByteArray& data);
+
+    static const int PAKKAUSRAJA = 1024;
+
+private:
+    static bool kaytossa__;
+};
+
+#endif // PILVILIIKENNE_H
@@ -17,6 +17,7 @@
 #include "pilvimodel.h"
 #include "db/kirjanpito.h"
 #include "pilvikysely.h"
+#include "pilvinippu.h"
 #include "versio.h"
 
 #include <QNetworkAccessManager>
@@ -37,7 +38,8 @@
 
 PilviModel::PilviModel(QObject *parent, const QString &token) :
     YhteysModel (parent),
-    token_(token)
+    token_(token),
+    nippu_(new PilviNippu(this))
 {
     timer_ = new QTimer(this);
     connect(timer_, &QTimer::timeout, this, &PilviModel::tarkistaKirjautuminen);
@@ -128,6 +130,7 @@ void PilviModel::sulje()
     oikeudet_ = 0;
     osoite_.clear();
     token_ = userToken();
+    nippu_->katkaise();
 }
 
 void PilviModel::poistaNykyinenPilvi()
@@ -24,6 +24,7 @@
 
 class QTimer;
 class QNetworkReply;
+class PilviNippu;
 
 /**
  * @brief Pilvessä olevien kirjanpitojen luettelo
@@ -77,6 +78,7 @@ public:
     QDate kokeilujakso() const { return data_.value("trialperiod").toDate(); }
     bool tilausvoimassa() const { return plan() || kokeilujakso() >= QDate::currentDate();}
     bool pilviVat() const { return  pilviVat_; }
+    PilviNippu* nippu() { return nippu_; }
     int blokattu() const { return data_.value("blocked").toInt(); }
 
     qlonglong oikeudet() const override { return oikeudet_;}
@@ -120,6 +122,7 @@ private:
 
     QVariantMap data_;
     QTimer *timer_;    
+    PilviNippu *nippu_;
     QMap<int,QPixmap> logot_;
 
     QDateTime tokenUusittu_;
@@ -0,0 +1,117 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "pilvinippu.h"
+#include "pilviliikenne.h"
+
+PilviNippu::PilviNippu(QObject *parent) : QObject(parent)
+{
+
+}
+
+bool PilviNippu::jonota(QObject *kysely, const QString &avain, std::function<void ()> lahetys)
+{
+    if( avain.isEmpty()) {
+        katkaise();
+    } else if( QObject* kesken = kesken_.value(avain) ) {
+        odottajat_[kesken].append( Jonossa{ kysely, kysely, lahetys} );
+        yhdistetty_++;
+        return true;
+    } else {
+        kesken_.insert(avain, kysely);
+        avaimet_.insert(kysely, avain);
+        connect( kysely, &QObject::destroyed, this, [this, kysely] { this->poistettu(kysely); });
+    }
+
+    if( jono_.isEmpty())
+        QMetaObject::invokeMethod(this, &PilviNippu::laheta, Qt::QueuedConnection);
+    jono_.append( Jonossa{ kysely, kysely, lahetys} );
+    return false;
+}
+
+QList<QObject *> PilviNippu::valmis(QObject *kysely)
+{
+    disconnect( kysely, &QObject::destroyed, this, nullptr);
+    const QString avain = avaimet_.take(kysely);
+    if( !avain.isEmpty() && kesken_.value(avain) == kysely)
+        kesken_.remove(avain);
+
+    QList<QObject*> lista;
+    for(const Jonossa& odottaja : odottajat_.take(kysely)) {
+        if( odottaja.kysely )
+            lista.append(odottaja.kysely);
+    }
+    return lista;
+}
+
+void PilviNippu::poistettu(QObject *osoite)
+{
+    const QString avain = avaimet_.take(osoite);
+    const bool kesken = !avain.isEmpty() && kesken_.value(avain) == osoite;
+    if( kesken )
+        kesken_.remove(avain);
+
+    QList<Jonossa> odottajat = odottajat_.take(osoite);
+    while( !odottajat.isEmpty() && !odottajat.first().kysely )
+        odottajat.removeFirst();
+    if( odottajat.isEmpty())
+        return;
+
+    // Poistettu kysely ei vastaa, joten ensimmäinen odottaja lähetetään itse
+    const Jonossa uusi = odottajat.takeFirst();
+    avaimet_.insert(uusi.osoite, avain);
+    if( kesken )
+        kesken_.insert(avain, uusi.osoite);
+    if( !odottajat.isEmpty())
+        odottajat_.insert(uusi.osoite, odottajat);
+    QObject* kysely = uusi.osoite;
+    connect( kysely, &QObject::destroyed, this, [this, kysely] { this->poistettu(kysely); });
+
+    if( jono_.isEmpty())
+        QMetaObject::invokeMethod(this, &PilviNippu::laheta, Qt::QueuedConnection);
+    jono_.append(uusi);
+}
+
+void PilviNippu::katkaise()
+{
+    kesken_.clear();
+}
+
+QVariantMap PilviNippu::tilasto() const
+{
+    QVariantMap map;
+    map.insert("niput", nippuja_);
+    map.insert("lahetetyt", lahetetty_);
+    map.insert("yhdistetyt", yhdistetty_);
+    map.insert("kesken", avaimet_.count());
+    return map;
+}
+
+void PilviNippu::laheta()
+{
+    QList<Jonossa> jono;
+    jono.swap(jono_);
+    nippuja_++;
+    qCDebug(pilviLoki) << "Nippu" << jono.count() << "kyselyä";
+
+    // Lähettämättä poistetun kyselyn tiedot on jo siivottu
+    for(const Jonossa& jonossa : jono) {
+        if( jonossa.kysely ) {
+            lahetetty_++;
+            jonossa.lahetys();
+        }
+    }
+}
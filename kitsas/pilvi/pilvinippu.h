@@ -0,0 +1,95 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PILVINIPPU_H
+#define PILVINIPPU_H
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QVariantMap>
+
+#include <functional>
+
+/**
+ * @brief Pilvikyselyiden kokoaminen nipuiksi
+ *
+ * Saman tapahtumasilmukan kierroksen aikana tehdyt kyselyt jonotetaan
+ * ja lähetetään peräkkäin kierroksen päätteeksi, jolloin ne kulkevat
+ * samaa HTTP/2-yhteyttä pitkin.
+ *
+ * Jos samaan polkuun samoin parametrein kohdistuva GET-kysely on jo
+ * kesken, uutta pyyntöä ei lähetetä, vaan kysely jää odottamaan ja
+ * saa kesken olevan kyselyn vastauksen. Muokkaava kysely katkaisee
+ * yhdistämisen, jotta sen jälkeen tehdyt haut näkevät muutoksen.
+ * Jos kesken oleva kysely poistetaan ennen vastausta, ensimmäinen
+ * odottaja lähetetään omana kyselynään ja muut jäävät odottamaan sitä.
+ */
+class PilviNippu : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PilviNippu(QObject *parent = nullptr);
+
+    /**
+     * @brief Jonottaa kyselyn lähetettäväksi kierroksen lopussa
+     * @param kysely Kysely
+     * @param avain GET-kyselyn polku ja parametrit, tyhjä jos kyselyä ei saa yhdistää
+     * @param lahetys Kyselyn lähettävä funktio
+     * @return tosi, jos kysely liitettiin odottamaan kesken olevaa kyselyä
+     */
+    bool jonota(QObject* kysely, const QString& avain, std::function<void()> lahetys);
+
+    /**
+     * @brief Kysely on saanut vastauksen
+     * @return Kyselyt, joille sama vastaus on välitettävä
+     */
+    QList<QObject*> valmis(QObject* kysely);
+
+    /**
+     * @brief Kesken oleviin kyselyihin ei enää yhdistetä
+     */
+    void katkaise();
+
+    /**
+     * @brief Nippujen, lähetettyjen ja yhdistettyjen kyselyiden määrät
+     */
+    QVariantMap tilasto() const;
+
+protected:
+    void laheta();
+    /**
+     * @brief Siivoaa poistetun kyselyn tiedot ja lähettää sen odottajat
+     */
+    void poistettu(QObject* osoite);
+
+    struct Jonossa {
+        QPointer<QObject> kysely;
+        QObject* osoite;
+        std::function<void()> lahetys;
+    };
+
+    QList<Jonossa> jono_;
+    QHash<QString, QObject*> kesken_;
+    QHash<QObject*, QString> avaimet_;
+    QHash<QObject*, QList<Jonossa>> odottajat_;
+
+    qlonglong nippuja_ = 0;
+    qlonglong lahetetty_ = 0;
+    qlonglong yhdistetty_ = 0;
+};
+
+#endif // PILVINIPPU_H
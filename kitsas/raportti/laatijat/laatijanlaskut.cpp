@@ -1,6 +1,7 @@
 #include "laatijanlaskut.h"
 
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 #include "db/tositetyyppimodel.h"
 
 LaatijanLaskut::LaatijanLaskut(RaportinLaatija *laatija, const RaporttiValinnat &valinnat) :
@@ -84,11 +85,11 @@ void LaatijanLaskut::dataSaapuu(QVariant *data)
         rivi.lisaa( map.value("pvm").toDate());
         rivi.lisaa( map.value("erapvm").toDate());
 
-        qlonglong summa = qRound64( map.value("summa").toDouble() * 100.0);
+        qlonglong summa = Euro::fromVariant(map.value("summa")).cents();
         rivi.lisaa( summa );
         kokosumma += summa;
 
-        qlonglong avoin = qRound64( map.value("avoin").toDouble() * 100.0);
+        qlonglong avoin = Euro::fromVariant(map.value("avoin")).cents();
         rivi.lisaa( avoin );
 
         int tyyppi = map.value("tyyppi").toInt();
@@ -1,5 +1,6 @@
 #include "laatijanpaakirja.h"
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 
 LaatijanPaakirja::LaatijanPaakirja(RaportinLaatija *laatija, const RaporttiValinnat &valinnat) :
     LaatijanRaportti(laatija, valinnat)
@@ -40,6 +41,8 @@ void LaatijanPaakirja::laadi()
     if( tililta )
         vientikysely->lisaaAttribuutti("tili", tililta);
 
+    vientikysely->asetaOsakoko(1000);
+    connect( vientikysely, &KpKysely::osaVastaus, this, &LaatijanPaakirja::vientejaSaapuu);
     connect( vientikysely, &KpKysely::vastaus, this, &LaatijanPaakirja::viennitSaapuu);
 
 
@@ -98,7 +101,7 @@ void LaatijanPaakirja::saldotSaapuu(QVariant *data)
     while(iter.hasNext()) {
         iter.next();
         const QString tili = iter.key();
-        saldot_.insert(tili, qRound64(iter.value().toDouble() * 100.0));
+        saldot_.insert(tili, Euro::fromVariant(iter.value()).cents());
         if( !data_.contains(tili))
             data_.insert(tili, QList<QVariantMap>());
     }
@@ -108,15 +111,21 @@ void LaatijanPaakirja::saldotSaapuu(QVariant *data)
 
 void LaatijanPaakirja::viennitSaapuu(QVariant *data)
 {
-    const QVariantList viennit = data->toList();
-    for(const auto& vienti : viennit) {
+    // Viennit ovat saapuneet jo osissa, vastaus päättää listan
+    QVariantList viennit = data->toList();
+    vientejaSaapuu(&viennit);
+
+    if( ++saapuneet_ > 1)
+        kirjoitaDatasta();
+}
+
+void LaatijanPaakirja::vientejaSaapuu(QVariantList *viennit)
+{
+    for(const auto& vienti : qAsConst(*viennit)) {
         QVariantMap map = vienti.toMap();
         const QString tili = map.value("tili").toString();
         data_[tili].append(map);
     }
-
-    if( ++saapuneet_ > 1)
-        kirjoitaDatasta();
 }
 
 void LaatijanPaakirja::kirjoitaDatasta()
@@ -182,16 +191,16 @@ void LaatijanPaakirja::kirjoitaDatasta()
                 rr.lisaa(  vienti.value("debet").toDouble()  );
                 rr.lisaa(  vienti.value("kredit").toDouble()  );
 
-                debetSumma += qRound64( vienti.value("debet").toDouble() * 100 );
-                kreditSumma += qRound64( vienti.value("kredit").toDouble() * 100 );
+                debetSumma += Euro::fromVariant(vienti.value("debet")).cents();
+                kreditSumma += Euro::fromVariant(vienti.value("kredit")).cents();
 
                 if( tili.onko(TiliLaji::VASTAAVAA))
                 {
-                    saldo += qRound64( vienti.value("debet").toDouble() * 100 );
-                    saldo -= qRound64( vienti.value("kredit").toDouble() * 100 );
+                    saldo += Euro::fromVariant(vienti.value("debet")).cents();
+                    saldo -= Euro::fromVariant(vienti.value("kredit")).cents();
                 } else {
-                    saldo -= qRound64( vienti.value("debet").toDouble() * 100 );
-                    saldo += qRound64( vienti.value("kredit").toDouble() * 100 );
+                    saldo -= Euro::fromVariant(vienti.value("debet")).cents();
+                    saldo += Euro::fromVariant(vienti.value("kredit")).cents();
                 }
 
                 if( tili.onko(TiliLaji::TULOS) || valinnat().arvo(RaporttiValinnat::Kohdennuksella).toInt() < 0)
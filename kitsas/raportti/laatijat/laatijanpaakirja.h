@@ -14,6 +14,7 @@ public:
 private slots:
     void saldotSaapuu(QVariant* data);
     void viennitSaapuu(QVariant* data);
+    void vientejaSaapuu(QVariantList* viennit);
 
 private:
     void kirjoitaDatasta();
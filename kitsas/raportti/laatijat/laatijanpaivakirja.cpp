@@ -1,5 +1,6 @@
 #include "laatijanpaivakirja.h"
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 #include "db/tositetyyppimodel.h"
 
 LaatijanPaivakirja::LaatijanPaivakirja(RaportinLaatija *laatija, const RaporttiValinnat &valinnat) :
@@ -156,8 +157,8 @@ void LaatijanPaivakirja::dataSaapuu(QVariant *data)
             rivi.lisaa( kumppani );
         rivi.lisaa( valinnat().onko(RaporttiValinnat::TulostaKumppani) && selite == kumppani ? "" : selite );
 
-        qlonglong debetsnt = qRound64( map.value("debet").toDouble() * 100.0 );
-        qlonglong kreditsnt = qRound64( map.value("kredit").toDouble() * 100.0 );
+        qlonglong debetsnt = Euro::fromVariant(map.value("debet")).cents();
+        qlonglong kreditsnt = Euro::fromVariant(map.value("kredit")).cents();
 
         debetsumma += debetsnt;
         debetvalisumma += debetsnt;
@@ -1,5 +1,6 @@
 #include "laatijantaseerittely.h"
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 
 LaatijanTaseErittely::LaatijanTaseErittely(RaportinLaatija *laatija, const RaporttiValinnat &valinnat) :
     LaatijanRaportti(laatija, valinnat)
@@ -99,7 +100,7 @@ void LaatijanTaseErittely::dataSaapuu(QVariant *data)
 
         if( tyyppi == 'S') {    // VAIN SALDO
             RaporttiRivi rr;
-            qlonglong saldo = qRound64(tieto.toDouble() * 100);
+            qlonglong saldo = Euro::fromVariant(tieto).cents();
             rr.lisaaLinkilla( RaporttiRiviSarake::TILI_NRO, tili->numero(), tili->nimiNumeroIban(kielikoodi()), 4 );
             rr.lisaa( saldo, true);
             rr.lihavoi();
@@ -139,7 +140,7 @@ void LaatijanTaseErittely::dataSaapuu(QVariant *data)
                             nimirivi.lisaa( selite);
                         }
 
-                        nimirivi.lisaa( qRound64( eramap.value("eur").toDouble() * 100));
+                        nimirivi.lisaa( Euro::fromVariant(eramap.value("eur")).cents());
                     }
                     rk.lisaaRivi(nimirivi);
 
@@ -149,15 +150,15 @@ void LaatijanTaseErittely::dataSaapuu(QVariant *data)
                             RaporttiRivi poistettuRivi;
                             poistettuRivi.lisaa(" ",2);
                             poistettuRivi.lisaa( kaanna("Lisäykset/vähennykset %1 saakka").arg( mista_.addDays(-1).toString("dd.MM.yyyy")),2);
-                            poistettuRivi.lisaa( qRound64( map.value("ennen").toDouble() * 100 ) -
-                                                 qRound64( eramap.value("eur").toDouble() * 100), true);
+                            poistettuRivi.lisaa( Euro::fromVariant(map.value("ennen")).cents() -
+                                                 Euro::fromVariant(eramap.value("eur")).cents(), true);
                             rk.lisaaRivi(poistettuRivi);
                         }
 
                         RaporttiRivi saldorivi;
                         saldorivi.lisaa(" ", 2);
                         saldorivi.lisaa( kaanna("Jäljellä %1").arg( mista_.toString("dd.MM.yyyy")),2);
-                        saldorivi.lisaa( qRound64( map.value("ennen").toDouble() * 100 ), true );
+                        saldorivi.lisaa( Euro::fromVariant(map.value("ennen")).cents(), true );
                         saldorivi.viivaYlle();
                         rk.lisaaRivi( saldorivi);
                     }
@@ -177,29 +178,29 @@ void LaatijanTaseErittely::dataSaapuu(QVariant *data)
                             rr.lisaa( kumppani);
                             rr.lisaa( selite);
                         }
-                        rr.lisaa(qRound64( mmap.value("eur").toDouble() * 100.0 ));
+                        rr.lisaa(Euro::fromVariant(mmap.value("eur")).cents());
                         rk.lisaaRivi(rr);
                     }
                     // Loppusaldo
                     RaporttiRivi loppuRivi;
                     loppuRivi.lisaa(" ", 2);
                     loppuRivi.lisaa( kaanna("Loppusaldo %1").arg(mihin_.toString("dd.MM.yyyy")),2);
-                    loppuRivi.lisaa( qRound64(map.value("saldo").toDouble() * 100.0),true);
+                    loppuRivi.lisaa( Euro::fromVariant(map.value("saldo")).cents(),true);
                     loppuRivi.viivaYlle();
                     rk.lisaaRivi(loppuRivi);
 
                     rk.lisaaRivi();
-                    loppusaldo += qRound64(map.value("saldo").toDouble() * 100.0);
+                    loppusaldo += Euro::fromVariant(map.value("saldo")).cents();
                 }
 
             } else if ( tyyppi == 'M') {
                 QVariantMap map = tieto.toMap();
-                loppusaldo = qRound64( map.value("saldo").toDouble() * 100);
+                loppusaldo = Euro::fromVariant(map.value("saldo")).cents();
 
                 RaporttiRivi saldorivi;
                 saldorivi.lisaa(" ", 2);
                 saldorivi.lisaa( kaanna("Alkusaldo %1").arg( mista_.toString("dd.MM.yyyy")),2);
-                saldorivi.lisaa( qRound64( map.value("ennen").toDouble() * 100 ), true );
+                saldorivi.lisaa( Euro::fromVariant(map.value("ennen")).cents(), true );
                 rk.lisaaRivi( saldorivi);
 
                 // Muutokset
@@ -219,7 +220,7 @@ void LaatijanTaseErittely::dataSaapuu(QVariant *data)
                         rr.lisaa( selite);
                     }
 
-                    rr.lisaa(qRound64( mmap.value("eur").toDouble() * 100.0 ));
+                    rr.lisaa(Euro::fromVariant(mmap.value("eur")).cents());
                     rk.lisaaRivi(rr);
                 }
 
@@ -248,9 +249,9 @@ void LaatijanTaseErittely::dataSaapuu(QVariant *data)
                         rr.lisaa("",2);
                         rr.lisaa(kaanna("Erittelemättömät"),2);
                     }
-                    rr.lisaa(qRound64( emap.value("eur").toDouble() * 100.0 ));
+                    rr.lisaa(Euro::fromVariant(emap.value("eur")).cents());
                     rk.lisaaRivi(rr);
-                    loppusaldo += qRound64( emap.value("eur").toDouble() * 100.0 );
+                    loppusaldo += Euro::fromVariant(emap.value("eur")).cents();
                 }
 
             }
@@ -130,7 +130,7 @@ void LaatijanTaseTulos::dataSaapuu(int sarake, QVariant *variant)
             while( iter.hasNext()) {
                 iter.next();
                 int tili = iter.key().toInt();
-                Euro euro = Euro(iter.value().toString());
+                Euro euro = Euro::fromVariant(iter.value());
                 if( euro == Euro::Zero) continue;
 
                 if( !eurot.contains(tili))
@@ -144,8 +144,7 @@ void LaatijanTaseTulos::dataSaapuu(int sarake, QVariant *variant)
         while( iter.hasNext()) {
             iter.next();
             int tili = iter.key().toInt();
-            QString euroStr = iter.value().toString();
-            Euro euro = Euro(euroStr);
+            Euro euro = Euro::fromVariant(iter.value());
             if( euro == Euro::Zero) continue;    // Nollaeuroja ei huomioida
 
             if( !eurot_.contains(tili))
@@ -171,8 +171,8 @@ void LaatijanTilikartta::saldotSaapuu(QVariant *data)
             if( saldopvm.isValid())
             {
 
-                rr.lisaa( saldot.value(nrostr).toDouble() );
-                csvr.lisaa( saldot.value(nrostr).toDouble());
+                rr.lisaa( Euro::fromVariant(saldot.value(nrostr)) );
+                csvr.lisaa( Euro::fromVariant(saldot.value(nrostr)));
             }
         }
         if( kirjausohjeet )
@@ -123,7 +123,16 @@ int RekisteriTuontiModel::lataaCsv(const QString &tiedostonnimi)
          return 0;
 
      beginResetModel();
-     csv_ = Tuonti::CsvTuonti::csvListana(tiedosto.readAll());
+     // Tiedosto luetaan muistiin kartoitettuna, jolloin sitä ei kopioida
+     // kokonaisuudessaan ennen purkamista
+     uchar* kartta = tiedosto.size() ? tiedosto.map(0, tiedosto.size()) : nullptr;
+     if( kartta ) {
+         csv_ = Tuonti::CsvTuonti::csvListana(
+                     QByteArray::fromRawData(reinterpret_cast<const char*>(kartta), static_cast<int>(tiedosto.size())));
+         tiedosto.unmap(kartta);
+     } else {
+         csv_ = Tuonti::CsvTuonti::csvListana(tiedosto.readAll());
+     }
      if( !csv_.isEmpty()) {
          sarakkeet_.resize(csv_.value(0).count());
          arvaaSarakkeet();
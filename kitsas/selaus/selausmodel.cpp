@@ -17,8 +17,7 @@
 
 #include "selausmodel.h"
 
-#include <QSqlQuery>
-#include <QSqlError>
+#include <QSqlRecord>
 #include "db/kirjanpito.h"
 #include "db/tositetyyppimodel.h"
 #include "tositeselausmodel.h"
@@ -27,6 +26,7 @@
 
 #include "sqlite/sqlitemodel.h"
 #include <QDebug>
+#include <QTimer>
 
 
 SelausModel::SelausModel(QObject *parent) :
@@ -87,38 +87,96 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
 
 void SelausModel::lataaSqlite(SQLiteModel* sqlite, const QDate &alkaa, const QDate &loppuu, int tili)
 {
-
-    QString tilistr = tili ? QString(" AND tili=%1").arg(tili) : "";
-
-    QString kysymys = QString("SELECT vienti.id AS id, vienti.pvm as pvm, vienti.tili as tili, debetsnt, kreditsnt, "
-                    "selite, vienti.kohdennus as kohdennus, eraid, vienti.tosite as tosite_id, tosite.pvm as tosite_pvm, tosite.tunniste as tosite_tunniste,"
-                    "tosite.tyyppi as tosite_tyyppi, tosite.sarja as tosite_sarja, "
-                    "kumppani.nimi as kumppani_nimi, liitteita "
+    // Erän alkuperäinen tosite, erän saldo ja merkkaukset liitetään samaan
+    // kyselyyn, jotta rivejä muodostettaessa ei tarvita lisäkyselyitä
+    QString kysymys = QString("SELECT Vienti.id AS id, Vienti.pvm AS pvm, Vienti.tili AS tili, Vienti.debetsnt AS debetsnt, Vienti.kreditsnt AS kreditsnt, "
+                    "Vienti.selite AS selite, Vienti.kohdennus AS kohdennus, Vienti.eraid AS eraid, Vienti.tosite AS tosite_id, Tosite.pvm AS tosite_pvm, "
+                    "Tosite.tunniste AS tosite_tunniste, Tosite.tyyppi AS tosite_tyyppi, Tosite.sarja AS tosite_sarja, "
+                    "Kumppani.nimi AS kumppani_nimi, liitteita, merkkaukset, "
+                    "EraTosite.tyyppi AS era_tyyppi, EraTosite.tunniste AS era_tunniste, EraTosite.sarja AS era_sarja, EraTosite.pvm AS era_pvm, "
+                    "era_debetsnt, era_kreditsnt "
                     "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                    "LEFT OUTER JOIN Kumppani ON Vienti.kumppani=kumppani.id "
+                    "LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
                     "LEFT OUTER JOIN (SELECT tosite, COUNT(id) AS liitteita FROM Liite GROUP BY tosite) AS lq ON Tosite.id=lq.tosite "
-                    "WHERE tila >= 100 AND Vienti.pvm BETWEEN '%1' AND '%2' %3 ORDER BY pvm")
-            .arg(alkaa.toString(Qt::ISODate), loppuu.toString(Qt::ISODate), tilistr);
+                    "LEFT OUTER JOIN (SELECT vienti, GROUP_CONCAT(kohdennus) AS merkkaukset FROM Merkkaus GROUP BY vienti) AS mq ON Vienti.id=mq.vienti "
+                    "LEFT OUTER JOIN Vienti AS EraVienti ON Vienti.eraid=EraVienti.id "
+                    "LEFT OUTER JOIN Tosite AS EraTosite ON EraVienti.tosite=EraTosite.id "
+                    "LEFT OUTER JOIN (SELECT eraid, SUM(debetsnt) AS era_debetsnt, SUM(kreditsnt) AS era_kreditsnt "
+                    "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+                    "WHERE Tosite.tila >= 100 AND eraid IN (SELECT eraid FROM Vienti WHERE pvm BETWEEN ? AND ?) GROUP BY eraid) AS eq ON Vienti.eraid=eq.eraid "
+                    "WHERE Tosite.tila >= 100 AND Vienti.pvm BETWEEN ? AND ? %1 ORDER BY Vienti.pvm")
+            .arg(tili ? "AND Vienti.tili=?" : "");
 
-    beginResetModel();
+    const int lataus = ++lataus_;
 
-    kaytetytTilit_.clear();
-    rivit_.clear();
+    QVariantList sidokset;
+    for(int i=0; i < 2; i++) {
+        sidokset.append( alkaa.toString(Qt::ISODate) );
+        sidokset.append( loppuu.toString(Qt::ISODate) );
+    }
+    if( tili )
+        sidokset.append( tili );
+
+    // Kysely suoritetaan lukijan säikeessä, ja kaikki tietueet saapuvat
+    // kerralla kursorin jo suljettua
+    sqlite->haeRivit(kysymys, sidokset, this, [this, lataus] (const QList<QSqlRecord>& tietueet) {
+        this->sqliteSaapuu(tietueet, lataus);
+    });
+}
 
-    QSqlQuery kysely( sqlite->tietokanta() );
-    kysely.exec(kysymys);
+void SelausModel::sqliteSaapuu(const QList<QSqlRecord> &tietueet, int lataus)
+{
+    // Välissä on aloitettu uusi lataus
+    if( lataus != lataus_)
+        return;
 
-    bool merkkauksia = kp()->kohdennukset()->merkkauksia();
+    tietueet_ = tietueet;
+    luettu_ = 0;
 
-    while(kysely.next()) {
-        SelausRivi rivi(kysely, samakausi_, sqlite, merkkauksia);
-        rivit_.append(rivi);
-        kaytetytTilit_.insert(rivi.getTili());
-    }
+    // Rivien muodostaminen tarvitsee kirjanpidon tietoja, joten se tehdään
+    // tässä säikeessä. Ensimmäinen sivu näytetään heti, loput muodostetaan
+    // tapahtumasilmukan lomassa.
+    beginResetModel();
+    kaytetytTilit_.clear();
+    rivit_ = lueSivu();
+    endResetModel();
 
+    jatkaLatausta(lataus);
+}
 
-    endResetModel();
+QList<SelausRivi> SelausModel::lueSivu()
+{
+    QList<SelausRivi> sivu;
+    while( sivu.count() < SIVUKOKO && luettu_ < tietueet_.count()) {
+        sivu.append( SelausRivi(tietueet_.at(luettu_++), samakausi_) );
+        kaytetytTilit_.insert( sivu.last().getTili() );
+    }
+    if( luettu_ >= tietueet_.count()) {
+        tietueet_.clear();
+        luettu_ = 0;
+    }
+    return sivu;
+}
 
+void SelausModel::jatkaLatausta(int lataus)
+{
+    if( !tietueet_.isEmpty())
+        QTimer::singleShot(0, this, [this, lataus] { this->lataaSivu(lataus); });
+}
+
+void SelausModel::lataaSivu(int lataus)
+{
+    // Välissä on aloitettu uusi lataus
+    if( lataus != lataus_ || tietueet_.isEmpty())
+        return;
+
+    QList<SelausRivi> sivu = lueSivu();
+    if( !sivu.isEmpty()) {
+        beginInsertRows(QModelIndex(), rivit_.count(), rivit_.count() + sivu.count() - 1);
+        rivit_.append(sivu);
+        endInsertRows();
+    }
+    jatkaLatausta(lataus);
 }
 
 int SelausModel::tili(int rivi) const
@@ -143,6 +201,8 @@ void SelausModel::lataa(const QDate &alkaa, const QDate &loppuu, int tili)
 {
     samakausi_ = kp()->tilikausiPaivalle(alkaa).alkaa() == kp()->tilikausiPaivalle(loppuu).alkaa();
     tiliselaus_ = tili;
+    tietueet_.clear();
+    luettu_ = 0;
 
     if( kp()->yhteysModel()) {
 
@@ -252,7 +312,7 @@ SelausRivi::SelausRivi(const QVariantMap &data, bool samakausi)
 
 }
 
-SelausRivi::SelausRivi(QSqlQuery &data, bool samakausi, SQLiteModel *sqlite, bool merkkauksia)
+SelausRivi::SelausRivi(const QSqlRecord &data, bool samakausi)
 {
     vientiId = data.value("id").toInt();
     tositeId = data.value("tosite_id").toInt();
@@ -283,40 +343,32 @@ SelausRivi::SelausRivi(QSqlQuery &data, bool samakausi, SQLiteModel *sqlite, boo
        kohdennus = kohdennusObj.nimi();
 
 
-    QSqlQuery apukysely( sqlite->tietokanta());
-    if(merkkauksia) {
-
-        apukysely.exec(QString("SELECT kohdennus FROM Merkkaus WHERE vienti=%1").arg(vientiId));
+    const QString merkkaukset = data.value("merkkaukset").toString();
+    if( !merkkaukset.isEmpty()) {
         QStringList tagit;
-        while( apukysely.next()) {
-            tagit.append( kp()->kohdennukset()->kohdennus(apukysely.value(0).toInt()).nimi() );
-        }
-        if( !tagit.isEmpty()) {
-            if(!kohdennus.isEmpty())
-                kohdennus.append(" ");
-            kohdennus.append(tagit.join(", "));
-        }
+        for(const QString& merkkaus : merkkaukset.split(','))
+            tagit.append( kp()->kohdennukset()->kohdennus(merkkaus.toInt()).nimi() );
+        if(!kohdennus.isEmpty())
+            kohdennus.append(" ");
+        kohdennus.append(tagit.join(", "));
     }
 
     int eraid = data.value("eraid").toInt();
     if( eraid) {
 
-        if( eraid != vientiId) {
-            apukysely.exec(QString("SELECT Tosite.tyyppi, Tosite.tunniste, Tosite.sarja, Tosite.pvm AS pvm FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE Vienti.id=%1").arg(eraid));
-            if(apukysely.next()) {
-                if(!kohdennus.isEmpty())
-                    kohdennus.append(" ");
-                kohdennuskuvake = kp()->tositeTyypit()->kuvake(apukysely.value("tyyppi").toInt());
-                kohdennus.append( kp()->tositeTunnus(apukysely.value("tunniste").toInt(),
-                                                     apukysely.value("pvm").toDate(),
-                                                     apukysely.value("sarja").toString(),
-                                                     kp()->tilikaudet()->tilikausiPaivalle(apukysely.value("pvm").toDate()).alkaa() == kp()->tilikaudet()->tilikausiPaivalle(pvm).alkaa() ));
-            }
+        if( eraid != vientiId && !data.value("era_pvm").isNull()) {
+            const QDate erapvm = data.value("era_pvm").toDate();
+            if(!kohdennus.isEmpty())
+                kohdennus.append(" ");
+            kohdennuskuvake = kp()->tositeTyypit()->kuvake(data.value("era_tyyppi").toInt());
+            kohdennus.append( kp()->tositeTunnus(data.value("era_tunniste").toInt(),
+                                                 erapvm,
+                                                 data.value("era_sarja").toString(),
+                                                 kp()->tilikaudet()->tilikausiPaivalle(erapvm).alkaa() == kp()->tilikaudet()->tilikausiPaivalle(pvm).alkaa() ));
         }
 
-        // Tarkistetaan saldo, onko maksettu
-        apukysely.exec(QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=%1 AND Tosite.tila >= 100").arg(eraid));
-        if(apukysely.next() && apukysely.value(0).toLongLong() == apukysely.value(1).toLongLong())
+        // Onko maksettu
+        if( data.value("era_debetsnt").toLongLong() == data.value("era_kreditsnt").toLongLong())
             kohdennuskuvake = QIcon(":/pic/ok.png");
     }
 }
@@ -22,7 +22,7 @@
 #include <QSet>
 #include <QList>
 #include <QDate>
-#include <QSqlQuery>
+#include <QSqlRecord>
 
 #include "db/tili.h"
 #include "db/kohdennus.h"
@@ -34,7 +34,7 @@ class SelausRivi
 {
 public:
      SelausRivi(const QVariantMap& data, bool samakausi = false);
-     SelausRivi(QSqlQuery& data, bool samakausi, SQLiteModel *sqlite, bool merkkauksia);
+     SelausRivi(const QSqlRecord& data, bool samakausi);
 
      QVariant data(int sarake, int role) const;
      int getTili() const { return tili;}
@@ -102,6 +102,14 @@ public slots:
     void tietoSaapuu(QVariant *map);
 
 protected:
+    void sqliteSaapuu(const QList<QSqlRecord>& tietueet, int lataus);
+    /**
+     * @brief Muodostaa luetuista tietueista enintään sivullisen rivejä
+     */
+    QList<SelausRivi> lueSivu();
+    void jatkaLatausta(int lataus);
+    void lataaSivu(int lataus);
+
     QSet<int> kaytetytTilit_;
     QList<SelausRivi> rivit_;
 
@@ -110,6 +118,12 @@ protected:
     int tiliselaus_ = 0;
     bool ladataan_ = false;
 
+    QList<QSqlRecord> tietueet_;
+    int luettu_ = 0;
+    int lataus_ = 0;
+
+    static const int SIVUKOKO = 500;
+
 };
 
 #endif // SELAUSMODEL_H
@@ -34,6 +34,7 @@
 #include "lisaikkuna.h"
 #include "db/yhteysmodel.h"
 #include "pilvi/pilvimodel.h"
+#include "sqlite/sqlitemodel.h"
 #include "tositeselausmodel.h"
 #include "laskutus/laskudlg/laskudialogitehdas.h"
 
@@ -60,9 +61,11 @@ SelausWg::SelausWg(QWidget *parent) :
 
     connect( selausProxy_, &QSortFilterProxyModel::modelReset, this, &SelausWg::modelResetoitu);
     connect( selausProxy_, &QSortFilterProxyModel::dataChanged, this, &SelausWg::modelResetoitu);
+    connect( selausProxy_, &QSortFilterProxyModel::rowsInserted, this, &SelausWg::modelResetoitu);
 
     connect( tositeProxy_, &QSortFilterProxyModel::modelReset, this, &SelausWg::modelResetoitu);
     connect( tositeProxy_, &QSortFilterProxyModel::dataChanged, this, &SelausWg::modelResetoitu);
+    connect( tositeProxy_, &QSortFilterProxyModel::rowsInserted, this, &SelausWg::modelResetoitu);
 
 
     ui->selausView->horizontalHeader()->setStretchLastSection(true);
@@ -78,6 +81,11 @@ SelausWg::SelausWg(QWidget *parent) :
     connect( ui->tiliCombo, SIGNAL(currentTextChanged(QString)), this, SLOT(suodata()));
     connect( ui->etsiEdit, &QLineEdit::textChanged, this, &SelausWg::etsi);
 
+    hakuAjastin_ = new QTimer(this);
+    hakuAjastin_->setSingleShot(true);
+    hakuAjastin_->setInterval(300);
+    connect( hakuAjastin_, &QTimer::timeout, this, &SelausWg::hae);
+
     connect( ui->selausView, &QTableView::clicked, this, &SelausWg::naytaTositeRivilta);
 
     ui->valintaTab->setCurrentIndex(0);     // Oletuksena tositteiden selaus
@@ -183,7 +191,10 @@ void SelausWg::paivita()
     else if( ui->valintaTab->currentIndex() == TOSITTEET )
     {
         kp()->odotusKursori(true);
-        tositeModel->lataa( ui->alkuEdit->date(), ui->loppuEdit->date());
+        if( haetaan_ )
+            tositeModel->hae( ui->etsiEdit->text().trimmed() );
+        else
+            tositeModel->lataa( ui->alkuEdit->date(), ui->loppuEdit->date());
     } else if( ui->valintaTab->currentIndex() == LUONNOKSET){
         kp()->odotusKursori(true);
         tositeModel->lataa( alkupvm, loppupvm, TositeSelausModel::LUONNOKSET);
@@ -393,6 +404,11 @@ void SelausWg::alkuPvmMuuttui()
 void SelausWg::selaa(int kumpi)
 {
     ui->etsiEdit->clear();
+    hakuAjastin_->stop();
+    if( haetaan_ ) {
+        haetaan_ = false;
+        ui->selausView->sortByColumn(TositeSelausModel::PVM, Qt::AscendingOrder);
+    }
     lataaKoon_=true;
 
     if( kumpi == VIENNIT) {
@@ -461,10 +477,34 @@ void SelausWg::etsi(const QString &teksti)
 {
     if( ui->valintaTab->currentIndex() == VIENNIT)
         selausProxy_->etsi(teksti);
+    else if( ui->valintaTab->currentIndex() == TOSITTEET && qobject_cast<SQLiteModel*>(kp()->yhteysModel()))
+        hakuAjastin_->start();
     else
         tositeProxy_->etsi(teksti);
 }
 
+void SelausWg::hae()
+{
+    const QString teksti = ui->etsiEdit->text().trimmed();
+
+    if( teksti.length() >= HAKU_MERKKEJA ) {
+        // Tositteet haetaan koko kirjanpidosta osuvuusjärjestyksessä
+        tositeProxy_->etsi(QString());
+        if( !haetaan_ )
+            ui->selausView->sortByColumn(-1, Qt::AscendingOrder);
+        haetaan_ = true;
+        kp()->odotusKursori(true);
+        tositeModel->hae(teksti);
+    } else {
+        if( haetaan_ ) {
+            haetaan_ = false;
+            ui->selausView->sortByColumn(TositeSelausModel::PVM, Qt::AscendingOrder);
+            paivita();
+        }
+        tositeProxy_->etsi(teksti);
+    }
+}
+
 void SelausWg::tallennaKoot()
 {
     if( lataaKoon_)
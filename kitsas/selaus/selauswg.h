@@ -32,6 +32,7 @@
 
 class SelausModel;
 class TositeSelausModel;
+class QTimer;
 
 #include "tositeselausproxymodel.h"
 #include "selausproxymodel.h"
@@ -92,6 +93,7 @@ public:
 protected slots:
     void modelResetoitu();
     void etsi(const QString& teksti);
+    void hae();
     void tallennaKoot();
     void lataaKoot();
 
@@ -124,6 +126,14 @@ private:
     Euro saldo_;
     int selaustili_ = 0;    
     bool lataaKoon_ = false;
+
+    /**
+     * @brief Tositteiden haku koko kirjanpidosta hakuindeksillä
+     */
+    bool haetaan_ = false;
+    QTimer* hakuAjastin_;
+
+    static const int HAKU_MERKKEJA = 3;
 };
 
 #endif // SELAUSWG_H
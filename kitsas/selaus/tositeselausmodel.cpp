@@ -105,9 +105,21 @@ QStringList TositeSelausModel::sarjaLista() const
 
 
 
+bool TositeSelausModel::canFetchMore(const QModelIndex & /* parent */) const
+{
+    return !haku_.isEmpty() && hakuJatkuu_ && !ladataan_;
+}
+
+void TositeSelausModel::fetchMore(const QModelIndex & /* parent */)
+{
+    haeSivu();
+}
+
 void TositeSelausModel::lataa(const QDate &alkaa, const QDate &loppuu, int tila)
 {
     tila_ = tila;
+    haku_.clear();
+    hakuNro_++;
     samakausi_ = kp()->tilikausiPaivalle(alkaa).alkaa() == kp()->tilikausiPaivalle(loppuu).alkaa();
 
     if( kp()->yhteysModel())
@@ -126,6 +138,15 @@ void TositeSelausModel::lataa(const QDate &alkaa, const QDate &loppuu, int tila)
             else if( tila == POISTETUT)
                 kysely->lisaaAttribuutti("poistetut", QString());
 
+            // Rivit lisätään näkymään sitä mukaa kun niitä saapuu
+            beginResetModel();
+            kaytetytTyypit_.clear();
+            kaytetytSarjat_.clear();
+            rivit_.clear();
+            endResetModel();
+
+            kysely->asetaOsakoko(500);
+            connect( kysely, &KpKysely::osaVastaus, this, &TositeSelausModel::tietoaSaapuu);
             connect( kysely, &KpKysely::vastaus, this, &TositeSelausModel::tietoSaapuu);
             connect(kysely, &KpKysely::virhe, this, &TositeSelausModel::latausVirhe);
             ladataan_ = true;
@@ -136,15 +157,20 @@ void TositeSelausModel::lataa(const QDate &alkaa, const QDate &loppuu, int tila)
 
 void TositeSelausModel::tietoSaapuu(QVariant *var)
 {
-    beginResetModel();
-    kaytetytTyypit_.clear();
-    kaytetytSarjat_.clear();
     QVariantList lista = var->toList();
+    tietoaSaapuu(&lista);
+    ladataan_ = false;
+}
 
-    rivit_.clear();
-    rivit_.reserve(lista.count());
+void TositeSelausModel::tietoaSaapuu(QVariantList *lista)
+{
+    if( lista->isEmpty())
+        return;
 
-    for( const auto& item : qAsConst( lista )) {
+    beginInsertRows(QModelIndex(), rivit_.count(), rivit_.count() + lista->count() - 1);
+    rivit_.reserve( rivit_.count() + lista->count());
+
+    for( const auto& item : qAsConst( *lista )) {
         QVariantMap map = item.toMap();
         TositeSelausRivi rivi(map, samakausi_);
         rivit_.append(rivi);
@@ -153,7 +179,52 @@ void TositeSelausModel::tietoSaapuu(QVariant *var)
             kaytetytSarjat_.insert( rivi.getSarja() );
     }
 
+    endInsertRows();
+}
+
+void TositeSelausModel::hae(const QString &teksti)
+{
+    tila_ = KIRJANPIDOSSA;
+    samakausi_ = false;
+    haku_ = teksti;
+    hakuNro_++;
+    hakuJatkuu_ = true;
+
+    beginResetModel();
+    kaytetytTyypit_.clear();
+    kaytetytSarjat_.clear();
+    rivit_.clear();
     endResetModel();
+
+    haeSivu();
+}
+
+void TositeSelausModel::haeSivu()
+{
+    KpKysely* kysely = kpk("/haku");
+    if( !kysely )
+        return;
+
+    kysely->lisaaAttribuutti("teksti", haku_);
+    kysely->lisaaAttribuutti("alkaen", rivit_.count());
+    kysely->lisaaAttribuutti("raja", HAKUSIVU);
+
+    const int haku = hakuNro_;
+    connect( kysely, &KpKysely::vastaus, this, [this, haku] (QVariant* data) { this->hakuSaapuu(data, haku); });
+    connect( kysely, &KpKysely::virhe, this, &TositeSelausModel::latausVirhe);
+    ladataan_ = true;
+    kysely->kysy();
+}
+
+void TositeSelausModel::hakuSaapuu(QVariant *data, int haku)
+{
+    // Hakua on muutettu tämän sivun hakemisen jälkeen
+    if( haku != hakuNro_)
+        return;
+
+    QVariantList lista = data->toList();
+    hakuJatkuu_ = lista.count() == HAKUSIVU;
+    tietoaSaapuu(&lista);
     ladataan_ = false;
 }
 
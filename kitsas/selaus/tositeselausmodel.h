@@ -107,13 +107,26 @@ public:
     QString etsiTeksti(int rivi) const { return rivit_.at(rivi).getEtsi();}
     bool huomio(int rivi) const { return rivit_.at(rivi).getHuomio();}
 
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
 public slots:
     void lataa(const QDate& alkaa, const QDate& loppuu, int tila = KIRJANPIDOSSA);
+    /**
+     * @brief Hakee kirjanpidossa olevia tositteita koko kirjanpidosta
+     *
+     * Tulokset ovat osuvuusjärjestyksessä. Seuraava sivu haetaan,
+     * kun näkymä vieritetään loppuun.
+     */
+    void hae(const QString& teksti);
     void tietoSaapuu(QVariant *var);
+    void tietoaSaapuu(QVariantList *lista);
     void latausVirhe();
 
 protected:
     void lataaSqlite(SQLiteModel* sqlite, const QDate& alkaa, const QDate& loppuu);
+    void haeSivu();
+    void hakuSaapuu(QVariant* data, int haku);
 
     QList<TositeSelausRivi> rivit_;
 
@@ -124,6 +137,11 @@ protected:
     bool samakausi_ = false;
     bool ladataan_ = false;
 
+    QString haku_;
+    int hakuNro_ = 0;
+    bool hakuJatkuu_ = false;
+
+    static const int HAKUSIVU = 100;
 };
 
 #endif // TOSITESELAUSMODEL_H
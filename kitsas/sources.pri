@@ -27,9 +27,11 @@ SOURCES += \
     $$PWD/arkistoija/aineistodialog.cpp \
     $$PWD/arkistoija/arkistohakemistodialogi.cpp \
     $$PWD/arkistoija/arkistoija.cpp \
+    $$PWD/arkistoija/arkistokirjoittaja.cpp \
     $$PWD/arkistoija/laatuslider.cpp \
     $$PWD/db/tilivalintadialogifiltteri.cpp \
     $$PWD/db/tositetyyppimodel.cpp \
+    $$PWD/db/vastausvalimuisti.cpp \
     $$PWD/db/yhteysmodel.cpp \
     $$PWD/kieli/kielet.cpp \
     $$PWD/kieli/kieli.cpp \
@@ -88,6 +90,8 @@ SOURCES += \
     $$PWD/laskutus/toimittaja/finvoicetoimittaja.cpp \
     $$PWD/laskutus/toimittaja/laskuntoimittaja.cpp \
     $$PWD/laskutus/toimittaja/pdftoimittaja.cpp \
+    $$PWD/laskutus/toimittaja/sahkopostiistunto.cpp \
+    $$PWD/laskutus/toimittaja/sahkopostijono.cpp \
     $$PWD/laskutus/toimittaja/sahkopostitoimittaja.cpp \
     $$PWD/laskutus/toimittaja/tulostustoimittaja.cpp \
     $$PWD/laskutus/tositerivialv.cpp \
@@ -139,6 +143,7 @@ SOURCES += \
     $$PWD/model/tositerivit.cpp \
     $$PWD/model/tositeviennit.cpp \
     $$PWD/model/tositevienti.cpp \
+    $$PWD/model/vientirivi.cpp \
     $$PWD/naytin/laaditunraportinnaytin.cpp \
     $$PWD/naytin/liitetulostaja.cpp \
     $$PWD/naytin/naytinscene.cpp \
@@ -197,6 +202,7 @@ SOURCES += \
     $$PWD/sqlite/routes/asiakkaatroute.cpp \
     $$PWD/sqlite/routes/budjettiroute.cpp \
     $$PWD/sqlite/routes/eraroute.cpp \
+    $$PWD/sqlite/routes/hakuroute.cpp \
     $$PWD/sqlite/routes/inforoute.cpp \
     $$PWD/sqlite/routes/initroute.cpp \
     $$PWD/sqlite/routes/kohdennusroute.cpp \
@@ -214,7 +220,12 @@ SOURCES += \
     $$PWD/sqlite/routes/tuotteetroute.cpp \
     $$PWD/sqlite/routes/vakioviiteroute.cpp \
     $$PWD/sqlite/routes/viennitroute.cpp \
+    $$PWD/sqlite/liitelukija.cpp \
     $$PWD/sqlite/sqlitealustaja.cpp \
+    $$PWD/sqlite/sqlitekahva.cpp \
+    $$PWD/sqlite/verkkolevy.cpp \
+    $$PWD/sqlite/sqlitelukija.cpp \
+    $$PWD/sqlite/sqlitemittari.cpp \
     $$PWD/sqlite/sqliteroute.cpp \
     $$PWD/tilaus/planmodel.cpp \
     $$PWD/tilaus/tilausvalintasivu.cpp \
@@ -241,6 +252,7 @@ SOURCES += \
     $$PWD/tools/tilicombo.cpp \
     $$PWD/tools/varinvalinta.cpp \
     $$PWD/tools/vuosidelegaatti.cpp \
+    $$PWD/tuonti/csvlukija.cpp \
     $$PWD/tuonti/palkkafituonti.cpp \
     $$PWD/tuonti/pdftiliote/oterivi.cpp \
     $$PWD/tuonti/pdftiliote/pdftiliotetuonti.cpp \
@@ -348,6 +360,8 @@ SOURCES += \
     sqlite/sqlitekysely.cpp \
     db/kantavariantti.cpp \
     pilvi/pilvikysely.cpp \
+    pilvi/pilviliikenne.cpp \
+    pilvi/pilvinippu.cpp \
     pilvi/pilvimodel.cpp \
     sqlite/sqlitemodel.cpp \
     rekisteri/asiakastoimittajavalinta.cpp \
@@ -389,10 +403,12 @@ HEADERS += \
     $$PWD/arkistoija/aineistodialog.h \
     $$PWD/arkistoija/arkistohakemistodialogi.h \
     $$PWD/arkistoija/arkistoija.h \
+    $$PWD/arkistoija/arkistokirjoittaja.h \
     $$PWD/arkistoija/laatuslider.h \
     $$PWD/db/kitsasinterface.h \
     $$PWD/db/tilivalintadialogifiltteri.h \
     $$PWD/db/tositetyyppimodel.h \
+    $$PWD/db/vastausvalimuisti.h \
     $$PWD/db/yhteysmodel.h \
     $$PWD/kieli/abstraktimonikielinen.h \
     $$PWD/kieli/kielet.h \
@@ -453,6 +469,8 @@ HEADERS += \
     $$PWD/laskutus/toimittaja/finvoicetoimittaja.h \
     $$PWD/laskutus/toimittaja/laskuntoimittaja.h \
     $$PWD/laskutus/toimittaja/pdftoimittaja.h \
+    $$PWD/laskutus/toimittaja/sahkopostiistunto.h \
+    $$PWD/laskutus/toimittaja/sahkopostijono.h \
     $$PWD/laskutus/toimittaja/sahkopostitoimittaja.h \
     $$PWD/laskutus/toimittaja/tulostustoimittaja.h \
     $$PWD/laskutus/tositerivialv.h \
@@ -504,6 +522,7 @@ HEADERS += \
     $$PWD/model/tositerivit.h \
     $$PWD/model/tositeviennit.h \
     $$PWD/model/tositevienti.h \
+    $$PWD/model/vientirivi.h \
     $$PWD/naytin/laaditunraportinnaytin.h \
     $$PWD/naytin/liitetulostaja.h \
     $$PWD/naytin/naytinscene.h \
@@ -564,6 +583,7 @@ HEADERS += \
     $$PWD/sqlite/routes/asiakkaatroute.h \
     $$PWD/sqlite/routes/budjettiroute.h \
     $$PWD/sqlite/routes/eraroute.h \
+    $$PWD/sqlite/routes/hakuroute.h \
     $$PWD/sqlite/routes/inforoute.h \
     $$PWD/sqlite/routes/initroute.h \
     $$PWD/sqlite/routes/kohdennusroute.h \
@@ -581,7 +601,12 @@ HEADERS += \
     $$PWD/sqlite/routes/tuotteetroute.h \
     $$PWD/sqlite/routes/vakioviiteroute.h \
     $$PWD/sqlite/routes/viennitroute.h \
+    $$PWD/sqlite/liitelukija.h \
     $$PWD/sqlite/sqlitealustaja.h \
+    $$PWD/sqlite/sqlitekahva.h \
+    $$PWD/sqlite/verkkolevy.h \
+    $$PWD/sqlite/sqlitelukija.h \
+    $$PWD/sqlite/sqlitemittari.h \
     $$PWD/sqlite/sqliteroute.h \
     $$PWD/tilaus/planmodel.h \
     $$PWD/tilaus/tilausvalintasivu.h \
@@ -608,6 +633,7 @@ HEADERS += \
     $$PWD/tools/tilicombo.h \
     $$PWD/tools/varinvalinta.h \
     $$PWD/tools/vuosidelegaatti.h \
+    $$PWD/tuonti/csvlukija.h \
     $$PWD/tuonti/palkkafituonti.h \
     $$PWD/tuonti/pdftiliote/oterivi.h \
     $$PWD/tuonti/pdftiliote/pdftiliotetuonti.h \
@@ -716,6 +742,8 @@ HEADERS += \
     sqlite/sqlitekysely.h \
     db/kantavariantti.h \
     pilvi/pilvikysely.h \
+    pilvi/pilviliikenne.h \
+    pilvi/pilvinippu.h \
     pilvi/pilvimodel.h \
     sqlite/sqlitemodel.h \
     rekisteri/asiakastoimittajavalinta.h \
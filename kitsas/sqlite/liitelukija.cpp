@@ -0,0 +1,112 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "liitelukija.h"
+#include "sqlitekahva.h"
+
+#include <QSqlQuery>
+#include <QDebug>
+
+#ifdef KITSAS_SYSTEM_SQLITE
+#include <sqlite3.h>
+#endif
+
+LiiteLukija::LiiteLukija(QSqlDatabase tietokanta, const QString &taulu, qint64 rivi, QObject *parent) :
+    QIODevice(parent), tietokanta_(tietokanta), taulu_(taulu), rivi_(rivi)
+{
+#ifdef KITSAS_SYSTEM_SQLITE
+    sqlite3* yhteys = sqliteKahva(tietokanta);
+    if( yhteys ) {
+        if( sqlite3_blob_open(yhteys, "main", taulu.toUtf8().constData(), "data", rivi, 0, &blob_) != SQLITE_OK) {
+            setErrorString( QString::fromUtf8( sqlite3_errmsg(yhteys) ) );
+            qWarning() << "Liitteen avaaminen epäonnistui " << errorString();
+            blob_ = nullptr;
+            return;
+        }
+        koko_ = sqlite3_blob_bytes(blob_);
+        // Puskurointi ohitetaan, koska blob-luku on jo valmiiksi satunnaissaantia
+        QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+        return;
+    }
+#endif
+
+    // Ilman blob-kahvaa jokainen osittainen kysely lataisi koko sisällön,
+    // joten sisältö haetaan kerran muistiin kuten ennenkin
+    QSqlQuery kysely(tietokanta);
+    kysely.prepare(QString("SELECT data FROM %1 WHERE rowid=?").arg(taulu));
+    kysely.addBindValue(rivi);
+    if( !kysely.exec() || !kysely.next() || kysely.value(0).isNull()) {
+        setErrorString(tr("Liitettä ei löydy"));
+        return;
+    }
+    sisalto_ = kysely.value(0).toByteArray();
+    koko_ = sisalto_.size();
+    QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+LiiteLukija::~LiiteLukija()
+{
+    close();
+}
+
+void LiiteLukija::close()
+{
+#ifdef KITSAS_SYSTEM_SQLITE
+    if( blob_ ) {
+        sqlite3_blob_close(blob_);
+        blob_ = nullptr;
+    }
+#endif
+    sisalto_.clear();
+    QIODevice::close();
+}
+
+qint64 LiiteLukija::readData(char *data, qint64 maxSize)
+{
+    if( !isOpen() )
+        return -1;
+
+    const qint64 alku = pos();
+    const qint64 maara = qMin(maxSize, koko_ - alku);
+    if( maara <= 0)
+        return 0;
+
+    if( !blob_ ) {
+        memcpy(data, sisalto_.constData() + alku, static_cast<size_t>(maara));
+        return maara;
+    }
+
+#ifdef KITSAS_SYSTEM_SQLITE
+    int tulos = sqlite3_blob_read(blob_, data, static_cast<int>(maara), static_cast<int>(alku));
+    if( tulos == SQLITE_ABORT ) {
+        // Saman rivin muiden sarakkeiden päivittäminen (esim. viittausten
+        // laskuri) vanhentaa kahvan, vaikka sisältö on ennallaan
+        if( sqlite3_blob_reopen(blob_, rivi_) == SQLITE_OK && sqlite3_blob_bytes(blob_) == koko_)
+            tulos = sqlite3_blob_read(blob_, data, static_cast<int>(maara), static_cast<int>(alku));
+    }
+    if( tulos != SQLITE_OK) {
+        // Rivi on poistettu lukemisen aikana
+        setErrorString(tr("Liitteen lukeminen epäonnistui"));
+        return -1;
+    }
+#endif
+    return maara;
+}
+
+qint64 LiiteLukija::writeData(const char * /* data */, qint64 /* maxSize */)
+{
+    return -1;
+}
@@ -0,0 +1,71 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LIITELUKIJA_H
+#define LIITELUKIJA_H
+
+#include <QIODevice>
+#include <QSqlDatabase>
+
+struct sqlite3_blob;
+
+/**
+ * @brief Liitteen sisällön lukeminen suoraan tietokannasta
+ *
+ * Käyttää SQLiten inkrementaalista blob-lukua, joten liitettä
+ * ei tarvitse ladata kerralla muistiin vaan sitä voi lukea
+ * paloina ja siirtyä sen sisällä vapaasti. Jos yhteyden SQLite-kahvaa
+ * ei voi käyttää (ks. sqliteKahva), sisältö haetaan avattaessa
+ * yhdellä kyselyllä muistiin.
+ *
+ * Lukija pitää tietokannassa lukutapahtumaa auki, joten se
+ * pitää sulkea ennen tietokannan sulkemista. Lukijaa saa käyttää
+ * vain tietokantayhteyden säikeessä.
+ */
+class LiiteLukija : public QIODevice
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Avaa lukijan
+     * @param tietokanta Tietokantayhteys
+     * @param taulu Taulu, jonka data-sarakkeesta luetaan (Liite tai LiiteData)
+     * @param rivi Rivin rowid
+     */
+    LiiteLukija(QSqlDatabase tietokanta, const QString& taulu, qint64 rivi, QObject* parent = nullptr);
+    ~LiiteLukija() override;
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return koko_; }
+    void close() override;
+
+    static const qint64 PALAKOKO = 256 * 1024;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    QSqlDatabase tietokanta_;
+    QString taulu_;
+    qint64 rivi_;
+
+    sqlite3_blob* blob_ = nullptr;
+    qint64 koko_ = 0;
+    QByteArray sisalto_;
+};
+
+#endif // LIITELUKIJA_H
@@ -30,6 +30,16 @@ CREATE TABLE Tilikausi
 	json text
 );
 
+CREATE TABLE Tilikausikooste
+(
+	alkaa date PRIMARY KEY NOT NULL,
+	tasemuutos BIGINT NOT NULL DEFAULT(0),
+	tulos BIGINT NOT NULL DEFAULT(0),
+	liikevaihto BIGINT NOT NULL DEFAULT(0),
+	viimeinen date,
+	paivitetty timestamp
+);
+
 CREATE TABLE Kohdennus
 (
 	id INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
@@ -107,7 +117,7 @@ CREATE TABLE Tosite
 
 CREATE INDEX tosite_pvm ON Tosite (pvm);
 CREATE INDEX tosite_tyyppi ON Tosite (tyyppi);
-CREATE INDEX tosite_tila ON Tosite (tila);
+CREATE INDEX tosite_tila_pvm ON Tosite (tila, pvm);
 
 CREATE TABLE Tositeloki
 (
@@ -151,11 +161,26 @@ CREATE TABLE Merkkaus
 	PRIMARY KEY (vienti, kohdennus)
 );
 
+CREATE INDEX merkkaus_kohdennus ON Merkkaus (kohdennus);
+
 CREATE INDEX vienti_tosite ON Vienti (tosite);
 CREATE INDEX vienti_pvm ON Vienti (pvm);
-CREATE INDEX vienti_tili ON Vienti (tili);
+CREATE INDEX vienti_tili_pvm ON Vienti (tili, pvm, tosite, debetsnt, kreditsnt);
+CREATE INDEX vienti_era_pvm ON Vienti (eraid, pvm, tosite, debetsnt, kreditsnt);
 CREATE INDEX vienti_kohdennus ON Vienti (kohdennus);
 
+CREATE TABLE Saldo
+(
+	tili INTEGER NOT NULL,
+	kohdennus INTEGER NOT NULL DEFAULT(0),
+	kuukausi DATE NOT NULL,
+	debetsnt BIGINT DEFAULT(0),
+	kreditsnt BIGINT DEFAULT(0),
+	PRIMARY KEY (tili, kohdennus, kuukausi)
+);
+
+CREATE INDEX saldo_kuukausi ON Saldo (kuukausi);
+
 CREATE TABLE Liite
 (
 	id INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
@@ -171,6 +196,14 @@ CREATE TABLE Liite
 );
 
 CREATE INDEX liite_tosite ON Liite (tosite);
+CREATE INDEX liite_sha ON Liite (sha);
+
+CREATE TABLE LiiteData
+(
+	sha text PRIMARY KEY NOT NULL,
+	data bytea,
+	viittauksia integer NOT NULL DEFAULT(0)
+);
 
 CREATE TABLE Tuote
 (
@@ -28,6 +28,12 @@ EraRoute::EraRoute(SQLiteModel *model) :
 
 }
 
+bool EraRoute::rinnakkainen(const QString &polku) const
+{
+    // Tase-erittely käyttää tilikartan tietoja
+    return polku != "erittely";
+}
+
 QVariant EraRoute::get(const QString &polku, const QUrlQuery &urlquery)
 {
     if(polku == "erittely")
@@ -36,8 +42,8 @@ QVariant EraRoute::get(const QString &polku, const QUrlQuery &urlquery)
 
 
 
-    QSqlQuery kysely( db() );
     QVariantList lista;
+    QVariantList arvot;
 
     QString kysymys("select vienti.eraid as eraid, sum(vienti.debetsnt) as sd, sum(vienti.kreditsnt) as sk, a.selite as selite, tosite.pvm as pvm, a.tili as tili, "
                     "tosite.tunniste as tunniste, tosite.sarja as sarja, tosite.tyyppi as tositetyyppi, "
@@ -48,29 +54,33 @@ QVariant EraRoute::get(const QString &polku, const QUrlQuery &urlquery)
                     "WHERE Tosite.tila >= 100 AND t.tila >= 100 ");
 
     if( urlquery.hasQueryItem("tili"))
-        kysymys.append(QString("AND a.tili=%1 ").arg(urlquery.queryItemValue("tili")));
+    {
+        kysymys.append("AND a.tili=? ");
+        arvot << urlquery.queryItemValue("tili").toInt();
+    }
     if( urlquery.hasQueryItem("asiakas"))
-        kysymys.append(QString("AND a.kumppani=%1 ").arg(urlquery.queryItemValue("asiakas")));
+    {
+        kysymys.append("AND a.kumppani=? ");
+        arvot << urlquery.queryItemValue("asiakas").toInt();
+    }
 
     kysymys.append("GROUP BY vienti.eraid ");
     if( !urlquery.hasQueryItem("kaikki") )
                    kysymys.append("HAVING sum(vienti.debetsnt) <> sum(vienti.kreditsnt) OR sum(vienti.debetsnt) IS NULL OR sum(vienti.kreditsnt) IS NULL");
 
-    qDebug() << kysymys;
-
-    kysely.exec(kysymys);
+    QSqlQuery kysely = suorita(kysymys, arvot);
     while( kysely.next()) {
         QString tili = kysely.value("tili").toString();
-        double debet = kysely.value(1).toLongLong() / 100.0;
-        double kredit = kysely.value(2).toLongLong() / 100.0;
-        double avoin = tili.startsWith('1') ?
+        const qlonglong debet = kysely.value(1).toLongLong();
+        const qlonglong kredit = kysely.value(2).toLongLong();
+        const Euro avoin( tili.startsWith('1') ?
                     debet - kredit :
-                    kredit - debet;
+                    kredit - debet );
 
         QVariantMap map;
         map.insert("id", kysely.value(0).toInt());
         map.insert("tili", tili);
-        map.insert("avoin", avoin);
+        map.insert("avoin", avoin.toTypedVariant());
         map.insert("selite", kysely.value("selite"));
         map.insert("pvm", kysely.value("pvm").toDate());
         map.insert("tunniste", kysely.value("tunniste"));
@@ -93,11 +103,9 @@ QVariant EraRoute::erittely(const QDate &mista, const QDate &pvm)
     QMap<QString,Euro> loppusaldot;
 
     // Haetaan loppusaldot
-    QSqlQuery kysely( db() );
-    kysely.exec( QString("SELECT tili, SUM(debetsnt), SUM(kreditsnt) FROM vienti "
-                              "JOIN Tosite ON Vienti.tosite=Tosite.id WHERE "
-                              "Vienti.pvm <= '%1' AND Tosite.tila >= 100 "
-                              "AND CAST (tili AS text) < 3 GROUP BY tili").arg(pvm.toString(Qt::ISODate)) );
+    QVariantList arvot;
+    QSqlQuery kysely = suorita( QString("SELECT tili, SUM(debetsnt), SUM(kreditsnt) FROM (%1) GROUP BY tili")
+                 .arg(saldoKysely(QDate(), pvm, arvot, "CAST(tili AS text) < ?", {"3"})), arvot );
     while( kysely.next()) {
         QString tilinro = kysely.value(0).toString();
         Tili* tili = kp()->tilit()->tili( tilinro.toInt() );
@@ -111,16 +119,15 @@ QVariant EraRoute::erittely(const QDate &mista, const QDate &pvm)
     }
 
     // Haetaan alkusaldot
-    kysely.exec( QString("SELECT tili, SUM(debetsnt), SUM(kreditsnt) FROM vienti "
-                              "JOIN Tosite ON Vienti.tosite=Tosite.id WHERE "
-                              "Vienti.pvm < '%1' AND Tosite.tila >= 100 "
-                              "AND CAST (tili AS text) < 3 GROUP BY tili").arg(mista.toString(Qt::ISODate)) );
-    while( kysely.next()) {
-        QString tilinro = kysely.value(0).toString();
+    arvot.clear();
+    QSqlQuery alkukysely = suorita( QString("SELECT tili, SUM(debetsnt), SUM(kreditsnt) FROM (%1) GROUP BY tili")
+                 .arg(saldoKysely(QDate(), mista.addDays(-1), arvot, "CAST(tili AS text) < ?", {"3"})), arvot );
+    while( alkukysely.next()) {
+        QString tilinro = alkukysely.value(0).toString();
         Tili* tili = kp()->tilit()->tili( tilinro.toInt() );
         if( !tili) continue;
-        Euro debet = Euro( kysely.value(1).toLongLong() );
-        Euro kredit = Euro( kysely.value(2).toLongLong());
+        Euro debet = Euro( alkukysely.value(1).toLongLong() );
+        Euro kredit = Euro( alkukysely.value(2).toLongLong());
         if( tilinro.startsWith('1'))
             alkusaldot.insert(tilinro, debet - kredit);
         else
@@ -145,7 +152,7 @@ QVariant EraRoute::erittely(const QDate &mista, const QDate &pvm)
         } else if( tili->taseErittelyTapa() == Tili::TASEERITTELY_MUUTOKSET) {
             ulos.insert( tiliStr + "M", muutosErittely(tili, mista, pvm, alkusaldo, loppusaldo));
         } else {
-            ulos.insert(tiliStr + "S", loppusaldo.toString());  // Pelkkä tilin loppusaldo
+            ulos.insert(tiliStr + "S", loppusaldo.toTypedVariant());  // Pelkkä tilin loppusaldo
         }
 
     }
@@ -153,25 +160,26 @@ QVariant EraRoute::erittely(const QDate &mista, const QDate &pvm)
     // Tulokset
     int betili = kp()->tilit()->tiliTyypilla(TiliLaji::EDELLISTENTULOS).numero();
     qlonglong edelliset = 0;
-    kysely.exec(QString("SELECT SUM(kreditsnt), SUM(debetsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                "WHERE vienti.pvm<'%1' AND CAST (tili AS text) >= '3' AND Tosite.tila >= 100").arg(mista.toString(Qt::ISODate)));
-    if(kysely.next())
-        edelliset = kysely.value(0).toLongLong() - kysely.value(1).toLongLong();
+    arvot.clear();
+    QSqlQuery edellisetKysely = suorita(QString("SELECT SUM(kreditsnt), SUM(debetsnt) FROM (%1)")
+                .arg(saldoKysely(QDate(), mista.addDays(-1), arvot, "CAST(tili AS text) >= ?", {"3"})), arvot);
+    if(edellisetKysely.next())
+        edelliset = edellisetKysely.value(0).toLongLong() - edellisetKysely.value(1).toLongLong();
 
-    kysely.exec(QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                "WHERE Vienti.pvm<='%1' AND Vienti.tili=%2 AND Tosite.tila>=100")
-                .arg(pvm.toString(Qt::ISODate))
-                .arg(betili));
-    if( kysely.next() )
-        edelliset += kysely.value(1).toLongLong() - kysely.value(0).toLongLong();
+    arvot.clear();
+    QSqlQuery betiliKysely = suorita(QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM (%1)")
+                .arg(saldoKysely(QDate(), pvm, arvot, "tili = ?", { betili })), arvot);
+    if( betiliKysely.next() )
+        edelliset += betiliKysely.value(1).toLongLong() - betiliKysely.value(0).toLongLong();
 
-    ulos.insert(QString("%1S").arg(betili), edelliset / 100.0 );
+    ulos.insert(QString("%1S").arg(betili), Euro(edelliset).toTypedVariant() );
 
     int ttili = kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).numero();
-    kysely.exec(QString("SELECT SUM(kreditsnt), SUM(debetsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                "WHERE vienti.pvm BETWEEN '%1' AND '%2' AND CAST (tili AS text) >= '3' AND Tosite.tila >= 100").arg(mista.toString(Qt::ISODate)).arg(pvm.toString(Qt::ISODate)));
-    if(kysely.next())
-        ulos.insert(QString("%1S").arg(ttili), (kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0 );
+    arvot.clear();
+    QSqlQuery tulosKysely = suorita(QString("SELECT SUM(kreditsnt), SUM(debetsnt) FROM (%1)")
+                .arg(saldoKysely(mista, pvm, arvot, "CAST(tili AS text) >= ?", {"3"})), arvot);
+    if(tulosKysely.next())
+        ulos.insert(QString("%1S").arg(ttili), Euro(tulosKysely.value(0).toLongLong() - tulosKysely.value(1).toLongLong()).toTypedVariant() );
 
 
     return ulos;
@@ -184,13 +192,12 @@ QVariant EraRoute::taysiErittely(Tili *tili, const QDate &mista, const QDate &mi
     Euro eritellytLopussa;
 
     // Tase-erät
-    QSqlQuery erakysely(db());
-    erakysely.exec(QString("select vienti.eraid, vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
+    QSqlQuery erakysely = suorita("select vienti.eraid, vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
                            "Tosite.tunniste, tosite.id, Vienti.pvm as vientipvm, Kumppani.nimi AS kumppaninimi "
                            "FROM Vienti JOIN Tosite ON Vienti.tosite = Tosite.id LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
-                           "WHERE Vienti.tili=%1 AND Vienti.id=Vienti.eraid "
-                           "AND Vienti.pvm <= '%2' AND Tosite.tila >= 100 ORDER BY Vienti.pvm")
-                   .arg( tili->numero() ).arg(mihin.toString(Qt::ISODate)));
+                           "WHERE Vienti.tili=? AND Vienti.id=Vienti.eraid "
+                           "AND Vienti.pvm <= ? AND Tosite.tila >= 100 ORDER BY Vienti.pvm",
+                           { tili->numero(), mihin });
 
     while( erakysely.next()) {
         // Tässä haetaan erän aloittavat
@@ -199,24 +206,23 @@ QVariant EraRoute::taysiErittely(Tili *tili, const QDate &mista, const QDate &mi
                     erakysely.value(1).toLongLong() - erakysely.value(2).toLongLong() :
                     erakysely.value(2).toLongLong() - erakysely.value(1).toLongLong() );
 
-        QSqlQuery apukysely( db() );
         Euro eranAloitus;
 
-        apukysely.exec(QString("SELECT sum(debetsnt), sum(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=%1 AND Vienti.pvm<'%2' AND Tosite.tila >= 100 ")
-                       .arg(eraid).arg(mista.toString(Qt::ISODate)));
-        if( apukysely.next()) {
+        QSqlQuery aloituskysely = suorita("SELECT sum(debetsnt), sum(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=? AND Vienti.pvm<? AND Tosite.tila >= 100 ",
+                                           { eraid, mista });
+        if( aloituskysely.next()) {
            eranAloitus = Euro(tili->onko(TiliLaji::VASTAAVAA) ?
-                        apukysely.value(0).toLongLong() - apukysely.value(1).toLongLong() :
-                        apukysely.value(1).toLongLong() - apukysely.value(0).toLongLong() );
+                        aloituskysely.value(0).toLongLong() - aloituskysely.value(1).toLongLong() :
+                        aloituskysely.value(1).toLongLong() - aloituskysely.value(0).toLongLong() );
         }
 
-        apukysely.exec(QString("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
+        QSqlQuery apukysely = suorita("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
                                "Tosite.tunniste, tosite.id, Vienti.pvm as vientipvm, Kumppani.nimi AS kumppaninimi "
                                "FROM Vienti  JOIN Tosite ON Vienti.tosite = Tosite.id  "
                                "LEFT OUTER JOIN Kumppani ON Vienti.kumppani = Kumppani.id "
-                               "WHERE Vienti.eraid=%1 AND Vienti.id<>Vienti.eraid "
-                               "AND Vienti.pvm BETWEEN '%2' AND '%3' AND Tosite.tila >= 100 ORDER BY Vienti.pvm")
-                       .arg(QString::number(eraid), mista.toString(Qt::ISODate), mihin.toString(Qt::ISODate)));
+                               "WHERE Vienti.eraid=? AND Vienti.id<>Vienti.eraid "
+                               "AND Vienti.pvm BETWEEN ? AND ? AND Tosite.tila >= 100 ORDER BY Vienti.pvm",
+                               { eraid, mista, mihin });
         QVariantList muutokset;
 
         // Jos erä alkaa tältä tilikaudelta, on erän aloitus osa muutosta
@@ -236,7 +242,7 @@ QVariant EraRoute::taysiErittely(Tili *tili, const QDate &mista, const QDate &mi
             map.insert("id", apukysely.value(6).toInt());
             map.insert("vientipvm", apukysely.value(7).toDate());
             map.insert("selite", apukysely.value(2).toString());
-            map.insert("eur", summa.toString());
+            map.insert("eur", summa.toTypedVariant());
             map.insert("kumppani", apukysely.value("kumppani"));
             eranMuutos += summa;
             muutokset.append(map);
@@ -251,13 +257,13 @@ QVariant EraRoute::taysiErittely(Tili *tili, const QDate &mista, const QDate &mi
         era.insert("tunniste", erakysely.value(6));
         era.insert("selite", erakysely.value("selite"));
         era.insert("kumppani", erakysely.value("kumppaninimi"));
-        era.insert("eur", eranAloitus);
+        era.insert("eur", eranAloitus.toTypedVariant());
 
         QVariantMap emap;
         emap.insert("era", era);
-        emap.insert("ennen", eraAlussa);
-        emap.insert("kausi", eranMuutos);
-        emap.insert("saldo",  eraAlussa + eranMuutos);
+        emap.insert("ennen", eraAlussa.toTypedVariant());
+        emap.insert("kausi", eranMuutos.toTypedVariant());
+        emap.insert("saldo", (eraAlussa + eranMuutos).toTypedVariant());
         erat.append(emap);
 
         erittellytAlussa += eraAlussa;
@@ -268,37 +274,35 @@ QVariant EraRoute::taysiErittely(Tili *tili, const QDate &mista, const QDate &mi
     Euro erittelematonLopussa = loppusaldo - eritellytLopussa;
     Euro erittelematonKausiSumma;
 
-    erakysely.exec(QString("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
+    QSqlQuery erittelematonKysely = suorita("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
                            "Tosite.tunniste, tosite.id, Vienti.pvm as vientipvm, Kumppani.nimi AS kumppani "
                            "FROM Vienti  JOIN Tosite ON Vienti.tosite = Tosite.id  "
                            "LEFT OUTER JOIN Kumppani ON Vienti.kumppani = Kumppani.id "
-                           "WHERE Vienti.tili=%1 AND Vienti.eraid IS NULL "
-                           "AND Vienti.pvm BETWEEN '%2' AND '%3' AND Tosite.tila >= 100 ORDER BY Vienti.pvm")
-                   .arg( tili->numero())
-                   .arg(mista.toString(Qt::ISODate))
-                   .arg(mihin.toString(Qt::ISODate)));
+                           "WHERE Vienti.tili=? AND Vienti.eraid IS NULL "
+                           "AND Vienti.pvm BETWEEN ? AND ? AND Tosite.tila >= 100 ORDER BY Vienti.pvm",
+                           { tili->numero(), mista, mihin });
 
-    while(erakysely.next()) {
+    while(erittelematonKysely.next()) {
         QVariantMap map;
         Euro summa = (tili->onko(TiliLaji::VASTAAVAA) ?
-                    erakysely.value(0).toLongLong() - erakysely.value(1).toLongLong() :
-                    erakysely.value(1).toLongLong() - erakysely.value(0).toLongLong()) ;
-        map.insert("pvm", erakysely.value(3).toDate());
-        map.insert("sarja", erakysely.value(4));
-        map.insert("tunniste", erakysely.value(5));
-        map.insert("id", erakysely.value(6).toInt());
-        map.insert("vientipvm", erakysely.value(7).toDate());
-        map.insert("selite", erakysely.value(2).toString());
-        map.insert("eur", summa);
-        map.insert("kumppani", erakysely.value("kumppani"));
+                    erittelematonKysely.value(0).toLongLong() - erittelematonKysely.value(1).toLongLong() :
+                    erittelematonKysely.value(1).toLongLong() - erittelematonKysely.value(0).toLongLong()) ;
+        map.insert("pvm", erittelematonKysely.value(3).toDate());
+        map.insert("sarja", erittelematonKysely.value(4));
+        map.insert("tunniste", erittelematonKysely.value(5));
+        map.insert("id", erittelematonKysely.value(6).toInt());
+        map.insert("vientipvm", erittelematonKysely.value(7).toDate());
+        map.insert("selite", erittelematonKysely.value(2).toString());
+        map.insert("eur", summa.toTypedVariant());
+        map.insert("kumppani", erittelematonKysely.value("kumppani"));
         erittelematonKausiSumma += summa;
     }
 
     if( erittelematonAlussa || erittelematonLopussa || erittelematonKausiSumma) {
         QVariantMap emap;
-        emap.insert("ennen", erittelematonAlussa);
-        emap.insert("kausi", erittelematonLopussa - erittelematonLopussa);
-        emap.insert("saldo", erittelematonLopussa);
+        emap.insert("ennen", erittelematonAlussa.toTypedVariant());
+        emap.insert("kausi", (erittelematonLopussa - erittelematonLopussa).toTypedVariant());
+        emap.insert("saldo", erittelematonLopussa.toTypedVariant());
         erat.append(emap);
     }
     return erat;
@@ -306,19 +310,18 @@ QVariant EraRoute::taysiErittely(Tili *tili, const QDate &mista, const QDate &mi
 
 QVariant EraRoute::listaErittely(Tili *tili, const QDate & /* mista */, const QDate &mihin, const Euro & /* alkusaldo */, const Euro &loppusaldo)
 {
-    QSqlQuery apukysely( db() );
     QVariantList erat;
     Euro erittelematta = loppusaldo;
 
-    apukysely.exec(QString("select vienti.eraid, sum(vienti.debetsnt) as sd, sum(vienti.kreditsnt) as sk, a.selite, tosite.pvm, "
+    QSqlQuery apukysely = suorita("select vienti.eraid, sum(vienti.debetsnt) as sd, sum(vienti.kreditsnt) as sk, a.selite, tosite.pvm, "
                            "tosite.sarja, tosite.tunniste, Vienti.pvm, Kumppani.nimi AS Kumppani "
                            "FROM Vienti "
                            "join Vienti as a on vienti.eraid = a.id "
                            "join Tosite on vienti.tosite=tosite.id "
                            "LEFT OUTER JOIN Kumppani ON a.kumppani=Kumppani.id "
-                           "WHERE vienti.tili=%1 AND vienti.pvm <= '%2'  AND Tosite.tila >= 100 GROUP BY vienti.eraid, a.selite, a.pvm, a.tili "
-                           "HAVING sum(vienti.debetsnt) <> sum(vienti.kreditsnt) OR sum(vienti.debetsnt) IS NULL OR sum(vienti.kreditsnt) IS NULL;"
-                           ).arg(tili->numero()).arg(mihin.toString(Qt::ISODate)));
+                           "WHERE vienti.tili=? AND vienti.pvm <= ?  AND Tosite.tila >= 100 GROUP BY vienti.eraid, a.selite, a.pvm, a.tili "
+                           "HAVING sum(vienti.debetsnt) <> sum(vienti.kreditsnt) OR sum(vienti.debetsnt) IS NULL OR sum(vienti.kreditsnt) IS NULL",
+                           { tili->numero(), mihin });
 
     while( apukysely.next()) {
         QVariantMap era;
@@ -332,7 +335,7 @@ QVariant EraRoute::listaErittely(Tili *tili, const QDate & /* mista */, const QD
         Euro summa = Euro(tili->onko(TiliLaji::VASTAAVAA) ?
                     apukysely.value(1).toLongLong() - apukysely.value(2).toLongLong() :
                     apukysely.value(2).toLongLong() - apukysely.value(1).toLongLong() );
-        era.insert("eur", summa);
+        era.insert("eur", summa.toTypedVariant());
         erat.append(era);
         erittelematta -= summa;
     }
@@ -340,7 +343,7 @@ QVariant EraRoute::listaErittely(Tili *tili, const QDate & /* mista */, const QD
     // Erittelemättömät loppuun
     if( erittelematta ) {
         QVariantMap erittelematon;
-        erittelematon.insert("eur", erittelematta);
+        erittelematon.insert("eur", erittelematta.toTypedVariant());
         erat.append(erittelematon);
     }
     return erat;
@@ -348,16 +351,13 @@ QVariant EraRoute::listaErittely(Tili *tili, const QDate & /* mista */, const QD
 
 QVariant EraRoute::muutosErittely(Tili *tili, const QDate &mista, const QDate &mihin, const Euro &alkusaldo, const Euro &loppusaldo)
 {
-    QSqlQuery apukysely( db());
-    apukysely.exec(QString("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm, Tosite.sarja, "
+    QSqlQuery apukysely = suorita("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm, Tosite.sarja, "
                            "Tosite.tunniste, Vienti.pvm, Kumppani.nimi AS Kumppani "
                            "FROM Vienti JOIN Tosite ON Vienti.tosite = Tosite.id  "
                            "LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
-                           "WHERE Vienti.tili=%1 "
-                           "AND Vienti.pvm BETWEEN '%2' AND '%3' AND Tosite.tila >= 100 ORDER BY vienti.pvm")
-                   .arg(tili->numero())
-                   .arg(mista.toString(Qt::ISODate))
-                   .arg(mihin.toString(Qt::ISODate)));
+                           "WHERE Vienti.tili=? "
+                           "AND Vienti.pvm BETWEEN ? AND ? AND Tosite.tila >= 100 ORDER BY vienti.pvm",
+                           { tili->numero(), mista, mihin });
 
     QVariantList muutokset;
     while( apukysely.next() )
@@ -373,12 +373,12 @@ QVariant EraRoute::muutosErittely(Tili *tili, const QDate &mista, const QDate &m
         map.insert("vientipvm", apukysely.value(6).toDate());
         map.insert("selite", apukysely.value(2).toString());
         map.insert("kumppani", apukysely.value("kumppani"));
-        map.insert("eur", summa);
+        map.insert("eur", summa.toTypedVariant());
         muutokset.append(map);
     }
     QVariantMap map;
-    map.insert("saldo", loppusaldo);
+    map.insert("saldo", loppusaldo.toTypedVariant());
     map.insert("kausi", muutokset);
-    map.insert("ennen", alkusaldo);
+    map.insert("ennen", alkusaldo.toTypedVariant());
     return map;
 }
@@ -26,6 +26,7 @@ class EraRoute : public SQLiteRoute
 {
 public:
     EraRoute(SQLiteModel *model);
+    bool rinnakkainen(const QString &polku) const override;
     QVariant get(const QString &polku, const QUrlQuery &urlquery = QUrlQuery()) override;
 
 protected:
@@ -0,0 +1,80 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "hakuroute.h"
+
+#include "model/tosite.h"
+
+#include <QRegularExpression>
+
+HakuRoute::HakuRoute(SQLiteModel *model) :
+    SQLiteRoute(model, "/haku")
+{
+
+}
+
+QVariant HakuRoute::get(const QString &/*polku*/, const QUrlQuery &urlquery)
+{
+    const QString teksti = urlquery.queryItemValue("teksti");
+    const QString lauseke = hakulauseke(teksti);
+    if( lauseke.isEmpty())
+        return QVariantList();
+
+    const int alkaen = urlquery.queryItemValue("alkaen").toInt();
+    const int raja = urlquery.hasQueryItem("raja") ? urlquery.queryItemValue("raja").toInt() : RAJA;
+
+    const QString kentat = "SELECT Tosite.id AS id, Tosite.pvm AS pvm, Tosite.tyyppi AS tyyppi, Tosite.tila AS tila, "
+                           "Tosite.tunniste AS tunniste, Tosite.otsikko AS otsikko, Kumppani.nimi AS kumppani, Tosite.sarja AS sarja, "
+                           "(SELECT COUNT(id) FROM Liite WHERE Liite.tosite=Tosite.id) AS liitteita, "
+                           "(SELECT SUM(debetsnt) FROM Vienti WHERE Vienti.tosite=Tosite.id) AS summasnt ";
+
+    // Otsikon ja kumppanin osumat painavat enemmän kuin selitteiden
+    QSqlQuery kysely(db());
+    if( model_->hakuindeksi() && kysely.prepare(kentat + QString(", snippet(Haku, -1, '', '', '…', 8) AS osuma "
+                       "FROM Haku JOIN Tosite ON Haku.rowid=Tosite.id "
+                       "LEFT OUTER JOIN Kumppani ON Tosite.kumppani=Kumppani.id "
+                       "WHERE Haku MATCH ? AND Tosite.tila >= %1 "
+                       "ORDER BY bm25(Haku, 2.0, 4.0, 1.0, 4.0) LIMIT ? OFFSET ?").arg(Tosite::KIRJANPIDOSSA))) {
+        kysely.addBindValue(lauseke);
+    } else {
+        // Ilman FTS5-tukea haetaan hitaammin ja järjestetään päivämäärän mukaan
+        const QString ehto = "%" + teksti + "%";
+        kysely.prepare(kentat + QString("FROM Tosite LEFT OUTER JOIN Kumppani ON Tosite.kumppani=Kumppani.id "
+                       "WHERE Tosite.tila >= %1 AND (Tosite.otsikko LIKE ? OR Kumppani.nimi LIKE ? "
+                       "OR EXISTS (SELECT id FROM Vienti WHERE Vienti.tosite=Tosite.id AND Vienti.selite LIKE ?)) "
+                       "ORDER BY Tosite.pvm DESC LIMIT ? OFFSET ?").arg(Tosite::KIRJANPIDOSSA));
+        kysely.addBindValue(ehto);
+        kysely.addBindValue(ehto);
+        kysely.addBindValue(ehto);
+    }
+    kysely.addBindValue(raja);
+    kysely.addBindValue(alkaen);
+
+    if( !kysely.exec())
+        throw SQLiteVirhe(kysely);
+
+    return resultList(kysely);
+}
+
+QString HakuRoute::hakulauseke(const QString &teksti)
+{
+    // Ilman Unicode-ominaisuuksia \W katkaisisi sanat ääkkösten kohdalta
+    static const QRegularExpression erotin("\\W+", QRegularExpression::UseUnicodePropertiesOption);
+    QStringList sanat;
+    for(const QString& sana : teksti.split(erotin, QString::SkipEmptyParts))
+        sanat.append( QString("\"%1\"*").arg(sana) );
+    return sanat.join(" ");
+}
@@ -0,0 +1,47 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HAKUROUTE_H
+#define HAKUROUTE_H
+
+#include "../sqliteroute.h"
+
+/**
+ * @brief Tositteiden vapaatekstihaku
+ *
+ * Hakee kirjanpidossa olevia tositteita koko kirjanpidosta otsikon,
+ * vientien selitteiden, kumppanien nimien ja tositetunnisteen perusteella.
+ * Tulokset järjestetään osuvuuden mukaan ja ne voi hakea sivuittain
+ * parametreilla alkaen ja raja.
+ */
+class HakuRoute : public SQLiteRoute
+{
+public:
+    HakuRoute(SQLiteModel *model);
+
+    QVariant get(const QString &polku, const QUrlQuery &urlquery = QUrlQuery()) override;
+
+    /**
+     * @brief Muodostaa hakutekstistä FTS5-hakulausekkeen
+     *
+     * Jokainen sana haetaan sanan alkuna, ja kaikkien sanojen on löydyttävä.
+     */
+    static QString hakulauseke(const QString& teksti);
+
+    static const int RAJA = 100;
+};
+
+#endif // HAKUROUTE_H
@@ -25,8 +25,19 @@ InfoRoute::InfoRoute(SQLiteModel *model) :
 
 }
 
-QVariant InfoRoute::get(const QString &/*polku*/, const QUrlQuery &/*urlquery*/)
+QVariant InfoRoute::get(const QString &polku, const QUrlQuery &/*urlquery*/)
 {
+    if( polku == "lauseet")
+        return kp()->sqlite()->lauseTilasto();
+    if( polku == "kyselyt") {
+        QVariantMap mittaukset;
+        mittaukset.insert("reitit", kp()->sqlite()->mittari()->reitit());
+        mittaukset.insert("kyselyt", kp()->sqlite()->mittari()->kyselyt());
+        return mittaukset;
+    }
+    if( polku == "valimuisti")
+        return model_->valimuisti()->tilasto();
+
     QVariantMap map;
     QFileInfo info( kp()->sqlite()->tiedostopolku() );
     map.insert("koko", info.size());
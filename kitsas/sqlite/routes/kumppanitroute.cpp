@@ -164,6 +164,9 @@ QVariant KumppanitRoute::put(const QString &polku, const QVariant &data)
         }
     }
 
+    // Nimi voi olla muuttunut
+    model_->paivitaHakuindeksi(QString("Tosite.kumppani=%1 OR Tosite.id IN (SELECT tosite FROM Vienti WHERE kumppani=%1)").arg(id));
+
     db().commit();
 
     return kopio;
@@ -227,6 +230,7 @@ QVariant KumppanitRoute::yhdista(const QVariantMap& data)
     kysely.exec(QString("UPDATE Tosite SET kumppani=%1 WHERE kumppani=%3").arg(uusi).arg(vanha));
     kysely.exec(QString("DELETE FROM KumppaniIban WHERE kumppani=%1").arg(vanha));
     kysely.exec(QString("DELETE FROM Kumppani WHERE id=%1").arg(vanha));
+    model_->paivitaHakuindeksi(QString("Tosite.kumppani=%1 OR Tosite.id IN (SELECT tosite FROM Vienti WHERE kumppani=%1)").arg(uusi));
 
     db().commit();
     return QVariant();
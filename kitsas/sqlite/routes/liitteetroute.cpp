@@ -42,14 +42,17 @@ QVariant LiitteetRoute::get(const QString &polku, const QUrlQuery &urlquery)
 
     }
     if( polku.toInt()) {
-        if(!kysely.exec(QString("SELECT data FROM Liite WHERE id=%1").arg(polku.toInt()) ) )
+        if(!kysely.exec(QString("SELECT COALESCE(LiiteData.data, Liite.data) FROM Liite "
+                                "LEFT OUTER JOIN LiiteData ON Liite.sha=LiiteData.sha WHERE Liite.id=%1").arg(polku.toInt()) ) )
             throw SQLiteVirhe(kysely);
     } else {
         QRegularExpression re(R"((\d+)\/(\S+))");
         QRegularExpressionMatch match = re.match(polku);
-        kysely.exec(QString("SELECT data FROM Liite WHERE tosite=%1 AND roolinimi='%2'")
-                    .arg(match.captured(1).toInt())
-                    .arg(match.captured(2)) );
+        kysely.prepare("SELECT COALESCE(LiiteData.data, Liite.data) FROM Liite "
+                       "LEFT OUTER JOIN LiiteData ON Liite.sha=LiiteData.sha WHERE Liite.tosite=? AND Liite.roolinimi=?");
+        kysely.addBindValue( match.captured(1).toInt() );
+        kysely.addBindValue( match.captured(2) );
+        kysely.exec();
     }
     if( kysely.next())
         return kysely.value(0).toByteArray();
@@ -57,6 +60,14 @@ QVariant LiitteetRoute::get(const QString &polku, const QUrlQuery &urlquery)
     throw SQLiteVirhe("Liitettä ei löydy",QNetworkReply::ContentNotFoundError);
 }
 
+QVariant LiitteetRoute::post(const QString &polku, const QVariant & /* data */)
+{
+    if( polku == "tiivista")
+        return model_->tiivistaLiitteet();
+
+    throw SQLiteVirhe("Tuntematon toiminto", QNetworkReply::ContentNotFoundError);
+}
+
 QPair<const QVariant, int> LiitteetRoute::byteArray(SQLiteKysely *kysely, const QByteArray &ba, const QMap<QString, QString> &meta)
 {
     QString loppu = kysely->polku().mid( polku().length()+1 );
@@ -65,12 +76,17 @@ QPair<const QVariant, int> LiitteetRoute::byteArray(SQLiteKysely *kysely, const
     QSqlQuery query(db());
     QVariantMap palautus;
 
+    const QByteArray sha = hash(ba);
+    QVariant vanhaSha;
+
+    db().transaction();
+
     if( kysely->metodi() == KpKysely::POST) {
-        query.prepare("INSERT INTO Liite(nimi,data,tyyppi,sha,tosite) VALUES (?,?,?,?,?)");
+        lisaaViittaus(sha, ba);
+        query.prepare("INSERT INTO Liite(nimi,tyyppi,sha,tosite) VALUES (?,?,?,?)");
         query.addBindValue( meta.value("Filename", QString()) );
-        query.addBindValue( ba );
         query.addBindValue( meta.value("Content-type", QString()));
-        query.addBindValue( hash( ba) );
+        query.addBindValue( sha );
         if( loppu.toInt()) {
             query.addBindValue( loppu.toInt() );
         } else {
@@ -79,20 +95,33 @@ QPair<const QVariant, int> LiitteetRoute::byteArray(SQLiteKysely *kysely, const
         }
     } else if( kysely->metodi() == KpKysely::PUT)
     {
-        query.prepare("INSERT INTO Liite (tosite,nimi,data,tyyppi,sha,roolinimi) VALUES (:tosite, :nimi, :data, :tyyppi, :sha, :roolinimi) "
-                      " ON CONFLICT (tosite,roolinimi) DO UPDATE SET nimi=EXCLUDED.nimi, data=EXCLUDED.data, tyyppi=EXCLUDED.tyyppi, sha=EXCLUDED.sha, "
+        // Korvattavan liitteen sisällöstä poistetaan viittaus vasta uuden lisäämisen jälkeen,
+        // jottei saman sisällön uudelleen tallentaminen hävitä sitä välillä
+        // Vanhojen tiedostojen liitteen sisältö voi olla Liite-taulussa,
+        // eikä sillä silloin ole viittausta LiiteData-tauluun
+        QSqlQuery vanha = suorita("SELECT sha FROM Liite WHERE tosite=? AND roolinimi=? AND data IS NULL",
+                                   { match.captured(1).toInt(), match.captured(2) });
+        if( vanha.next())
+            vanhaSha = vanha.value(0);
+
+        lisaaViittaus(sha, ba);
+        query.prepare("INSERT INTO Liite (tosite,nimi,data,tyyppi,sha,roolinimi) VALUES (:tosite, :nimi, NULL, :tyyppi, :sha, :roolinimi) "
+                      " ON CONFLICT (tosite,roolinimi) DO UPDATE SET nimi=EXCLUDED.nimi, data=NULL, tyyppi=EXCLUDED.tyyppi, sha=EXCLUDED.sha, "
                       " roolinimi=EXCLUDED.roolinimi, luotu=current_timestamp"  );
 
         query.bindValue(":tosite", match.captured(1).toInt());
         query.bindValue(":nimi", meta.value("Filename", QString()) );
-        query.bindValue(":data", ba);
         query.bindValue(":tyyppi", meta.value("Content-type", QString()) );
-        query.bindValue(":sha", hash(ba));
+        query.bindValue(":sha", sha);
         query.bindValue(":roolinimi", match.captured(2));
 
     }
-    if( !query.exec() )
+    if( !query.exec() ) {
+        db().rollback();
         throw SQLiteVirhe(query);
+    }
+    poistaViittaus(vanhaSha);
+    db().commit();
 
 
     palautus.insert("liite", query.lastInsertId());
@@ -107,12 +136,41 @@ QVariant LiitteetRoute::doDelete(const QString &polku)
 {
     int id = polku.toInt();
     if( id ) {
-        QSqlQuery kysely( db());
-        kysely.exec( QString("DELETE FROM Liite WHERE id=%1").arg(id));
+        db().transaction();
+        QSqlQuery kysely = suorita("SELECT sha FROM Liite WHERE id=? AND data IS NULL", { id });
+        const QVariant sha = kysely.next() ? kysely.value(0) : QVariant();
+        suorita("DELETE FROM Liite WHERE id=?", { id });
+        poistaViittaus(sha);
+        db().commit();
     }
     return QVariant();
 }
 
+void LiitteetRoute::lisaaViittaus(const QByteArray &sha, const QByteArray &data)
+{
+    QSqlQuery paivitys = suorita("UPDATE LiiteData SET viittauksia=viittauksia+1 WHERE sha=?", { sha });
+    if( paivitys.numRowsAffected() > 0)
+        return;
+
+    // Sisältöä ei sidota välimuistissa olevaan kyselyyn, ettei se jää muistiin
+    QSqlQuery lisays(db());
+    lisays.prepare("INSERT INTO LiiteData(sha, data, viittauksia) VALUES (?,?,1)");
+    lisays.addBindValue(sha);
+    lisays.addBindValue(data);
+    if( !lisays.exec()) {
+        db().rollback();
+        throw SQLiteVirhe(lisays);
+    }
+}
+
+void LiitteetRoute::poistaViittaus(const QVariant &sha)
+{
+    if( sha.isNull())
+        return;
+    suorita("UPDATE LiiteData SET viittauksia=viittauksia-1 WHERE sha=?", { sha });
+    suorita("DELETE FROM LiiteData WHERE sha=? AND viittauksia < 1", { sha });
+}
+
 QByteArray LiitteetRoute::hash(const QByteArray &ba)
 {
     QCryptographicHash laskin(QCryptographicHash::Sha256);
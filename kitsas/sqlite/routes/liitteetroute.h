@@ -26,12 +26,28 @@ public:
 
     QVariant get(const QString &polku, const QUrlQuery &urlquery = QUrlQuery()) override;
 
+    QVariant post(const QString &polku, const QVariant &data) override;
+
     QPair<const QVariant,int> byteArray(SQLiteKysely *kysely, const QByteArray &ba, const QMap<QString,QString> &meta) override;
 
     QVariant doDelete(const QString &polku) override;
 
     static QByteArray hash(const QByteArray& ba);
 
+protected:
+    /**
+     * @brief Lisää viittauksen liitteen sisältöön
+     *
+     * Jo tallennetulle sisällölle kasvatetaan vain viittausten määrää,
+     * muuten sisältö tallennetaan LiiteData-tauluun.
+     */
+    void lisaaViittaus(const QByteArray& sha, const QByteArray& data);
+
+    /**
+     * @brief Poistaa viittauksen ja viimeisen viittauksen poistuessa myös sisällön
+     */
+    void poistaViittaus(const QVariant& sha);
+
 };
 
 #endif // LIITTEETROUTE_H
@@ -17,8 +17,10 @@
 #include "saldotroute.h"
 
 #include "db/kirjanpito.h"
+#include "model/euro.h"
 
 #include <QDebug>
+#include <QSqlError>
 
 SaldotRoute::SaldotRoute(SQLiteModel* model) :
     SQLiteRoute(model, "/saldot")
@@ -26,8 +28,11 @@ SaldotRoute::SaldotRoute(SQLiteModel* model) :
 
 }
 
-QVariant SaldotRoute::get(const QString &/*polku*/, const QUrlQuery &urlquery)
+QVariant SaldotRoute::get(const QString &polku, const QUrlQuery &urlquery)
 {
+    if( polku == "tarkasta")
+        return model_->tarkastaSaldot();
+
     QDate pvm = QDate::fromString(urlquery.queryItemValue("pvm"),Qt::ISODate);
     Tilikausi kausi = kp()->tilikaudet()->tilikausiPaivalle(pvm);
     QDate kaudenalku = kausi.alkaa();
@@ -42,25 +47,25 @@ QVariant SaldotRoute::get(const QString &/*polku*/, const QUrlQuery &urlquery)
         return kustannuspaikat( kaudenalku, pvm, true, kuuluu );
     }
 
-    QSqlQuery kysely(db());
     QVariantMap saldot;
 
+    // Alkusaldoihin ei oteta mukaan päivän vientejä
+    const QDate saldopvm = urlquery.hasQueryItem("alkusaldot") ? pvm.addDays(-1) : pvm;
 
     if( urlquery.hasQueryItem("tili")) {
         Tili* tili = kp()->tilit()->tili(urlquery.queryItemValue("tili").toInt());
         if(tili) {
-            QString kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) "
-                                      "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                                      "WHERE Vienti.tili = %1 AND Tosite.tila >= 100 AND ").arg(tili->numero()) +
-                   ( tili->onko(TiliLaji::TULOS) ? QString("vienti.pvm BETWEEN '%1' AND '%2").arg(kaudenalku.toString(Qt::ISODate).arg(pvm.toString(Qt::ISODate)))
-                                                 : ( urlquery.hasQueryItem("alkusaldot")  ? QString("vienti.pvm < '%1'").arg(pvm.toString(Qt::ISODate))  :  QString("vienti.pvm <= '%1'").arg(pvm.toString(Qt::ISODate)) ));
-            qDebug() << kysymys;
-            kysely.exec(kysymys);
+            QVariantList arvot;
+            QString kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM (%1)")
+                    .arg( tili->onko(TiliLaji::TULOS)
+                          ? saldoKysely(kaudenalku, pvm, arvot, "tili = ?", { tili->numero() })
+                          : saldoKysely(QDate(), saldopvm, arvot, "tili = ?", { tili->numero() }));
+            QSqlQuery kysely = suorita(kysymys, arvot);
             if(kysely.next()) {
-                double saldo = tili->onko(TiliLaji::VASTAAVAA)
-                        ? (kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0
-                        : (kysely.value(1).toLongLong() - kysely.value(0).toLongLong()) / 100.0;
-                saldot.insert(urlquery.queryItemValue("tili"), saldo);
+                Euro saldo = tili->onko(TiliLaji::VASTAAVAA)
+                        ? Euro(kysely.value(0).toLongLong() - kysely.value(1).toLongLong())
+                        : Euro(kysely.value(1).toLongLong() - kysely.value(0).toLongLong());
+                saldot.insert(urlquery.queryItemValue("tili"), saldo.toTypedVariant());
             }
         }
         return saldot;
@@ -70,100 +75,106 @@ QVariant SaldotRoute::get(const QString &/*polku*/, const QUrlQuery &urlquery)
 
 
     if( !urlquery.hasQueryItem("tuloslaskelma")) {
-        QString kysymys = "SELECT tili, sum(debetsnt), sum(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE vienti.pvm ";
-        kysymys += urlquery.hasQueryItem("alkusaldot") ? "<" : "<=";
-        kysymys += QString("'%1' ").arg(pvm.toString(Qt::ISODate));
-        if( urlquery.hasQueryItem("tili"))
-            kysymys += QString(" AND tili=%1 ").arg(urlquery.queryItemValue("tili").toInt());
-        kysymys += " AND CAST(tili as text) < '3' AND Tosite.tila >= 100 GROUP BY tili ORDER BY tili ";
-
-        kysely.exec(kysymys);
+        QVariantList arvot;
+        QString kysymys = QString("SELECT tili, sum(debetsnt), sum(kreditsnt) FROM (%1) GROUP BY tili ORDER BY tili")
+                .arg( saldoKysely(QDate(), saldopvm, arvot, "CAST(tili AS text) < ?", {"3"}) );
+
+        QSqlQuery kysely = suorita(kysymys, arvot);
         while (kysely.next()) {
             QString tilistr = kysely.value(0).toString();
             if( tilistr.startsWith(QChar('1')))
-                saldot.insert( tilistr, (kysely.value(1).toLongLong() - kysely.value(2).toLongLong() ) / 100.0);
+                saldot.insert( tilistr, Euro(kysely.value(1).toLongLong() - kysely.value(2).toLongLong()).toTypedVariant());
             else
-                saldot.insert( tilistr, (kysely.value(2).toLongLong() - kysely.value(1).toLongLong() ) / 100.0 );
+                saldot.insert( tilistr, Euro(kysely.value(2).toLongLong() - kysely.value(1).toLongLong()).toTypedVariant());
         }
 
         // Edellisten tulos
-        kysely.exec(QString("SELECT sum(kreditsnt), sum(debetsnt) FROM Vienti Join Tosite ON Vienti.tosite=Tosite.id WHERE CAST(tili as text) >= '3' "
-                            "AND vienti.pvm<'%1' AND Tosite.tila >= 100").arg(kausi.alkaa().toString(Qt::ISODate)));
-        if( kysely.next()) {
+        arvot.clear();
+        QSqlQuery edellisetKysely = suorita(QString("SELECT sum(kreditsnt), sum(debetsnt) FROM (%1)")
+                    .arg( saldoKysely(QDate(), kausi.alkaa().addDays(-1), arvot, "CAST(tili AS text) >= ?", {"3"})), arvot);
+        if( edellisetKysely.next()) {
             QString edtili = QString::number( kp()->tilit()->tiliTyypilla(TiliLaji::EDELLISTENTULOS).numero() ) ;
-            double saldo = ( qRound64(saldot.value(edtili).toDouble()*100) + kysely.value(0).toLongLong() - kysely.value(1).toLongLong() ) / 100.0 ;
-            saldot[edtili] = saldo;
+            Euro saldo = Euro::fromVariant(saldot.value(edtili)) + Euro(edellisetKysely.value(0).toLongLong() - edellisetKysely.value(1).toLongLong());
+            saldot[edtili] = saldo.toTypedVariant();
         }
 
         if( !urlquery.hasQueryItem("alkusaldot")) {
             // Nykyisen tulos
-            kysely.exec(QString("SELECT sum(kreditsnt), sum(debetsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE CAST(tili as text) >= '3' "
-                                "AND vienti.pvm BETWEEN '%1' AND '%2' AND Tosite.tila >= 100")
-                        .arg(kausi.alkaa().toString(Qt::ISODate), pvm.toString(Qt::ISODate)));
-            if( kysely.next()) {
+            arvot.clear();
+            QSqlQuery tulosKysely = suorita(QString("SELECT sum(kreditsnt), sum(debetsnt) FROM (%1)")
+                        .arg( saldoKysely(kausi.alkaa(), pvm, arvot, "CAST(tili AS text) >= ?", {"3"})), arvot);
+            if( tulosKysely.next()) {
                 QString tulostili = QString::number( kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).numero() ) ;
-                saldot.insert(tulostili, (kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0 );
+                saldot.insert(tulostili, Euro(tulosKysely.value(0).toLongLong() - tulosKysely.value(1).toLongLong()).toTypedVariant());
             }
         }
     }
 
     if( !urlquery.hasQueryItem("tase")) {
 
-        QString kysymys("SELECT tili, SUM(kreditsnt), SUM(debetsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id ");
-        if(urlquery.hasQueryItem("kohdennus"))
-            kysymys.append("JOIN Kohdennus ON Vienti.kohdennus=Kohdennus.id LEFT OUTER JOIN Merkkaus ON Vienti.id=Merkkaus.vienti ");
-        kysymys.append(" WHERE vienti.pvm ");
-
-        if( urlquery.hasQueryItem("alkusaldot"))
-            kysymys += "<";
-        else
-            kysymys += "<=";
-        kysymys += QString(" '%1' ").arg(pvm.toString(Qt::ISODate));
-        if( urlquery.hasQueryItem("kohdennus"))
-            kysymys += QString(" AND (kohdennus.id=%1 OR kohdennus.kuuluu=%1 OR Merkkaus.kohdennus=%1) ").arg(urlquery.queryItemValue("kohdennus"));
-        kysymys += QString(" AND vienti.pvm >= '%1' AND CAST(tili as text) >= 3 AND Tosite.tila >= 100 GROUP BY tili ORDER BY tili")
-                .arg(kaudenalku.toString(Qt::ISODate));
-
-        qDebug() << kysymys;
+        QString kysymys;
+        QVariantList arvot;
+        if(urlquery.hasQueryItem("kohdennus")) {
+            // Merkkauksia ei ole eritelty saldotaulussa, joten ne lasketaan vienneistä
+            kysymys = "SELECT tili, SUM(kreditsnt), SUM(debetsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+                      "JOIN Kohdennus ON Vienti.kohdennus=Kohdennus.id LEFT OUTER JOIN Merkkaus ON Vienti.id=Merkkaus.vienti ";
+            kysymys += " WHERE vienti.pvm <= ? AND (kohdennus.id=? OR kohdennus.kuuluu=? OR Merkkaus.kohdennus=?) "
+                       " AND vienti.pvm >= ? AND CAST(tili as text) >= '3' AND Tosite.tila >= 100 GROUP BY tili ORDER BY tili";
+            const int kohdennus = urlquery.queryItemValue("kohdennus").toInt();
+            arvot << saldopvm << kohdennus << kohdennus << kohdennus << kaudenalku;
+        } else {
+            kysymys = QString("SELECT tili, SUM(kreditsnt), SUM(debetsnt) FROM (%1) GROUP BY tili ORDER BY tili")
+                    .arg( saldoKysely(kaudenalku, saldopvm, arvot, "CAST(tili AS text) >= ?", {"3"}));
+        }
 
-        if( !kysely.exec(kysymys) )
+        QSqlQuery kysely = suorita(kysymys, arvot);
+        if( kysely.lastError().isValid() )
             throw SQLiteVirhe(kysely);
 
 
         while( kysely.next()) {
-            saldot.insert( kysely.value(0).toString(), (kysely.value(1).toLongLong() - kysely.value(2).toLongLong() ) / 100.0 );
+            saldot.insert( kysely.value(0).toString(), Euro(kysely.value(1).toLongLong() - kysely.value(2).toLongLong()).toTypedVariant());
         }
     }
     return saldot;
 }
 
+QVariant SaldotRoute::post(const QString &polku, const QVariant &/*data*/)
+{
+    if( polku == "rakenna") {
+        model_->rakennaSaldot();
+        return model_->tarkastaSaldot();
+    }
+    throw SQLiteVirhe("Tuntematon komento", 404);
+}
+
 QVariant SaldotRoute::kustannuspaikat(const QDate &mista, const QDate &mihin, bool projektit, int kuuluu)
 {
     QVariantMap kohdennukset;
 
-    QSqlQuery kysely(db());
     QString kysymys;
+    QVariantList arvot;
 
     if( projektit) {
         kysymys = QString("SELECT kohdennus, tili, SUM(kreditsnt) as ks, SUM(debetsnt) as ds "
-                          "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                          "JOIN Kohdennus ON Vienti.kohdennus=Kohdennus.id "
-                          "WHERE Tosite.tila >= 100 AND Kohdennus.tyyppi=2 AND CAST(tili as text) >= '3' "
-                          "AND Vienti.pvm BETWEEN '%1' AND '%2' %3"
+                          "FROM (%1) AS s "
+                          "JOIN Kohdennus ON s.kohdennus=Kohdennus.id "
+                          "WHERE Kohdennus.tyyppi=2 %2"
                           "GROUP BY kohdennus,tili ")
-                .arg(mista.toString(Qt::ISODate), mihin.toString(Qt::ISODate),
-                     kuuluu > -1 ? QString("AND kuuluu=%1 ").arg(kuuluu) : "" );
+                .arg(saldoKysely(mista, mihin, arvot, "CAST(tili AS text) >= ?", {"3"}),
+                     kuuluu > -1 ? "AND kuuluu=? " : "" );
+        if( kuuluu > -1)
+            arvot << kuuluu;
     }
     else
         kysymys = QString("SELECT kohdennus, kuuluu, tili, SUM(kreditsnt) as ks, SUM(debetsnt) as ds "
-                          "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                          "JOIN Kohdennus ON Vienti.kohdennus=Kohdennus.id "
-                          "WHERE Tosite.tila >= 100 AND CAST(tili as text) >= '3' "
-                          "AND Vienti.pvm BETWEEN '%1' AND '%2' "
+                          "FROM (%1) AS s "
+                          "JOIN Kohdennus ON s.kohdennus=Kohdennus.id "
                           "GROUP BY kohdennus,tili ")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate));
+                .arg(saldoKysely(mista, mihin, arvot, "CAST(tili AS text) >= ?", {"3"}));
 
-    if( !kysely.exec(kysymys) )
+    QSqlQuery kysely = suorita(kysymys, arvot);
+    if( kysely.lastError().isValid() )
         throw SQLiteVirhe(kysely);
 
     while( kysely.next()) {
@@ -174,9 +185,9 @@ QVariant SaldotRoute::kustannuspaikat(const QDate &mista, const QDate &mihin, bo
         QString tilistr = kysely.value("tili").toString();
 
         QVariantMap kmap = kohdennukset.value(kohdennus).toMap();
-        kmap.insert(tilistr, (  qRound64(kmap.value(tilistr).toDouble() * 100.0 ) +
-                                qRound64(kysely.value("ks").toDouble() ) -
-                                qRound64(kysely.value("ds").toDouble() )) / 100.0 );
+        const Euro saldo = Euro::fromVariant(kmap.value(tilistr)) +
+                           Euro(kysely.value("ks").toLongLong() - kysely.value("ds").toLongLong());
+        kmap.insert(tilistr, saldo.toTypedVariant());
 
         kohdennukset.insert( kohdennus, kmap);
     }
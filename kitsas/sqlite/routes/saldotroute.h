@@ -24,6 +24,7 @@ class SaldotRoute : public SQLiteRoute
 public:
     SaldotRoute(SQLiteModel* model);
     QVariant get(const QString &polku, const QUrlQuery &urlquery = QUrlQuery()) override;
+    QVariant post(const QString &polku, const QVariant &data) override;
 
 protected:
     QVariant kustannuspaikat(const QDate& mista, const QDate& mihin, bool projektit = false, int kuuluu = -1);
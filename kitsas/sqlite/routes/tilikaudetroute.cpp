@@ -17,6 +17,7 @@
 #include "tilikaudetroute.h"
 #include "db/kirjanpito.h"
 #include "db/tositetyyppimodel.h"
+#include "model/euro.h"
 #include <QDate>
 #include <QJsonDocument>
 #include <QVariant>
@@ -35,52 +36,38 @@ QVariant TilikaudetRoute::get(const QString &polku, const QUrlQuery &/*urlquery*
     if( QDate::fromString(polku, Qt::ISODate).isValid() )
         return laskelma( kp()->tilikaudet()->tilikausiPaivalle( QDate::fromString(polku, Qt::ISODate) ) );
 
-    QSqlQuery kysely(db());
-    kysely.exec("SELECT alkaa,loppuu,json FROM Tilikausi ORDER BY alkaa");
-
-    QVariantList list = resultList(kysely);
-    for(int i=0; i < list.count(); i++){
-        QVariantMap map = list.at(i).toMap();
-
-        // Tase
-        kysely.exec( QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE vienti.pvm <= '%1' AND CAST(tili as text) < '2' AND Tosite.tila >= 100 ")
-                     .arg(map.value("loppuu").toString()) );
-        if( kysely.next())
-            map.insert("tase", QString::number( qAbs(kysely.value(1).toLongLong() - kysely.value(0).toLongLong()) / 100.0,'f',2));
-        // Tulos
-        kysely.exec( QString("SELECT sum(kreditsnt), sum(debetsnt) FROM vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE vienti.pvm BETWEEN '%1' AND '%2' AND Tosite.tila >= 100 AND CAST(tili as text) >= '3' ")
-                     .arg(map.value("alkaa").toString())
-                     .arg(map.value("loppuu").toString()) );
-        if( kysely.next())
-            map.insert("tulos", QString::number((kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0, 'f', 2));
-
-        // Liikevaihto
-        kysely.exec( QString("SELECT sum(kreditsnt), sum(debetsnt) FROM vienti "
-                             "JOIN Tili ON Vienti.tili=Tili.numero JOIN Tosite ON vienti.tosite=tosite.id "
-                             "WHERE vienti.pvm BETWEEN '%1' AND '%2' AND CAST(tili as text) >= '3' AND Tosite.tila >= 100 "
-                             "AND (tili.tyyppi='CL' OR tili.tyyppi='CLZ')")
-                     .arg(map.value("alkaa").toString())
-                     .arg(map.value("loppuu").toString()) );
-        if( kysely.next())
-            map.insert("liikevaihto", QString::number((kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0, 'f', 2));
-
-        // Kauden viimeinen tosite
-        kysely.exec(QString("SELECT MAX(pvm) FROM Tosite WHERE pvm BETWEEN '%1' AND '%2' AND Tosite.tila >= 100")
-                    .arg(map.value("alkaa").toString()).arg(map.value("loppuu").toString()) );
-        qDebug() << kysely.lastQuery();
-        if( kysely.next())
-            map.insert("viimeinen", kysely.value(0));
-
-        // Tilikauden päivitys
-        kysely.exec(QString("SELECT MAX(aika) FROM Tositeloki JOIN Tosite ON Tositeloki.tosite=Tosite.id "
-                            "WHERE Tosite.pvm BETWEEN '%1' AND '%2' ").arg(map.value("alkaa").toString()).arg(map.value("loppuu").toString()) );
-        if( kysely.next()) {
-            QDateTime paivitetty = kysely.value(0).toDateTime();
+    if( polku == "tarkasta")
+        return model_->tarkastaKausikooste();
+
+    // Yhteenvedot ylläpidetään tositteita tallennettaessa (kirjaaKoosteeseen)
+    QSqlQuery kysely = suorita("SELECT Tilikausi.alkaa, Tilikausi.loppuu, Tilikausi.json, "
+                                "Tilikausikooste.tasemuutos, Tilikausikooste.tulos, Tilikausikooste.liikevaihto, "
+                                "Tilikausikooste.viimeinen, Tilikausikooste.paivitetty, "
+                                "(SELECT tasemuutos FROM Tilikausikooste AS Ennen WHERE Ennen.alkaa='<' || Tilikausi.alkaa) "
+                                "FROM Tilikausi LEFT OUTER JOIN Tilikausikooste ON Tilikausi.alkaa=Tilikausikooste.alkaa "
+                                "ORDER BY Tilikausi.alkaa");
+
+    QVariantList list;
+    qlonglong tase = 0;
+    while( kysely.next()) {
+        QVariantMap map = QJsonDocument::fromJson( kysely.value(2).toByteArray() ).toVariant().toMap();
+        map.insert("alkaa", kysely.value(0));
+        map.insert("loppuu", kysely.value(1));
+
+        // Tase on vastaavaa-tilien saldo kauden lopussa. Siihen lisätään
+        // myös kautta edeltävät, minkään tilikauden ulkopuoliset viennit.
+        tase += kysely.value(8).toLongLong() + kysely.value(3).toLongLong();
+        map.insert("tase", Euro( qAbs(tase) ).toTypedVariant());
+        map.insert("tulos", Euro( kysely.value(4).toLongLong() ).toTypedVariant());
+        map.insert("liikevaihto", Euro( kysely.value(5).toLongLong() ).toTypedVariant());
+        map.insert("viimeinen", kysely.value(6));
+
+        if( !kysely.value(7).isNull()) {
+            QDateTime paivitetty = kysely.value(7).toDateTime();
             paivitetty.setTimeSpec(Qt::UTC);
             map.insert("paivitetty", paivitetty.toLocalTime());
         }
-
-        list[i] = map;
+        list.append(map);
     }
 
     return list;
@@ -117,6 +104,9 @@ QVariant TilikaudetRoute::put(const QString &polku, const QVariant &data)
         }
     }
 
+    // Kausien rajat muuttuivat, joten yhteenvedot lasketaan uudelleen
+    model_->rakennaKausikooste();
+
     return QVariant();
 }
 
@@ -124,11 +114,16 @@ QVariant TilikaudetRoute::doDelete(const QString &polku)
 {
     QDate alkaa = QDate::fromString(polku, Qt::ISODate);
     db().exec(QString("DELETE FROM Tilikausi WHERE alkaa='%1'").arg(alkaa.toString(Qt::ISODate)));
+    model_->rakennaKausikooste();
     return QVariant();
 }
 
 QVariant TilikaudetRoute::post(const QString &polku, const QVariant &data)
 {
+    if( polku == "rakenna") {
+        model_->rakennaKausikooste();
+        return model_->tarkastaKausikooste();
+    }
     if( polku !="numerointi")
         return QVariant();
 
@@ -172,6 +167,7 @@ QVariant TilikaudetRoute::post(const QString &polku, const QVariant &data)
         update.exec(QString("UPDATE Tosite SET tunniste=%1 WHERE id=%2")
                 .arg(tunniste).arg(id));
     }
+    model_->paivitaHakuindeksi(QString("Tosite.pvm BETWEEN '%1' AND '%2'").arg(alkaa).arg(loppuu));
     db().commit();
     return QVariant();
 }
@@ -29,6 +29,7 @@ QVariant TilitRoute::put(const QString &osoite, const QVariant &data)
     QVariantMap map = data.toMap();
     QSqlQuery query( db());
     QString tyyppi = map.take("tyyppi").toString();
+    bool rakennaKooste = false;
 
     if( osoite.contains('/')) {
         int kautta = osoite.indexOf('/');
@@ -47,6 +48,13 @@ QVariant TilitRoute::put(const QString &osoite, const QVariant &data)
         query.addBindValue( mapToJson(map) );
     } else {
         int numero = map.take("numero").toInt();
+
+        // Liikevaihtotilien muuttuessa tilikausien yhteenvedot lasketaan uudelleen
+        query.exec(QString("SELECT tyyppi FROM Tili WHERE numero=%1").arg(numero));
+        const QString vanhatyyppi = query.next() ? query.value(0).toString() : QString();
+        if( vanhatyyppi != tyyppi && ( vanhatyyppi.startsWith("CL") || tyyppi.startsWith("CL") ))
+            rakennaKooste = true;
+
         query.prepare("INSERT INTO Tili (numero, tyyppi, iban, json, muokattu) VALUES "
                       "(?,?,?,?,CURRENT_TIMESTAMP) "
                       "ON CONFLICT(numero) DO UPDATE SET "
@@ -58,6 +66,9 @@ QVariant TilitRoute::put(const QString &osoite, const QVariant &data)
     }
     query.exec();
 
+    if( rakennaKooste )
+        model_->rakennaKausikooste();
+
     return QVariant();
 }
 
@@ -37,7 +37,7 @@ TositeRoute::TositeRoute(SQLiteModel *model) :
 
 }
 
-QString TositeRoute::kysymys(const QUrlQuery &urlquery)
+QString TositeRoute::kysymys(const QUrlQuery &urlquery, QVariantList &arvot)
 {
     QStringList ehdot;
     if( urlquery.hasQueryItem("luonnos") )
@@ -51,21 +51,35 @@ QString TositeRoute::kysymys(const QUrlQuery &urlquery)
     else
         ehdot.append( QString("tosite.tila >= %1").arg(Tosite::KIRJANPIDOSSA));
 
-    if( urlquery.hasQueryItem("alkupvm"))
-        ehdot.append( QString("tosite.pvm >= '%1'").arg( urlquery.queryItemValue("alkupvm") ));
-    if( urlquery.hasQueryItem("loppupvm"))
-        ehdot.append( QString("tosite.pvm <= '%1'").arg( urlquery.queryItemValue("loppupvm")));
+    if( urlquery.hasQueryItem("alkupvm")) {
+        ehdot.append("tosite.pvm >= ?");
+        arvot << urlquery.queryItemValue("alkupvm");
+    }
+    if( urlquery.hasQueryItem("loppupvm")) {
+        ehdot.append("tosite.pvm <= ?");
+        arvot << urlquery.queryItemValue("loppupvm");
+    }
 
-    if( urlquery.hasQueryItem("pvm"))
-        ehdot.append( QString("tosite.pvm = '%1'").arg(urlquery.queryItemValue("pvm")));
-    if( urlquery.hasQueryItem("kumppani"))
-        ehdot.append( QString("kumppani = %1").arg(urlquery.queryItemValue("kumppani")));
-    if( urlquery.hasQueryItem("tyyppi"))
-        ehdot.append( QString("tosite.tyyppi = %1").arg(urlquery.queryItemValue("tyyppi")));
-    if( urlquery.hasQueryItem("laskupvm"))
-        ehdot.append( QString("tosite.laskupvm = '%1'").arg(urlquery.queryItemValue("laskupvm")));
-    if( urlquery.hasQueryItem("viite"))
-        ehdot.append( QString("tosite.viite = '%1'").arg(urlquery.queryItemValue("viite").remove(QRegularExpression("\\W")).remove("^0+")));
+    if( urlquery.hasQueryItem("pvm")) {
+        ehdot.append("tosite.pvm = ?");
+        arvot << urlquery.queryItemValue("pvm");
+    }
+    if( urlquery.hasQueryItem("kumppani")) {
+        ehdot.append("kumppani = ?");
+        arvot << urlquery.queryItemValue("kumppani").toInt();
+    }
+    if( urlquery.hasQueryItem("tyyppi")) {
+        ehdot.append("tosite.tyyppi = ?");
+        arvot << urlquery.queryItemValue("tyyppi").toInt();
+    }
+    if( urlquery.hasQueryItem("laskupvm")) {
+        ehdot.append("tosite.laskupvm = ?");
+        arvot << urlquery.queryItemValue("laskupvm");
+    }
+    if( urlquery.hasQueryItem("viite")) {
+        ehdot.append("tosite.viite = ?");
+        arvot << urlquery.queryItemValue("viite").remove(QRegularExpression("\\W")).remove("^0+");
+    }
 
 
 
@@ -99,16 +113,16 @@ QVariant TositeRoute::get(const QString &polku, const QUrlQuery &urlquery)
 
     // Muuten tositteiden lista
 
-    QSqlQuery kysely( db());
-    kysely.exec(kysymys(urlquery));
-
-    QVariantList tositteet = resultList(kysely);
-
-    return tositteet;
+    QVariantList arvot;
+    const QString kysymysPohja = kysymys(urlquery, arvot);
+    QSqlQuery kysely = suorita(kysymysPohja, arvot);
+    return resultVastaus( kysely );
 }
 
-QVariant TositeRoute::post(const QString & /*polku*/, const QVariant &data)
+QVariant TositeRoute::post(const QString & polku, const QVariant &data)
 {
+    if( polku == "bulk")
+        return lisaaJoukko( data.toList() );
     return hae( lisaaTaiPaivita(data) );
 }
 
@@ -124,7 +138,7 @@ QVariant TositeRoute::patch(const QString &polku, const QVariant &data)
     int tila = map.value("tila").toInt();
 
     // Haetaan tunniste
-    db().transaction();
+    Transaktio transaktio(db());
     QSqlQuery kysely(db());
     int tunniste = 0;
 
@@ -150,9 +164,12 @@ QVariant TositeRoute::patch(const QString &polku, const QVariant &data)
     }
 
     // Päivitetään
+    kirjaaSaldoihin(tositeid, -1);
     if(!kysely.exec(QString("UPDATE Tosite SET tila=%1, tunniste=%2 WHERE id=%3")
                 .arg(tila).arg(tunniste).arg(tositeid)))
         throw SQLiteVirhe(kysely);
+    kirjaaSaldoihin(tositeid, 1);
+    model_->paivitaHakuindeksi(QString("Tosite.id=%1").arg(tositeid));
 
     // Lisätään tositelokiin
     kysely.prepare("INSERT INTO Tositeloki (tosite, tila, data) VALUES (?,?,?) ");
@@ -161,7 +178,7 @@ QVariant TositeRoute::patch(const QString &polku, const QVariant &data)
     kysely.addBindValue(mapToJson(map));
     kysely.exec();
 
-    db().commit();
+    transaktio.vahvista();
     return QVariant();
 
 }
@@ -171,7 +188,9 @@ QVariant TositeRoute::doDelete(const QString &polku)
     int tositeid = polku.toInt();
 
     QSqlQuery kysely(db());
+    Transaktio transaktio(db());
 
+    kirjaaSaldoihin(tositeid, -1);
     if(!kysely.exec(QString("UPDATE Tosite SET tila=0 WHERE id=%1")
                 .arg(tositeid)))
         throw SQLiteVirhe(kysely);
@@ -181,6 +200,8 @@ QVariant TositeRoute::doDelete(const QString &polku)
     kysely.addBindValue(tositeid);
     kysely.exec();
 
+    transaktio.vahvista();
+
     return QVariant();
 }
 
@@ -192,7 +213,15 @@ int TositeRoute::lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanT
     QByteArray lokiin = QJsonDocument::fromVariant(pyynto).toJson(QJsonDocument::Compact);
 
     QSqlQuery kysely(db());
-    db().transaction();
+    // Epäonnistunut kirjoitus keskeyttää tallennuksen, jotta joukosta
+    // perutaan vain tämä tosite ja virhe välittyy kutsujalle
+    auto kirjoita = [this] (const QString& pohja, const QVariantList& arvot) {
+        QSqlQuery tulos = suorita(pohja, arvot);
+        if( tulos.lastError().isValid())
+            throw SQLiteVirhe(tulos);
+    };
+    // Joukkoa lisättäessä tosite perutaan lisaaJoukko-metodin tallennuspisteeseen
+    Transaktio transaktio(db(), !joukko_);
 
     QDate pvm = map.take("pvm").toDate();
     int tyyppi = map.take("tyyppi").toInt();
@@ -222,38 +251,16 @@ int TositeRoute::lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanT
         tunniste = 0;
 
     // Tunnisteen hakeminen
-    if( !tunniste && tila >= Tosite::KIRJANPIDOSSA) {
-        if( sarja.isNull() )
-            kysely.exec( QString("SELECT MAX(tunniste) as tunniste FROM Tosite WHERE pvm BETWEEN '%1' AND '%2' AND sarja IS NULL AND tila >= 100")
-                         .arg(kausi.alkaa().toString(Qt::ISODate)).arg(kausi.paattyy().toString(Qt::ISODate)));
-        else
-            kysely.exec( QString("SELECT MAX(tunniste) as tunniste FROM Tosite WHERE pvm BETWEEN '%1' AND '%2' AND sarja='%3' AND tila >= 100")
-                         .arg(kausi.alkaa().toString(Qt::ISODate)).arg(kausi.paattyy().toString(Qt::ISODate)).arg(sarja));
-        if( kysely.next())
-            tunniste = kysely.value("tunniste").toInt() + 1;
-    }
+    if( !tunniste && tila >= Tosite::KIRJANPIDOSSA)
+        tunniste = seuraavaTunniste(kausi, sarja);
+    else if( tunniste && joukko_)
+        kirjaaTunniste(kausi, sarja, tunniste);
     // Laskun numero ja viite
     if( map.contains("lasku") && !map.value("lasku").toMap().contains("numero") && tila >= Tosite::KIRJANPIDOSSA &&
             tyyppi >= TositeTyyppi::MYYNTILASKU && tyyppi <= TositeTyyppi::MAKSUMUISTUTUS) {
-        // LaskuSeuraavaId käsitellään käsin, jotta ei tule päällekkäisiä numeroita
-        // vaikka olisi monta instanssia.
-        qulonglong laskunumero = kp()->asetukset()->isoluku("LaskuSeuraavaId", 1);
-
-        QSqlQuery laskunumerokysely( db());
-        laskunumerokysely.exec("SELECT arvo FROM Asetus WHERE avain='LaskuSeuraavaId'");
-
-        if( laskunumerokysely.next()) {
-            qulonglong haettu = laskunumerokysely.value(0).toULongLong();
-            if( haettu > laskunumero)
-                laskunumero = haettu;
-        }
-        qulonglong numerointialkaa = kp()->asetukset()->asetus("LaskuNumerointialkaa").toULongLong();
-        if( numerointialkaa > laskunumero)
-            laskunumero = numerointialkaa;
+        const qulonglong laskunumero = seuraavaLaskunumero();
 
         QVariantMap laskumap = map.value("lasku").toMap();
-        kp()->asetukset()->aseta("LaskuSeuraavaId", laskunumero + 1);
-
         laskumap.insert("numero", laskunumero);
 
         if( viitenro.isEmpty()) {
@@ -264,24 +271,25 @@ int TositeRoute::lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanT
         map.insert("lasku", laskumap);
     }
 
-    // Lisätään itse tosite
-    QSqlQuery tositelisays(db());
+    // Vanhat viennit pois saldoista, tallennetut lisätään lopuksi
+    if( paivitettavanTositeId )
+        kirjaaSaldoihin(paivitettavanTositeId, -1);
 
+    // Lisätään itse tosite
     if( !laskupvm.isValid())
         laskupvm = pvm;
 
-    if( paivitettavanTositeId ) {
-        tositelisays.prepare("INSERT INTO Tosite (id, pvm, tyyppi, tila, tunniste, otsikko, kumppani, sarja, laskupvm, erapvm, viite, json) "
-                             "VALUES (?,?,?,?,?,?,?,?,?,?,?,?) "
-                             "ON CONFLICT(id) DO UPDATE "
-                             "SET pvm=EXCLUDED.pvm, tyyppi=EXCLUDED.tyyppi, tila=EXCLUDED.tila, tunniste=EXCLUDED.tunniste, otsikko=EXCLUDED.otsikko, "
-                             "kumppani=EXCLUDED.kumppani, sarja=EXCLUDED.sarja, laskupvm=EXCLUDED.laskupvm, erapvm=EXCLUDED.erapvm, viite=EXCLUDED.viite, json=EXCLUDED.json");
+    QSqlQuery tositelisays = paivitettavanTositeId ?
+                lause("INSERT INTO Tosite (id, pvm, tyyppi, tila, tunniste, otsikko, kumppani, sarja, laskupvm, erapvm, viite, json) "
+                      "VALUES (?,?,?,?,?,?,?,?,?,?,?,?) "
+                      "ON CONFLICT(id) DO UPDATE "
+                      "SET pvm=EXCLUDED.pvm, tyyppi=EXCLUDED.tyyppi, tila=EXCLUDED.tila, tunniste=EXCLUDED.tunniste, otsikko=EXCLUDED.otsikko, "
+                      "kumppani=EXCLUDED.kumppani, sarja=EXCLUDED.sarja, laskupvm=EXCLUDED.laskupvm, erapvm=EXCLUDED.erapvm, viite=EXCLUDED.viite, json=EXCLUDED.json") :
+                lause("INSERT INTO Tosite (pvm, tyyppi, tila, tunniste, otsikko, kumppani, sarja, laskupvm, erapvm, viite, json) "
+                      "VALUES (?,?,?,?,?,?,?,?,?,?,?)");
 
+    if( paivitettavanTositeId )
         tositelisays.addBindValue(paivitettavanTositeId);
-    } else {
-        tositelisays.prepare("INSERT INTO Tosite (pvm, tyyppi, tila, tunniste, otsikko, kumppani, sarja, laskupvm, erapvm, viite, json) "
-                             "VALUES (?,?,?,?,?,?,?,?,?,?,?)");
-    }
     tositelisays.addBindValue(pvm);
     tositelisays.addBindValue(tyyppi);
     tositelisays.addBindValue(tila);
@@ -293,7 +301,8 @@ int TositeRoute::lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanT
     tositelisays.addBindValue(erapvm);
     tositelisays.addBindValue(viitenro);
     tositelisays.addBindValue( mapToJson(map) );
-    tositelisays.exec();
+    if( !tositelisays.exec())
+        throw SQLiteVirhe(tositelisays);
 
 
     int tositeId = paivitettavanTositeId ? paivitettavanTositeId : tositelisays.lastInsertId().toInt();
@@ -335,90 +344,89 @@ int TositeRoute::lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanT
 
         if( vientiid ) {
             if( !vanhatviennit.contains(vientiid)) {
-                db().rollback();
                 throw SQLiteVirhe("Virheellinen viennin id", 206);
             }
             vanhatviennit.remove(vientiid);
-            kysely.prepare("INSERT INTO Vienti (id, tosite, pvm, tili, kohdennus, selite, debetsnt, kreditsnt, eraid, json, alvkoodi, alvprosentti, rivi, kumppani, jaksoalkaa, jaksoloppuu, tyyppi, arkistotunnus) "
+        }
+
+        QSqlQuery vientilisays = vientiid ?
+                    lause("INSERT INTO Vienti (id, tosite, pvm, tili, kohdennus, selite, debetsnt, kreditsnt, eraid, json, alvkoodi, alvprosentti, rivi, kumppani, jaksoalkaa, jaksoloppuu, tyyppi, arkistotunnus) "
                            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
                            "ON CONFLICT (id) DO UPDATE SET tosite=EXCLUDED.tosite, pvm=EXCLUDED.pvm, tili=EXCLUDED.tili, kohdennus=EXCLUDED.kohdennus,"
                            "selite=EXCLUDED.selite, debetsnt=EXCLUDED.debetsnt, kreditsnt=EXCLUDED.kreditsnt, eraid=EXCLUDED.eraid,"
                            "json=EXCLUDED.json, alvkoodi=EXCLUDED.alvkoodi, alvprosentti=EXCLUDED.alvprosentti, rivi=EXCLUDED.rivi,"
                            "kumppani=EXCLUDED.kumppani, jaksoalkaa=EXCLUDED.jaksoalkaa, jaksoloppuu=EXCLUDED.jaksoloppuu,"
-                           "tyyppi=EXCLUDED.tyyppi, arkistotunnus=EXCLUDED.arkistotunnus");
-            kysely.addBindValue( vientiid );
-        } else {
-            kysely.prepare("INSERT INTO Vienti (tosite, pvm, tili, kohdennus, selite, debetsnt, kreditsnt, eraid, json, alvkoodi, alvprosentti, rivi, kumppani, jaksoalkaa, jaksoloppuu, tyyppi, arkistotunnus) "
+                           "tyyppi=EXCLUDED.tyyppi, arkistotunnus=EXCLUDED.arkistotunnus") :
+                    lause("INSERT INTO Vienti (tosite, pvm, tili, kohdennus, selite, debetsnt, kreditsnt, eraid, json, alvkoodi, alvprosentti, rivi, kumppani, jaksoalkaa, jaksoloppuu, tyyppi, arkistotunnus) "
                            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) ");
-        }
-        kysely.addBindValue(tositeId);
-        kysely.addBindValue(vientipvm);
-        kysely.addBindValue(tili);
-        kysely.addBindValue(kohdennus);
-        kysely.addBindValue(selite);
-
-        kysely.addBindValue( debet ? debet : QVariant());
-        kysely.addBindValue( kredit ? kredit : QVariant());
-
-        kysely.addBindValue( eraid > 0 ? eraid : QVariant());
-        kysely.addBindValue( mapToJson(vientimap) );
-        kysely.addBindValue( alvkoodi );
-        kysely.addBindValue( alvkoodi ? QString::number(alvprosentti,'f',2) : QVariant());
-        kysely.addBindValue( rivinumero );
-        kysely.addBindValue( kumppani ? kumppani : QVariant());
-        kysely.addBindValue( jaksoalkaa );
-        kysely.addBindValue( jaksoloppuu );
-        kysely.addBindValue( vientityyppi );
-        kysely.addBindValue( arkistotunnus );
-
-        kysely.exec();                
+        if( vientiid )
+            vientilisays.addBindValue( vientiid );
+        vientilisays.addBindValue(tositeId);
+        vientilisays.addBindValue(vientipvm);
+        vientilisays.addBindValue(tili);
+        vientilisays.addBindValue(kohdennus);
+        vientilisays.addBindValue(selite);
+
+        vientilisays.addBindValue( debet ? debet : QVariant());
+        vientilisays.addBindValue( kredit ? kredit : QVariant());
+
+        vientilisays.addBindValue( eraid > 0 ? eraid : QVariant());
+        vientilisays.addBindValue( mapToJson(vientimap) );
+        vientilisays.addBindValue( alvkoodi );
+        vientilisays.addBindValue( alvkoodi ? QString::number(alvprosentti,'f',2) : QVariant());
+        vientilisays.addBindValue( rivinumero );
+        vientilisays.addBindValue( kumppani ? kumppani : QVariant());
+        vientilisays.addBindValue( jaksoalkaa );
+        vientilisays.addBindValue( jaksoloppuu );
+        vientilisays.addBindValue( vientityyppi );
+        vientilisays.addBindValue( arkistotunnus );
+
+        if( !vientilisays.exec())
+            throw SQLiteVirhe(vientilisays);
 
 
         if( !vientiid)
-            vientiid = kysely.lastInsertId().toInt();
+            vientiid = vientilisays.lastInsertId().toInt();
 
         // Uusi erä käyttöön
         if( eraid == Kitsas::UUSI_ERA)
-            kysely.exec(QString("UPDATE Vienti SET eraid=%1 WHERE id=%1").arg(vientiid) );
+            kirjoita("UPDATE Vienti SET eraid=? WHERE id=?", { vientiid, vientiid });
 
         if( vientiid )
-            kysely.exec(QString("DELETE FROM Merkkaus WHERE vienti=%1").arg(vientiid));
+            kirjoita("DELETE FROM Merkkaus WHERE vienti=?", { vientiid });
 
         // Merkkaukset
         for(const auto& merkkaus : merkkaukset) {
-            kysely.exec(QString("INSERT INTO Merkkaus(vienti,kohdennus) VALUES (%1,%2)")
-                        .arg(vientiid)
-                        .arg(merkkaus.toInt()));
+            kirjoita("INSERT INTO Merkkaus(vienti,kohdennus) VALUES (?,?)", { vientiid, merkkaus.toInt() });
         }
 
     }
 
     // Kiinnitetään esilähetetyt liitteet
-    for(const auto& liite : liita)
-        kysely.exec(QString("UPDATE Liite SET tosite=%1 WHERE id=%2")
-                    .arg(tositeId).arg(liite.toInt()) );
+    for(const auto& liite : liita) {
+        if( !kysely.exec(QString("UPDATE Liite SET tosite=%1 WHERE id=%2")
+                    .arg(tositeId).arg(liite.toInt()) ))
+            throw SQLiteVirhe(kysely);
+    }
 
-    if( paivitettavanTositeId )
-        kysely.exec(QString("DELETE FROM Rivi WHERE tosite=%1").arg(paivitettavanTositeId));
+    if( paivitettavanTositeId && !kysely.exec(QString("DELETE FROM Rivi WHERE tosite=%1").arg(paivitettavanTositeId)))
+        throw SQLiteVirhe(kysely);
 
-    kysely.prepare("INSERT INTO Rivi(tosite,rivi,tuote,myyntikpl,ostokpl, ahinta, json) VALUES (?,?,?,?,?,?,?) ");
     for(int rivi=0; rivi < rivit.count(); rivi++)
     {
         QVariantMap rmap = rivit.at(rivi).toMap();
-        kysely.addBindValue(tositeId);
-        kysely.addBindValue(rivi + 1);
-        kysely.addBindValue(rmap.take("tuote").toString());
-        kysely.addBindValue(rmap.take("myyntikpl").toDouble());
-        kysely.addBindValue(rmap.take("ostokpl").toDouble());
-        kysely.addBindValue(rmap.take("ahinta").toDouble());
-        kysely.addBindValue( mapToJson(rmap) );
-        kysely.exec();
+        kirjoita("INSERT INTO Rivi(tosite,rivi,tuote,myyntikpl,ostokpl, ahinta, json) VALUES (?,?,?,?,?,?,?) ",
+                { tositeId, rivi + 1, rmap.take("tuote").toString(),
+                  rmap.take("myyntikpl").toDouble(), rmap.take("ostokpl").toDouble(),
+                  rmap.take("ahinta").toDouble(), mapToJson(rmap) });
     }
 
 
     // Poistettujen poistamiset
-    for(int poistoid : vanhatviennit)
-        kysely.exec(QString("DELETE FROM Vienti WHERE id=%1").arg(poistoid));
+    for(int poistoid : vanhatviennit) {
+        if( !kysely.exec(QString("DELETE FROM Vienti WHERE id=%1").arg(poistoid)))
+            throw SQLiteVirhe(kysely);
+    }
 
 
     // Lisätään lokitieto
@@ -426,13 +434,135 @@ int TositeRoute::lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanT
     kysely.addBindValue(tositeId);
     kysely.addBindValue(tila);
     kysely.addBindValue(lokiin);
-    kysely.exec();
+    if( !kysely.exec())
+        throw SQLiteVirhe(kysely);
 
+    kirjaaSaldoihin(tositeId, 1);
 
-    db().commit();
+    // Joukkoa lisättäessä hakuindeksi päivitetään kerralla lopuksi
+    if( !joukko_ ) {
+        model_->paivitaHakuindeksi(QString("Tosite.id=%1").arg(tositeId));
+        transaktio.vahvista();
+    }
     return tositeId;
 }
 
+QVariantList TositeRoute::lisaaJoukko(const QVariantList &tositteet)
+{
+    QVariantList tulokset;
+    QList<int> lisatyt;
+
+    joukko_ = true;
+    tunnisteet_.clear();
+    laskunumero_ = 0;
+    const QHash<QString,int> kumppanitAlussa = kumppaniCache_;
+    Transaktio transaktio(db());
+
+    try {
+        for(const QVariant& tosite : tositteet) {
+            // Perutun tositteen tunnisteet, laskunumerot ja kumppanit eivät jää käyttöön
+            const QHash<QString,int> tunnisteet = tunnisteet_;
+            const QHash<QString,int> kumppanit = kumppaniCache_;
+            const qulonglong laskunumero = laskunumero_;
+            QVariantMap tulos;
+
+            suorita("SAVEPOINT tosite");
+            try {
+                const int tositeId = lisaaTaiPaivita(tosite);
+                suorita("RELEASE tosite");
+                lisatyt.append(tositeId);
+                tulos.insert("id", tositeId);
+            } catch (SQLiteVirhe& virhe) {
+                suorita("ROLLBACK TO tosite");
+                suorita("RELEASE tosite");
+                tunnisteet_ = tunnisteet;
+                kumppaniCache_ = kumppanit;
+                laskunumero_ = laskunumero;
+                tulos.insert("virhe", virhe.selitys());
+                tulos.insert("koodi", virhe.koodi());
+            }
+            tulokset.append(tulos);
+        }
+
+        for(const QString& idt : idListat(lisatyt))
+            model_->paivitaHakuindeksi(QString("Tosite.id IN (%1)").arg(idt));
+    } catch (...) {
+        // Koko joukko perutaan, joten joukossa lisätyt kumppanit eivät ole tallessa
+        joukko_ = false;
+        tunnisteet_.clear();
+        laskunumero_ = 0;
+        kumppaniCache_ = kumppanitAlussa;
+        throw;
+    }
+
+    transaktio.vahvista();
+    // Varatun numerojakson loppu tallennetaan kerralla
+    if( laskunumero_ )
+        kp()->asetukset()->aseta("LaskuSeuraavaId", laskunumero_ + 1);
+
+    joukko_ = false;
+    tunnisteet_.clear();
+    laskunumero_ = 0;
+    return tulokset;
+}
+
+QString TositeRoute::tunnisteAvain(const Tilikausi &kausi, const QString &sarja)
+{
+    return kausi.alkaa().toString(Qt::ISODate) + ( sarja.isNull() ? QString() : "/" + sarja );
+}
+
+int TositeRoute::seuraavaTunniste(const Tilikausi &kausi, const QString &sarja)
+{
+    const QString avain = tunnisteAvain(kausi, sarja);
+
+    if( !joukko_ || !tunnisteet_.contains(avain)) {
+        QSqlQuery kysely = sarja.isNull() ?
+                    suorita("SELECT MAX(tunniste) FROM Tosite WHERE pvm BETWEEN ? AND ? AND sarja IS NULL AND tila >= 100",
+                            { kausi.alkaa().toString(Qt::ISODate), kausi.paattyy().toString(Qt::ISODate) }) :
+                    suorita("SELECT MAX(tunniste) FROM Tosite WHERE pvm BETWEEN ? AND ? AND sarja=? AND tila >= 100",
+                            { kausi.alkaa().toString(Qt::ISODate), kausi.paattyy().toString(Qt::ISODate), sarja });
+        tunnisteet_.insert(avain, kysely.next() ? kysely.value(0).toInt() : 0);
+        kysely.finish();
+    }
+    return ++tunnisteet_[avain];
+}
+
+void TositeRoute::kirjaaTunniste(const Tilikausi &kausi, const QString &sarja, int tunniste)
+{
+    // Jos suurinta tunnistetta ei ole vielä haettu, haku näkee tämänkin tositteen
+    auto iter = tunnisteet_.find( tunnisteAvain(kausi, sarja) );
+    if( iter != tunnisteet_.end() && iter.value() < tunniste)
+        iter.value() = tunniste;
+}
+
+qulonglong TositeRoute::seuraavaLaskunumero()
+{
+    if( joukko_ && laskunumero_ )
+        return ++laskunumero_;
+
+    // LaskuSeuraavaId käsitellään käsin, jotta ei tule päällekkäisiä numeroita
+    // vaikka olisi monta instanssia.
+    qulonglong laskunumero = kp()->asetukset()->isoluku("LaskuSeuraavaId", 1);
+
+    QSqlQuery laskunumerokysely( db());
+    laskunumerokysely.exec("SELECT arvo FROM Asetus WHERE avain='LaskuSeuraavaId'");
+
+    if( laskunumerokysely.next()) {
+        qulonglong haettu = laskunumerokysely.value(0).toULongLong();
+        if( haettu > laskunumero)
+            laskunumero = haettu;
+    }
+    qulonglong numerointialkaa = kp()->asetukset()->asetus("LaskuNumerointialkaa").toULongLong();
+    if( numerointialkaa > laskunumero)
+        laskunumero = numerointialkaa;
+
+    if( joukko_ )
+        laskunumero_ = laskunumero;
+    else
+        kp()->asetukset()->aseta("LaskuSeuraavaId", laskunumero + 1);
+    return laskunumero;
+}
+
 QVariantList TositeRoute::lokinpurku(QSqlQuery &kysely) const
 {
     QVariantList lista;
@@ -547,7 +677,6 @@ int TositeRoute::kumppaniMapista(QVariantMap &map)
         if( kumppaniId ) {
             kumppaniCache_.insert(nimi, kumppaniId);
         } else {
-            db().rollback();
             throw SQLiteVirhe(kumppaniKysely);
        }
     } else if (!map.value("iban").toList().isEmpty()) {
@@ -556,7 +685,6 @@ int TositeRoute::kumppaniMapista(QVariantMap &map)
             kumppaniKysely.addBindValue(kumppaniId);
             kumppaniKysely.addBindValue(var.toString());
             if(!kumppaniKysely.exec()) {
-                db().rollback();
                 throw SQLiteVirhe(kumppaniKysely);
             }
         }
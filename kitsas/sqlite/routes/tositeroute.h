@@ -18,6 +18,7 @@
 #define TOSITEROUTE_H
 
 #include "../sqliteroute.h"
+#include "db/tilikausi.h"
 
 class TositeRoute : public SQLiteRoute
 {
@@ -30,10 +31,49 @@ public:
     QVariant patch(const QString &polku, const QVariant &data) override;
     QVariant doDelete(const QString &polku) override;
 
-    static QString kysymys(const QUrlQuery &urlquery);
+    static QString kysymys(const QUrlQuery &urlquery, QVariantList& arvot);
 
 protected:
     int lisaaTaiPaivita(const QVariant pyynto, const int paivitettavanTositeId = 0);
+
+    /**
+     * @brief Lisää joukon tositteita yhdessä transaktiossa
+     *
+     * Jokainen tosite tallennetaan omassa tallennuspisteessään, joten
+     * virheellinen tosite ei estä muiden tallentamista.
+     *
+     * @param tositteet Lista tallennettavista tositteista
+     * @return Jokaisesta tositteesta samassa järjestyksessä joko id
+     *         tai virhe ja virhekoodi
+     */
+    QVariantList lisaaJoukko(const QVariantList& tositteet);
+
+    static QString tunnisteAvain(const Tilikausi& kausi, const QString& sarja);
+
+    /**
+     * @brief Seuraava vapaa tunniste sarjassa tilikaudella
+     *
+     * Joukkoa lisättäessä sarjan suurin tunniste haetaan vain kerran
+     * ja seuraavat numeroidaan muistissa.
+     */
+    int seuraavaTunniste(const Tilikausi& kausi, const QString& sarja);
+    /**
+     * @brief Kirjaa joukossa annetun tunnisteen käytetyksi
+     *
+     * Muistissa numeroitaessa seuraavat tunnisteet jatkavat annetun
+     * tunnisteen jälkeen, jotta samaa numeroa ei anneta kahdesti.
+     */
+    void kirjaaTunniste(const Tilikausi& kausi, const QString& sarja, int tunniste);
+
+    /**
+     * @brief Seuraava laskun numero
+     *
+     * Joukkoa lisättäessä laskuille varataan yhtenäinen numerojakso:
+     * seuraava numero haetaan vain kerran, ja jakson loppu
+     * tallennetaan asetuksiin vasta lopuksi.
+     */
+    qulonglong seuraavaLaskunumero();
+
     QVariantList lokinpurku(QSqlQuery &kysely) const;
 
     QVariant hae(int tositeId);
@@ -51,6 +91,10 @@ protected:
      */
     int kumppaniMapista(QVariantMap &map);
     QHash<QString,int> kumppaniCache_;
+
+    bool joukko_ = false;
+    QHash<QString,int> tunnisteet_;
+    qulonglong laskunumero_ = 0;
 };
 
 #endif // TOSITEROUTE_H
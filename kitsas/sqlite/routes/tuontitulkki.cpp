@@ -21,6 +21,7 @@
 #include "db/kirjanpito.h"
 
 #include <QRegularExpression>
+#include <QSet>
 #include <QDebug>
 
 TuontiTulkki::TuontiTulkki(SQLiteModel *model) :
@@ -42,6 +43,7 @@ QVariant TuontiTulkki::post(const QString &/*polku*/, const QVariant &data)
 QVariant TuontiTulkki::tiliote( QVariantMap &map)
 {
     QVariantList tapahtumat = map.value("tapahtumat").toList();
+    lataaHakemisto(tapahtumat);
 
     QMutableListIterator<QVariant> iter(tapahtumat);
     while( iter.hasNext()) {
@@ -52,24 +54,188 @@ QVariant TuontiTulkki::tiliote( QVariantMap &map)
 
         iter.setValue(tapahtuma);
     }
+    tyhjennaHakemisto();
+
     map.insert("tapahtumat", tapahtumat);
     return map;
 }
 
-void TuontiTulkki::tilioteTulorivi(QVariantMap &rivi)
+void TuontiTulkki::lataaHakemisto(const QVariantList &tapahtumat)
+{
+    tyhjennaHakemisto();
+    lataaKumppanit();
+
+    // Selvitetään ensin tapahtumien viitteet ja vastapuolet
+    QSet<QString> viitteet;
+    QSet<int> kumppanit;
+    for(const QVariant& item : tapahtumat) {
+        const QVariantMap tapahtuma = item.toMap();
+        QPair<int,QString> kumppani;
+        if( tapahtuma.value("euro").toDouble() > 0) {
+            QString viite = tapahtuma.value("viite").toString();
+            if( viite.startsWith("RF"))
+                viite = viite.mid(4);
+            if( !viite.isEmpty())
+                viitteet.insert(viite);
+            kumppani = kumppaniNimella( tapahtuma.value("saajamaksaja").toString());
+        } else {
+            if( tapahtuma.contains("iban"))
+                kumppani = kumppaniIbanilla( tapahtuma.value("iban").toString());
+            if( !kumppani.first)
+                kumppani = kumppaniNimella( tapahtuma.value("saajamaksaja").toString());
+        }
+        if( kumppani.first)
+            kumppanit.insert(kumppani.first);
+    }
+
+    lataaErat( viitteet.values(), kumppanit.values());
+}
+
+void TuontiTulkki::lataaKumppanit()
+{
+    QSqlQuery kysely( db() );
+    kysely.setForwardOnly(true);
+
+    kysely.exec("SELECT viite, tili, kohdennus, otsikko FROM Vakioviite");
+    while( kysely.next()) {
+        Vakioviite vakioviite;
+        vakioviite.tili = kysely.value(1);
+        vakioviite.kohdennus = kysely.value(2);
+        vakioviite.otsikko = kysely.value(3);
+        vakioviitteet_.insert( kysely.value(0).toInt(), vakioviite);
+    }
+
+    kysely.exec("SELECT iban, id, nimi FROM KumppaniIban JOIN Kumppani ON KumppaniIban.kumppani=Kumppani.id");
+    while( kysely.next())
+        ibanit_.insert( kysely.value(0).toString(), qMakePair( kysely.value(1).toInt(), kysely.value(2).toString()));
+
+    // Nimet tunnuksen mukaisessa järjestyksessä, jotta useammasta
+    // sopivasta valitaan sama kuin tietokantahaussa
+    kysely.exec("SELECT id, nimi FROM Kumppani WHERE nimi IS NOT NULL ORDER BY id");
+    while( kysely.next()) {
+        const QString nimi = kysely.value(1).toString();
+        const int indeksi = kumppanit_.count();
+        kumppanit_.append( qMakePair( kysely.value(0).toInt(), nimi ));
+
+        const QString avain = pienin(nimi);
+        if( !kumppaniNimet_.contains(avain))
+            kumppaniNimet_.insert(avain, indeksi);
+        nimenPituudet_[nimi.length()].append(indeksi);
+    }
+}
+
+void TuontiTulkki::lataaErat(const QStringList &viitteet, const QList<int> &kumppanit)
 {
-    // Ensisijaisesti etsitään viitteellä
     QSqlQuery kysely( db() );
+    kysely.setForwardOnly(true);
+    QList<int> eraIdt;
+
+    // Myyntien viitteet
+    for(int i=0; i < viitteet.count(); i += 500) {
+        const QStringList pala = viitteet.mid(i, 500);
+        QString paikat = QString("?,").repeated(pala.count());
+        paikat.chop(1);
+        kysely.prepare( QString("SELECT Tosite.viite, Vienti.eraid, Vienti.tili, Vienti.kumppani, Kumppani.nimi, Tosite.pvm, Vienti.selite, Tosite.tunniste, Tosite.sarja FROM Vienti "
+                                "JOIN Tosite ON Vienti.tosite=Tosite.id "
+                                "LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
+                                "WHERE Vienti.tyyppi=%1 AND Tosite.viite IN (%2) AND Tosite.tila >= 100 ORDER BY Vienti.id")
+                        .arg(TositeVienti::MYYNTI + TositeVienti::VASTAKIRJAUS)
+                        .arg(paikat));
+        for(const QString& viite : pala)
+            kysely.addBindValue(viite);
+        kysely.exec();
+        while( kysely.next()) {
+            const QString viite = kysely.value(0).toString();
+            if( myynnitViitteella_.contains(viite))
+                continue;
+            Era era;
+            era.id = kysely.value(1);
+            era.tili = kysely.value(2);
+            era.kumppani = kysely.value(3);
+            era.kumppaniNimi = kysely.value(4);
+            era.pvm = kysely.value(5);
+            era.selite = kysely.value(6);
+            era.tunniste = kysely.value(7);
+            era.sarja = kysely.value(8);
+            myynnitViitteella_.insert(viite, era);
+        }
+    }
 
+    for(const QString& idt : idListat(kumppanit)) {
+        // Ostojen viitteet
+        kysely.exec( QString("SELECT Vienti.kumppani, Tosite.viite, Vienti.eraid, Vienti.tili, Vienti.selite, Tosite.pvm, Tosite.tunniste, Tosite.sarja FROM Vienti "
+                             "JOIN Tosite ON Vienti.tosite=Tosite.id "
+                             "WHERE Vienti.tyyppi=%1 AND Vienti.kumppani IN (%2) AND Tosite.viite IS NOT NULL "
+                             "AND Tosite.tila >= 100 ORDER BY Vienti.pvm, Vienti.id")
+                     .arg(TositeVienti::OSTO + TositeVienti::VASTAKIRJAUS)
+                     .arg(idt));
+        while( kysely.next()) {
+            Era era;
+            era.id = kysely.value(2);
+            era.tili = kysely.value(3);
+            era.selite = kysely.value(4);
+            era.pvm = kysely.value(5);
+            era.tunniste = kysely.value(6);
+            era.sarja = kysely.value(7);
+            ostotViitteella_[ qMakePair(kysely.value(0).toInt(), kysely.value(1).toString()) ].append(era);
+            eraIdt.append( era.id.toInt() );
+        }
+
+        // Kumppanin vähiten käytetty tulo- tai menotili
+        kysely.exec( QString("SELECT kumppani, tyyppi, tili FROM Vienti WHERE tyyppi IN (%1,%2) AND kumppani IN (%3) "
+                             "GROUP BY kumppani, tyyppi, tili ORDER BY kumppani, tyyppi, COUNT(tili), tili")
+                     .arg(TositeVienti::MYYNTI + TositeVienti::KIRJAUS)
+                     .arg(TositeVienti::OSTO + TositeVienti::KIRJAUS)
+                     .arg(idt));
+        while( kysely.next()) {
+            const QPair<int,int> avain = qMakePair(kysely.value(0).toInt(), kysely.value(1).toInt());
+            if( !kumppaninTilit_.contains(avain))
+                kumppaninTilit_.insert(avain, kysely.value(2));
+        }
+    }
+
+    lataaSaldot(eraIdt);
+}
+
+void TuontiTulkki::lataaSaldot(const QList<int> &eraIdt)
+{
+    QSqlQuery kysely( db() );
+    kysely.setForwardOnly(true);
+
+    const QList<int> idt = eraIdt.toSet().values();
+    for(const QString& pala : idListat(idt)) {
+        kysely.exec( QString("SELECT eraid, SUM(debetsnt), SUM(kreditsnt) FROM Vienti WHERE eraid IN (%1) GROUP BY eraid").arg(pala));
+        while( kysely.next())
+            saldot_.insert( kysely.value(0).toInt(), qMakePair( kysely.value(1).toLongLong(), kysely.value(2).toLongLong()));
+    }
+}
+
+void TuontiTulkki::tyhjennaHakemisto()
+{
+    vakioviitteet_.clear();
+    ibanit_.clear();
+    kumppanit_.clear();
+    kumppaniNimet_.clear();
+    nimenPituudet_.clear();
+    nimiHaut_.clear();
+    myynnitViitteella_.clear();
+    ostotViitteella_.clear();
+    saldot_.clear();
+    kumppaninTilit_.clear();
+}
+
+void TuontiTulkki::tilioteTulorivi(QVariantMap &rivi)
+{
+    // Ensisijaisesti etsitään viitteellä
     QString viite = rivi.value("viite").toString();
     if( !viite.isEmpty()) {
 
         // Etsitään vakioviitettä
-        kysely.exec(QString("SELECT tili, kohdennus, otsikko FROM Vakioviite WHERE viite=%1").arg(viite.toInt()));
-        if( kysely.next()) {
-            rivi.insert("selite", kysely.value("otsikko"));
-            rivi.insert("tili", kysely.value("tili"));
-            rivi.insert("kohdennus", kysely.value("kohdennus"));
+        const auto vakioviite = vakioviitteet_.constFind( viite.toInt() );
+        if( vakioviite != vakioviitteet_.constEnd()) {
+            rivi.insert("selite", vakioviite->otsikko);
+            rivi.insert("tili", vakioviite->tili);
+            rivi.insert("kohdennus", vakioviite->kohdennus);
             return;
         }
 
@@ -77,24 +243,18 @@ void TuontiTulkki::tilioteTulorivi(QVariantMap &rivi)
         if( viite.startsWith("RF"))
             viite = viite.mid(4);
 
-        kysely.exec( QString("SELECT Vienti.eraid, Vienti.tili, Vienti.kumppani, Kumppani.nimi, Tosite.pvm, Vienti.selite, Tosite.tunniste, Tosite.sarja FROM Vienti "
-                             "JOIN Tosite ON Vienti.tosite=Tosite.id "
-                             "LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
-                             "WHERE Vienti.tyyppi=%1 AND "
-                             "Tosite.Viite='%2' AND Tosite.tila >= 100")
-                     .arg(TositeVienti::MYYNTI + TositeVienti::VASTAKIRJAUS)
-                     .arg(viite));
-        if( kysely.next()) {
-           rivi.insert("saajamaksajaid", kysely.value(2));
-           rivi.insert("saajamaksaja", kysely.value(3));
+        const auto era = myynnitViitteella_.constFind(viite);
+        if( era != myynnitViitteella_.constEnd()) {
+           rivi.insert("saajamaksajaid", era->kumppani);
+           rivi.insert("saajamaksaja", era->kumppaniNimi);
            QVariantMap eramap;
-           eramap.insert("id", kysely.value(0));
-           eramap.insert("pvm", kysely.value(4));
-           eramap.insert("tunniste", kysely.value(6));
-           eramap.insert("sarja", kysely.value(7));
+           eramap.insert("id", era->id);
+           eramap.insert("pvm", era->pvm);
+           eramap.insert("tunniste", era->tunniste);
+           eramap.insert("sarja", era->sarja);
            rivi.insert("era", eramap);
-           rivi.insert("tili",kysely.value(1));
-           rivi.insert("selite", kysely.value(5));
+           rivi.insert("tili",era->tili);
+           rivi.insert("selite", era->selite);
            return;
         }
     }
@@ -111,50 +271,10 @@ void TuontiTulkki::tilioteTulorivi(QVariantMap &rivi)
     }
 
     if( kumppani.first) {
-
-        QSqlQuery apukysely( db() );
-        int tili = 0;
-        QVariantMap era;
-
-        // Yritetään löytää tähän kumppaniin liitetty oikean suuruinen erä
-        kysely.exec( QString("SELECT Vienti.id, tosite.pvm, tili, tunniste, sarja FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE vienti.tyyppi=%1 AND "
-                             "kumppani=%2 AND debetsnt=%3 AND pvm<'%4'")
-                     .arg(TositeVienti::MYYNTI + TositeVienti::VASTAKIRJAUS)
-                     .arg(kumppani.first)
-                     .arg( qRound64(rivi.value("euro").toDouble() * 100) )
-                     .arg( rivi.value("pvm").toDate().toString(Qt::ISODate)) );
-
-
-
-        while( kysely.next()) {
-            apukysely.exec( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM Vienti WHERE eraid=%1").arg(kysely.value(0).toInt()));
-            if( apukysely.next() && apukysely.value(0).toLongLong() == qRound64(rivi.value("euro").toDouble() * 100) &&
-                    apukysely.value(1).toLongLong() == 0l) {
-                if(!tili) {
-                    era.insert("id", kysely.value(0));
-                    era.insert("pvm", kysely.value(1));
-                    era.insert("tunniste", kysely.value(2));
-                    era.insert("sarja", kysely.value(3));
-                    tili = kysely.value(2).toInt();
-                } else {
-                    tili = -1;      // Löydetty monta, joten ei valita niistä yhtäkään
-                }
-            }
-        }
-        if( tili > 0) {
-            rivi.insert("era", era);
-            rivi.insert("tili", tili);
-            return;
-        }
-
         // Viimeisenä toivona etsitään sopivaa tulotiliä ;)
-
-        kysely.exec(QString("SELECT tili FROM Vienti WHERE tyyppi=%1 AND kumppani=%2 GROUP BY tili ORDER BY count(tili) LIMIT 1")
-                    .arg(TositeVienti::MYYNTI + TositeVienti::KIRJAUS).arg(kumppani.first));
-        if( kysely.next())
-            rivi.insert("tili", kysely.value(0));
-
-
+        const auto tili = kumppaninTilit_.constFind( qMakePair(kumppani.first, TositeVienti::MYYNTI + TositeVienti::KIRJAUS));
+        if( tili != kumppaninTilit_.constEnd())
+            rivi.insert("tili", tili.value());
     }
 }
 
@@ -193,116 +313,122 @@ void TuontiTulkki::tilioteMenorivi(QVariantMap &rivi)
     else if( rivi.value("ktokoodi").toInt() == 740)
         rivi.insert("tili", kp()->asetukset()->luku("PankkiMaksettavakorko"));
     else if( kumppani.first){
-        QSqlQuery apukysely( db() );
+        const qlonglong maksu = qRound64(rivi.value("euro").toDouble() * -100);
 
         // 1) Viitemaksun etsiminen
-        QSqlQuery kysely( db() );
-
-        kysely.exec( QString("SELECT Vienti.eraid, Vienti.tili, Vienti.selite, Tosite.pvm, Tosite.tunniste, Tosite.sarja FROM Vienti "
-                             "JOIN Tosite ON Vienti.tosite=Tosite.id "
-                             "WHERE Vienti.tyyppi=%1 AND "
-                             "Tosite.Viite='%2' AND Vienti.kumppani=%3 AND Tosite.tila >= 100 ORDER BY Vienti.pvm")
-                     .arg(TositeVienti::OSTO + TositeVienti::VASTAKIRJAUS)
-                     .arg(rivi.value("viite").toString())
-                     .arg(kumppani.first));
-        while( kysely.next()) {
+        for(const Era& era : ostotViitteella_.value( qMakePair(kumppani.first, rivi.value("viite").toString()))) {
             // Jos erä on jo maksettu, ei se kelpaa
-           apukysely.exec( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM Vienti WHERE eraid=%1").arg(kysely.value(0).toInt()));
-           if( apukysely.next() &&  (apukysely.value(1).toLongLong() != qRound64(rivi.value("euro").toDouble() * -100) ||
-                   apukysely.value(0).toLongLong() != 0l ))
-               continue;
-
-           QVariantMap eramap;
-           eramap.insert("id", kysely.value(0));
-           eramap.insert("pvm", kysely.value(3));
-           eramap.insert("tunniste", kysely.value(4));
-           eramap.insert("sarja", kysely.value(5));
-           rivi.insert("era", eramap);
-           rivi.insert("tili",kysely.value(1));
-           rivi.insert("selite", kysely.value(2));
-           return;
-        }
-        // 2) Viitteettömän erän etsiminen
-
-        int tili = 0;
-        QDate pvm;
-        QVariantMap era;
-
-        // Yritetään löytää tähän kumppaniin liitetty oikean suuruinen erä
-        kysely.exec( QString("SELECT id, tosite.pvm, tili, tunniste, sarja FROM Vienti "
-                             "JOIN Tosite ON Vienti.tosite=Tosite.id WHERE vienti.tyyppi=%1 AND "
-                             "kumppani=%2 AND kreditsnt=%3 AND pvm<'%4' AND Tosite.tila>=100")
-                     .arg(TositeVienti::OSTO + TositeVienti::VASTAKIRJAUS)
-                     .arg(kumppani.first)
-                     .arg( qRound64(rivi.value("euro").toDouble() * 100) )
-                     .arg( rivi.value("pvm").toDate().toString(Qt::ISODate)) );
-
-
-
-        while( kysely.next()) {
-            apukysely.exec( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM Vienti WHERE eraid=%1").arg(kysely.value(0).toInt()));
-            if( apukysely.next() && apukysely.value(1).toLongLong() == qRound64(rivi.value("euro").toDouble() * -100) &&
-                    apukysely.value(0).toLongLong() == 0l) {
-                if(!tili) {
-                    era.insert("id", kysely.value(0));
-                    era.insert("pvm", kysely.value(1));
-                    era.insert("tunniste", kysely.value(3));
-                    era.insert("sarja", kysely.value(4));
-                    tili = kysely.value(2).toInt();
-                } else {
-                    tili = -1;      // Löydetty monta, joten ei valita niistä yhtäkään
-                }
-            }
-        }
-        if( tili > 0) {
-            rivi.insert("era", era);
-            rivi.insert("tili", tili);
-            rivi.insert("laskupvm",pvm);
+            const QPair<qlonglong,qlonglong> saldo = saldot_.value( era.id.toInt() );
+            if( saldo.second != maksu || saldo.first != 0l)
+                continue;
+
+            QVariantMap eramap;
+            eramap.insert("id", era.id);
+            eramap.insert("pvm", era.pvm);
+            eramap.insert("tunniste", era.tunniste);
+            eramap.insert("sarja", era.sarja);
+            rivi.insert("era", eramap);
+            rivi.insert("tili",era.tili);
+            rivi.insert("selite", era.selite);
             return;
         }
 
-        // 3) Viimeisenä toivona etsitään sopivaa menotiliä ;)
-
-        kysely.exec(QString("SELECT tili FROM Vienti WHERE tyyppi=%1 AND kumppani=%2 GROUP BY tili ORDER BY count(tili) LIMIT 1")
-                    .arg(TositeVienti::OSTO + TositeVienti::KIRJAUS).arg(kumppani.first));
-        if( kysely.next())
-            rivi.insert("tili", kysely.value(0));
-
+        // 2) Viimeisenä toivona etsitään sopivaa menotiliä ;)
+        const auto tili = kumppaninTilit_.constFind( qMakePair(kumppani.first, TositeVienti::OSTO + TositeVienti::KIRJAUS));
+        if( tili != kumppaninTilit_.constEnd())
+            rivi.insert("tili", tili.value());
     }
 }
 
 QPair<int,QString> TuontiTulkki::kumppaniNimella(const QString &nimi)
 {
-    QSqlQuery kysely( db());
+    const auto aiempi = nimiHaut_.constFind(nimi);
+    if( aiempi != nimiHaut_.constEnd())
+        return aiempi.value();
 
     // Siivotaan skandeja, jotta saadaan merkkikokoriippumaton haku
     QString hakunimi(nimi);
     hakunimi.replace(QRegularExpression("[åäöÅÄÖ']"),"_");
 
-    kysely.exec( QString("SELECT id, nimi FROM Kumppani WHERE nimi LIKE '%1'").arg(hakunimi));
-    if( kysely.next()) {
-        return qMakePair( kysely.value(0).toInt(), kysely.value(1).toString() );
+    QPair<int,QString> tulos = qMakePair(0, nimi);
+    if( !hakunimi.contains('%') && !hakunimi.contains('_')) {
+        const int indeksi = kumppaniNimet_.value( pienin(hakunimi), -1);
+        if( indeksi >= 0)
+            tulos = kumppanit_.at(indeksi);
+    } else {
+        // Ilman %-merkkiä sopivan nimen pituus on sama kuin hakunimen
+        const bool pituus = !hakunimi.contains('%');
+        const QList<int> ehdokkaat = nimenPituudet_.value(hakunimi.length());
+        for(int i=0; i < (pituus ? ehdokkaat.count() : kumppanit_.count()); i++) {
+            const QPair<int,QString>& kumppani = kumppanit_.at( pituus ? ehdokkaat.at(i) : i );
+            if( like(hakunimi, kumppani.second)) {
+                tulos = kumppani;
+                break;
+            }
+        }
     }
 
     // Muuten tehdään nimihaku paloista, jolloin useimmat henkilönimet löytyvät
-    QStringList paloina = hakunimi.split(QRegularExpression("\\s"));
-    if( paloina.size() > 1) {
-        kysely.exec( "SELECT id,nimi FROM Kumppani WHERE nimi LIKE '%" + paloina.value(0)
-                     + "%' AND nimi LIKE '%" + paloina.value(1) + "%' ");
-        if( kysely.next()) {
-            return qMakePair( kysely.value(0).toInt(), kysely.value(1).toString() );
+    if( !tulos.first ) {
+        QStringList paloina = hakunimi.split(QRegularExpression("\\s"));
+        if( paloina.size() > 1) {
+            const QString ensimmainen = "%" + paloina.value(0) + "%";
+            const QString toinen = "%" + paloina.value(1) + "%";
+            for(const QPair<int,QString>& kumppani : kumppanit_) {
+                if( like(ensimmainen, kumppani.second) && like(toinen, kumppani.second)) {
+                    tulos = kumppani;
+                    break;
+                }
+            }
         }
     }
 
-    return qMakePair(0, nimi);
+    nimiHaut_.insert(nimi, tulos);
+    return tulos;
+}
+
+QPair<int, QString> TuontiTulkki::kumppaniIbanilla(const QString &iban) const
+{
+    return ibanit_.value(iban, qMakePair(0, QString()));
 }
 
-QPair<int, QString> TuontiTulkki::kumppaniIbanilla(const QString &iban)
+bool TuontiTulkki::like(const QString &kuvio, const QString &teksti)
 {
-    QSqlQuery kysely( db());
-    kysely.exec(QString("SELECT id, nimi FROM KumppaniIban JOIN Kumppani ON KumppaniIban.kumppani=Kumppani.id WHERE iban='%1'")
-                .arg(iban));
-    if( kysely.next())
-        return qMakePair(kysely.value(0).toInt(), kysely.value(1).toString());
-    return qMakePair(0, QString());
+    int k = 0;
+    int t = 0;
+    int tahti = -1;
+    int paluu = 0;
+
+    while( t < teksti.length()) {
+        if( k < kuvio.length() && kuvio.at(k) == '%') {
+            tahti = k++;
+            paluu = t;
+        } else if( k < kuvio.length() &&
+                   ( kuvio.at(k) == '_' || kuvio.at(k) == teksti.at(t) ||
+                     ( kuvio.at(k).unicode() < 128 && teksti.at(t).unicode() < 128 &&
+                       kuvio.at(k).toLower() == teksti.at(t).toLower()))) {
+            k++;
+            t++;
+        } else if( tahti >= 0) {
+            // Palataan edelliseen %-merkkiin ja kokeillaan pidempää osumaa
+            k = tahti + 1;
+            t = ++paluu;
+        } else {
+            return false;
+        }
+    }
+    while( k < kuvio.length() && kuvio.at(k) == '%')
+        k++;
+    return k == kuvio.length();
+}
+
+QString TuontiTulkki::pienin(const QString &teksti)
+{
+    QString pienet(teksti);
+    for(int i=0; i < pienet.length(); i++) {
+        const ushort merkki = pienet.at(i).unicode();
+        if( merkki >= 'A' && merkki <= 'Z')
+            pienet[i] = QChar(merkki + 32);
+    }
+    return pienet;
 }
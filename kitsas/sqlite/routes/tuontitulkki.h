@@ -19,6 +19,16 @@
 
 #include "../sqliteroute.h"
 
+#include <QHash>
+
+/**
+ * @brief Tuotavien tiedostojen tulkinta
+ *
+ * Tiliotteen tapahtumille etsitään vastapuoli, tili ja avoin erä.
+ * Tulkinnassa tarvittavat tiedot haetaan kerran koko tiliotetta
+ * kohden hakutauluihin, joista jokainen tapahtuma tulkitaan
+ * tekemättä omia tietokantakyselyjä.
+ */
 class TuontiTulkki : public SQLiteRoute
 {
 public:
@@ -27,14 +37,65 @@ public:
     QVariant post(const QString &polku, const QVariant &data) override;
 
 protected:
+    struct Era {
+        QVariant id;
+        QVariant tili;
+        QVariant kumppani;
+        QVariant kumppaniNimi;
+        QVariant pvm;
+        QVariant selite;
+        QVariant tunniste;
+        QVariant sarja;
+    };
+
+    struct Vakioviite {
+        QVariant tili;
+        QVariant kohdennus;
+        QVariant otsikko;
+    };
+
     QVariant tiliote(QVariantMap &map);
 
+    /**
+     * @brief Hakee tiliotteen tulkinnassa tarvittavat tiedot
+     *
+     * Vastapuolet haetaan ensin, jotta erät voidaan rajata
+     * tiliotteella esiintyviin viitteisiin ja kumppaneihin.
+     */
+    void lataaHakemisto(const QVariantList& tapahtumat);
+    void lataaKumppanit();
+    void lataaErat(const QStringList& viitteet, const QList<int>& kumppanit);
+    void lataaSaldot(const QList<int>& eraIdt);
+    void tyhjennaHakemisto();
+
     void tilioteTulorivi(QVariantMap& rivi);
 
     void tilioteMenorivi(QVariantMap& rivi);
 
     QPair<int, QString> kumppaniNimella(const QString& nimi);
-    QPair<int, QString> kumppaniIbanilla(const QString& iban);
+    QPair<int, QString> kumppaniIbanilla(const QString& iban) const;
+
+    /**
+     * @brief Vastaa SQLiten LIKE-vertailua
+     *
+     * % vastaa mitä tahansa merkkijonoa ja _ yhtä merkkiä, ja
+     * ASCII-merkit vertaillaan kirjainkoosta riippumatta.
+     */
+    static bool like(const QString& kuvio, const QString& teksti);
+    static QString pienin(const QString& teksti);
+
+    QHash<int, Vakioviite> vakioviitteet_;
+    QHash<QString, QPair<int,QString>> ibanit_;
+
+    QList<QPair<int,QString>> kumppanit_;
+    QHash<QString, int> kumppaniNimet_;
+    QHash<int, QList<int>> nimenPituudet_;
+    QHash<QString, QPair<int,QString>> nimiHaut_;
+
+    QHash<QString, Era> myynnitViitteella_;
+    QHash<QPair<int,QString>, QList<Era>> ostotViitteella_;
+    QHash<int, QPair<qlonglong,qlonglong>> saldot_;
+    QHash<QPair<int,int>, QVariant> kumppaninTilit_;
 };
 
 #endif // TUONTITULKKI_H
@@ -16,7 +16,7 @@
 */
 #include "viennitroute.h"
 #include "tositeroute.h"
-#include "db/kirjanpito.h"
+#include "db/kohdennus.h"
 #include "model/tosite.h"
 
 ViennitRoute::ViennitRoute(SQLiteModel* model) :
@@ -25,22 +25,36 @@ ViennitRoute::ViennitRoute(SQLiteModel* model) :
 
 }
 
+bool ViennitRoute::rinnakkainen(const QString & /*polku*/) const
+{
+    return true;
+}
+
 QVariant ViennitRoute::get(const QString &polku, const QUrlQuery &urlquery)
 {
     if( polku.toInt())
         return vienti(polku.toInt());
 
     QStringList ehdot;
+    QVariantList arvot;
     ehdot.append(QString("tila >= %1").arg(Tosite::KIRJANPIDOSSA));
 
-    if( urlquery.hasQueryItem("alkupvm"))
-        ehdot.append(QString("vienti.pvm >= '%1'").arg(urlquery.queryItemValue("alkupvm")));
-    if( urlquery.hasQueryItem("loppupvm"))
-        ehdot.append(QString("vienti.pvm <= '%1'").arg(urlquery.queryItemValue("loppupvm")));
-    if( urlquery.hasQueryItem("tili"))
-        ehdot.append(QString("tili=%1").arg(urlquery.queryItemValue("tili")));
-    if( urlquery.hasQueryItem("era"))
-        ehdot.append(QString("eraid=%1").arg(urlquery.queryItemValue("era")));
+    if( urlquery.hasQueryItem("alkupvm")) {
+        ehdot.append("vienti.pvm >= ?");
+        arvot << urlquery.queryItemValue("alkupvm");
+    }
+    if( urlquery.hasQueryItem("loppupvm")) {
+        ehdot.append("vienti.pvm <= ?");
+        arvot << urlquery.queryItemValue("loppupvm");
+    }
+    if( urlquery.hasQueryItem("tili")) {
+        ehdot.append("tili=?");
+        arvot << urlquery.queryItemValue("tili").toInt();
+    }
+    if( urlquery.hasQueryItem("era")) {
+        ehdot.append("eraid=?");
+        arvot << urlquery.queryItemValue("era").toInt();
+    }
 
 
     // TODO Kohdennus ja merkkaus
@@ -64,15 +78,24 @@ QVariant ViennitRoute::get(const QString &polku, const QUrlQuery &urlquery)
                     "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id ");
 
     if( urlquery.hasQueryItem("kohdennus")) {
-        Kohdennus kohdennus = kp()->kohdennukset()->kohdennus( urlquery.queryItemValue("kohdennus").toInt() );
-        if( kohdennus.tyyppi() == Kohdennus::PROJEKTI )
-            ehdot.append(QString("kohdennus=%1").arg(kohdennus.id()));
-        else if( kohdennus.tyyppi() == Kohdennus::MERKKAUS ) {
+        // Kohdennuksen tyyppi haetaan tietokannasta, koska haku
+        // voidaan suorittaa lukijan säikeessä
+        const int kohdennusId = urlquery.queryItemValue("kohdennus").toInt();
+        QSqlQuery tyyppikysely = suorita("SELECT tyyppi FROM Kohdennus WHERE id=?", { kohdennusId });
+        const int tyyppi = tyyppikysely.next() ? tyyppikysely.value(0).toInt() : Kohdennus::EIKOHDENNETA;
+        tyyppikysely.finish();
+
+        if( tyyppi == Kohdennus::PROJEKTI ) {
+            ehdot.append("kohdennus=?");
+            arvot << kohdennusId;
+        } else if( tyyppi == Kohdennus::MERKKAUS ) {
             kysymys.append("JOIN Merkkaus ON Vienti.id=Merkkaus.vienti ");
-            ehdot.append(QString("merkkaus.kohdennus=%1").arg(kohdennus.id()));
+            ehdot.append("merkkaus.kohdennus=?");
+            arvot << kohdennusId;
         } else {
             kysymys.append("JOIN Kohdennus ON Vienti.kohdennus=Kohdennus.id ");
-            ehdot.append(QString("(Kohdennus.id=%1 OR Kohdennus.kuuluu=%1)").arg(kohdennus.id()));
+            ehdot.append("(Kohdennus.id=? OR Kohdennus.kuuluu=?)");
+            arvot << kohdennusId << kohdennusId;
         }
     }
 
@@ -81,33 +104,27 @@ QVariant ViennitRoute::get(const QString &polku, const QUrlQuery &urlquery)
     kysymys.append( ehdot.join(" AND ") );
     kysymys.append(" ORDER BY " + jarjestys + "Vienti.pvm, Tosite.sarja, Tosite.tunniste, Vienti.rivi ");
 
-    QSqlQuery kysely(db());
-    kysely.exec(kysymys);
-
-    QVariantList viennit = resultList(kysely);
+    QSqlQuery kysely = suorita(kysymys, arvot);
 
-    if( urlquery.hasQueryItem("vastatilit"))
-        taydennaVastatilit(viennit);
-
-    taydennaEratJaMerkkaukset(viennit);
-    return viennit;
+    const bool vastatilit = urlquery.hasQueryItem("vastatilit");
+    return resultVastaus(kysely, [this, vastatilit] (QVariantList& viennit) {
+        if( vastatilit )
+            taydennaVastatilit(viennit);
+        taydennaEratJaMerkkaukset(viennit);
+    });
 
 }
 
 QVariant ViennitRoute::vienti(int id)
 {
-    QString kysymys(QString("SELECT vienti.id, pvm, tili, selite, debetsnt, kreditsnt, kumppani.nimi as kumppani "
-                            "FROM Vienti LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id WHERE Vienti.id=%1").arg(id));
-    QSqlQuery kysely( db());
-    kysely.exec(kysymys);
+    QSqlQuery kysely = suorita("SELECT vienti.id, pvm, tili, selite, debetsnt, kreditsnt, kumppani.nimi as kumppani "
+                                "FROM Vienti LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id WHERE Vienti.id=?", { id });
 
     return resultMap(kysely);
 }
 
 void ViennitRoute::taydennaVastatilit(QVariantList &lista)
 {
-    QSqlQuery kysely(db());
-
     for(int i=0; i < lista.count(); i++) {
         QVariantMap vienti = lista[i].toMap();
         int tili = vienti.value("tili").toInt();
@@ -115,7 +132,7 @@ void ViennitRoute::taydennaVastatilit(QVariantList &lista)
         int tositeId = tosite.value("id").toInt();
 
         QVariantList vastatilit;
-        kysely.exec(QString("SELECT tili FROM Vienti WHERE tosite=%1 AND tili <> %2").arg(tositeId).arg(tili));
+        QSqlQuery kysely = suorita("SELECT tili FROM Vienti WHERE tosite=? AND tili <> ?", { tositeId, tili });
         while(kysely.next()) {
             int vastatili = kysely.value(0).toInt();
             if( !vastatilit.contains(vastatili)) {
@@ -24,6 +24,7 @@ class ViennitRoute : public SQLiteRoute
 public:
     ViennitRoute(SQLiteModel* model);
 
+    bool rinnakkainen(const QString &polku) const override;
     QVariant get(const QString &polku, const QUrlQuery &urlquery = QUrlQuery()) override;
     QVariant vienti(int id);
 
@@ -0,0 +1,50 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "sqlitekahva.h"
+
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QDebug>
+
+#ifdef KITSAS_SYSTEM_SQLITE
+#include <sqlite3.h>
+#endif
+
+sqlite3 *sqliteKahva(const QSqlDatabase &tietokanta)
+{
+#ifdef KITSAS_SYSTEM_SQLITE
+    if( !tietokanta.isOpen() || !tietokanta.driver())
+        return nullptr;
+    QVariant kahva = tietokanta.driver()->handle();
+    if( !kahva.isValid() || qstrcmp(kahva.typeName(), "sqlite3*") != 0)
+        return nullptr;
+
+    // Ajurin mukana käännetty SQLite on yleensä eri versio kuin
+    // järjestelmän kirjasto, jolloin kahvaa ei käytetä
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec("SELECT sqlite_version()") || !kysely.next() ||
+        kysely.value(0).toString() != QString::fromLatin1(sqlite3_libversion())) {
+        qWarning() << "SQLite-ajuri ei käytä järjestelmän SQLite-kirjastoa";
+        return nullptr;
+    }
+    return *static_cast<sqlite3**>(kahva.data());
+#else
+    Q_UNUSED(tietokanta)
+    return nullptr;
+#endif
+}
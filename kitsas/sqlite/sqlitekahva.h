@@ -0,0 +1,37 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SQLITEKAHVA_H
+#define SQLITEKAHVA_H
+
+#include <QSqlDatabase>
+
+struct sqlite3;
+
+/**
+ * @brief QSQLITE-yhteyden SQLite-kahva
+ *
+ * Kahvaa voi käyttää SQLite-kirjaston funktioilla vain, jos Qt:n
+ * SQLite-ajuri on käännetty samaa järjestelmän SQLite-kirjastoa
+ * vastaan, johon Kitsas linkitetään. Tämä on varmistettava
+ * käännettäessä (KITSAS_SYSTEM_SQLITE, ks. kitsas.pro). Lisäksi
+ * yhteyden ja linkitetyn kirjaston versioiden on oltava samat.
+ *
+ * @return Kahva tai nullptr, jos sitä ei voi käyttää
+ */
+sqlite3* sqliteKahva(const QSqlDatabase& tietokanta);
+
+#endif // SQLITEKAHVA_H
@@ -24,6 +24,7 @@
 #include <QMessageBox>
 #include <QSqlError>
 #include <QJsonDocument>
+#include <QThread>
 #include <QDebug>
 
 SQLiteKysely::SQLiteKysely(SQLiteModel *parent, KpKysely::Metodi metodi, QString polku)
@@ -34,8 +35,15 @@ SQLiteKysely::SQLiteKysely(SQLiteModel *parent, KpKysely::Metodi metodi, QString
 
 void SQLiteKysely::kysy(const QVariant &data)
 {
+    if( vastaaValimuistista() )
+        return;
+
+    SQLiteModel* model = qobject_cast<SQLiteModel*>( parent() );
+    // Raskaat haut luetaan omassa säikeessään, joka myös vastaa
+    if( model->lueRinnakkain(this) )
+        return;
+
     try {
-        SQLiteModel* model = qobject_cast<SQLiteModel*>( parent() );
         model->reitita(this, data);
     } catch ( SQLiteVirhe &e ) {
         emit virhe( e.koodi(), e.selitys() );
@@ -65,12 +73,27 @@ void SQLiteKysely::lahetaTiedosto(const QByteArray &ba, const QMap<QString, QStr
 void SQLiteKysely::vastaa(const QVariant &tulos)
 {
     vastaus_ = tulos;
+    kirjaaValimuistiin();
+    jaaOsiin();
     emit vastaus(&vastaus_);
 }
 
+void SQLiteKysely::vastaaOsana(QVariantList &rivit)
+{
+    if( QThread::currentThread() != thread()) {
+        // Lukijan säikeessä luetut osat lähetetään kyselyn omassa säikeessä
+        QMetaObject::invokeMethod(this, [this, rivit] () mutable {
+            emit osaVastaus(&rivit);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    emit osaVastaus(&rivit);
+}
+
 void SQLiteKysely::vastaaLisayksesta(const QPair<const QVariant, int> &tulos)
 {
     vastaus_ = tulos.first;
+    kirjaaValimuistiin();
     emit vastaus(&vastaus_);
     if( tulos.second)
         emit lisaysVastaus(vastaus_, tulos.second);
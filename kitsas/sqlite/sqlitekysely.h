@@ -45,6 +45,7 @@ public:
     SQLiteKysely(SQLiteModel* parent, Metodi metodi=GET, QString polku = QString());
     void vastaa(const QVariant& tulos);
     void vastaaLisayksesta(const QPair<const QVariant,int>& tulos);
+    void vastaaOsana(QVariantList& rivit);
 
 public slots:
     void kysy(const QVariant& data = QVariant()) override;
@@ -0,0 +1,206 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "sqlitelukija.h"
+#include "sqlitemodel.h"
+#include "sqlitekysely.h"
+#include "sqlitekahva.h"
+
+#include "routes/viennitroute.h"
+#include "routes/eraroute.h"
+
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QDebug>
+
+#ifdef KITSAS_SYSTEM_SQLITE
+#include <sqlite3.h>
+#endif
+
+static const char* LUKUYHTEYS = "KIRJANPITO_LUKU";
+
+SQLiteLukija::SQLiteLukija(SQLiteModel *model) :
+    auki_(false), kerta_(0), kahva_(nullptr),
+    mittari_(model->mittari())
+{
+    routes_.append(new ViennitRoute(model));
+    routes_.append(new EraRoute(model));
+    for(SQLiteRoute* route : qAsConst(routes_))
+        route->asetaLukija(this);
+}
+
+SQLiteLukija::~SQLiteLukija()
+{
+    qDeleteAll(routes_);
+}
+
+void SQLiteLukija::avaa(const QString &polku)
+{
+    sulje();
+
+    {
+        QSqlDatabase yhteys = QSqlDatabase::addDatabase("QSQLITE", LUKUYHTEYS);
+        yhteys.setDatabaseName(polku);
+        yhteys.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if( !yhteys.open()) {
+            qWarning() << "SQLiteLukija: Lukuyhteyden avaaminen epäonnistui : " << yhteys.lastError().text();
+            return;
+        }
+
+        // Jos tiedosto on toisen yhteyden yksinoikeudella lukitsema
+        // tai ei ole WAL-tilassa, luetaan pääyhteydellä
+        QSqlQuery kysely(yhteys);
+        if( !kysely.exec("PRAGMA JOURNAL_MODE") || !kysely.next() ||
+            kysely.value(0).toString().compare("wal", Qt::CaseInsensitive)) {
+            qWarning() << "SQLiteLukija: Tiedostoa ei voi lukea rinnakkain " << kysely.lastError().text();
+            kysely.finish();
+            yhteys.close();
+            return;
+        }
+
+        // Ilman kahvaa käynnissä olevaa kyselyä ei voi keskeyttää,
+        // mutta sen tulos hylätään
+        kahva_ = sqliteKahva(yhteys);
+        mittari_.kiinnita(yhteys);
+    }
+    auki_ = true;
+}
+
+void SQLiteLukija::sulje()
+{
+    auki_ = false;
+    kahva_ = nullptr;
+    tyhjennaLauseet();
+    if( QSqlDatabase::contains(LUKUYHTEYS)) {
+        QSqlDatabase yhteys = QSqlDatabase::database(LUKUYHTEYS, false);
+        if( yhteys.isOpen())
+            mittari_.irrota(yhteys);
+        yhteys.close();
+        yhteys = QSqlDatabase();
+        QSqlDatabase::removeDatabase(LUKUYHTEYS);
+    }
+}
+
+void SQLiteLukija::keskeyta()
+{
+    kerta_++;
+#ifdef KITSAS_SYSTEM_SQLITE
+    sqlite3* kahva = kahva_;
+    if( kahva )
+        sqlite3_interrupt(kahva);
+#endif
+}
+
+SQLiteRoute *SQLiteLukija::reitti(SQLiteKysely *kysely) const
+{
+    for(SQLiteRoute* route : routes_) {
+        if( kysely->polku().startsWith(route->polku()))
+            return route->rinnakkainen( route->loppu(kysely->polku())) ? route : nullptr;
+    }
+    return nullptr;
+}
+
+void SQLiteLukija::lue(SQLiteKysely *kysely, SQLiteRoute *reitti, int kerta)
+{
+    // Lukijan hakuja on vähän, joten täyttynyt varasto vain tyhjennetään.
+    // Sen voi tehdä vain kyselyiden välissä, kun lauseita ei ole käytössä.
+    if( lauseet_.count() >= LAUSEITA_ENINTAAN)
+        tyhjennaLauseet();
+
+    QVariant vastaus;
+    try {
+        if( kerta != kerta_ || !auki_)
+            throw SQLiteVirhe(tr("Kirjanpito on suljettu"), 503);
+        SQLiteMittari::Mittaus mittaus(&mittari_, reitti->polku(), kysely->polku(), kysely->metodi());
+        vastaus = reitti->route(kysely, QVariant());
+        // Keskeytetyn kyselyn tulos voi olla vajaa
+        if( kerta != kerta_)
+            throw SQLiteVirhe(tr("Kirjanpito on suljettu"), 503);
+        mittaus.valmis(vastaus);
+        vapautaLauseet();
+    } catch (SQLiteVirhe &e) {
+        vapautaLauseet();
+        const int koodi = e.koodi();
+        const QString selitys = e.selitys();
+        QMetaObject::invokeMethod(kysely, [kysely, koodi, selitys] {
+            emit kysely->virhe(koodi, selitys);
+            qWarning() << "[" << koodi << " " << kysely->polku() << "] " << selitys;
+            kysely->deleteLater();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    QMetaObject::invokeMethod(kysely, [kysely, vastaus] {
+        kysely->vastaa(vastaus);
+        kysely->deleteLater();
+    }, Qt::QueuedConnection);
+}
+
+QSqlDatabase SQLiteLukija::tietokanta() const
+{
+    return QSqlDatabase::database(LUKUYHTEYS, false);
+}
+
+QList<QSqlRecord> SQLiteLukija::rivit(const QSqlDatabase &tietokanta, const QString &sql, const QVariantList &sidokset)
+{
+    QList<QSqlRecord> rivit;
+    QSqlQuery kysely(tietokanta);
+    kysely.setForwardOnly(true);
+    kysely.prepare(sql);
+    for(const QVariant& sidos : sidokset)
+        kysely.addBindValue(sidos);
+    if( !kysely.exec()) {
+        qWarning() << " *SQLVIRHE* " << kysely.lastError().text() << sql;
+        return rivit;
+    }
+    while( kysely.next())
+        rivit.append(kysely.record());
+    kysely.finish();
+    return rivit;
+}
+
+QSqlQuery SQLiteLukija::lause(const QString &pohja)
+{
+    QSqlQuery* kysely = lauseet_.value(pohja);
+    if( kysely ) {
+        kysely->finish();
+        kaytossa_.insert(pohja, *kysely);
+        return *kysely;
+    }
+
+    kysely = new QSqlQuery(tietokanta());
+    kysely->setForwardOnly(true);
+    if( !kysely->prepare(pohja))
+        qWarning() << " *SQLVIRHE* " << kysely->lastError().text() << pohja;
+    lauseet_.insert(pohja, kysely);
+    kaytossa_.insert(pohja, *kysely);
+    return *kysely;
+}
+
+void SQLiteLukija::tyhjennaLauseet()
+{
+    kaytossa_.clear();
+    qDeleteAll(lauseet_);
+    lauseet_.clear();
+}
+
+void SQLiteLukija::vapautaLauseet()
+{
+    // Avoin kursori pitäisi lukutilannekuvan auki hakujen välissä
+    for(QSqlQuery& kysely : kaytossa_)
+        kysely.finish();
+    kaytossa_.clear();
+}
@@ -0,0 +1,121 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SQLITELUKIJA_H
+#define SQLITELUKIJA_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QHash>
+
+#include "sqlitemittari.h"
+
+#include <atomic>
+
+class SQLiteModel;
+class SQLiteRoute;
+class SQLiteKysely;
+struct sqlite3;
+
+/**
+ * @brief Paikallisen kirjanpidon lukukyselyt omassa säikeessään
+ *
+ * Elää omassa säikeessään ja käyttää kirjanpitoon omaa, vain luku
+ * -tilassa avattua yhteyttään. Raskaat hakukyselyt (viennit, erät)
+ * suoritetaan näin käyttöliittymää pysäyttämättä, ja vastaukset
+ * toimitetaan kyselyn säikeeseen jonotettuina.
+ *
+ * Lukijalla on omat reittiolionsa, eikä se käytä Kirjanpito-oliota,
+ * joten rinnakkain voi suorittaa vain reitit, jotka eivät tarvitse
+ * muistiin ladattuja tietoja. Kirjoittaminen tehdään aina
+ * pääyhteydellä, ja WAL-lokin ansiosta lukija näkee jokaisen
+ * vahvistetun muutoksen.
+ *
+ * Lukuyhteydellä on oma mittarinsa, joka kirjaa kyselyt mallin
+ * mittarin puskuriin.
+ */
+class SQLiteLukija : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SQLiteLukija(SQLiteModel* model);
+    ~SQLiteLukija() override;
+
+    /**
+     * @brief Avaa lukuyhteyden, kutsutaan lukijan säikeessä
+     */
+    void avaa(const QString& polku);
+    /**
+     * @brief Sulkee lukuyhteyden, kutsutaan lukijan säikeessä
+     */
+    void sulje();
+    /**
+     * @brief Keskeyttää käynnissä olevan kyselyn ja hylkää jonossa olevat
+     *
+     * Voidaan kutsua mistä säikeestä tahansa ennen sulkemista.
+     */
+    void keskeyta();
+
+    bool auki() const { return auki_; }
+    int kerta() const { return kerta_; }
+
+    /**
+     * @brief Reitti, jolla kysely voidaan suorittaa lukijan säikeessä
+     * @return Reitti tai nullptr, jos kysely on suoritettava pääyhteydellä
+     */
+    SQLiteRoute* reitti(SQLiteKysely* kysely) const;
+
+    /**
+     * @brief Suorittaa kyselyn, kutsutaan lukijan säikeessä
+     * @param kerta Avauskerta, jolloin kysely jonotettiin
+     */
+    void lue(SQLiteKysely* kysely, SQLiteRoute* reitti, int kerta);
+
+    QSqlDatabase tietokanta() const;
+    SQLiteMittari* mittari() { return &mittari_; }
+
+    /**
+     * @brief Suorittaa hakukyselyn ja lukee kaikki sen rivit
+     *
+     * Kursori suljetaan ennen paluuta, joten rivit voi käsitellä
+     * vapaasti tapahtumasilmukan kierroksilla.
+     */
+    static QList<QSqlRecord> rivit(const QSqlDatabase& tietokanta, const QString& sql, const QVariantList& sidokset);
+    /**
+     * @brief Valmisteltu kysely lukuyhteydelle
+     *
+     * Kysely päätetään, kun haku on käsitelty.
+     */
+    QSqlQuery lause(const QString& pohja);
+
+    static const int LAUSEITA_ENINTAAN = 64;
+
+protected:
+    void tyhjennaLauseet();
+    void vapautaLauseet();
+
+    QList<SQLiteRoute*> routes_;
+    QHash<QString, QSqlQuery*> lauseet_;
+    QHash<QString, QSqlQuery> kaytossa_;
+    std::atomic_bool auki_;
+    std::atomic_int kerta_;
+    std::atomic<sqlite3*> kahva_;
+    SQLiteMittari mittari_;
+};
+
+#endif // SQLITELUKIJA_H
@@ -0,0 +1,325 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "sqlitemittari.h"
+#include "sqlitekahva.h"
+
+#include <QSqlDriver>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QDebug>
+
+#ifdef KITSAS_SYSTEM_SQLITE
+#include <sqlite3.h>
+#endif
+#include <algorithm>
+
+std::atomic_bool SQLiteMittari::kootMitataan_(false);
+thread_local SQLiteMittari* SQLiteMittari::saikeessa_ = nullptr;
+
+SQLiteMittari::SQLiteMittari(SQLiteMittari *kirjaamo) :
+    kirjaamo_(kirjaamo ? kirjaamo : this)
+{
+    bool ok = false;
+    const int raja = qEnvironmentVariableIntValue("KITSAS_HIDAS_KYSELY", &ok);
+    if( ok )
+        hidasRaja_ = raja;
+    riveittain_ = qEnvironmentVariableIsSet("KITSAS_KYSELYN_RIVIT");
+}
+
+void SQLiteMittari::kiinnita(QSqlDatabase tietokanta)
+{
+#ifdef KITSAS_SYSTEM_SQLITE
+    sqlite3* yhteys = sqliteKahva(tietokanta);
+    // Rivikohtainen jäljitys kutsutaan jokaiselle riville, joten se on käytössä vain pyydettäessä
+    if( yhteys )
+        sqlite3_trace_v2(yhteys, riveittain_ ? SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW : SQLITE_TRACE_PROFILE,
+                         &SQLiteMittari::jaljitys, this);
+#else
+    Q_UNUSED(tietokanta)
+#endif
+}
+
+void SQLiteMittari::irrota(QSqlDatabase tietokanta)
+{
+#ifdef KITSAS_SYSTEM_SQLITE
+    sqlite3* yhteys = sqliteKahva(tietokanta);
+    if( yhteys )
+        sqlite3_trace_v2(yhteys, 0, nullptr, nullptr);
+#else
+    Q_UNUSED(tietokanta)
+#endif
+    lauseenRivit_.clear();
+}
+
+QVariantList SQLiteMittari::kyselyt() const
+{
+    QMutexLocker lukko(&lukko_);
+    QVariantList lista;
+    const int alku = rengas_.count() < KYSELYITA ? 0 : seuraava_;
+    for(int i=0; i < rengas_.count(); i++)
+        lista.append( kartaksi( rengas_.at( (alku + i) % rengas_.count() ) ) );
+    return lista;
+}
+
+QVariantList SQLiteMittari::reitit() const
+{
+    struct Summa {
+        int maara = 0;
+        int lauseita = 0;
+        qint64 rivit = 0;
+        qint64 tavut = 0;
+        qint64 ns = 0;
+        qint64 enintaan = 0;
+    };
+    QHash<QString, Summa> summat;
+    QMutexLocker lukko(&lukko_);
+    for(const Kysely& kysely : qAsConst(rengas_)) {
+        Summa& summa = summat[kysely.reitti];
+        summa.maara++;
+        summa.lauseita += kysely.lauseita;
+        summa.rivit += kysely.rivit;
+        summa.tavut += qMax<qint64>(kysely.tavut, 0);
+        summa.ns += kysely.ns;
+        summa.enintaan = qMax(summa.enintaan, kysely.ns);
+    }
+    lukko.unlock();
+
+    QList<QPair<qint64,QVariantMap>> jarjestetty;
+    for(auto iter = summat.constBegin(); iter != summat.constEnd(); ++iter) {
+        QVariantMap map;
+        map.insert("reitti", iter.key());
+        map.insert("kyselyita", iter.value().maara);
+        map.insert("lauseita", iter.value().lauseita);
+        map.insert("riveja", iter.value().rivit);
+        map.insert("tavuja", iter.value().tavut);
+        map.insert("ms", iter.value().ns / 1e6);
+        map.insert("enintaan_ms", iter.value().enintaan / 1e6);
+        jarjestetty.append(qMakePair(iter.value().ns, map));
+    }
+    std::sort(jarjestetty.begin(), jarjestetty.end(),
+              [] (const QPair<qint64,QVariantMap>& a, const QPair<qint64,QVariantMap>& b) { return a.first > b.first; });
+
+    QVariantList lista;
+    for(const auto& pari : jarjestetty)
+        lista.append(pari.second);
+    return lista;
+}
+
+QByteArray SQLiteMittari::json() const
+{
+    QVariantMap map;
+    map.insert("reitit", reitit());
+    map.insert("kyselyt", kyselyt());
+    return QJsonDocument::fromVariant(map).toJson(QJsonDocument::Indented);
+}
+
+void SQLiteMittari::tyhjenna()
+{
+    QMutexLocker lukko(&lukko_);
+    rengas_.clear();
+    seuraava_ = 0;
+}
+
+void SQLiteMittari::aloita(const QString &reitti, const QString &polku, KpKysely::Metodi metodi)
+{
+    Kysely kysely;
+    kysely.aika = QDateTime::currentDateTime();
+    kysely.reitti = reitti;
+    kysely.polku = polku;
+    switch (metodi) {
+    case KpKysely::GET: kysely.metodi = "GET"; break;
+    case KpKysely::POST: kysely.metodi = "POST"; break;
+    case KpKysely::PATCH: kysely.metodi = "PATCH"; break;
+    case KpKysely::PUT: kysely.metodi = "PUT"; break;
+    case KpKysely::DELETE: kysely.metodi = "DELETE"; break;
+    }
+    kysely.mitataan = kootMitataan_;
+    kesken_.append(kysely);
+    kesken_.last().ajastin.start();
+    saikeessa_ = this;
+}
+
+void SQLiteMittari::lopeta(const QVariant &vastaus, bool virhe)
+{
+    if( kesken_.isEmpty())
+        return;
+
+    Kysely kysely = kesken_.takeLast();
+    if( kesken_.isEmpty() && saikeessa_ == this)
+        saikeessa_ = nullptr;
+    kysely.ns = kysely.ajastin.nsecsElapsed();
+    kysely.virhe = virhe;
+
+    // Osina lähetetyn vastauksen osien kokoja ei voi laskea jälkikäteen
+    const bool hidas = hidasRaja_ >= 0 && kysely.ns >= hidasRaja_ * 1000000LL;
+    if( kysely.mitataan || (hidas && !kysely.osia))
+        kysely.tavut = qMax<qint64>(kysely.tavut, 0) + koko(vastaus);
+
+    if( hidas )
+        kirjaaHidas(kysely);
+
+    kirjaamo_->tallenna(kysely);
+}
+
+void SQLiteMittari::mittaaKoot(bool mitataan)
+{
+    kootMitataan_ = mitataan;
+}
+
+void SQLiteMittari::osa(const QVariantList &rivit)
+{
+    SQLiteMittari* mittari = saikeessa_;
+    if( !mittari || mittari->kesken_.isEmpty())
+        return;
+    Kysely& kysely = mittari->kesken_.last();
+    kysely.osia++;
+    if( kysely.mitataan )
+        kysely.tavut = qMax<qint64>(kysely.tavut, 0) + koko(rivit);
+}
+
+void SQLiteMittari::tallenna(const Kysely &kysely)
+{
+    QMutexLocker lukko(&lukko_);
+    if( rengas_.count() < KYSELYITA)
+        rengas_.append(kysely);
+    else
+        rengas_[seuraava_] = kysely;
+    seuraava_ = (seuraava_ + 1) % KYSELYITA;
+}
+
+void SQLiteMittari::kirjaaHidas(const Kysely &kysely) const
+{
+    qWarning().noquote() << QString("Hidas kysely %1 ms: %2 %3 (%4 lausetta, %5 riviä, %6 tavua%7)")
+                            .arg(kysely.ns / 1e6, 0, 'f', 1)
+                            .arg(kysely.metodi, kysely.polku)
+                            .arg(kysely.lauseita)
+                            .arg(kysely.rivit)
+                            .arg(kysely.tavut >= 0 ? QString::number(kysely.tavut) : QString("?"))
+                            .arg(kysely.osia ? QString(", %1 osaa").arg(kysely.osia) : QString());
+    for(const Lause& lause : kysely.lauseet)
+        qWarning().noquote() << QString("   %1 ms %2 riviä: %3")
+                                .arg(lause.ns / 1e6, 0, 'f', 2)
+                                .arg(lause.rivit)
+                                .arg(lause.sql.simplified());
+}
+
+int SQLiteMittari::jaljitys(unsigned tyyppi, void *konteksti, void *p, void *x)
+{
+#ifdef KITSAS_SYSTEM_SQLITE
+    SQLiteMittari* mittari = static_cast<SQLiteMittari*>(konteksti);
+
+    if( tyyppi == SQLITE_TRACE_ROW ) {
+        // Rivit kirjataan lauseittain, koska lauseita voidaan lukea sisäkkäin
+        mittari->lauseenRivit_[p]++;
+        if( !mittari->kesken_.isEmpty())
+            mittari->kesken_.last().rivit++;
+    } else if( tyyppi == SQLITE_TRACE_PROFILE ) {
+        const qint64 rivit = mittari->lauseenRivit_.take(p);
+        if( mittari->kesken_.isEmpty())
+            return 0;
+
+        Kysely& kysely = mittari->kesken_.last();
+        kysely.lauseita++;
+        if( kysely.lauseet.count() < LAUSEITA_KYSELYSSA) {
+            Lause lause;
+            lause.sql = QString::fromUtf8( sqlite3_sql( static_cast<sqlite3_stmt*>(p) ) );
+            lause.ns = *static_cast<sqlite3_int64*>(x);
+            lause.rivit = rivit;
+            kysely.lauseet.append(lause);
+        }
+    }
+#else
+    Q_UNUSED(tyyppi) Q_UNUSED(konteksti) Q_UNUSED(p) Q_UNUSED(x)
+#endif
+    return 0;
+}
+
+qint64 SQLiteMittari::koko(const QVariant &arvo)
+{
+    // Arvioidaan vastauksen koko JSON-muodossa muodostamatta sitä
+    switch (arvo.type()) {
+    case QVariant::List:
+    {
+        qint64 tavut = 2;
+        for(const QVariant& alkio : arvo.toList())
+            tavut += koko(alkio) + 1;
+        return tavut;
+    }
+    case QVariant::Map:
+    {
+        const QVariantMap map = arvo.toMap();
+        qint64 tavut = 2;
+        for(auto iter = map.constBegin(); iter != map.constEnd(); ++iter)
+            tavut += iter.key().size() + 4 + koko(iter.value());
+        return tavut;
+    }
+    case QVariant::ByteArray:
+        return arvo.toByteArray().size();
+    case QVariant::String:
+        return arvo.toString().size() + 2;
+    case QVariant::Invalid:
+        return 0;
+    default:
+        return arvo.toString().size();
+    }
+}
+
+QVariantMap SQLiteMittari::kartaksi(const Kysely &kysely)
+{
+    QVariantMap map;
+    map.insert("aika", kysely.aika);
+    map.insert("reitti", kysely.reitti);
+    map.insert("polku", kysely.polku);
+    map.insert("metodi", kysely.metodi);
+    map.insert("lauseita", kysely.lauseita);
+    map.insert("riveja", kysely.rivit);
+    map.insert("tavuja", kysely.tavut >= 0 ? QVariant(kysely.tavut) : QVariant());
+    if( kysely.osia )
+        map.insert("osia", kysely.osia);
+    map.insert("ms", kysely.ns / 1e6);
+    if( kysely.virhe )
+        map.insert("virhe", true);
+
+    QVariantList lauseet;
+    for(const Lause& lause : kysely.lauseet) {
+        QVariantMap lmap;
+        lmap.insert("sql", lause.sql);
+        lmap.insert("ms", lause.ns / 1e6);
+        lmap.insert("riveja", lause.rivit);
+        lauseet.append(lmap);
+    }
+    map.insert("lauseet", lauseet);
+    return map;
+}
+
+SQLiteMittari::Mittaus::Mittaus(SQLiteMittari *mittari, const QString &reitti, const QString &polku, KpKysely::Metodi metodi) :
+    mittari_(mittari)
+{
+    mittari_->aloita(reitti, polku, metodi);
+}
+
+SQLiteMittari::Mittaus::~Mittaus()
+{
+    if( !valmis_ )
+        mittari_->lopeta(QVariant(), true);
+}
+
+void SQLiteMittari::Mittaus::valmis(const QVariant &vastaus)
+{
+    mittari_->lopeta(vastaus, false);
+    valmis_ = true;
+}
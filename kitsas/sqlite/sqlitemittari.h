@@ -0,0 +1,167 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SQLITEMITTARI_H
+#define SQLITEMITTARI_H
+
+#include "db/kpkysely.h"
+
+#include <QSqlDatabase>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+#include <atomic>
+
+/**
+ * @brief Paikallisen kirjanpidon kyselyiden mittaus
+ *
+ * Jokaisesta reititetystä kyselystä kirjataan reitti, metodi,
+ * suoritetut SQL-lauseet, palautetut rivit, vastauksen koko sekä
+ * kulunut aika. Kirjaukset säilytetään rengaspuskurissa, josta ne
+ * voi tarkastella kehittäjän työkaluissa.
+ *
+ * Lauseet ja rivit saadaan SQLiten jäljitysrajapinnasta, joten
+ * mittaus kattaa myös reittien suoraan suorittamat kyselyt. Jos
+ * yhteyden kahvaa ei voi käyttää (ks. sqliteKahva), kirjataan
+ * vain kyselyiden ajat ja vastausten koot.
+ *
+ * Palautettuja rivejä lasketaan vain, jos ympäristömuuttuja
+ * KITSAS_KYSELYN_RIVIT on asetettu, koska rivien jäljitys hidastaa
+ * jokaista luettua riviä. Muuten rivimääriksi kirjataan nolla.
+ *
+ * Lukijan säikeen yhteydellä on oma mittarinsa, joka kirjaa valmiit
+ * kyselyt pääyhteyden mittarin puskuriin. Puskuria suojaa lukko, mutta
+ * muuten mittaria käytetään vain sen yhteyden säikeessä.
+ *
+ * Vastausten koot lasketaan vain, kun kehittäjän työkalu on auki
+ * (ks. mittaaKoot) tai kysely kirjataan hitaaksi, koska laskeminen
+ * käy koko vastauksen läpi. Muulloin kooksi jää tyhjä.
+ *
+ * Jos ympäristömuuttuja KITSAS_HIDAS_KYSELY on asetettu, kirjataan
+ * lokiin kyselyt, joiden suorittaminen kesti vähintään muuttujassa
+ * annetun määrän millisekunteja lauseineen.
+ */
+class SQLiteMittari
+{
+public:
+    /**
+     * @param kirjaamo Mittari, jonka puskuriin valmiit kyselyt kirjataan,
+     *        oletuksena tämä mittari
+     */
+    explicit SQLiteMittari(SQLiteMittari* kirjaamo = nullptr);
+
+    /**
+     * @brief Mittaa yhden kyselyn reitityksen
+     *
+     * Mittaus päättyy valmis-kutsuun, tai jos reitti heittää
+     * poikkeuksen, olion tuhoutuessa.
+     */
+    class Mittaus {
+    public:
+        Mittaus(SQLiteMittari* mittari, const QString& reitti, const QString& polku, KpKysely::Metodi metodi);
+        ~Mittaus();
+        void valmis(const QVariant& vastaus);
+    private:
+        SQLiteMittari* mittari_;
+        bool valmis_ = false;
+    };
+
+    /**
+     * @brief Kytkee mittauksen avattuun tietokantaan
+     */
+    void kiinnita(QSqlDatabase tietokanta);
+    /**
+     * @brief Irrottaa mittauksen ennen tietokannan sulkemista
+     */
+    void irrota(QSqlDatabase tietokanta);
+
+    /**
+     * @brief Puskurissa olevat kyselyt vanhimmasta uusimpaan
+     */
+    QVariantList kyselyt() const;
+    /**
+     * @brief Kyselyt reiteittäin koottuna, hitain ensin
+     */
+    QVariantList reitit() const;
+    /**
+     * @brief Kyselyt ja reittien yhteenveto JSON-muodossa
+     */
+    QByteArray json() const;
+
+    void tyhjenna();
+
+    /**
+     * @brief Lasketaanko vastausten koot kaikista kyselyistä
+     */
+    static void mittaaKoot(bool mitataan);
+    /**
+     * @brief Kirjaa osina lähetetyn vastauksen osan saman säikeen käynnissä olevaan mittaukseen
+     */
+    static void osa(const QVariantList& rivit);
+
+    static const int KYSELYITA = 500;
+    static const int LAUSEITA_KYSELYSSA = 64;
+
+protected:
+    struct Lause {
+        QString sql;
+        qint64 ns = 0;
+        qint64 rivit = 0;
+    };
+
+    struct Kysely {
+        QDateTime aika;
+        QString reitti;
+        QString polku;
+        QString metodi;
+        QList<Lause> lauseet;
+        int lauseita = 0;
+        qint64 rivit = 0;
+        qint64 tavut = -1;
+        int osia = 0;
+        bool mitataan = false;
+        qint64 ns = 0;
+        bool virhe = false;
+        QElapsedTimer ajastin;
+    };
+
+    void aloita(const QString& reitti, const QString& polku, KpKysely::Metodi metodi);
+    void lopeta(const QVariant& vastaus, bool virhe);
+    void tallenna(const Kysely& kysely);
+    void kirjaaHidas(const Kysely& kysely) const;
+
+    static int jaljitys(unsigned tyyppi, void* konteksti, void* p, void* x);
+    static qint64 koko(const QVariant& arvo);
+    static QVariantMap kartaksi(const Kysely& kysely);
+
+    SQLiteMittari* kirjaamo_;
+    mutable QMutex lukko_;
+    QVector<Kysely> rengas_;
+    int seuraava_ = 0;
+
+    QList<Kysely> kesken_;
+    QHash<void*, qint64> lauseenRivit_;
+    int hidasRaja_ = -1;
+    bool riveittain_ = false;
+
+    static std::atomic_bool kootMitataan_;
+    static thread_local SQLiteMittari* saikeessa_;
+};
+
+#endif // SQLITEMITTARI_H
@@ -19,6 +19,9 @@
 #include "sqlitekysely.h"
 
 #include "sqlitealustaja.h"
+#include "liitelukija.h"
+#include "sqlitelukija.h"
+#include "verkkolevy.h"
 
 #include <QSettings>
 #include <QImage>
@@ -29,6 +32,10 @@
 #include <QApplication>
 #include <QJsonDocument>
 #include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+#include <QDir>
 
 #include "routes/initroute.h"
 #include "routes/tositeroute.h"
@@ -52,6 +59,7 @@
 #include "routes/tuontitulkki.h"
 #include "routes/inforoute.h"
 #include "routes/vakioviiteroute.h"
+#include "routes/hakuroute.h"
 
 #include "versio.h"
 
@@ -82,10 +90,23 @@ SQLiteModel::SQLiteModel(QObject *parent)
     lisaaRoute(new AlvRoute(this));
     lisaaRoute(new VakioviiteRoute(this));
     lisaaRoute(new InfoRoute(this));
+    lisaaRoute(new HakuRoute(this));
+
+    lukuSaie_ = new QThread(this);
+    lukuSaie_->setObjectName("SQLiteLukija");
+    lukija_ = new SQLiteLukija(this);
+    lukija_->moveToThread(lukuSaie_);
+    lukuSaie_->start();
 }
 
 SQLiteModel::~SQLiteModel()
 {
+    suljeLukuyhteys();
+    lukuSaie_->quit();
+    lukuSaie_->wait();
+    delete lukija_;
+    suljeLukijat();
+    tyhjennaLauseet();
     for( auto route : routes_)
         delete route;
 }
@@ -136,13 +157,44 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
 
     kp()->odotusKursori(true);
 
+    suljeLukuyhteys();
+    suljeLukijat();
+    tyhjennaLauseet();
+    mittari_.irrota(tietokanta_);
+    lukko_.reset();
     tietokanta_.setDatabaseName( polku );
     tiedostoPolku_.clear();
     if( asetaAktiiviseksi)
         kp()->yhteysAvattu(nullptr);
 
+    // Verkkolevyllä WAL-tilan jaettu muisti ei toimi eikä lukitustiedoston
+    // vanhentumista voi päätellä toiselta koneelta, joten siellä käytetään
+    // SQLiten yksinoikeustilaa kuten ennenkin ilman rinnakkaista lukijaa.
+    const bool verkossa = verkkolevylla(polku);
+
+    // Paikallisella levyllä lukitaan tiedosto, jotta kirjanpitoa ei voi avata
+    // samaan aikaan toisesta ohjelmasta. SQLiten yksinoikeustilaa ei käytetä,
+    // jotta lukijan säikeen yhteys voi lukea tiedostoa rinnakkain.
+#ifndef KITSAS_DEVEL
+    if( !verkossa ) {
+        lukko_.reset(new QLockFile(polku + ".lock"));
+        lukko_->setStaleLockTime(0);
+        if( !lukko_->tryLock()) {
+            lukko_.reset();
+            kp()->odotusKursori(false);
+            if( ilmoitavirheestaAvattaessa ) {
+                QMessageBox::critical(nullptr, tr("Kirjanpitoa ei voi avata"),
+                                      tr("Kirjanpitotiedosto %1 on jo käytössä.\n\n"
+                                         "Sulje kaikki Kitsas-ohjelman ikkunat ja yritä uudelleen.").arg(polku));
+            }
+            return false;
+        }
+    }
+#endif
+
     if( !tietokanta_.open())
     {
+        lukko_.reset();
         kp()->odotusKursori(false);
         if( ilmoitavirheestaAvattaessa ) {
             QMessageBox::critical(nullptr, tr("Tietokannan avaaminen epäonnistui"),
@@ -153,10 +205,10 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
         return false;
     }
 
-    // Lukitaan tietokanta, jotta käyttäminen on varmasti turvallista
-#ifndef KITSAS_DEVEL
-    tietokanta_.exec("PRAGMA LOCKING_MODE = EXCLUSIVE");
-#endif
+    mittari_.kiinnita(tietokanta_);
+
+    if( verkossa )
+        tietokanta_.exec("PRAGMA LOCKING_MODE = EXCLUSIVE");
     tietokanta_.exec("PRAGMA JOURNAL_MODE = WAL");
 
     QSqlQuery query( tietokanta_ );
@@ -182,6 +234,7 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
             }
         }
         tietokanta_.close();
+        lukko_.reset();
         return false;
     }
     // Tarkastetaan versio
@@ -195,6 +248,7 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
                                      "osoitteesta https://kitsas.fi")
                                   .arg( qApp->applicationVersion() ));
             tietokanta_.close();
+            lukko_.reset();
             return false;
         } else if( versio < TIETOKANTAVERSIO) {
             kp()->odotusKursori(false);
@@ -202,39 +256,25 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
                                      tr("Avataksesi kirjanpidon pitää se päivittää yhteensopivaksi nykyisen version kanssa. Päivityksen jälkeen kirjanpitoa ei voi enää avata varhaisemmilla esiversioilla. "
                                         "\nPäivitetäänkö kirjanpito nyt?"), QMessageBox::Yes | QMessageBox::Cancel, QMessageBox::Cancel)!= QMessageBox::Yes) {
                 tietokanta_.close();
+                lukko_.reset();
                 return false;
             }
             kp()->odotusKursori(false);
-            // #603 IBAN siirretään omaan tietokantakenttään, jotta säilyy päivitysten ylitse
-            if( versio < 24) {
-                query.exec("ALTER TABLE Tili ADD COLUMN iban VARCHAR(32)");
-                QSqlQuery ibanquery( tietokanta_ );
-                ibanquery.exec("SELECT numero,json FROM Tili WHERE tyyppi='ARP'");
-                while(ibanquery.next()) {
-                    QVariantMap map = QJsonDocument::fromJson(ibanquery.value("json").toByteArray()).toVariant().toMap();
-                    if( map.contains("JSON")) {
-                        query.exec(QString("UPDATE Tili SET IBAN='%1' WHERE numero=%2").arg(ibanquery.value("numero").toInt()).arg(map.value("IBAN").toString()));
-                    }
-                }
-            }
-            // #539 Vakioviitteiden taulun luominen
-            if( versio < 23 )
-                query.exec("CREATE TABLE Vakioviite ( viite integer PRIMARY KEY NOT NULL, tili INTEGER REFERENCES Tili(numero) ON DELETE CASCADE, kohdennus INTEGER REFERENCES Kohdennus(id) ON DELETE CASCADE, "
-                        " otsikko TEXT, alkaen DATE, paattyen DATE, json TEXT) ");
-            if( versio < 22) {
-                // Ensimmäisen version jälkeen on lisätty kenttä laskupäivälle
-                query.exec("ALTER TABLE Tosite ADD COLUMN laskupvm DATE");
-                query.exec("ALTER TABLE Tosite ADD COLUMN erapvm DATE");
-                query.exec("ALTER TABLE Tosite ADD COLUMN viite TEXT");
-                query.exec("ALTER TABLE Vienti ADD COLUMN arkistotunnus TEXT");
-                query.exec("UPDATE Tosite SET erapvm =(SELECT MAX(erapvm) FROM Vienti WHERE Vienti.tosite=Tosite.id");
-                query.exec("UPDATE Tosite SET viite =(SELECT MAX(viite) FROM Vienti WHERE Vienti.tosite=Tosite.id");
-
-                if( versio == 21) {
-                    query.exec("UPDATE Tosite SET laskupvm =(SELECT MAX(laskupvm) FROM Vienti WHERE Vienti.tosite=Tosite.id");
-                } else {
-                    query.exec("UPDATE Tosite SET laskupvm=pvm");
-                }
+            // Päivitykset tehdään versioittain vanhimmasta alkaen, ja versionumero
+            // päivitetään vasta, kun kaikki ovat onnistuneet
+            bool paivitetty = paivitaRakenne(tietokanta_, versio);
+            // Koosteet muodostetaan vienneistä, kun taulut ovat paikallaan
+            if( versio < 25 && paivitetty)
+                paivitetty = rakennaSaldot();
+            if( versio < 29 && paivitetty)
+                paivitetty = rakennaKausikooste();
+            if( !paivitetty ) {
+                // Versio jää ennalleen, jolloin päivitys yritetään seuraavalla avauksella uudelleen
+                QMessageBox::critical(nullptr, tr("Kirjanpidon päivittäminen"),
+                                      tr("Kirjanpidon %1 päivittäminen epäonnistui.").arg(polku));
+                tietokanta_.close();
+                lukko_.reset();
+                return false;
             }
             query.exec(QString("UPDATE Asetus SET arvo=%1 WHERE avain='KpVersio'").arg(TIETOKANTAVERSIO));
         }
@@ -245,6 +285,7 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
                               tr("Valitsemasi tiedosto ei ole Kitsaan tietokanta, tai tiedosto on vahingoittunut."));
         qDebug() << tietokanta_.lastError().text();
         tietokanta_.close();
+        lukko_.reset();
         return false;
     }        
 
@@ -261,12 +302,91 @@ bool SQLiteModel::avaaTiedosto(const QString &polku, bool ilmoitavirheestaAvatta
 
     tiedostoPolku_ = polku;
 
+    alustaHakuindeksi();
     alusta();
     if( asetaAktiiviseksi)
         lisaaViimeisiin();   
 
     connect( kp(), &Kirjanpito::perusAsetusMuuttui, this, &SQLiteModel::lisaaViimeisiin );
 
+    // Yksinoikeustilassa toinen yhteys ei pääse tiedostoon, joten
+    // kaikki kyselyt tehdään tällöin tämän yhteyden kautta
+    if( !verkossa )
+        avaaLukuyhteys(polku);
+
+    return true;
+}
+
+bool SQLiteModel::paivitaRakenne(QSqlDatabase &tietokanta, int versio)
+{
+    QSqlQuery query( tietokanta );
+    if( versio < 22) {
+        // Ensimmäisen version jälkeen on lisätty kenttä laskupäivälle
+        query.exec("ALTER TABLE Tosite ADD COLUMN laskupvm DATE");
+        query.exec("ALTER TABLE Tosite ADD COLUMN erapvm DATE");
+        query.exec("ALTER TABLE Tosite ADD COLUMN viite TEXT");
+        query.exec("ALTER TABLE Vienti ADD COLUMN arkistotunnus TEXT");
+        query.exec("UPDATE Tosite SET erapvm =(SELECT MAX(erapvm) FROM Vienti WHERE Vienti.tosite=Tosite.id");
+        query.exec("UPDATE Tosite SET viite =(SELECT MAX(viite) FROM Vienti WHERE Vienti.tosite=Tosite.id");
+
+        if( versio == 21) {
+            query.exec("UPDATE Tosite SET laskupvm =(SELECT MAX(laskupvm) FROM Vienti WHERE Vienti.tosite=Tosite.id");
+        } else {
+            query.exec("UPDATE Tosite SET laskupvm=pvm");
+        }
+    }
+    // #539 Vakioviitteiden taulun luominen
+    if( versio < 23 )
+        query.exec("CREATE TABLE Vakioviite ( viite integer PRIMARY KEY NOT NULL, tili INTEGER REFERENCES Tili(numero) ON DELETE CASCADE, kohdennus INTEGER REFERENCES Kohdennus(id) ON DELETE CASCADE, "
+                " otsikko TEXT, alkaen DATE, paattyen DATE, json TEXT) ");
+    // #603 IBAN siirretään omaan tietokantakenttään, jotta säilyy päivitysten ylitse
+    if( versio < 24) {
+        query.exec("ALTER TABLE Tili ADD COLUMN iban VARCHAR(32)");
+        QSqlQuery ibanquery( tietokanta );
+        ibanquery.exec("SELECT numero,json FROM Tili WHERE tyyppi='ARP'");
+        while(ibanquery.next()) {
+            QVariantMap map = QJsonDocument::fromJson(ibanquery.value("json").toByteArray()).toVariant().toMap();
+            if( map.contains("JSON")) {
+                query.exec(QString("UPDATE Tili SET IBAN='%1' WHERE numero=%2").arg(ibanquery.value("numero").toInt()).arg(map.value("IBAN").toString()));
+            }
+        }
+    }
+
+    // Uudemmat päivitykset voi ajaa uudelleen, joten ne keskeytetään ensimmäiseen virheeseen
+    QStringList lauseet;
+    // Kuukausittaiset saldot ylläpidetään omassa taulussaan
+    if( versio < 25) {
+        lauseet << "CREATE TABLE IF NOT EXISTS Saldo (tili INTEGER NOT NULL, kohdennus INTEGER NOT NULL DEFAULT(0), kuukausi DATE NOT NULL, "
+                   "debetsnt BIGINT DEFAULT(0), kreditsnt BIGINT DEFAULT(0), PRIMARY KEY (tili, kohdennus, kuukausi))"
+                << "CREATE INDEX IF NOT EXISTS saldo_kuukausi ON Saldo (kuukausi)";
+    }
+    // Erien ja saldojen hakujen käyttämät yhdistelmäindeksit
+    if( versio < 26) {
+        lauseet << "DROP INDEX IF EXISTS vienti_tili"
+                << "DROP INDEX IF EXISTS tosite_tila"
+                << "CREATE INDEX IF NOT EXISTS vienti_tili_pvm ON Vienti (tili, pvm, tosite, debetsnt, kreditsnt)"
+                << "CREATE INDEX IF NOT EXISTS vienti_era_pvm ON Vienti (eraid, pvm, tosite, debetsnt, kreditsnt)"
+                << "CREATE INDEX IF NOT EXISTS tosite_tila_pvm ON Tosite (tila, pvm)"
+                << "CREATE INDEX IF NOT EXISTS merkkaus_kohdennus ON Merkkaus (kohdennus)";
+    }
+    // Liitteiden sisältö tallennetaan tiivisteen mukaan vain kerran
+    if( versio < 27) {
+        lauseet << "CREATE TABLE IF NOT EXISTS LiiteData (sha text PRIMARY KEY NOT NULL, data bytea, viittauksia integer NOT NULL DEFAULT(0))"
+                << "CREATE INDEX IF NOT EXISTS liite_sha ON Liite (sha)";
+    }
+    // Versiossa 28 lisätty hakuindeksi luodaan avattaessa, ks. alustaHakuindeksi
+    // Tilikausien yhteenvedot ylläpidetään omassa taulussaan
+    if( versio < 29) {
+        lauseet << "CREATE TABLE IF NOT EXISTS Tilikausikooste (alkaa date PRIMARY KEY NOT NULL, tasemuutos BIGINT NOT NULL DEFAULT(0), "
+                   "tulos BIGINT NOT NULL DEFAULT(0), liikevaihto BIGINT NOT NULL DEFAULT(0), viimeinen date, paivitetty timestamp)";
+    }
+
+    for(const QString& lause : lauseet) {
+        if( !query.exec(lause)) {
+            qWarning() << "SQLiteModel: Tietokannan päivitys epäonnistui " << lause << " " << query.lastError().text();
+            return false;
+        }
+    }
     return true;
 }
 
@@ -319,8 +439,37 @@ KpKysely *SQLiteModel::kysely(const QString &polku, KpKysely::Metodi metodi)
 
 void SQLiteModel::sulje()
 {
-    tietokanta_.exec("DELETE FROM Liite WHERE tosite IS NULL");
+    // Poistetaan tositteettomat liitteet. Vain Liite-taulussa sisältönsä
+    // säilyttävät vanhat liitteet eivät ole viitanneet LiiteData-tauluun.
+    const QStringList poistot = {
+        "UPDATE LiiteData SET viittauksia = viittauksia - "
+        "(SELECT COUNT(*) FROM Liite WHERE Liite.tosite IS NULL AND Liite.data IS NULL AND Liite.sha=LiiteData.sha) "
+        "WHERE sha IN (SELECT sha FROM Liite WHERE tosite IS NULL AND data IS NULL)",
+        "DELETE FROM Liite WHERE tosite IS NULL",
+        "DELETE FROM LiiteData WHERE viittauksia < 1"
+    };
+    if( tietokanta_.isOpen()) {
+        tietokanta_.transaction();
+        QSqlQuery query( tietokanta_ );
+        bool onnistui = true;
+        for(const QString& lause : poistot) {
+            if( !query.exec(lause)) {
+                qWarning() << "Liitteiden siivoaminen epäonnistui " << query.lastError().text();
+                onnistui = false;
+                break;
+            }
+        }
+        if( onnistui )
+            tietokanta_.commit();
+        else
+            tietokanta_.rollback();
+    }
+    suljeLukuyhteys();
+    suljeLukijat();
+    tyhjennaLauseet();
+    mittari_.irrota(tietokanta_);
     tietokanta_.close();
+    lukko_.reset();
     tiedostoPolku_.clear();
     disconnect( kp(), &Kirjanpito::perusAsetusMuuttui, this, &SQLiteModel::lisaaViimeisiin );
 }
@@ -347,13 +496,376 @@ bool SQLiteModel::uusiKirjanpito(const QString &polku, const QVariantMap &initia
     return SqliteAlustaja::luoKirjanpito(polku, initials);
 }
 
+bool SQLiteModel::rakennaSaldot()
+{
+    tietokanta_.transaction();
+    QSqlQuery query( tietokanta_ );
+    query.exec("DELETE FROM Saldo");
+    query.exec("INSERT INTO Saldo(tili, kohdennus, kuukausi, debetsnt, kreditsnt) "
+               "SELECT Vienti.tili, IFNULL(Vienti.kohdennus,0), strftime('%Y-%m-01',Vienti.pvm), "
+               "IFNULL(SUM(Vienti.debetsnt),0), IFNULL(SUM(Vienti.kreditsnt),0) "
+               "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+               "WHERE Tosite.tila >= 100 AND Vienti.pvm IS NOT NULL GROUP BY 1,2,3");
+    if( query.lastError().isValid()) {
+        qWarning() << "Saldojen muodostaminen epäonnistui " << query.lastError().text();
+        tietokanta_.rollback();
+        return false;
+    }
+    return tietokanta_.commit();
+}
+
+bool SQLiteModel::rakennaKausikooste()
+{
+    tietokanta_.transaction();
+    QSqlQuery query( tietokanta_ );
+    query.exec("DELETE FROM Tilikausikooste");
+    query.exec("INSERT INTO Tilikausikooste(alkaa, tasemuutos, tulos, liikevaihto, viimeinen, paivitetty) "
+               + SQLiteRoute::kausikoosteKysely());
+    if( query.lastError().isValid()) {
+        qWarning() << "Tilikausien yhteenvetojen muodostaminen epäonnistui " << query.lastError().text();
+        tietokanta_.rollback();
+        return false;
+    }
+    return tietokanta_.commit();
+}
+
+void SQLiteModel::alustaHakuindeksi()
+{
+    // Hakuindeksi vaatii SQLiten FTS5-laajennuksen. Ilman sitä haku tehdään
+    // hitaammin suoraan tositteista, ja indeksi luodaan vasta, kun kirjanpito
+    // avataan ohjelmalla, jonka SQLite tukee FTS5:tä.
+    QSqlQuery query( tietokanta_ );
+    hakuindeksi_ = query.exec("CREATE VIRTUAL TABLE temp.Fts5Testi USING fts5(teksti)");
+    if( !hakuindeksi_ ) {
+        qInfo() << "SQLite ilman FTS5-tukea, hakuindeksi ei ole käytössä";
+        return;
+    }
+    query.exec("DROP TABLE temp.Fts5Testi");
+
+    query.exec("SELECT name FROM sqlite_master WHERE type='table' AND name='Haku'");
+    if( query.next())
+        return;
+
+    if( !query.exec("CREATE VIRTUAL TABLE Haku USING fts5(tunniste, otsikko, selite, kumppani, prefix='2 3')")) {
+        qWarning() << "Hakuindeksin luominen epäonnistui " << query.lastError().text();
+        hakuindeksi_ = false;
+        return;
+    }
+    paivitaHakuindeksi();
+}
+
+void SQLiteModel::paivitaHakuindeksi(const QString &ehto)
+{
+    if( !hakuindeksi_ )
+        return;
+
+    const QString tositteet = ehto.isEmpty() ? "1=1" : ehto;
+    QSqlQuery query( tietokanta_ );
+    query.exec(QString("DELETE FROM Haku WHERE rowid IN (SELECT id FROM Tosite WHERE %1)").arg(tositteet));
+    query.exec(QString("INSERT INTO Haku(rowid, tunniste, otsikko, selite, kumppani) "
+               "SELECT Tosite.id, TRIM(IFNULL(Tosite.sarja,'') || ' ' || IFNULL(Tosite.tunniste,'')), Tosite.otsikko, "
+               "(SELECT GROUP_CONCAT(DISTINCT Vienti.selite) FROM Vienti WHERE Vienti.tosite=Tosite.id), "
+               "(SELECT GROUP_CONCAT(Kumppani.nimi, ' ') FROM Kumppani WHERE Kumppani.id=Tosite.kumppani "
+               "OR Kumppani.id IN (SELECT Vienti.kumppani FROM Vienti WHERE Vienti.tosite=Tosite.id)) "
+               "FROM Tosite WHERE %1").arg(tositteet));
+    if( query.lastError().isValid())
+        qWarning() << "Hakuindeksin päivittäminen epäonnistui " << query.lastError().text();
+}
+
+QVariantList SQLiteModel::tarkastaSaldot()
+{
+    QVariantList poikkeamat;
+    QSqlQuery query( tietokanta_ );
+    query.exec("SELECT tili, kohdennus, kuukausi, SUM(debetsnt), SUM(kreditsnt) FROM ("
+               "SELECT tili, kohdennus, kuukausi, debetsnt, kreditsnt FROM Saldo "
+               "UNION ALL "
+               "SELECT Vienti.tili, IFNULL(Vienti.kohdennus,0), strftime('%Y-%m-01',Vienti.pvm), "
+               "0 - IFNULL(Vienti.debetsnt,0), 0 - IFNULL(Vienti.kreditsnt,0) "
+               "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+               "WHERE Tosite.tila >= 100 AND Vienti.pvm IS NOT NULL) "
+               "GROUP BY tili, kohdennus, kuukausi HAVING SUM(debetsnt) <> 0 OR SUM(kreditsnt) <> 0");
+    while( query.next()) {
+        QVariantMap map;
+        map.insert("tili", query.value(0).toInt());
+        map.insert("kohdennus", query.value(1).toInt());
+        map.insert("kuukausi", query.value(2).toDate());
+        map.insert("debetsnt", query.value(3).toLongLong());
+        map.insert("kreditsnt", query.value(4).toLongLong());
+        poikkeamat.append(map);
+    }
+    return poikkeamat;
+}
+
+QVariantList SQLiteModel::tarkastaKausikooste()
+{
+    QHash<QString, QVariantList> tallennetut;
+    QSqlQuery query( tietokanta_ );
+    query.exec("SELECT alkaa, tasemuutos, tulos, liikevaihto, viimeinen FROM Tilikausikooste");
+    while( query.next())
+        tallennetut.insert( query.value(0).toString(),
+                            { query.value(1).toLongLong(), query.value(2).toLongLong(),
+                              query.value(3).toLongLong(), query.value(4).toString() });
+
+    QVariantList poikkeamat;
+    const QVariantList tyhja = { 0LL, 0LL, 0LL, QString() };
+    const QStringList kentat = { "tasemuutos", "tulos", "liikevaihto", "viimeinen"};
+    auto vertaa = [&poikkeamat, &kentat] (const QString& alkaa, const QVariantList& tallennettu, const QVariantList& laskettu) {
+        if( tallennettu == laskettu )
+            return;
+        QVariantMap map;
+        map.insert("alkaa", alkaa);
+        for(int i=0; i < kentat.count(); i++) {
+            map.insert(kentat.at(i), tallennettu.value(i));
+            map.insert(kentat.at(i) + "_laskettu", laskettu.value(i));
+        }
+        poikkeamat.append(map);
+    };
+
+    query.exec( SQLiteRoute::kausikoosteKysely() );
+    while( query.next()) {
+        const QString alkaa = query.value(0).toString();
+        const QVariantList laskettu = { query.value(1).toLongLong(), query.value(2).toLongLong(),
+                                        query.value(3).toLongLong(), query.value(4).toString() };
+        vertaa( alkaa, tallennetut.contains(alkaa) ? tallennetut.take(alkaa) : tyhja, laskettu);
+    }
+    for(auto iter = tallennetut.constBegin(); iter != tallennetut.constEnd(); ++iter)
+        vertaa( iter.key(), iter.value(), tyhja);
+
+    return poikkeamat;
+}
+
+QVariantMap SQLiteModel::tiivistaLiitteet()
+{
+    QVariantMap tulos;
+    tulos.insert("ennen", QFileInfo(tiedostoPolku_).size());
+    suljeLukijat();
+
+    tietokanta_.transaction();
+    QSqlQuery query( tietokanta_ );
+
+    // Tiiviste vanhoille liitteille, joilta se puuttuu
+    QSqlQuery paivitys( tietokanta_ );
+    paivitys.prepare("UPDATE Liite SET sha=? WHERE id=?");
+    query.exec("SELECT id, data FROM Liite WHERE sha IS NULL AND data IS NOT NULL");
+    while( query.next()) {
+        paivitys.addBindValue( LiitteetRoute::hash( query.value(1).toByteArray() ));
+        paivitys.addBindValue( query.value(0) );
+        if( !paivitys.exec()) {
+            qWarning() << "Liitteiden tiivistäminen epäonnistui " << paivitys.lastError().text();
+            tietokanta_.rollback();
+            return QVariantMap();
+        }
+    }
+
+    // Viittauksiksi lasketaan vain liitteet, joiden sisältö on LiiteData-taulussa
+    const QStringList siirrot = {
+        "INSERT INTO LiiteData(sha, data) SELECT sha, data FROM Liite "
+        "WHERE sha IS NOT NULL AND data IS NOT NULL GROUP BY sha "
+        "ON CONFLICT(sha) DO NOTHING",
+        "UPDATE Liite SET data=NULL WHERE data IS NOT NULL AND sha IN (SELECT sha FROM LiiteData)",
+        "UPDATE LiiteData SET viittauksia=(SELECT COUNT(*) FROM Liite WHERE Liite.sha=LiiteData.sha AND Liite.data IS NULL)",
+        "DELETE FROM LiiteData WHERE viittauksia < 1"
+    };
+    for(const QString& lause : siirrot) {
+        if( !query.exec(lause)) {
+            qWarning() << "Liitteiden tiivistäminen epäonnistui " << query.lastError().text();
+            tietokanta_.rollback();
+            return QVariantMap();
+        }
+    }
+    tietokanta_.commit();
+
+    query.exec("SELECT COUNT(*) FROM LiiteData");
+    if( query.next())
+        tulos.insert("tiedostoja", query.value(0).toInt());
+    query.finish();
+
+    // VACUUM ei onnistu, jos yksikin kysely on kesken
+    tyhjennaLauseet();
+    query.exec("VACUUM");
+    tulos.insert("jalkeen", QFileInfo(tiedostoPolku_).size());
+    return tulos;
+}
+
+QIODevice *SQLiteModel::liiteLukija(int liiteId)
+{
+    QSqlQuery query( tietokanta_ );
+    query.exec(QString("SELECT LiiteData.rowid FROM Liite LEFT OUTER JOIN LiiteData ON Liite.sha=LiiteData.sha "
+                       "WHERE Liite.id=%1").arg(liiteId));
+    if( !query.next())
+        return nullptr;
+
+    // Vanhoissa tiedostoissa sisältö voi olla vielä Liite-taulussa
+    const QVariant dataRivi = query.value(0);
+    query.finish();
+    LiiteLukija* lukija = dataRivi.isNull() ?
+                new LiiteLukija(tietokanta_, "Liite", liiteId) :
+                new LiiteLukija(tietokanta_, "LiiteData", dataRivi.toLongLong());
+    if( !lukija->isOpen()) {
+        delete lukija;
+        return nullptr;
+    }
+
+    lukijat_.removeAll(nullptr);
+    lukijat_.append(lukija);
+    return lukija;
+}
+
+QSqlQuery SQLiteModel::lause(const QString &pohja)
+{
+    ValmisteltuLause* lause = lauseet_.value(pohja);
+    if( lause ) {
+        lauseOsumat_++;
+        lause->kysely.finish();
+    } else {
+        lauseOhitukset_++;
+
+        // Varasto on rajallinen, joten harvimmin käytetty poistetaan
+        if( lauseet_.count() >= LAUSEITA_ENINTAAN ) {
+            QString vanhin;
+            quint64 vanhinKaytto = lauseKaytto_;
+            for(auto iter = lauseet_.constBegin(); iter != lauseet_.constEnd(); ++iter) {
+                if( iter.value()->kaytetty < vanhinKaytto) {
+                    vanhin = iter.key();
+                    vanhinKaytto = iter.value()->kaytetty;
+                }
+            }
+            delete lauseet_.take(vanhin);
+        }
+
+        lause = new ValmisteltuLause;
+        lause->kysely = QSqlQuery(tietokanta_);
+        lause->kysely.setForwardOnly(true);
+        QElapsedTimer ajastin;
+        ajastin.start();
+        if( !lause->kysely.prepare(pohja))
+            qWarning() << " *SQLVIRHE* " << lause->kysely.lastError().text() << pohja;
+        valmisteluNs_ += ajastin.nsecsElapsed();
+        lauseet_.insert(pohja, lause);
+    }
+    lause->kaytetty = ++lauseKaytto_;
+    kaytossa_.insert(pohja, lause->kysely);
+    return lause->kysely;
+}
+
+QVariantMap SQLiteModel::lauseTilasto() const
+{
+    QVariantMap map;
+    map.insert("lauseita", lauseet_.count());
+    map.insert("osumat", lauseOsumat_);
+    map.insert("ohitukset", lauseOhitukset_);
+    map.insert("valmistelums", valmisteluNs_ / 1000000.0);
+    return map;
+}
+
+void SQLiteModel::suljeLukijat()
+{
+    for(auto& lukija : lukijat_) {
+        if( lukija )
+            lukija->close();
+    }
+    lukijat_.clear();
+}
+
+void SQLiteModel::avaaLukuyhteys(const QString &polku)
+{
+    SQLiteLukija* lukija = lukija_;
+    QMetaObject::invokeMethod(lukija, [lukija, polku] { lukija->avaa(polku); }, Qt::BlockingQueuedConnection);
+}
+
+void SQLiteModel::suljeLukuyhteys()
+{
+    // Keskeneräinen haku keskeytetään, jotta sulkemista ei tarvitse odottaa
+    SQLiteLukija* lukija = lukija_;
+    lukija->keskeyta();
+    QMetaObject::invokeMethod(lukija, [lukija] { lukija->sulje(); }, Qt::BlockingQueuedConnection);
+}
+
+void SQLiteModel::tyhjennaLauseet()
+{
+    kaytossa_.clear();
+    qDeleteAll(lauseet_);
+    lauseet_.clear();
+}
+
+SQLiteModel::Reititys::Reititys(SQLiteModel *model) :
+    model_(model)
+{
+    model_->reitityksia_++;
+}
+
+SQLiteModel::Reititys::~Reititys()
+{
+    // Osina vastattaessa voidaan reitittää sisäkkäin, jolloin
+    // ulomman reitityksen kyselyä ei saa päättää kesken
+    if( --model_->reitityksia_ == 0)
+        model_->vapautaLauseet();
+}
+
+void SQLiteModel::vapautaLauseet()
+{
+    // Aktiivinen SELECT pitäisi lukutilannekuvan auki ja estäisi
+    // WAL-tiedoston tarkistuspisteen
+    for(QSqlQuery& kysely : kaytossa_)
+        kysely.finish();
+    kaytossa_.clear();
+}
+
+bool SQLiteModel::lueRinnakkain(SQLiteKysely *kysely)
+{
+    if( kysely->metodi() != KpKysely::GET || !lukija_->auki())
+        return false;
+
+    SQLiteRoute* reitti = lukija_->reitti(kysely);
+    if( !reitti )
+        return false;
+
+    qInfo() << kysely->polku() + " " + kysely->urlKysely().toString();
+
+    SQLiteLukija* lukija = lukija_;
+    const int kerta = lukija->kerta();
+    QMetaObject::invokeMethod(lukija, [lukija, kysely, reitti, kerta] {
+        lukija->lue(kysely, reitti, kerta);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SQLiteModel::haeRivit(const QString &sql, const QVariantList &sidokset, QObject *vastaanottaja,
+                           std::function<void (const QList<QSqlRecord> &)> valmis)
+{
+    if( !lukija_->auki()) {
+        valmis( SQLiteLukija::rivit(tietokanta(), sql, sidokset) );
+        return;
+    }
+
+    SQLiteLukija* lukija = lukija_;
+    const int kerta = lukija->kerta();
+    QPointer<QObject> kohde(vastaanottaja);
+    QMetaObject::invokeMethod(lukija, [this, lukija, kerta, sql, sidokset, kohde, valmis] {
+        if( kerta != lukija->kerta() || !lukija->auki())
+            return;
+        SQLiteMittari::Mittaus mittaus(lukija->mittari(), "rivit", sql.simplified(), KpKysely::GET);
+        const QList<QSqlRecord> rivit = SQLiteLukija::rivit(lukija->tietokanta(), sql, sidokset);
+        mittaus.valmis(QVariant());
+        // Malli elää lukijaa pidempään, joten vastaus välitetään sen kautta
+        QMetaObject::invokeMethod(this, [lukija, kerta, kohde, valmis, rivit] {
+            if( kohde && kerta == lukija->kerta())
+                valmis(rivit);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
 void SQLiteModel::reitita(SQLiteKysely* reititettavakysely, const QVariant &data)
 {
     qInfo() << reititettavakysely->polku() + " " + reititettavakysely->urlKysely().toString();
 
     for( SQLiteRoute* route : routes_) {
         if( reititettavakysely->polku().startsWith( route->polku() ) ) {
-            reititettavakysely->vastaa(route->route( reititettavakysely, data));
+            Reititys reititys{this};
+            SQLiteMittari::Mittaus mittaus(&mittari_, route->polku(), reititettavakysely->polku(), reititettavakysely->metodi());
+            const QVariant vastaus = route->route( reititettavakysely, data);
+            mittaus.valmis(vastaus);
+            reititettavakysely->vastaa(vastaus);
             return;
         }
     }
@@ -365,7 +877,11 @@ void SQLiteModel::reitita(SQLiteKysely *reititettavakysely, const QByteArray &ba
 {
     for( SQLiteRoute* route : routes_) {
         if( reititettavakysely->polku().startsWith( route->polku() ) ) {
-            reititettavakysely->vastaaLisayksesta( route->byteArray(reititettavakysely, ba, meta) );
+            Reititys reititys{this};
+            SQLiteMittari::Mittaus mittaus(&mittari_, route->polku(), reititettavakysely->polku(), reititettavakysely->metodi());
+            const QPair<const QVariant, int> tulos = route->byteArray(reititettavakysely, ba, meta);
+            mittaus.valmis(tulos.first);
+            reititettavakysely->vastaaLisayksesta( tulos );
             return;
         }
     }
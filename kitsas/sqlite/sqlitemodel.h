@@ -19,10 +19,21 @@
 
 #include "db/yhteysmodel.h"
 #include "sqlitekysely.h"
+#include "sqlitemittari.h"
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QHash>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QLockFile>
+
+#include <functional>
 
 class SQLiteRoute;
+class SQLiteLukija;
+class QThread;
 
 class SQLiteModel : public YhteysModel
 {
@@ -55,6 +66,123 @@ public:
 
     bool uusiKirjanpito(const QString& polku, const QVariantMap& initials);
 
+    /**
+     * @brief Päivittää vanhemman tietokannan taulut ja indeksit nykyiseen versioon
+     *
+     * Päivitykset tehdään versioittain vanhimmasta alkaen. Vienneistä
+     * muodostettavat koosteet rakennetaan tämän jälkeen erikseen.
+     *
+     * @param versio Tietokannan nykyinen versio
+     * @return Onnistuiko päivitys
+     */
+    static bool paivitaRakenne(QSqlDatabase& tietokanta, int versio);
+
+    /**
+     * @brief Muodostaa Saldo-taulun uudelleen vienneistä
+     * @return Onnistuiko muodostaminen
+     */
+    bool rakennaSaldot();
+
+    /**
+     * @brief Vertaa Saldo-taulua vienneistä laskettuihin summiin
+     * @return Lista poikkeavista riveistä, tyhjä jos taulu on ajan tasalla
+     */
+    QVariantList tarkastaSaldot();
+
+    /**
+     * @brief Muodostaa Tilikausikooste-taulun uudelleen vienneistä
+     * @return Onnistuiko muodostaminen
+     */
+    bool rakennaKausikooste();
+
+    /**
+     * @brief Vertaa Tilikausikooste-taulua vienneistä laskettuihin yhteenvetoihin
+     * @return Lista poikkeavista tilikausista, tyhjä jos taulu on ajan tasalla
+     */
+    QVariantList tarkastaKausikooste();
+
+    /**
+     * @brief Päivittää tositteiden tekstit hakuindeksiin
+     *
+     * Kutsutaan samassa transaktiossa, jossa tositetta, sen vientejä
+     * tai kumppania on muutettu. Ei tee mitään, jos hakuindeksi ei ole
+     * käytettävissä (ks. hakuindeksi).
+     *
+     * @param ehto Tosite-taulun ehto päivitettäville tositteille, tyhjä päivittää kaikki
+     */
+    void paivitaHakuindeksi(const QString& ehto = QString());
+
+    /**
+     * @brief Onko FTS5-hakuindeksi käytettävissä
+     */
+    bool hakuindeksi() const { return hakuindeksi_; }
+
+    /**
+     * @brief Siirtää liitteiden sisällön jaettuun LiiteData-tauluun ja tiivistää tiedoston
+     *
+     * Samansisältöiset liitteet tallennetaan vain kerran. Lopuksi
+     * tiedosto tiivistetään VACUUM-komennolla.
+     *
+     * @return Tiedoston koko ennen ja jälkeen sekä erillisten tiedostojen määrä
+     */
+    QVariantMap tiivistaLiitteet();
+
+    /**
+     * @brief Avaa liitteen sisällön luettavaksi paloina
+     *
+     * Lukija suljetaan viimeistään kirjanpidon sulkemisen yhteydessä.
+     *
+     * @param liiteId Liitteen id
+     * @return Avattu lukija, jonka kutsuja omistaa, tai nullptr
+     */
+    QIODevice* liiteLukija(int liiteId);
+
+    /**
+     * @brief Valmisteltu kysely lausepohjalle
+     *
+     * Lauseet valmistellaan tietokantayhteydelle vain kerran ja niitä
+     * käytetään uudelleen sidotuilla parametreilla. Samaa lausepohjaa
+     * ei voi käyttää sisäkkäin, koska kysely on yhteinen.
+     *
+     * @param pohja Kyselyn SQL, jossa parametrit merkitty ?-merkein
+     * @return Valmisteltu kysely, jolle sidotaan parametrit ja joka suoritetaan.
+     *         Kysely jakaa tilansa varastossa olevan kanssa, joten se pysyy
+     *         käytettävänä, vaikka lause poistettaisiin varastosta.
+     *         Kysely päätetään (finish), kun reititetty kysely on käsitelty,
+     *         jotta avoin kursori ei pidä WAL-tilannekuvaa auki.
+     */
+    QSqlQuery lause(const QString& pohja);
+
+    /**
+     * @brief Lausevaraston osumat, ohitukset ja valmisteluun kulunut aika
+     */
+    QVariantMap lauseTilasto() const;
+
+    /**
+     * @brief Reititettyjen kyselyiden mittaukset
+     */
+    SQLiteMittari* mittari() { return &mittari_; }
+
+    /**
+     * @brief Jonottaa kyselyn lukijan säikeeseen, jos se voidaan suorittaa siellä
+     *
+     * Lukija vastaa kyselyyn ja tuhoaa sen.
+     *
+     * @return tosi, jos kysely jonotettiin
+     */
+    bool lueRinnakkain(SQLiteKysely* kysely);
+
+    /**
+     * @brief Suorittaa hakukyselyn ja toimittaa kaikki rivit kerralla
+     *
+     * Kysely suoritetaan lukijan säikeessä, kun lukuyhteys on auki, ja
+     * muuten heti pääyhteydellä. Rivit toimitetaan käyttöliittymän
+     * säikeessä, ja ne hylätään, jos vastaanottaja on sillä välin tuhottu
+     * tai kirjanpito suljettu.
+     */
+    void haeRivit(const QString& sql, const QVariantList& sidokset, QObject* vastaanottaja,
+                  std::function<void(const QList<QSqlRecord>&)> valmis);
+
     void reitita(SQLiteKysely *reititettavakysely, const QVariant& data);
     void reitita(SQLiteKysely* reititettavakysely, const QByteArray &ba, const QMap<QString,QString> &meta);
 
@@ -63,17 +191,53 @@ public:
      *
      * Jos yritetään avata uudempaa, tulee virhe
      */
-    static const int TIETOKANTAVERSIO = 24;
+    static const int TIETOKANTAVERSIO = 29;
 
 private slots:
     void lisaaViimeisiin();
 
 protected:
     void lisaaRoute(SQLiteRoute *route);
+    void tyhjennaLauseet();
+    void vapautaLauseet();
+    void suljeLukijat();
+    void avaaLukuyhteys(const QString& polku);
+    void suljeLukuyhteys();
+    void alustaHakuindeksi();
 
 private:
     QVariantList viimeiset_;
 
+    /**
+     * @brief Päättää käytetyt lauseet, kun uloin reititys päättyy
+     */
+    struct Reititys {
+        explicit Reititys(SQLiteModel* model);
+        ~Reititys();
+        SQLiteModel* model_;
+    };
+
+    struct ValmisteltuLause {
+        QSqlQuery kysely;
+        quint64 kaytetty = 0;
+    };
+    QHash<QString, ValmisteltuLause*> lauseet_;
+    QHash<QString, QSqlQuery> kaytossa_;
+    int reitityksia_ = 0;
+    QList<QPointer<QIODevice>> lukijat_;
+    quint64 lauseKaytto_ = 0;
+    qlonglong lauseOsumat_ = 0;
+    qlonglong lauseOhitukset_ = 0;
+    qlonglong valmisteluNs_ = 0;
+    SQLiteMittari mittari_;
+
+    QThread* lukuSaie_;
+    SQLiteLukija* lukija_;
+    QScopedPointer<QLockFile> lukko_;
+    bool hakuindeksi_ = false;
+
+    static const int LAUSEITA_ENINTAAN = 128;
+
 protected:
     QSqlDatabase tietokanta_;
     QString tiedostoPolku_;
@@ -19,8 +19,12 @@
 #include <QSqlRecord>
 #include <QDebug>
 #include <QSqlError>
+#include <QSet>
+#include <QHash>
+#include <QDate>
 
 #include "model/euro.h"
+#include "sqlitelukija.h"
 
 SQLiteRoute::SQLiteRoute(SQLiteModel *model, const QString &polku)
     : model_(model), polku_(polku)
@@ -33,28 +37,52 @@ SQLiteRoute::~SQLiteRoute()
 
 }
 
-QVariant SQLiteRoute::route(SQLiteKysely *kysely, const QVariant &data)
+QString SQLiteRoute::loppu(const QString &kyselynPolku) const
 {
-    QString loppu = kysely->polku().mid( polku().length() );
+    QString loppu = kyselynPolku.mid( polku().length() );
 
     if( loppu.startsWith(QChar('/')) )
         loppu = loppu.mid(1);
+    return loppu;
+}
+
+bool SQLiteRoute::rinnakkainen(const QString & /*polku*/) const
+{
+    return false;
+}
+
+QVariant SQLiteRoute::route(SQLiteKysely *kysely, const QVariant &data)
+{
+    const QString loppu = this->loppu( kysely->polku() );
 
     QVariant paluu;
+    kysely_ = kysely;
+    // Kysely nollataan myös, kun käsittelijä heittää poikkeuksen
+    struct Nollaus {
+        SQLiteKysely*& kysely;
+        ~Nollaus() { kysely = nullptr; }
+    } nollaus{kysely_};
 
     switch (kysely->metodi()) {
     case KpKysely::GET:
-        return get(loppu, kysely->urlKysely());
+        paluu = get(loppu, kysely->urlKysely());
+        break;
     case KpKysely::POST:
-        return post(loppu, data);
+        paluu = post(loppu, data);
+        break;
     case KpKysely::PUT:
-        return  put(loppu, data);
+        paluu = put(loppu, data);
+        break;
     case KpKysely::PATCH:
-        return patch(loppu, data);
+        paluu = patch(loppu, data);
+        break;
     case KpKysely::DELETE:
-        return  doDelete(loppu);
+        paluu = doDelete(loppu);
+        break;
+    default:
+        throw SQLiteVirhe("Tuntematon metodi",405);
     }
-    throw SQLiteVirhe("Tuntematon metodi",405);
+    return paluu;
 }
 
 QPair<const QVariant, int> SQLiteRoute::byteArray(SQLiteKysely * /*reititettavaKysely*/, const QByteArray & /*ba*/, const QMap<QString, QString> & /*meta*/)
@@ -99,38 +127,85 @@ QVariantList SQLiteRoute::resultList(QSqlQuery &kysely)
 
     QVariantList lista;
     while( kysely.next()) {
-        // Sijoitetaan ensin json-kenttä
-
-        QSqlRecord tietue = kysely.record();
-        QVariantMap map = QJsonDocument::fromJson( tietue.value("json").toString().toUtf8() ).toVariant().toMap();
-
-        for(int i=0; i < tietue.count(); i++) {
-            QString kenttanimi = tietue.fieldName(i);
-            // Jos kenttänimi esim. era_id, tulee era.id
-            if( tietue.value(i).toString().isEmpty() ||
-                tietue.value(i).toString() == "0")
-                continue;   // Ei tyhjiä kenttiä
-
-            if( kenttanimi.contains(QChar('_'))) {
-                int viivanpaikka = kenttanimi.indexOf('_');
-                QString ryhma = kenttanimi.left(viivanpaikka);
-                QString alakentta = kenttanimi.mid(viivanpaikka+1);
-                QVariantMap rmap = map.value(ryhma, QVariantMap()).toMap();
-                rmap.insert(alakentta, tietue.value(i));
-                map.insert(ryhma, rmap);
-            }
-            else if( kenttanimi.endsWith("snt")) {
-                map.insert( kenttanimi.left( kenttanimi.length() - 3 ), Euro( tietue.value(i).toLongLong() ).toString() );
-            }
-            else if( kenttanimi != "json") {
-                map.insert( kenttanimi, tietue.value(i));
-            }
-        }
-        lista.append(map);
+        lista.append( resultRow(kysely.record()) );
     }
     return lista;
 }
 
+QVariantMap SQLiteRoute::resultRow(const QSqlRecord &tietue)
+{
+    // Sijoitetaan ensin json-kenttä
+    QVariantMap map = QJsonDocument::fromJson( tietue.value("json").toString().toUtf8() ).toVariant().toMap();
+
+    for(int i=0; i < tietue.count(); i++) {
+        QString kenttanimi = tietue.fieldName(i);
+        const QVariant arvo = tietue.value(i);
+        if( arvo.isNull())
+            continue;
+        const QString teksti = arvo.toString();
+        // Jos kenttänimi esim. era_id, tulee era.id
+        if( teksti.isEmpty() || teksti == "0")
+            continue;   // Ei tyhjiä kenttiä
+
+        if( kenttanimi.contains(QChar('_'))) {
+            int viivanpaikka = kenttanimi.indexOf('_');
+            QString ryhma = kenttanimi.left(viivanpaikka);
+            QString alakentta = kenttanimi.mid(viivanpaikka+1);
+            QVariantMap rmap = map.value(ryhma, QVariantMap()).toMap();
+            rmap.insert(alakentta, arvo);
+            map.insert(ryhma, rmap);
+        }
+        else if( kenttanimi.endsWith("snt")) {
+            // Sentit välitetään kokonaislukuina, ei merkkijonoina
+            map.insert( kenttanimi.left( kenttanimi.length() - 3 ), Euro( arvo.toLongLong() ).toTypedVariant() );
+        }
+        else if( kenttanimi != "json") {
+            map.insert( kenttanimi, arvo);
+        }
+    }
+    return map;
+}
+
+QVariant SQLiteRoute::resultVastaus(QSqlQuery &kysely, std::function<void (QVariantList &)> taydennys)
+{
+    const int osakoko = kysely_ ? kysely_->osakoko() : 0;
+
+    if( !osakoko ) {
+        QVariantList lista = resultList(kysely);
+        if( taydennys )
+            taydennys(lista);
+        return lista;
+    }
+
+    if( kysely.lastError().type() != QSqlError::NoError) {
+        qDebug() << " *SQLVIRHE* "
+                  << kysely.lastError().text()
+                  << kysely.lastQuery();
+    }
+
+    // Rivit lähetetään osissa sitä mukaa kun niitä luetaan,
+    // jolloin koko vastausta ei tarvitse pitää muistissa
+    QVariantList osa;
+    osa.reserve(osakoko);
+    while( kysely.next()) {
+        osa.append( resultRow(kysely.record()));
+        if( osa.count() >= osakoko) {
+            if( taydennys )
+                taydennys(osa);
+            SQLiteMittari::osa(osa);
+            kysely_->vastaaOsana(osa);
+            osa.clear();
+        }
+    }
+    if( !osa.isEmpty()) {
+        if( taydennys )
+            taydennys(osa);
+        SQLiteMittari::osa(osa);
+        kysely_->vastaaOsana(osa);
+    }
+    return QVariantList();
+}
+
 QVariantMap SQLiteRoute::resultMap(QSqlQuery &kysely)
 {
     // Kyselyssä voi olla vain yksi rivi
@@ -148,45 +223,233 @@ QByteArray SQLiteRoute::mapToJson(const QVariantMap &map)
 
 QSqlDatabase SQLiteRoute::db()
 {
+    if( lukija_ )
+        return lukija_->tietokanta();
     return model_->tietokanta();
 }
 
 
 void SQLiteRoute::taydennaEratJaMerkkaukset(QVariantList &vientilista)
 {
+    // Kerätään ensin kaikkien vientien ja erien tunnisteet, jotta
+    // erät ja merkkaukset saadaan haettua muutamalla kyselyllä
+    // eikä jokaiselle viennille erikseen
+
+    QList<int> eraIdt;
+    QList<int> vientiIdt;
+    QSet<int> eraJoukko;
+
+    for(const QVariant& item : qAsConst(vientilista)) {
+        const QVariantMap& map = item.toMap();
+        const int eraid = map.value("era").toMap().value("id").toInt();
+        if( eraid && !eraJoukko.contains(eraid)) {
+            eraJoukko.insert(eraid);
+            eraIdt.append(eraid);
+        }
+        const int vientiId = map.value("id").toInt();
+        if( vientiId )
+            vientiIdt.append(vientiId);
+    }
+
+    QHash<int,QVariantMap> erat;
+    QHash<int,qlonglong> saldot;
+    QHash<int,QVariantList> merkkaukset;
+
     QSqlQuery kysely(db());
 
+    for(const QString& idt : idListat(eraIdt)) {
+        kysely.exec(QString("SELECT Vienti.id as id, Tosite.tunniste as tunniste, Tosite.sarja as sarja, Tosite.pvm as pvm, Tosite.tyyppi as tositetyyppi "
+                            "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+                            "WHERE Vienti.id IN (%1)").arg(idt));
+        for(const QVariant& era : resultList(kysely)) {
+            const QVariantMap& eramap = era.toMap();
+            erat.insert( eramap.value("id").toInt(), eramap);
+        }
+
+        kysely.exec(QString("SELECT eraid, SUM(debetsnt) as debetit, SUM(kreditsnt) as kreditit FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+                            "WHERE eraid IN (%1) AND Tosite.tila >= 100 GROUP BY eraid").arg(idt));
+        while( kysely.next())
+            saldot.insert( kysely.value(0).toInt(), kysely.value(1).toLongLong() - kysely.value(2).toLongLong() );
+    }
+
+    for(const QString& idt : idListat(vientiIdt)) {
+        kysely.exec(QString("SELECT vienti, kohdennus FROM Merkkaus WHERE vienti IN (%1) ORDER BY vienti, kohdennus").arg(idt));
+        while( kysely.next())
+            merkkaukset[ kysely.value(0).toInt() ].append( kysely.value(1).toInt() );
+    }
+
+    // Yhdistetään haetut tiedot vienteihin
     for(int i=0; i < vientilista.count(); i++) {
         QVariantMap map = vientilista.at(i).toMap();
+        bool muuttunut = false;
+
         if( map.contains("era")) {
-            QVariantMap eramap = map.value("era").toMap();
-            int eraid = eramap.value("id").toInt();
+            const int eraid = map.value("era").toMap().value("id").toInt();
             if( eraid ) {
-                kysely.exec(QString("SELECT Vienti.id as id, Tosite.tunniste as tunniste, Tosite.sarja as sarja, Tosite.pvm as pvm, Tosite.tyyppi as tositetyyppi "
-                                    "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
-                                    "WHERE Vienti.id=%1")
-                            .arg(eraid));
-                eramap = resultMap(kysely);
-
-                if( eramap.isEmpty()) {
-                    map.remove("era");
-                } else {
-                    kysely.exec(QString("SELECT SUM(debetsnt) as debetit, SUM(kreditsnt) as kreditit FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=%1 AND Tosite.tila >= 100 ").arg(eraid));
-                    if( kysely.next())
-                        eramap.insert("saldo", (kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0);
+                if( erat.contains(eraid)) {
+                    QVariantMap eramap = erat.value(eraid);
+                    eramap.insert("saldo", saldot.value(eraid) / 100.0);
                     map.insert("era", eramap);
+                } else {
+                    map.remove("era");
                 }
-                vientilista[i] = map;
+                muuttunut = true;
             }
         }
 
-        QVariantList merkkaukset;
-        kysely.exec(QString("SELECT kohdennus FROM Merkkaus WHERE vienti=%1").arg(map.value("id").toInt()));
-        while( kysely.next() )
-            merkkaukset.append( kysely.value(0).toInt() );
-        if( merkkaukset.count()) {
-            map.insert("merkkaukset", merkkaukset);
-            vientilista[i] = map;            
-        }        
+        const QVariantList& vienninMerkkaukset = merkkaukset.value( map.value("id").toInt() );
+        if( !vienninMerkkaukset.isEmpty()) {
+            map.insert("merkkaukset", vienninMerkkaukset);
+            muuttunut = true;
+        }
+
+        if( muuttunut )
+            vientilista[i] = map;
+    }
+}
+
+QStringList SQLiteRoute::idListat(const QList<int> &idt, int koko)
+{
+    QStringList listat;
+    for(int i=0; i < idt.count(); i += koko) {
+        QStringList osa;
+        for(int j=i; j < idt.count() && j < i + koko; j++)
+            osa.append(QString::number(idt.at(j)));
+        listat.append(osa.join(","));
+    }
+    return listat;
+}
+
+void SQLiteRoute::kirjaaSaldoihin(int tositeId, int etumerkki)
+{
+    QSqlQuery kysely = suorita("INSERT INTO Saldo(tili, kohdennus, kuukausi, debetsnt, kreditsnt) "
+                                "SELECT Vienti.tili, IFNULL(Vienti.kohdennus,0), strftime('%Y-%m-01',Vienti.pvm), "
+                                "? * IFNULL(SUM(Vienti.debetsnt),0), ? * IFNULL(SUM(Vienti.kreditsnt),0) "
+                                "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+                                "WHERE Vienti.tosite=? AND Tosite.tila >= 100 AND Vienti.pvm IS NOT NULL "
+                                "GROUP BY 1,2,3 "
+                                "ON CONFLICT(tili, kohdennus, kuukausi) DO UPDATE SET "
+                                "debetsnt=debetsnt+EXCLUDED.debetsnt, kreditsnt=kreditsnt+EXCLUDED.kreditsnt",
+                                { etumerkki, etumerkki, tositeId });
+    if( kysely.lastError().isValid())
+        throw SQLiteVirhe(kysely);
+
+    kirjaaKoosteeseen(tositeId, etumerkki);
+}
+
+void SQLiteRoute::kirjaaKoosteeseen(int tositeId, int etumerkki)
+{
+    QSqlQuery summat = suorita("INSERT INTO Tilikausikooste(alkaa, tasemuutos, tulos, liikevaihto) "
+                                "SELECT alkaa, ? * tasemuutos, ? * tulos, ? * liikevaihto FROM (" + kausikoosteKysely(true) + ") "
+                                "WHERE true ON CONFLICT(alkaa) DO UPDATE SET tasemuutos=tasemuutos+EXCLUDED.tasemuutos, "
+                                "tulos=tulos+EXCLUDED.tulos, liikevaihto=liikevaihto+EXCLUDED.liikevaihto",
+                                { etumerkki, etumerkki, etumerkki, tositeId });
+    if( summat.lastError().isValid())
+        throw SQLiteVirhe(summat);
+
+    QSqlQuery tosite = suorita("SELECT Tosite.pvm, Tosite.tila, Tilikausi.alkaa, Tilikausi.loppuu FROM Tosite "
+                                "JOIN Tilikausi ON Tosite.pvm BETWEEN Tilikausi.alkaa AND Tilikausi.loppuu "
+                                "WHERE Tosite.id=?", { tositeId });
+    if( !tosite.next())
+        return;
+    const QString pvm = tosite.value(0).toString();
+    const bool kirjanpidossa = tosite.value(1).toInt() >= 100;
+    const QString alkaa = tosite.value(2).toString();
+    const QString loppuu = tosite.value(3).toString();
+    tosite.finish();
+
+    QSqlQuery kausi = etumerkki > 0 ?
+        suorita("INSERT INTO Tilikausikooste(alkaa, viimeinen, paivitetty) VALUES (?, ?, CURRENT_TIMESTAMP) "
+                "ON CONFLICT(alkaa) DO UPDATE SET viimeinen=NULLIF(MAX(IFNULL(viimeinen,''), IFNULL(EXCLUDED.viimeinen,'')),''), "
+                "paivitetty=CURRENT_TIMESTAMP",
+                { alkaa, kirjanpidossa ? pvm : QVariant() }) :
+        suorita("INSERT INTO Tilikausikooste(alkaa) VALUES (?) "
+                "ON CONFLICT(alkaa) DO UPDATE SET viimeinen=CASE WHEN viimeinen=? THEN "
+                "(SELECT MAX(pvm) FROM Tosite WHERE tila >= 100 AND pvm BETWEEN ? AND ? AND id <> ?) ELSE viimeinen END",
+                { alkaa, kirjanpidossa ? pvm : QVariant(), alkaa, loppuu, tositeId });
+    if( kausi.lastError().isValid())
+        throw SQLiteVirhe(kausi);
+}
+
+QString SQLiteRoute::kausikoosteKysely(bool tositteelle)
+{
+    // Tilit, joiden numero alkaa 1:llä, ovat vastaavaa ja 3:sta alkaen tuloslaskelmaa.
+    // Tilikausien ulkopuoliset viennit kirjataan seuraavan kauden '<alkaa' -riville.
+    const QString viennit =
+            "SELECT IFNULL((SELECT Tilikausi.alkaa FROM Tilikausi WHERE Vienti.pvm BETWEEN Tilikausi.alkaa AND Tilikausi.loppuu), "
+            "IFNULL('<' || (SELECT MIN(Tilikausi.alkaa) FROM Tilikausi WHERE Tilikausi.alkaa > Vienti.pvm),'')) AS kausi, "
+            "CASE WHEN CAST(Vienti.tili AS text) < '2' THEN IFNULL(Vienti.debetsnt,0) - IFNULL(Vienti.kreditsnt,0) ELSE 0 END AS tasemuutos, "
+            "CASE WHEN CAST(Vienti.tili AS text) >= '3' THEN IFNULL(Vienti.kreditsnt,0) - IFNULL(Vienti.debetsnt,0) ELSE 0 END AS tulos, "
+            "CASE WHEN CAST(Vienti.tili AS text) >= '3' AND Tili.tyyppi IN ('CL','CLZ') THEN IFNULL(Vienti.kreditsnt,0) - IFNULL(Vienti.debetsnt,0) ELSE 0 END AS liikevaihto, "
+            "NULL AS viimeinen, NULL AS paivitetty "
+            "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id LEFT OUTER JOIN Tili ON Vienti.tili=Tili.numero "
+            "WHERE Tosite.tila >= 100 AND Vienti.pvm IS NOT NULL";
+
+    if( tositteelle )
+        return QString("SELECT kausi AS alkaa, SUM(tasemuutos) AS tasemuutos, SUM(tulos) AS tulos, SUM(liikevaihto) AS liikevaihto "
+                       "FROM (%1 AND Vienti.tosite=?) GROUP BY kausi").arg(viennit);
+
+    const QString kaudet =
+            "SELECT Tilikausi.alkaa, 0, 0, 0, "
+            "(SELECT MAX(Tosite.pvm) FROM Tosite WHERE Tosite.tila >= 100 AND Tosite.pvm BETWEEN Tilikausi.alkaa AND Tilikausi.loppuu), "
+            "(SELECT MAX(Tositeloki.aika) FROM Tositeloki JOIN Tosite ON Tositeloki.tosite=Tosite.id "
+            "WHERE Tosite.pvm BETWEEN Tilikausi.alkaa AND Tilikausi.loppuu) FROM Tilikausi";
+
+    return QString("SELECT kausi AS alkaa, SUM(tasemuutos), SUM(tulos), SUM(liikevaihto), MAX(viimeinen), MAX(paivitetty) "
+                   "FROM (%1 UNION ALL %2) GROUP BY kausi").arg(viennit).arg(kaudet);
+}
+
+QString SQLiteRoute::saldoKysely(const QDate &alkaa, const QDate &paattyy, QVariantList &arvot, const QString &ehto, const QVariantList &ehdonArvot)
+{
+    // Kokonaisten kuukausien jakso [ekaKuukausi, loppuRaja[
+    const QDate seuraava = paattyy.addDays(1);
+    const QDate loppuRaja = QDate( seuraava.year(), seuraava.month(), 1);
+    QDate ekaKuukausi;
+    if( alkaa.isValid())
+        ekaKuukausi = alkaa.day() == 1 ? alkaa : QDate(alkaa.year(), alkaa.month(), 1).addMonths(1);
+
+    const QString lisaehto = ehto.isEmpty() ? QString() : QString(" AND (%1)").arg(ehto);
+    const QString saldoosa = QString("SELECT tili, kohdennus, debetsnt, kreditsnt FROM Saldo WHERE kuukausi >= ? AND kuukausi < ?%1").arg(lisaehto);
+    const QString vientiosa = QString("SELECT Vienti.tili AS tili, IFNULL(Vienti.kohdennus,0) AS kohdennus, Vienti.debetsnt AS debetsnt, Vienti.kreditsnt AS kreditsnt "
+                                      "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE Tosite.tila >= 100 AND Vienti.pvm >= ? AND Vienti.pvm < ?%1").arg(lisaehto);
+
+    // Jokaisen osan jakso ja lisäehdon arvot sidotaan osan omiin parametreihin
+    QStringList osat;
+    auto lisaa = [&osat, &arvot, &ehdonArvot] (const QString& osa, const QVariant& mista, const QVariant& mihin) {
+        osat << osa;
+        arvot << mista << mihin << ehdonArvot;
+    };
+
+    if( !alkaa.isValid()) {
+        lisaa(saldoosa, QStringLiteral("0000-00-00"), loppuRaja);
+        lisaa(vientiosa, loppuRaja, seuraava);
+    } else if( ekaKuukausi < loppuRaja) {
+        lisaa(saldoosa, ekaKuukausi, loppuRaja);
+        lisaa(vientiosa, alkaa, ekaKuukausi);
+        lisaa(vientiosa, loppuRaja, seuraava);
+    } else {
+        lisaa(vientiosa, alkaa, seuraava);
+    }
+
+    return osat.join(" UNION ALL ");
+}
+
+QSqlQuery SQLiteRoute::lause(const QString &pohja)
+{
+    if( lukija_ )
+        return lukija_->lause(pohja);
+    return model_->lause(pohja);
+}
+
+QSqlQuery SQLiteRoute::suorita(const QString &pohja, const QVariantList &arvot)
+{
+    QSqlQuery kysely = lause(pohja);
+    for(const QVariant& arvo : arvot)
+        kysely.addBindValue(arvo);
+    if( !kysely.exec()) {
+        qDebug() << " *SQLVIRHE* "
+                  << kysely.lastError().text()
+                  << pohja;
     }
+    return kysely;
 }
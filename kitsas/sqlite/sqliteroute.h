@@ -24,6 +24,10 @@
 #include <QSqlQuery>
 
 #include <exception>
+#include <functional>
+
+class QSqlRecord;
+class SQLiteLukija;
 
 class SQLiteRoute
 {
@@ -36,7 +40,57 @@ public:
 
     QString polku() const { return polku_;}
 
+    /**
+     * @brief Kyselyn polun reitin jälkeinen osa
+     */
+    QString loppu(const QString& kyselynPolku) const;
+
+    /**
+     * @brief Voidaanko GET-kysely suorittaa lukijan säikeessä
+     *
+     * Rinnakkain suoritettava haku ei saa käyttää Kirjanpito-oliota
+     * eikä reitin omaa tilaa.
+     *
+     * @param polku Kyselyn polun reitin jälkeinen osa
+     */
+    virtual bool rinnakkainen(const QString& polku) const;
+
+    /**
+     * @brief Ohjaa reitin kyselyt lukijan yhteydelle
+     */
+    void asetaLukija(SQLiteLukija* lukija) { lukija_ = lukija; }
+
 protected:
+    /**
+     * @brief Transaktio, joka perutaan, ellei sitä vahvisteta
+     *
+     * Jos käsittely keskeytyy poikkeukseen, transaktio perutaan
+     * eikä jää auki seuraaville kyselyille.
+     */
+    class Transaktio
+    {
+    public:
+        Transaktio(QSqlDatabase tietokanta, bool aloita = true) :
+            tietokanta_(tietokanta), auki_(aloita)
+        {
+            if( auki_ )
+                tietokanta_.transaction();
+        }
+        ~Transaktio()
+        {
+            if( auki_ )
+                tietokanta_.rollback();
+        }
+        void vahvista()
+        {
+            if( auki_ )
+                tietokanta_.commit();
+            auki_ = false;
+        }
+    private:
+        QSqlDatabase tietokanta_;
+        bool auki_;
+    };
 
     virtual QVariant get(const QString& polku, const QUrlQuery& urlquery = QUrlQuery());
     virtual QVariant put(const QString& polku, const QVariant& data);
@@ -45,15 +99,103 @@ protected:
     virtual QVariant doDelete(const QString& polku);
 
     QVariantList resultList(QSqlQuery& kysely);
+    QVariantMap resultRow(const QSqlRecord& tietue);
+
+    /**
+     * @brief Kyselyn tulos vastaukseksi
+     *
+     * Jos kysely on pyydetty osissa, rivit lähetetään osina jo
+     * lukemisen aikana ja palautetaan tyhjä lista. Muuten palautetaan
+     * kaikki rivit kuten resultList.
+     *
+     * @param kysely Suoritettu kysely
+     * @param taydennys Käsittely, joka tehdään jokaiselle osalle ennen lähettämistä
+     */
+    QVariant resultVastaus(QSqlQuery& kysely, std::function<void(QVariantList&)> taydennys = nullptr);
     QVariantMap resultMap(QSqlQuery& kysely);
     static QByteArray mapToJson(const QVariantMap& map);
 
     void taydennaEratJaMerkkaukset(QVariantList& vientilista);
 
+    /**
+     * @brief Jakaa tunnisteet pilkuin erotelluiksi listoiksi IN-ehtoja varten
+     * @param idt Tunnisteet
+     * @param koko Yhden listan enimmäispituus
+     */
+    static QStringList idListat(const QList<int>& idt, int koko = 500);
+
+    /**
+     * @brief Päivittää tositteen viennit Saldo-tauluun
+     *
+     * Kutsutaan tositetta tallennettaessa samassa transaktiossa
+     * ennen muutosta etumerkillä -1 ja muutoksen jälkeen etumerkillä 1.
+     * Vain kirjanpidossa olevat tositteet vaikuttavat saldoihin.
+     * Samalla päivitetään tilikausien yhteenvedot (kirjaaKoosteeseen).
+     *
+     * @param tositeId Tositteen id
+     * @param etumerkki 1 lisää viennit saldoihin, -1 poistaa ne
+     */
+    void kirjaaSaldoihin(int tositeId, int etumerkki);
+
+    /**
+     * @brief Päivittää tositteen vaikutuksen Tilikausikooste-tauluun
+     *
+     * Tase-, tulos- ja liikevaihtosummat päivitetään etumerkin mukaan.
+     * Kauden viimeinen tosite lasketaan uudelleen vain, jos poistuva
+     * tosite oli kauden viimeinen. Päivitysaika merkitään vain
+     * lisättäessä, joten poistaminen ei muuta sitä.
+     */
+    void kirjaaKoosteeseen(int tositeId, int etumerkki);
+
+    /**
+     * @brief Kysely tilikausien yhteenvedoista kokonaan vienneistä laskettuna
+     *
+     * Sarakkeet ovat alkaa, tasemuutos, tulos, liikevaihto, viimeinen ja
+     * paivitetty. Tilikausien ulkopuoliset (tilinavauksen) viennit ovat
+     * rivillä, jonka alkaa on '<' ja seuraavan tilikauden alkupäivä, ja
+     * viimeisen tilikauden jälkeiset viennit rivillä, jonka alkaa on tyhjä.
+     *
+     * @param tositteelle Lasketaan vain parametrina sidottavan tositteen
+     *        viennit, jolloin viimeinen ja paivitetty jäävät tyhjiksi
+     */
+    static QString kausikoosteKysely(bool tositteelle = false);
+
+    /**
+     * @brief Kysely vientien summista ajanjaksolla
+     *
+     * Kokonaiset kuukaudet luetaan Saldo-taulusta ja vain jakson
+     * alun ja lopun vajaat kuukaudet summataan vienneistä.
+     * Kyselyssä ovat sarakkeet tili, kohdennus, debetsnt ja kreditsnt.
+     *
+     * @param alkaa Jakson ensimmäinen päivä, tyhjä kirjanpidon alusta
+     * @param paattyy Jakson viimeinen päivä
+     * @param arvot Lista, johon lisätään kyselyyn sidottavat arvot
+     * @param ehto Lisäehto, jossa voi käyttää sarakkeita tili ja kohdennus
+     *        sekä ?-merkein merkittyjä parametreja
+     * @param ehdonArvot Lisäehtoon sidottavat arvot
+     */
+    static QString saldoKysely(const QDate& alkaa, const QDate& paattyy, QVariantList& arvot,
+                               const QString& ehto = QString(), const QVariantList& ehdonArvot = QVariantList());
+
+    /**
+     * @brief Valmisteltu kysely mallin lausevarastosta
+     */
+    QSqlQuery lause(const QString& pohja);
+
+    /**
+     * @brief Suorittaa valmistellun kyselyn annetuilla arvoilla
+     * @param pohja Kyselyn SQL, jossa parametrit merkitty ?-merkein
+     * @param arvot Sidottavat arvot järjestyksessä
+     * @return Suoritettu kysely
+     */
+    QSqlQuery suorita(const QString& pohja, const QVariantList& arvot = QVariantList());
+
 protected:
     QSqlDatabase db();
     SQLiteModel *model_;
     QString polku_;
+    SQLiteKysely* kysely_ = nullptr;
+    SQLiteLukija* lukija_ = nullptr;
 };
 
 #endif // SQLITEROUTE_H
@@ -0,0 +1,46 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "verkkolevy.h"
+
+#include <QFileInfo>
+#include <QDir>
+#include <QStorageInfo>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+bool verkkolevylla(const QString &polku)
+{
+    const QString hakemisto = QFileInfo(polku).absolutePath();
+    // UNC-polku \\palvelin\jako
+    if( hakemisto.startsWith("//") || QDir::toNativeSeparators(hakemisto).startsWith("\\\\"))
+        return true;
+
+#ifdef Q_OS_WIN
+    // Verkkoasemaksi liitetty levy näyttää tiedostojärjestelmältään paikalliselta
+    const QString juuri = QDir::toNativeSeparators( QStorageInfo(hakemisto).rootPath() );
+    if( GetDriveTypeW( reinterpret_cast<const wchar_t*>(juuri.utf16()) ) == DRIVE_REMOTE )
+        return true;
+#endif
+
+    static const QList<QByteArray> verkkojarjestelmat = {
+        "nfs", "nfs4", "cifs", "smbfs", "smb2", "smb3", "afpfs", "webdav",
+        "davfs", "fuse.sshfs", "9p", "ncpfs", "afs"
+    };
+    return verkkojarjestelmat.contains( QStorageInfo(hakemisto).fileSystemType().toLower() );
+}
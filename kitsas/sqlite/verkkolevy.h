@@ -0,0 +1,31 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VERKKOLEVY_H
+#define VERKKOLEVY_H
+
+#include <QString>
+
+/**
+ * @brief Onko tiedosto verkkolevyllä
+ *
+ * Verkkolevyllä SQLiten WAL-tilan jaettu muisti ei toimi, joten
+ * kirjanpito avataan siellä yksinoikeustilassa ilman lukitustiedostoa
+ * ja rinnakkaista lukijaa.
+ */
+bool verkkolevylla(const QString& polku);
+
+#endif // VERKKOLEVY_H
@@ -22,6 +22,7 @@
 #include <QTableView>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QCheckBox>
 
 #include "devtool.h"
 #include "ui_devtool.h"
@@ -29,6 +30,7 @@
 #include "db/kirjanpito.h"
 
 #include "db/kpkysely.h"
+#include "sqlite/sqlitemodel.h"
 
 #include "kitsaslokimodel.h"
 
@@ -53,12 +55,21 @@ DevTool::DevTool(QWidget *parent) :
     connect( ui->copyButton, &QPushButton::clicked, [] {KitsasLokiModel::instanssi()->copyAll();});
     connect( ui->vieNappi, &QPushButton::clicked, this, &DevTool::vie);
 
+    connect( ui->mittausPaivitaNappi, &QPushButton::clicked, this, &DevTool::paivitaMittaukset);
+    connect( ui->mittausTyhjennaNappi, &QPushButton::clicked, this, &DevTool::tyhjennaMittaukset);
+    connect( ui->mittausVieNappi, &QPushButton::clicked, this, &DevTool::vieMittaukset);
+    connect( ui->mittausTaulu, &QTableWidget::itemSelectionChanged, this, &DevTool::naytaMittauksenLauseet);
+    connect( ui->valimuistiValinta, &QCheckBox::toggled, this, &DevTool::valimuistiKayttoon);
+
     alustaRistinolla();
 
+    // Vastausten koot lasketaan vain työkalun ollessa auki
+    SQLiteMittari::mittaaKoot(true);
 }
 
 DevTool::~DevTool()
 {
+    SQLiteMittari::mittaaKoot(false);
     delete ui;
 }
 
@@ -119,6 +130,8 @@ void DevTool::tabMuuttui(int tab)
         ui->avainLista->clear();
         ui->avainLista->addItems( kp()->asetukset()->avaimet() );
     }
+    else if( ui->tabWidget->widget(tab) == ui->mittausTab)
+        paivitaMittaukset();
 }
 
 void DevTool::kysely()
@@ -251,6 +264,116 @@ void DevTool::vie()
     }
 }
 
+void DevTool::paivitaMittaukset()
+{
+    SQLiteMittari* mittari = kp()->sqlite() ? kp()->sqlite()->mittari() : nullptr;
+    mittaukset_ = mittari ? mittari->kyselyt() : QVariantList();
+
+    ui->mittausTaulu->setSortingEnabled(false);
+    ui->mittausTaulu->clear();
+    ui->mittausTaulu->setColumnCount(8);
+    ui->mittausTaulu->setHorizontalHeaderLabels(QStringList() << "Aika" << "Metodi" << "Polku" << "Reitti"
+                                                << "Lauseita" << "Rivejä" << "Tavuja" << "ms");
+    ui->mittausTaulu->setRowCount(mittaukset_.count());
+
+    for(int i=0; i < mittaukset_.count(); i++) {
+        const QVariantMap map = mittaukset_.at(i).toMap();
+        QTableWidgetItem* aika = new QTableWidgetItem( map.value("aika").toDateTime().toString("hh:mm:ss.zzz") );
+        aika->setData(Qt::UserRole, i);
+        ui->mittausTaulu->setItem(i, 0, aika);
+        ui->mittausTaulu->setItem(i, 1, new QTableWidgetItem( map.value("metodi").toString()));
+        ui->mittausTaulu->setItem(i, 2, new QTableWidgetItem( map.value("polku").toString()));
+        ui->mittausTaulu->setItem(i, 3, new QTableWidgetItem( map.value("reitti").toString()));
+
+        int sarake = 4;
+        for(const QString& avain : QStringList{"lauseita", "riveja", "tavuja", "ms"}) {
+            QTableWidgetItem* item = new QTableWidgetItem();
+            item->setData(Qt::DisplayRole, map.value(avain));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            if( map.value("virhe").toBool())
+                item->setForeground(QBrush(Qt::red));
+            ui->mittausTaulu->setItem(i, sarake++, item);
+        }
+    }
+    ui->mittausTaulu->setSortingEnabled(true);
+    ui->mittausTaulu->resizeColumnsToContents();
+    ui->mittausLauseet->clear();
+
+    ui->mittausInfo->setText( mittari ? tr("%1 kyselyä").arg(mittaukset_.count())
+                                      : tr("Mittaukset ovat käytössä vain paikallisessa kirjanpidossa"));
+
+    VastausValimuisti* valimuisti = kp()->yhteysModel() ? kp()->yhteysModel()->valimuisti() : nullptr;
+    ui->valimuistiValinta->setEnabled( valimuisti );
+    if( valimuisti ) {
+        const QVariantMap tilasto = valimuisti->tilasto();
+        ui->valimuistiValinta->setChecked( valimuisti->kaytossa() );
+        ui->valimuistiInfo->setText( tr("Välimuisti: %1 vastausta, %2 osumaa, %3 ohitusta (%4 %), %5 mitätöity")
+                                     .arg(tilasto.value("vastauksia").toInt())
+                                     .arg(tilasto.value("osumat").toLongLong())
+                                     .arg(tilasto.value("ohitukset").toLongLong())
+                                     .arg(tilasto.value("osumaprosentti").toDouble(), 0, 'f', 1)
+                                     .arg(tilasto.value("mitatoidyt").toLongLong()));
+    } else {
+        ui->valimuistiInfo->clear();
+    }
+}
+
+void DevTool::valimuistiKayttoon(bool kaytossa)
+{
+    if( kp()->yhteysModel() && kp()->yhteysModel()->valimuisti()->kaytossa() != kaytossa) {
+        kp()->yhteysModel()->valimuisti()->asetaKaytossa(kaytossa);
+        paivitaMittaukset();
+    }
+}
+
+void DevTool::naytaMittauksenLauseet()
+{
+    const int rivi = ui->mittausTaulu->currentRow();
+    QTableWidgetItem* item = rivi > -1 ? ui->mittausTaulu->item(rivi, 0) : nullptr;
+    if( !item ) {
+        ui->mittausLauseet->clear();
+        return;
+    }
+
+    const QVariantMap map = mittaukset_.value( item->data(Qt::UserRole).toInt() ).toMap();
+    QStringList rivit;
+    for(const QVariant& lause : map.value("lauseet").toList()) {
+        const QVariantMap lmap = lause.toMap();
+        rivit << QString("%1 ms  %2 riviä\n%3\n")
+                 .arg(lmap.value("ms").toDouble(), 0, 'f', 3)
+                 .arg(lmap.value("riveja").toLongLong())
+                 .arg(lmap.value("sql").toString().simplified());
+    }
+    if( map.value("lauseita").toInt() > rivit.count())
+        rivit << tr("... yhteensä %1 lausetta").arg(map.value("lauseita").toInt());
+    ui->mittausLauseet->setPlainText(rivit.join("\n"));
+}
+
+void DevTool::tyhjennaMittaukset()
+{
+    if( kp()->sqlite())
+        kp()->sqlite()->mittari()->tyhjenna();
+    paivitaMittaukset();
+}
+
+void DevTool::vieMittaukset()
+{
+    if( !kp()->sqlite())
+        return;
+
+    QString tiedosto = QFileDialog::getSaveFileName(this, tr("Vie mittaukset"), "kyselyt.json",
+                                                    tr("JSON-tiedosto (*.json)"));
+    if( tiedosto.isEmpty())
+        return;
+
+    QFile file(tiedosto);
+    if( file.open(QIODevice::WriteOnly))
+        file.write( kp()->sqlite()->mittari()->json() );
+    else
+        QMessageBox::critical(this, tr("Mittausten vieminen epäonnistui"),
+                              tr("Tiedostoon %1 ei voitu kirjoittaa").arg(tiedosto));
+}
+
 int DevTool::voitonTarkastaja(const QVector<int>& taulu)
 {
     QStringList rivit;
@@ -52,6 +52,12 @@ protected slots:
     void lokiLeikepoydalle();
     void vie();
 
+    void paivitaMittaukset();
+    void naytaMittauksenLauseet();
+    void tyhjennaMittaukset();
+    void vieMittaukset();
+    void valimuistiKayttoon(bool kaytossa);
+
 protected:
     /**
      * @brief Tarkastaa voiton ja ilmoittaa tuloksen
@@ -73,6 +79,8 @@ protected:
     QVector<int> peliRuudut_;
     bool pelissa_ = true;
 
+    QVariantList mittaukset_;
+
 
 private:
     Ui::DevTool *ui;
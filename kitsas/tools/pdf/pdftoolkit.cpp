@@ -29,6 +29,16 @@ PdfAnalyzerDocument *PdfToolkit::analyzer(const QByteArray &data)
     return new PopplerAnalyzerDocument(data);
 }
 
+PdfRendererDocument *PdfToolkit::renderer(QIODevice *device)
+{
+    return new PopplerRendererDocument(device);
+}
+
+PdfAnalyzerDocument *PdfToolkit::analyzer(QIODevice *device)
+{
+    return new PopplerAnalyzerDocument(device);
+}
+
 PdfRendererDocument::~PdfRendererDocument()
 {
 
@@ -18,6 +18,7 @@
 #define PDFTOOLKIT_H
 
 #include <QByteArray>
+#include <QIODevice>
 #include <QImage>
 
 class PdfAnalyzerPage;
@@ -85,6 +86,12 @@ public:
      * @return QImage, johon pdf renderöity
      */
     virtual QImage renderPageToWidth(int page, double width) = 0;
+    /**
+     * @brief Sivun koko renderöimättä
+     * @param page Sivunumero, alkaa nollasta
+     * @return Koko pisteinä (1/72 tuumaa)
+     */
+    virtual QSizeF pageSize(int page) = 0;
     /**
      * @brief Onko tiedosto lukittu (salasanasuojauksen takia)
      * @return Tosi, jos tiedostoa ei voi käsitellä
@@ -103,6 +110,15 @@ class PdfToolkit {
 public:
     static PdfRendererDocument* renderer(const QByteArray& data);
     static PdfAnalyzerDocument* analyzer(const QByteArray& data);
+
+    /**
+     * @brief Renderöijä, joka lukee tiedostoa laitteelta tarpeen mukaan
+     *
+     * Laitteen pitää olla avoinna ja säilyä dokumentin käytön ajan,
+     * dokumentti ei ota sitä omistukseensa.
+     */
+    static PdfRendererDocument* renderer(QIODevice* device);
+    static PdfAnalyzerDocument* analyzer(QIODevice* device);
 };
 
 
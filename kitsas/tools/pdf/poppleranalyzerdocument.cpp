@@ -26,6 +26,11 @@ PopplerAnalyzerDocument::PopplerAnalyzerDocument(const QByteArray &data)
     pdfDoc_ = Poppler::Document::loadFromData(data);
 }
 
+PopplerAnalyzerDocument::PopplerAnalyzerDocument(QIODevice *device)
+{
+    pdfDoc_ = Poppler::Document::load(device);
+}
+
 PopplerAnalyzerDocument::~PopplerAnalyzerDocument()
 {
     if( pdfDoc_)
@@ -24,6 +24,7 @@ class PopplerAnalyzerDocument : public PdfAnalyzerDocument
 {
 public:
     PopplerAnalyzerDocument(const QByteArray& data);
+    PopplerAnalyzerDocument(QIODevice* device);
     ~PopplerAnalyzerDocument();
 
     virtual int pageCount() override;
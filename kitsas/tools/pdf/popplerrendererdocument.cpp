@@ -28,6 +28,16 @@ PopplerRendererDocument::PopplerRendererDocument(const QByteArray &data)
     }
 }
 
+PopplerRendererDocument::PopplerRendererDocument(QIODevice *device)
+{
+    pdfDoc_ = Poppler::Document::load(device);
+
+    if( pdfDoc_) {
+        pdfDoc_->setRenderHint(Poppler::Document::TextAntialiasing);
+        pdfDoc_->setRenderHint(Poppler::Document::Antialiasing);
+    }
+}
+
 PopplerRendererDocument::~PopplerRendererDocument()
 {
     if(pdfDoc_)
@@ -56,6 +66,20 @@ QImage PopplerRendererDocument::renderPage(int page, double resolution)
     return image;
 }
 
+QSizeF PopplerRendererDocument::pageSize(int page)
+{
+    if( !pdfDoc_ || locked())
+        return QSizeF();
+
+    Poppler::Page *pdfSivu = pdfDoc_->page(page);
+    if( !pdfSivu)
+        return QSizeF();
+
+    QSizeF koko = pdfSivu->pageSizeF();
+    delete pdfSivu;
+    return koko;
+}
+
 bool PopplerRendererDocument::locked() const
 {
     if( pdfDoc_)
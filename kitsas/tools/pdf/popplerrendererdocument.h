@@ -24,11 +24,13 @@ class PopplerRendererDocument : public PdfRendererDocument
 {
 public:
     PopplerRendererDocument(const QByteArray& data);
+    PopplerRendererDocument(QIODevice* device);
     ~PopplerRendererDocument();
 
     virtual int pageCount() override;
     virtual QImage renderPage(int page, double resolution) override;
     virtual QImage renderPageToWidth(int page, double width) override;
+    virtual QSizeF pageSize(int page) override;
     virtual bool locked() const override;
 
 private:
@@ -0,0 +1,182 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "csvlukija.h"
+
+#include <QTextCodec>
+#include <QRegularExpression>
+
+namespace Tuonti {
+
+CsvLukija::CsvLukija(const QByteArray &data) :
+    data_(data),
+    koodaus_( haistaKoodaus(data) ),
+    erotin_( haistaErotin(data) )
+{
+    // Ohitetaan utf8:n tavujärjestysmerkki
+    if( koodaus_ == UTF8 && data_.startsWith("\xEF\xBB\xBF"))
+        sijainti_ = 3;
+}
+
+bool CsvLukija::seuraava()
+{
+    kentat_.clear();
+
+    const char* d = data_.constData();
+    const int n = data_.size();
+    if( sijainti_ >= n)
+        return false;
+
+    int alku = sijainti_;
+    bool lainattuna = false;
+    bool lainauksia = false;
+    int i = sijainti_;
+
+    for(; i < n; i++) {
+        const char merkki = d[i];
+        if( merkki == '"') {
+            lainauksia = true;
+            if( lainattuna && i + 1 < n && d[i+1] == '"')
+                i++;
+            else
+                lainattuna = !lainattuna;
+        } else if( !lainattuna ) {
+            if( merkki == erotin_) {
+                // Erotin löytyi, kenttä tuli valmiiksi
+                kentat_.append( Kentta{alku, i - alku, lainauksia} );
+                alku = i + 1;
+                lainauksia = false;
+            } else if( merkki == '\n') {
+                break;
+            }
+        }
+    }
+
+    int loppu = i;
+    if( loppu < n && loppu > alku && d[loppu-1] == '\r')
+        loppu--;
+    kentat_.append( Kentta{alku, loppu - alku, lainauksia} );
+
+    sijainti_ = i + 1;
+    return true;
+}
+
+QByteArray CsvLukija::kentta(int indeksi) const
+{
+    const Kentta& kentta = kentat_.at(indeksi);
+    const char* alku = data_.constData() + kentta.alku;
+    if( !kentta.lainattu )
+        return QByteArray::fromRawData(alku, kentta.pituus);
+
+    QByteArray purettu;
+    purettu.reserve(kentta.pituus);
+    bool lainattuna = false;
+    for(int i=0; i < kentta.pituus; i++) {
+        if( alku[i] == '"') {
+            if( lainattuna && i + 1 < kentta.pituus && alku[i+1] == '"') {
+                purettu.append('"');
+                i++;
+            } else
+                lainattuna = !lainattuna;
+        } else
+            purettu.append(alku[i]);
+    }
+    return purettu;
+}
+
+QString CsvLukija::teksti(int indeksi) const
+{
+    const Kentta& kentta = kentat_.at(indeksi);
+    if( !kentta.lainattu )
+        return dekoodaa( data_.constData() + kentta.alku, kentta.pituus, koodaus_);
+
+    const QByteArray purettu = this->kentta(indeksi);
+    return dekoodaa( purettu.constData(), purettu.size(), koodaus_);
+}
+
+QStringList CsvLukija::rivi() const
+{
+    QStringList lista;
+    lista.reserve( kentat_.count());
+    for(int i=0; i < kentat_.count(); i++)
+        lista.append( teksti(i) );
+    return lista;
+}
+
+CsvLukija::Koodaus CsvLukija::haistaKoodaus(const QByteArray &data)
+{
+    const QByteArray nayte = QByteArray::fromRawData( data.constData(), qMin(data.size(), NAYTE));
+    QRegularExpression skandit("[äöÄÖ€]");
+
+    if( QString::fromUtf8(nayte).contains(skandit))
+        return UTF8;
+    if( QString::fromLatin1(nayte).contains(skandit))
+        return LATIN1;
+    if( dekoodaa(nayte.constData(), nayte.size(), ISO885915).contains(skandit))
+        return ISO885915;
+
+    // Ellei muuta, niin oletuksena tulee utf8
+    return UTF8;
+}
+
+char CsvLukija::haistaErotin(const QByteArray &data)
+{
+    int pilkut = 0;
+    int puolipisteet = 0;
+    int sarkaimet = 0;
+
+    bool lainattu = false;
+    const int n = qMin(data.size(), NAYTE);
+
+    for(int i=0; i < n; i++) {
+        const char mki = data.at(i);
+        if( mki == '"')
+            lainattu = !lainattu;
+        else if( !lainattu ) {
+            if( mki == '\n')
+                break;
+            else if( mki == ',')
+                pilkut++;
+            else if( mki == ';')
+                puolipisteet++;
+            else if( mki == '\t')
+                sarkaimet++;
+        }
+    }
+    if( puolipisteet > pilkut && puolipisteet > sarkaimet)
+        return ';';
+    else if( sarkaimet > pilkut && sarkaimet > puolipisteet)
+        return '\t';
+    else
+        return ',';
+}
+
+QString CsvLukija::dekoodaa(const char *data, int pituus, CsvLukija::Koodaus koodaus)
+{
+    switch (koodaus) {
+    case LATIN1:
+        return QString::fromLatin1(data, pituus);
+    case ISO885915:
+    {
+        static QTextCodec* iso15 = QTextCodec::codecForName("ISO-8859-15");
+        return iso15->toUnicode(data, pituus);
+    }
+    default:
+        return QString::fromUtf8(data, pituus);
+    }
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CSVLUKIJA_H
+#define CSVLUKIJA_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+namespace Tuonti {
+
+/**
+ * @brief CSV-tiedoston virtaava lukija
+ *
+ * Lukee RFC 4180 -muotoista tietoa tietue kerrallaan suoraan
+ * tavutaulukosta, joka voi olla myös muistiin kartoitettu tiedosto.
+ * Lainausmerkeissä olevat erottimet ja rivinvaihdot kuuluvat kenttään.
+ *
+ * Lainaamattomat kentät palautetaan näkyminä alkuperäiseen dataan,
+ * joten dataa ei saa vapauttaa kenttien käsittelyn aikana.
+ *
+ * Koodaus ja erotinmerkki päätellään datan alusta otetusta näytteestä.
+ */
+class CsvLukija
+{
+public:
+    enum Koodaus { UTF8, LATIN1, ISO885915 };
+
+    explicit CsvLukija(const QByteArray& data);
+
+    /**
+     * @brief Siirtyy seuraavaan tietueeseen
+     * @return false, kun data on luettu loppuun
+     */
+    bool seuraava();
+
+    int kenttia() const { return kentat_.count(); }
+
+    /**
+     * @brief Kentän raakadata
+     *
+     * Lainaamaton kenttä palautetaan kopioimatta, lainatusta
+     * poistetaan lainausmerkit.
+     */
+    QByteArray kentta(int indeksi) const;
+    QString teksti(int indeksi) const;
+    QStringList rivi() const;
+
+    char erotin() const { return erotin_; }
+    Koodaus koodaus() const { return koodaus_; }
+
+    /**
+     * @brief Haistelee koodauksen ääkkösten avulla
+     *
+     * Vaihtoehtoina utf8, Latin1 ja 8859-15, oletuksena utf8
+     */
+    static Koodaus haistaKoodaus(const QByteArray& data);
+    /**
+     * @brief Päättelee ensimmäisen tietueen pohjalta erotinmerkin
+     * @return Vaihtoehtoina , ; TAB
+     */
+    static char haistaErotin(const QByteArray& data);
+    static QString dekoodaa(const char* data, int pituus, Koodaus koodaus);
+
+    /**
+     * @brief Haisteluun käytettävän näytteen koko tavuina
+     */
+    static const int NAYTE = 256 * 1024;
+
+protected:
+    struct Kentta {
+        int alku;
+        int pituus;
+        bool lainattu;
+    };
+
+    QByteArray data_;
+    int sijainti_ = 0;
+    Koodaus koodaus_;
+    char erotin_;
+    QVector<Kentta> kentat_;
+};
+
+}
+
+#endif // CSVLUKIJA_H
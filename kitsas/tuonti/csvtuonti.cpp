@@ -15,12 +15,12 @@
    along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <QTextCodec>
 #include <QRegularExpression>
 #include <QFile>
 #include <QDebug>
 
 #include "csvtuonti.h"
+#include "csvlukija.h"
 #include "tuontisarakedelegaatti.h"
 #include "tilimuuntomodel.h"
 #include "tuontiapu.h"
@@ -58,7 +58,7 @@ QVariantMap CsvTuonti::tuo(const QByteArray &data)
 QVariantMap CsvTuonti::tuonti(const QByteArray &data)
 {
     tuoListaan( data );
-    if( csv_.count() < 2)
+    if( esikatselu_.count() < 2)
         return QVariantMap();
 
     ui->tuontiTable->setRowCount( muodot_.count() );
@@ -67,7 +67,7 @@ QVariantMap CsvTuonti::tuonti(const QByteArray &data)
     TuontiSarakeDelegaatti* delegaatti = new TuontiSarakeDelegaatti();
     ui->tuontiTable->setItemDelegateForColumn(2, delegaatti);
 
-    QStringList otsikot = csv_.first();
+    QStringList otsikot = esikatselu_.first();
 
     connect( ui->kirjausRadio, SIGNAL(toggled(bool)), delegaatti, SLOT(asetaTyyppi(bool)));
     connect( ui->kirjausRadio, SIGNAL(toggled(bool)), this, SLOT(tarkistaTiliValittu()));
@@ -95,9 +95,9 @@ QVariantMap CsvTuonti::tuonti(const QByteArray &data)
         tuontiItem->setData(TyyppiRooli, muodot_.at(i));
         ui->tuontiTable->setItem(i,2,tuontiItem);
 
-        if( i < csv_.at(1).count() )
+        if( i < esikatselu_.at(1).count() )
         {
-            QTableWidgetItem *esimItem = new QTableWidgetItem( csv_.at(1).at(i));
+            QTableWidgetItem *esimItem = new QTableWidgetItem( esikatselu_.at(1).at(i));
             esimItem->setFlags(Qt::ItemIsEnabled);
             ui->tuontiTable->setItem(i,3,esimItem);
         }
@@ -130,17 +130,20 @@ QVariantMap CsvTuonti::kirjaukset()
         QList<QPair<int,QString>> tilinimet;
         QRegularExpression tiliRe("(\\d+)\\s?(.*)");
 
-        for(int r=1; r < csv_.count(); r++)
+        CsvLukija lukija(data_);
+        seuraavaRivi(lukija);   // Otsikkorivi
+        while( seuraavaRivi(lukija))
         {
+            const QStringList kentat = lukija.rivi();
             int tilinro = 0;
             QString tilinimi;
             for( int c=0; c < muodot_.count(); c++)
             {
-                if( c  >= csv_.at(r).count() )
+                if( c  >= kentat.count() )
                     continue;   // Rivimäärä ei täsmää
 
                 int tuonti = ui->tuontiTable->item(c,2)->data(Qt::EditRole).toInt();
-                QString tieto = csv_.at(r).at(c);
+                QString tieto = kentat.at(c);
                 if( tuonti == DEBETTILI || tuonti == KREDITTILI) {
                     // #1126 Lisätään tilimuuntoon myös debet- ja kredit-tilit
                     QRegularExpressionMatch mats = tiliRe.match(tieto);
@@ -193,8 +196,11 @@ QVariantMap CsvTuonti::kirjaukset()
 
     QRegularExpression numRe("\\d+");
 
-    for(int r=1; r < csv_.count(); r++)
+    CsvLukija lukija(data_);
+    seuraavaRivi(lukija);   // Otsikkorivi
+    while( seuraavaRivi(lukija))
     {
+        const QStringList kentat = lukija.rivi();
         TositeVienti vienti;
         int kreditTili = 0;
 
@@ -204,11 +210,11 @@ QVariantMap CsvTuonti::kirjaukset()
 
         for( int c=0; c < muodot_.count(); c++)
         {
-            if( c >= csv_.at(r).count() )
+            if( c >= kentat.count() )
                 continue;
 
             int tuonti = ui->tuontiTable->item(c,2)->data(Qt::EditRole).toInt();
-            QString tieto = csv_.at(r).at(c);
+            QString tieto = kentat.at(c);
             qlonglong sentit = TuontiApu::sentteina(tieto);
 
             if( tuonti == PAIVAMAARA )
@@ -303,8 +309,11 @@ QVariantMap CsvTuonti::tiliote()
     QDate alkaa;
     QDate loppuu;
 
-    for(int r=1; r < csv_.count(); r++)
+    CsvLukija lukija(data_);
+    seuraavaRivi(lukija);   // Otsikkorivi
+    while( seuraavaRivi(lukija))
     {
+        const QStringList kentat = lukija.rivi();
 
         QVariantMap rivi;
         QDate pvm;
@@ -312,10 +321,10 @@ QVariantMap CsvTuonti::tiliote()
         for( int c=0; c < muodot_.count(); c++)
         {
             int tuonti = ui->tuontiTable->item(c,2)->data(Qt::EditRole).toInt();
-            if( c >= csv_.at(r).count())
+            if( c >= kentat.count())
                 continue;
 
-            QString tieto = csv_.at(r).at(c);
+            QString tieto = kentat.at(c);
 
             if( tuonti == PAIVAMAARA )
             {
@@ -386,109 +395,33 @@ QVariantMap CsvTuonti::tiliote()
 
 QString CsvTuonti::haistettuKoodattu(const QByteArray &data)
 {
-    // Haistelee koodausta ääkkösten avulla
-    // Vaihtoehtoina utf8, Latin1, 8859-15
-
-    QRegularExpression skandit("[äöÄÖ€]");
-
-    QString utf8 = QString::fromUtf8(data);
-    if( utf8.contains(skandit))
-        return utf8;
-
-    QString latin1 = QString::fromLatin1(data);
-    if( latin1.contains(skandit))
-        return latin1;
-
-    QString iso15 = QTextCodec::codecForName("ISO-8859-15")->toUnicode(data);
-    if( iso15.contains(skandit))
-        return iso15;
-
-    // Ellei muuta, niin oletuksena tulee utf8
-    return utf8;
+    // Koodaus haistellaan datan alusta, ja koko data puretaan vain kerran
+    return CsvLukija::dekoodaa( data.constData(), data.size(), CsvLukija::haistaKoodaus(data));
 }
 
 QChar CsvTuonti::haistaErotin(const QString &data)
 {
-    // Päättelee, mikä on CSV-erottimena
-
-    int pilkut = 0;
-    int puolipisteet = 0;
-    int sarkaimet = 0;
-
-    bool lainattu = false;
-
-    for(const QChar& mki : data)
-    {
-        if( mki == QChar('\"'))
-            lainattu = !lainattu;
-        if( !lainattu)
-        {
-            if( mki == QChar(','))
-                pilkut++;
-            else if( mki == QChar(';'))
-                puolipisteet++;
-            else if( mki == QChar('\t'))
-                sarkaimet++;
-        }
-    }
-    if( puolipisteet > pilkut && puolipisteet > sarkaimet)
-        return QChar(';');
-    else if( sarkaimet > pilkut && sarkaimet > puolipisteet)
-        return QChar('\t');
-    else
-        return QChar(',');
+    return QChar( CsvLukija::haistaErotin( data.toUtf8() ) );
 }
 
-QList<QStringList> CsvTuonti::csvListana(const QByteArray &data)
+QList<QStringList> CsvTuonti::csvListana(const QByteArray &data, int enintaan)
 {
     QList<QStringList> csv;
+    CsvLukija lukija(data);
 
-    QString kaikki = haistettuKoodattu(data);
-    QStringList listana = kaikki.split(QRegularExpression("\\r?\\n"));
-    if( listana.isEmpty())
-        return {};
-    QChar erotin = haistaErotin(listana.first());
-
-    // Nyt sitten luodaan rivi kerrallaan listaa
-    for(QString rivi : listana)
-    {
-        QStringList nykyinenRivi;
-        QString nykyinenSana;
-        bool lainattuna = false;
+    while( (enintaan < 0 || csv.count() < enintaan) && seuraavaRivi(lukija))
+        csv.append( lukija.rivi() );
+    return csv;
+}
 
-        for(int i = 0; i < rivi.length(); i++)
-        {
-            QChar merkki = rivi.at(i);
-            if( merkki == QChar('"'))
-            {
-                if( lainattuna && rivi.length() > i+1 && rivi.at(i+1) == QChar('"'))
-                {
-                    nykyinenSana.append('"');
-                    i++;
-                }
-                else
-                    lainattuna = !lainattuna;
-            }
-            else if( !lainattuna && merkki == erotin )
-            {
-                // Erotin löytyi, sana tuli valmiiksi
-                nykyinenRivi.append(nykyinenSana);
-                nykyinenSana.clear();
-            }
-            else
-            {
-                // Muuten merkki lisätään paikalleen
-                nykyinenSana.append(merkki);
-            }
-        }
-        // Lopuksi viimeinen sana riville ja rivi tauluun
-        if( nykyinenRivi.length())
-        {
-            nykyinenRivi.append(nykyinenSana);
-            csv.append(nykyinenRivi);
-        }
+bool CsvTuonti::seuraavaRivi(CsvLukija &lukija)
+{
+    while( lukija.seuraava()) {
+        // Rivi ilman erotinta ei ole csv-tietoa
+        if( lukija.kenttia() > 1)
+            return true;
     }
-    return csv;
+    return false;
 }
 
 QString CsvTuonti::tyyppiTeksti(int muoto)
@@ -581,7 +514,7 @@ bool CsvTuonti::onkoCsv(const QByteArray &data)
 
     QByteArray testattava = data.left(4096);
 
-    QList<QStringList> lista = CsvTuonti::csvListana(testattava);
+    QList<QStringList> lista = CsvTuonti::csvListana(testattava, 20);
 
     // Kelpo CSV:ssä on alussakin vähintään 2 riviä, ja riveillä sama pituus
     if( lista.count() < 2 )
@@ -600,7 +533,7 @@ bool CsvTuonti::onkoCsv(const QByteArray &data)
 
 void CsvTuonti::paivitaOletukset()
 {
-    QStringList otsikot = csv_.first();
+    QStringList otsikot = esikatselu_.first();
 
     bool pvmkaytetty = false;
 
@@ -705,81 +638,92 @@ void CsvTuonti::tarkistaTiliValittu()
 
 int CsvTuonti::tuoListaan(const QByteArray &data)
 {
-    csv_ = csvListana(data);
-
-    // Tämän jälkeen sitten analysoidaan listaa eli mitä sisältää
-    QRegularExpression suomipvmRe("^[0123]?\\d\\.[01]?\\d\\.\\d{4}$");
-    QRegularExpression isopvmRe("^\\d{4}-[01]\\d-[0123]\\d$");
-    QRegularExpression uspvmRe(R"(^\d\d [A-Z][a-z][a-z] 20\d\d( \d\d:\d\d:\d\d)?$)");
-    QRegularExpression rahaRe("^[+-]?\\d+[.,]?\\d{0,2}$");
-    QRegularExpression lukuTekstiRe("^\\d+\\s.*");
-    QRegularExpression lukuRe("^[+-]?\\d+$");
-    QRegularExpression valiRe("\\s");
-    valiRe.setPatternOptions(QRegularExpression::UseUnicodePropertiesOption);
+    // Tuotavat rivit luetaan vasta tuotaessa, joten muistissa
+    // pidetään vain esikatseltavat otsikko- ja esimerkkirivi
+    data_ = data;
+    esikatselu_ = csvListana(data, 2);
+    muodot_ = sarakemuodot(data);
+    return esikatselu_.count();
+}
 
+QVector<CsvTuonti::Sarakemuoto> CsvTuonti::sarakemuodot(const QByteArray &data)
+{
+    QVector<Sarakemuoto> muodot;
+    CsvLukija lukija(data);
+    if( !seuraavaRivi(lukija))
+        return muodot;
 
     // Muototauluun luetaan datasarakkeiden muoto
     // Jos yhdelläkin rivillä ei ole samassa muodossa, tulee muodoksi TEKSTI
-    muodot_.resize( csv_.first().length() );
+    muodot.resize( lukija.kenttia() );
 
-    for( int r = 1; r < csv_.count(); r++)
+    while( seuraavaRivi(lukija))
     {
-        QStringList rivi = csv_.at(r);
-
-        for(int i=0; i < qMin(rivi.length(), csv_.first().length()); i++)
-        {
-            const QString& teksti = rivi.at(i);
-            QString valeitta = teksti;
-            valeitta.remove(valiRe);
-
-            Sarakemuoto muoto = TEKSTI;
-
-            if( valeitta.isEmpty())
-                muoto = TYHJA;
-            else if( teksti.count(suomipvmRe)  )
-                muoto = SUOMIPVM;
-            else if( teksti.count(isopvmRe))
-                muoto = ISOPVM;
-            else if( teksti.contains(uspvmRe))
-                muoto = USPVM;
-            // Tilinumeron kanssa samaan kenttään on voitu tunkea IBAN-joten kokeillaan
-            // myös vähän muokatuilla versioilla
-            else if( !valeitta.startsWith("RF") &&
-                     ( IbanValidator::kelpaako(valeitta) ||
-                     IbanValidator::kelpaako(valeitta.left(18)) ||
-                     IbanValidator::kelpaako(teksti.left(teksti.indexOf(QChar(' '))) ))  )
-                muoto = TILI;
-            else if( ViiteValidator::kelpaako(valeitta ) )
-                muoto = VIITE;
-            else if( teksti.contains(lukuRe)) {
-                if( teksti.toLongLong() > -1 && teksti.toLongLong() < 100)
-                    muoto = ALLESATA;
-                else
-                    muoto = LUKU;
-            } else if( valeitta.contains(rahaRe))
-                muoto = RAHA;
-            else if( teksti.contains(lukuTekstiRe))
-                muoto = LUKUTEKSTI;
+        for(int i=0; i < qMin(lukija.kenttia(), muodot.count()); i++)
+            muodot[i] = yhdistaMuodot( muodot.at(i), tunnistaMuoto( lukija.teksti(i) ) );
+    }
+    return muodot;
+}
 
+CsvTuonti::Sarakemuoto CsvTuonti::tunnistaMuoto(const QString &teksti)
+{
+    static const QRegularExpression suomipvmRe("^[0123]?\\d\\.[01]?\\d\\.\\d{4}$");
+    static const QRegularExpression isopvmRe("^\\d{4}-[01]\\d-[0123]\\d$");
+    static const QRegularExpression uspvmRe(R"(^\d\d [A-Z][a-z][a-z] 20\d\d( \d\d:\d\d:\d\d)?$)");
+    static const QRegularExpression rahaRe("^[+-]?\\d+[.,]?\\d{0,2}$");
+    static const QRegularExpression lukuTekstiRe("^\\d+\\s.*");
+    static const QRegularExpression lukuRe("^[+-]?\\d+$");
+    static const QRegularExpression valiRe("\\s", QRegularExpression::UseUnicodePropertiesOption);
+
+    QString valeitta = teksti;
+    valeitta.remove(valiRe);
+
+    if( valeitta.isEmpty())
+        return TYHJA;
+    else if( teksti.count(suomipvmRe)  )
+        return SUOMIPVM;
+    else if( teksti.count(isopvmRe))
+        return ISOPVM;
+    else if( teksti.contains(uspvmRe))
+        return USPVM;
+    // Tilinumeron kanssa samaan kenttään on voitu tunkea IBAN-joten kokeillaan
+    // myös vähän muokatuilla versioilla
+    else if( !valeitta.startsWith("RF") &&
+             ( IbanValidator::kelpaako(valeitta) ||
+             IbanValidator::kelpaako(valeitta.left(18)) ||
+             IbanValidator::kelpaako(teksti.left(teksti.indexOf(QChar(' '))) ))  )
+        return TILI;
+    else if( ViiteValidator::kelpaako(valeitta ) )
+        return VIITE;
+    else if( teksti.contains(lukuRe)) {
+        if( teksti.toLongLong() > -1 && teksti.toLongLong() < 100)
+            return ALLESATA;
+        else
+            return LUKU;
+    } else if( valeitta.contains(rahaRe))
+        return RAHA;
+    else if( teksti.contains(lukuTekstiRe))
+        return LUKUTEKSTI;
+    return TEKSTI;
+}
 
-            if(muodot_[i] != TEKSTI && muodot_[i] != muoto && muoto != TYHJA)
-            {
-                if( muodot_[i] == TYHJA || (muodot_[i]==LUKU && muoto == LUKUTEKSTI) ||                        
-                        (muodot_[i]==LUKU && muoto==RAHA) ||
-                        (muodot_[i]==ALLESATA && muoto==LUKU) ||
-                        (muodot_[i]==ALLESATA && muoto==RAHA))
-                    muodot_[i] = muoto;
-                else if( muodot_[i]==RAHA && ( muoto==LUKU || muoto == ALLESATA || muoto==VIITE))
-                    muodot_[i] = RAHA;
-                else if( (muodot_[i] == LUKU && muoto == VIITE ) || (muodot_[i] == VIITE && muoto == LUKU) )
-                    muodot_[i] = LUKU;
-                else
-                    muodot_[i] = TEKSTI;
-            }
-        }
+CsvTuonti::Sarakemuoto CsvTuonti::yhdistaMuodot(Sarakemuoto sarake, Sarakemuoto muoto)
+{
+    if(sarake != TEKSTI && sarake != muoto && muoto != TYHJA)
+    {
+        if( sarake == TYHJA || (sarake==LUKU && muoto == LUKUTEKSTI) ||
+                (sarake==LUKU && muoto==RAHA) ||
+                (sarake==ALLESATA && muoto==LUKU) ||
+                (sarake==ALLESATA && muoto==RAHA))
+            return muoto;
+        else if( sarake==RAHA && ( muoto==LUKU || muoto == ALLESATA || muoto==VIITE))
+            return RAHA;
+        else if( (sarake == LUKU && muoto == VIITE ) || (sarake == VIITE && muoto == LUKU) )
+            return LUKU;
+        else
+            return TEKSTI;
     }
-
-    return csv_.count();
+    return sarake;
 }
 
 }
@@ -28,7 +28,7 @@
 
 namespace Tuonti {
 
-
+class CsvLukija;
 
 class CsvTuonti : public QDialog
 {
@@ -99,9 +99,10 @@ public:
     /**
      * @brief Sijoittaa csv:n listamuotoon
      * @param data
+     * @param enintaan Luettavien rivien enimmäismäärä, -1 luetaan kaikki
      * @return
      */
-    static QList<QStringList> csvListana(const QByteArray& data);
+    static QList<QStringList> csvListana(const QByteArray& data, int enintaan = -1);
 
     static QString tyyppiTeksti(int muoto);
     static QString tuontiTeksti(int tuominen);
@@ -125,7 +126,20 @@ protected:
 
     int tuoListaan(const QByteArray& data);
 
-    QList<QStringList> csv_;
+    /**
+     * @brief Päättelee sarakkeiden muodot lukemalla datan rivi kerrallaan
+     */
+    static QVector<Sarakemuoto> sarakemuodot(const QByteArray& data);
+    static Sarakemuoto tunnistaMuoto(const QString& teksti);
+    static Sarakemuoto yhdistaMuodot(Sarakemuoto sarake, Sarakemuoto muoto);
+
+    /**
+     * @brief Siirtyy seuraavalle csv-riville ohittaen rivit, joilla ei ole erotinta
+     */
+    static bool seuraavaRivi(CsvLukija& lukija);
+
+    QByteArray data_;
+    QList<QStringList> esikatselu_;
     QVector<Sarakemuoto> muodot_;
 
     Ui::CsvTuonti *ui;
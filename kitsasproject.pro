@@ -7,4 +7,14 @@ SUBDIRS = kitsas/kitsas.pro \
 	testit/testit.pro \
 	unittest/eurotest \
 	unittest/tositerivitesti \
-	unittest/viitetesti
+	unittest/viitetesti \
+	unittest/taydennystesti \
+	unittest/indeksitesti \
+	unittest/tuontitulkkitesti \
+	unittest/csvlukijatesti \
+	unittest/pilviliikennetesti \
+	unittest/pilvinipputesti \
+	unittest/vientirivitesti \
+	unittest/luettelotesti \
+	unittest/sahkopostijonotesti \
+	unittest/valimuistitesti
@@ -5,6 +5,7 @@ QT += printsupport
 QT += network
 QT += svg
 QT += xml
+QT += concurrent
 QT += qml
 
 CONFIG += c++14
@@ -8,11 +8,18 @@ QT += printsupport
 QT += network
 QT += svg
 QT += xml
+QT += concurrent
 
 LIBS += -lpoppler-qt5
 LIBS += -lpoppler
 LIBS += -lzip
 
+# SQLite-kahvan käyttö, ks. kitsas/kitsas.pro
+contains(QT.sql_private.enabled_features, system-sqlite)|contains(QT.sqldrivers_private.enabled_features, system-sqlite)|kitsas_system_sqlite {
+    DEFINES += KITSAS_SYSTEM_SQLITE
+    LIBS += -lsqlite3
+}
+
 CONFIG += qt console warn_on depend_includepath testcase
 CONFIG -= app_bundle
 
@@ -0,0 +1,15 @@
+QT += testlib
+QT -= gui
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../kitsas
+VPATH += $$PWD/../../kitsas
+
+SOURCES +=  tst_csvlukijatesti.cpp \
+    tuonti/csvlukija.cpp
+
+HEADERS += tuonti/csvlukija.h
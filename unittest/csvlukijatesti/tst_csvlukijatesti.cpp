@@ -0,0 +1,269 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QTextCodec>
+#include <QRegularExpression>
+
+#include "tuonti/csvlukija.h"
+
+using Tuonti::CsvLukija;
+
+class CsvLukijaTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    CsvLukijaTesti();
+    ~CsvLukijaTesti();
+
+private slots:
+    void initTestCase();
+    void erotin_data();
+    void erotin();
+    void koodaus();
+    void lainausmerkit();
+    void rivinvaihtoKentassa();
+    void windowsRivit();
+    void tavujarjestysmerkki();
+    void nakymaDataan();
+    void vastaavuus();
+    void vanhaLista();
+    void uusiLista();
+    void virtaavaLuku();
+
+protected:
+    static QList<QStringList> luettu(const QByteArray& data);
+    static QList<QStringList> vanhaCsvListana(const QByteArray& data);
+
+    QByteArray suuri_;
+};
+
+CsvLukijaTesti::CsvLukijaTesti()
+{
+}
+
+CsvLukijaTesti::~CsvLukijaTesti()
+{
+}
+
+void CsvLukijaTesti::initTestCase()
+{
+    // Noin 50 megatavun tiliotevienti toisesta järjestelmästä
+    QByteArray rivi;
+    suuri_.reserve(52 * 1024 * 1024);
+    suuri_.append("Päivämäärä;Saaja/Maksaja;Selitys;Viite;Määrä;Arkistotunnus\n");
+    for(int i=0; suuri_.size() < 50 * 1024 * 1024; i++) {
+        rivi = QString("%1.%2.2020;\"Kauppa %3 Oy\";\"Ostos, kortti\";%4;-%5,%6;%7\n")
+                .arg(1 + i % 28).arg(1 + i % 12).arg(i % 500)
+                .arg(1000 + i).arg(i % 300).arg(i % 100, 2, 10, QChar('0'))
+                .arg(i, 16, 10, QChar('0')).toUtf8();
+        suuri_.append(rivi);
+    }
+}
+
+void CsvLukijaTesti::erotin_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<char>("erotin");
+
+    QTest::newRow("pilkku") << QByteArray("a,b,c\n1,2,3\n") << ',';
+    QTest::newRow("puolipiste") << QByteArray("a;b;c\n1,5;2;3\n") << ';';
+    QTest::newRow("sarkain") << QByteArray("a\tb\tc\n") << '\t';
+    QTest::newRow("lainattu") << QByteArray("\"a;b;c\",d,e\n") << ',';
+    QTest::newRow("vain ensimmäinen rivi") << QByteArray("a,b\n1;2;3;4\n") << ',';
+}
+
+void CsvLukijaTesti::erotin()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(char, erotin);
+
+    QCOMPARE( CsvLukija::haistaErotin(data), erotin);
+}
+
+void CsvLukijaTesti::koodaus()
+{
+    const QString teksti = QString::fromUtf8("Määrä;Öljy €\n");
+
+    QCOMPARE( CsvLukija::haistaKoodaus( teksti.toUtf8()), CsvLukija::UTF8);
+    QCOMPARE( CsvLukija::haistaKoodaus( QString("Määrä;Öljy\n").toLatin1()), CsvLukija::LATIN1);
+    QCOMPARE( CsvLukija::haistaKoodaus( QTextCodec::codecForName("ISO-8859-15")->fromUnicode("Hinta;€\n")), CsvLukija::ISO885915);
+    QCOMPARE( CsvLukija::haistaKoodaus( "abc;def\n"), CsvLukija::UTF8);
+
+    CsvLukija lukija( QString("Määrä;Öljy\n").toLatin1() );
+    QVERIFY( lukija.seuraava());
+    QCOMPARE( lukija.rivi(), QStringList() << "Määrä" << "Öljy");
+}
+
+void CsvLukijaTesti::lainausmerkit()
+{
+    QCOMPARE( luettu("a,\"b,c\",\"sanoi \"\"hei\"\"\",\n"),
+              QList<QStringList>() << (QStringList() << "a" << "b,c" << "sanoi \"hei\"" << ""));
+}
+
+void CsvLukijaTesti::rivinvaihtoKentassa()
+{
+    QCOMPARE( luettu("nimi,osoite\nOy Ab,\"Katu 1\nPL 12\"\nToinen,Tie 2\n"),
+              QList<QStringList>() << (QStringList() << "nimi" << "osoite")
+                                   << (QStringList() << "Oy Ab" << "Katu 1\nPL 12")
+                                   << (QStringList() << "Toinen" << "Tie 2"));
+}
+
+void CsvLukijaTesti::windowsRivit()
+{
+    QCOMPARE( luettu("a;b\r\n\"1\";2\r\n\r\n3;4"),
+              QList<QStringList>() << (QStringList() << "a" << "b")
+                                   << (QStringList() << "1" << "2")
+                                   << (QStringList() << "")
+                                   << (QStringList() << "3" << "4"));
+}
+
+void CsvLukijaTesti::tavujarjestysmerkki()
+{
+    QCOMPARE( luettu("\xEF\xBB\xBFp\xC3\xA4iv\xC3\xA4,summa\n"),
+              QList<QStringList>() << (QStringList() << "päivä" << "summa"));
+}
+
+void CsvLukijaTesti::nakymaDataan()
+{
+    const QByteArray data("abc;\"d\"\"e\";f\n");
+    CsvLukija lukija(data);
+    QVERIFY( lukija.seuraava());
+    QCOMPARE( lukija.kenttia(), 3);
+
+    // Lainaamaton kenttä osoittaa suoraan alkuperäiseen dataan
+    QVERIFY( lukija.kentta(0).constData() == data.constData());
+    QCOMPARE( lukija.kentta(0), QByteArray("abc"));
+    QCOMPARE( lukija.kentta(1), QByteArray("d\"e"));
+    QVERIFY( lukija.kentta(2).constData() == data.constData() + 11);
+    QVERIFY( !lukija.seuraava());
+}
+
+void CsvLukijaTesti::vastaavuus()
+{
+    // Ilman lainattuja rivinvaihtoja tulos on sama kuin aiemmin
+    QList<QStringList> uusi;
+    CsvLukija lukija( suuri_.left(1024 * 1024));
+    while( lukija.seuraava())
+        if( lukija.kenttia() > 1)
+            uusi.append( lukija.rivi());
+
+    const QList<QStringList> vanha = vanhaCsvListana( suuri_.left(1024 * 1024) );
+    QCOMPARE( uusi.count(), vanha.count());
+    for(int i=0; i < vanha.count(); i++)
+        QCOMPARE( uusi.at(i), vanha.at(i));
+}
+
+void CsvLukijaTesti::vanhaLista()
+{
+    QBENCHMARK_ONCE {
+        QList<QStringList> lista = vanhaCsvListana(suuri_);
+        QVERIFY( lista.count() > 1);
+    }
+}
+
+void CsvLukijaTesti::uusiLista()
+{
+    QBENCHMARK_ONCE {
+        QList<QStringList> lista;
+        CsvLukija lukija(suuri_);
+        while( lukija.seuraava())
+            if( lukija.kenttia() > 1)
+                lista.append( lukija.rivi());
+        QVERIFY( lista.count() > 1);
+    }
+}
+
+void CsvLukijaTesti::virtaavaLuku()
+{
+    // Kenttiä käsitellään näkyminä muodostamatta välitaulukoita
+    qint64 tavuja = 0;
+    QBENCHMARK_ONCE {
+        CsvLukija lukija(suuri_);
+        while( lukija.seuraava())
+            for(int i=0; i < lukija.kenttia(); i++)
+                tavuja += lukija.kentta(i).size();
+    }
+    QVERIFY( tavuja > 0);
+}
+
+QList<QStringList> CsvLukijaTesti::luettu(const QByteArray &data)
+{
+    QList<QStringList> lista;
+    CsvLukija lukija(data);
+    while( lukija.seuraava())
+        lista.append( lukija.rivi());
+    return lista;
+}
+
+QList<QStringList> CsvLukijaTesti::vanhaCsvListana(const QByteArray &data)
+{
+    // Aiempi toteutus, joka purki koko tiedoston kerralla
+    QList<QStringList> csv;
+
+    QRegularExpression skandit("[äöÄÖ€]");
+    QString kaikki = QString::fromUtf8(data);
+    if( !kaikki.contains(skandit)) {
+        const QString latin1 = QString::fromLatin1(data);
+        if( latin1.contains(skandit))
+            kaikki = latin1;
+    }
+
+    QStringList listana = kaikki.split(QRegularExpression("\\r?\\n"));
+    if( listana.isEmpty())
+        return {};
+    const QChar erotin = QChar( CsvLukija::haistaErotin( listana.first().toUtf8()) );
+
+    for(QString rivi : listana)
+    {
+        QStringList nykyinenRivi;
+        QString nykyinenSana;
+        bool lainattuna = false;
+
+        for(int i = 0; i < rivi.length(); i++)
+        {
+            QChar merkki = rivi.at(i);
+            if( merkki == QChar('"'))
+            {
+                if( lainattuna && rivi.length() > i+1 && rivi.at(i+1) == QChar('"'))
+                {
+                    nykyinenSana.append('"');
+                    i++;
+                }
+                else
+                    lainattuna = !lainattuna;
+            }
+            else if( !lainattuna && merkki == erotin )
+            {
+                nykyinenRivi.append(nykyinenSana);
+                nykyinenSana.clear();
+            }
+            else
+                nykyinenSana.append(merkki);
+        }
+        if( nykyinenRivi.length())
+        {
+            nykyinenRivi.append(nykyinenSana);
+            csv.append(nykyinenRivi);
+        }
+    }
+    return csv;
+}
+
+QTEST_APPLESS_MAIN(CsvLukijaTesti)
+
+#include "tst_csvlukijatesti.moc"
@@ -18,6 +18,8 @@
 
 #include "model/euro.h"
 
+#include <QJsonDocument>
+
 class EuroTest : public QObject
 {
     Q_OBJECT
@@ -41,6 +43,10 @@ private slots:
     void str2();
     void neg_to_str();
     void euro_eq_euro();
+    void typed_variant();
+    void typed_variant_json();
+    void typed_variant_eq();
+    void big_double_to_euro();
 };
 
 EuroTest::EuroTest()
@@ -198,7 +204,36 @@ void EuroTest::euro_eq_euro()
     QVERIFY(c != d);
 }
 
+void EuroTest::typed_variant()
+{
+    QVariant variant = Euro(-12345).toTypedVariant();
+    QCOMPARE( variant.userType(), qMetaTypeId<Euro>());
+    QCOMPARE( Euro::fromVariant(variant).cents(), -12345);
+    QCOMPARE( variant.toString(), QString("-123.45"));
+    QVERIFY( qAbs(variant.toDouble() + 123.45) < 1e-9);
+}
+
+void EuroTest::typed_variant_json()
+{
+    QVariantMap map;
+    map.insert("debet", Euro(1205).toTypedVariant());
+    QCOMPARE( QJsonDocument::fromVariant(map).toJson(QJsonDocument::Compact),
+              QByteArray("{\"debet\":\"12.05\"}"));
+}
 
+void EuroTest::typed_variant_eq()
+{
+    QVERIFY( Euro(512).toTypedVariant() == Euro(512).toTypedVariant());
+    QVERIFY( Euro(512).toTypedVariant() != Euro(-512).toTypedVariant());
+    QVERIFY( Euro(512).toTypedVariant() == QVariant("5.12"));
+}
+
+void EuroTest::big_double_to_euro()
+{
+    // QVariant esittää suuret liukuluvut eksponenttimuodossa
+    QCOMPARE( Euro::fromVariant(QVariant(1000000.0)).cents(), 100000000);
+    QCOMPARE( Euro::fromVariant(QVariant(-0.07)).cents(), -7);
+}
 
 QTEST_APPLESS_MAIN(EuroTest)
 
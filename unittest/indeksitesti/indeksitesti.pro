@@ -0,0 +1,7 @@
+include(../apptest.pri)
+
+SOURCES += \
+    tst_indeksitesti.cpp
+
+RESOURCES += \
+    indeksitesti.qrc
@@ -0,0 +1,238 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QFile>
+#include <QTextStream>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QRegularExpression>
+
+#include "sqlite/sqliteroute.h"
+#include "sqlite/sqlitemodel.h"
+
+/**
+ * @brief Saldokyselyn muodostus ilman reitin luomista
+ */
+class SaldoKysely : public SQLiteRoute
+{
+public:
+    using SQLiteRoute::saldoKysely;
+};
+
+/**
+ * @brief Varmistaa, etteivät kuormittavimmat kyselyt joudu käymään taulua läpi
+ *
+ * Kyselysuunnitelmat haetaan tyhjästä, luo.sql:n mukaisesta tietokannasta.
+ * Jos jokin kysely ei enää osu indeksiin, suunnitelmassa näkyy SCAN-rivi.
+ *
+ * Lisäksi versiossa 24 luotu tietokanta päivitetään nykyiseen versioon,
+ * ja sillä pitää olla samat indeksit kuin uudella tietokannalla.
+ */
+class IndeksiTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    IndeksiTesti();
+    ~IndeksiTesti();
+
+private slots:
+    void initTestCase();
+    void erat();
+    void merkkaukset();
+    void taseErittely();
+    void saldot();
+    void tositteet();
+    void paivitys();
+    void cleanupTestCase();
+
+protected:
+    void lataa(QSqlDatabase& db, const QString& tiedosto);
+    void tarkasta(const QString& kysely, const QVariantList& arvot = QVariantList());
+    void tarkasta(QSqlDatabase& db, const QString& kysely, const QVariantList& arvot = QVariantList());
+    static QStringList indeksit(QSqlDatabase& db);
+
+    QSqlDatabase db_;
+    QSqlDatabase vanha_;
+};
+
+IndeksiTesti::IndeksiTesti()
+{
+}
+
+IndeksiTesti::~IndeksiTesti()
+{
+}
+
+void IndeksiTesti::initTestCase()
+{
+    db_ = QSqlDatabase::addDatabase("QSQLITE", "INDEKSITESTI");
+    db_.setDatabaseName(":memory:");
+    QVERIFY( db_.open() );
+    lataa(db_, ":/sqlite/luo.sql");
+}
+
+void IndeksiTesti::lataa(QSqlDatabase &db, const QString &tiedosto)
+{
+    QSqlQuery query(db);
+    QFile sqltiedosto(tiedosto);
+    QVERIFY( sqltiedosto.open(QIODevice::ReadOnly) );
+    QTextStream in(&sqltiedosto);
+    in.setCodec("UTF-8");
+    QString sqluonti = in.readAll();
+    sqluonti.replace("\n","");
+    for(const QString& kysely : sqluonti.split(";")) {
+        if( !kysely.isEmpty())
+            QVERIFY2( query.exec(kysely), qPrintable(query.lastError().text()));
+    }
+}
+
+void IndeksiTesti::tarkasta(const QString &kysely, const QVariantList &arvot)
+{
+    tarkasta(db_, kysely, arvot);
+}
+
+void IndeksiTesti::tarkasta(QSqlDatabase &db, const QString &kysely, const QVariantList &arvot)
+{
+    QSqlQuery query(db);
+    QVERIFY2( query.prepare("EXPLAIN QUERY PLAN " + kysely), qPrintable(query.lastError().text()) );
+    for(const QVariant& arvo : arvot)
+        query.addBindValue(arvo);
+    QVERIFY2( query.exec(), qPrintable(query.lastError().text()) );
+
+    // Alikyselyn tulosten läpikäynti on sallittua, taulujen ei
+    const QRegularExpression taulunLapikaynti("^SCAN (?!\\(?subquery|SUBQUERY|CONSTANT)", QRegularExpression::CaseInsensitiveOption);
+    QStringList suunnitelma;
+    bool lapikaynti = false;
+    while( query.next()) {
+        const QString rivi = query.value(3).toString();
+        suunnitelma << rivi;
+        if( taulunLapikaynti.match(rivi).hasMatch())
+            lapikaynti = true;
+    }
+    QVERIFY2( !lapikaynti, qPrintable(kysely + "\n" + suunnitelma.join("\n")) );
+}
+
+void IndeksiTesti::erat()
+{
+    const QDate pvm(2020,6,15);
+
+    tarkasta("SELECT eraid, SUM(debetsnt) as debetit, SUM(kreditsnt) as kreditit FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+             "WHERE eraid IN (1,2,3) AND Tosite.tila >= 100 GROUP BY eraid");
+    tarkasta("SELECT sum(debetsnt), sum(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=? AND Vienti.pvm<? AND Tosite.tila >= 100 ",
+             { 1, pvm });
+    tarkasta("select vienti.eraid as eraid, sum(vienti.debetsnt) as sd, sum(vienti.kreditsnt) as sk, a.selite as selite, tosite.pvm as pvm, a.tili as tili, "
+             "tosite.tunniste as tunniste, tosite.sarja as sarja, tosite.tyyppi as tositetyyppi, "
+             "a.kumppani, kumppani.nimi "
+             "FROM  Vienti JOIN Tosite AS t ON vienti.tosite=t.id "
+             "JOIN Vienti AS a ON vienti.eraid = a.id JOIN Tosite ON a.Tosite=Tosite.id  "
+             "LEFT OUTER JOIN Kumppani ON a.kumppani=Kumppani.id "
+             "WHERE Tosite.tila >= 100 AND t.tila >= 100 AND a.tili=? "
+             "GROUP BY vienti.eraid ", { 1700 });
+}
+
+void IndeksiTesti::merkkaukset()
+{
+    tarkasta("SELECT vienti, kohdennus FROM Merkkaus WHERE vienti IN (1,2,3) ORDER BY vienti, kohdennus");
+    tarkasta("SELECT vienti.id AS id FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+             "JOIN Merkkaus ON Vienti.id=Merkkaus.vienti WHERE tila >= 100 AND merkkaus.kohdennus=?", { 1 });
+}
+
+void IndeksiTesti::taseErittely()
+{
+    const QDate mista(2020,1,1);
+    const QDate mihin(2020,12,31);
+
+    tarkasta("select vienti.eraid, vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
+             "Tosite.tunniste, tosite.id, Vienti.pvm as vientipvm, Kumppani.nimi AS kumppaninimi "
+             "FROM Vienti JOIN Tosite ON Vienti.tosite = Tosite.id LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
+             "WHERE Vienti.tili=? AND Vienti.id=Vienti.eraid "
+             "AND Vienti.pvm <= ? AND Tosite.tila >= 100 ORDER BY Vienti.pvm", { 1700, mihin });
+    tarkasta("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm as pvm, Tosite.sarja, "
+             "Tosite.tunniste, tosite.id, Vienti.pvm as vientipvm, Kumppani.nimi AS kumppaninimi "
+             "FROM Vienti  JOIN Tosite ON Vienti.tosite = Tosite.id  "
+             "LEFT OUTER JOIN Kumppani ON Vienti.kumppani = Kumppani.id "
+             "WHERE Vienti.eraid=? AND Vienti.id<>Vienti.eraid "
+             "AND Vienti.pvm BETWEEN ? AND ? AND Tosite.tila >= 100 ORDER BY Vienti.pvm", { 1, mista, mihin });
+    tarkasta("select vienti.debetsnt, vienti.kreditsnt, vienti.selite, Tosite.pvm, Tosite.sarja, "
+             "Tosite.tunniste, Vienti.pvm, Kumppani.nimi AS Kumppani "
+             "FROM Vienti JOIN Tosite ON Vienti.tosite = Tosite.id  "
+             "LEFT OUTER JOIN Kumppani ON Vienti.kumppani=Kumppani.id "
+             "WHERE Vienti.tili=? "
+             "AND Vienti.pvm BETWEEN ? AND ? AND Tosite.tila >= 100 ORDER BY vienti.pvm", { 1700, mista, mihin });
+}
+
+void IndeksiTesti::saldot()
+{
+    QVariantList arvot;
+    tarkasta(QString("SELECT tili, SUM(debetsnt), SUM(kreditsnt) FROM (%1) GROUP BY tili")
+             .arg(SaldoKysely::saldoKysely(QDate(2020,1,15), QDate(2020,6,15), arvot)), arvot);
+
+    arvot.clear();
+    tarkasta(QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM (%1)")
+             .arg(SaldoKysely::saldoKysely(QDate(), QDate(2020,6,15), arvot, "tili = 1910")), arvot);
+}
+
+void IndeksiTesti::tositteet()
+{
+    tarkasta("SELECT tosite.id AS id FROM Tosite WHERE tosite.tila = 0 ORDER BY pvm");
+    tarkasta("SELECT tili FROM Vienti WHERE tosite=? AND tili <> ?", { 1, 1700 });
+}
+
+void IndeksiTesti::paivitys()
+{
+    vanha_ = QSqlDatabase::addDatabase("QSQLITE", "PAIVITYSTESTI");
+    vanha_.setDatabaseName(":memory:");
+    QVERIFY( vanha_.open() );
+    lataa(vanha_, ":/indeksitesti/versio24.sql");
+    QVERIFY( indeksit(vanha_).contains("vienti_tili") );
+
+    QVERIFY( SQLiteModel::paivitaRakenne(vanha_, 24) );
+    QCOMPARE( indeksit(vanha_), indeksit(db_) );
+
+    // Päivitetyllä tietokannalla kyselyt osuvat samoihin indekseihin
+    tarkasta(vanha_, "SELECT sum(debetsnt), sum(kreditsnt) FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=? AND Vienti.pvm<? AND Tosite.tila >= 100 ",
+             { 1, QDate(2020,6,15) });
+    tarkasta(vanha_, "SELECT vienti.id AS id FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+             "JOIN Merkkaus ON Vienti.id=Merkkaus.vienti WHERE tila >= 100 AND merkkaus.kohdennus=?", { 1 });
+    tarkasta(vanha_, "SELECT tosite.id AS id FROM Tosite WHERE tosite.tila = 0 ORDER BY pvm");
+
+    // Päivityksen voi ajaa uudelleen, jos edellinen yritys on keskeytynyt
+    QVERIFY( SQLiteModel::paivitaRakenne(vanha_, 26) );
+    QCOMPARE( indeksit(vanha_), indeksit(db_) );
+}
+
+QStringList IndeksiTesti::indeksit(QSqlDatabase &db)
+{
+    QStringList nimet;
+    QSqlQuery query(db);
+    query.exec("SELECT name FROM sqlite_master WHERE type='index' AND name NOT LIKE 'sqlite_autoindex%' ORDER BY name");
+    while( query.next())
+        nimet << query.value(0).toString();
+    return nimet;
+}
+
+void IndeksiTesti::cleanupTestCase()
+{
+    db_.close();
+    vanha_.close();
+}
+
+QTEST_GUILESS_MAIN(IndeksiTesti)
+
+#include "tst_indeksitesti.moc"
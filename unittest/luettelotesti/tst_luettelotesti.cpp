@@ -0,0 +1,239 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QApplication>
+
+#include "db/kirjanpito.h"
+#include "db/tilimodel.h"
+#include "db/tilikausimodel.h"
+#include "db/kohdennusmodel.h"
+#include "kieli/kielet.h"
+
+/**
+ * @brief Tilien, kohdennusten ja tilikausien hakemistot
+ *
+ * Hakemistojen tulosta verrataan luettelon läpikäyntiin, ja
+ * vertailuissa haetaan raportin tapaan jokaiselle 100 000 rivistä
+ * tilikausi, tili ja kohdennus.
+ */
+class LuetteloTesti : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void tilikausiPaivalle();
+    void kelvotonPaiva();
+    void tiliNumerolla();
+    void tiliTyypilla();
+    void tiliIbanilla();
+    void kohdennus();
+    void lisattyTili();
+
+    void raporttiHakemistoilla();
+    void raporttiLapikaynnilla();
+
+private:
+    struct Rivi {
+        QDate pvm;
+        int tili;
+        int kohdennus;
+    };
+
+    static Tilikausi kausiLapikaynnilla(const QList<Tilikausi>& kaudet, const QDate& pvm);
+
+    TiliModel tilit_;
+    TilikausiModel kaudet_;
+    KohdennusModel kohdennukset_;
+
+    QList<Tilikausi> kausilista_;
+    QVector<Rivi> rivit_;
+};
+
+void LuetteloTesti::initTestCase()
+{
+    char *argv[] = {"Test"};
+    int argc = 1;
+    new QApplication(argc, argv);
+    Kielet::alustaKielet(":/tr/tulkki.json");
+    kp()->asetaInstanssi(new Kirjanpito());
+
+    const QStringList tyypit = { "A", "AS", "ARP", "B", "BS", "BL", "C", "CL", "D", "DP" };
+    QVariantList tililista;
+    for(int i=0; i < 400; i++) {
+        QVariantMap tili;
+        tili.insert("numero", 1000 + i * 20);
+        tili.insert("tyyppi", tyypit.at( i * tyypit.count() / 400 ));
+        tili.insert("nimi", QString("Tili %1").arg(i));
+        if( i % 50 == 7)
+            tili.insert("iban", QString("FI%1").arg(i, 16, 10, QChar('0')));
+        tililista.append(tili);
+    }
+    tilit_.lataa(tililista);
+
+    QVariantList kausilista;
+    for(int vuosi = 2000; vuosi < 2030; vuosi++) {
+        QVariantMap kausi;
+        kausi.insert("alkaa", QDate(vuosi, 1, 1));
+        kausi.insert("loppuu", QDate(vuosi, 12, 31));
+        kausilista.append(kausi);
+        kausilista_.append( Tilikausi(kausi) );
+    }
+    kaudet_.lataa(kausilista);
+
+    QVariantList kohdennuslista;
+    for(int i=0; i < 200; i++) {
+        QVariantMap kohdennus;
+        kohdennus.insert("id", i);
+        kohdennus.insert("tyyppi", i ? Kohdennus::KUSTANNUSPAIKKA : Kohdennus::EIKOHDENNETA);
+        kohdennus.insert("nimi", QString("Kohdennus %1").arg(i));
+        kohdennuslista.append(kohdennus);
+    }
+    kohdennukset_.lataa(kohdennuslista);
+
+    rivit_.reserve(100000);
+    for(int i=0; i < 100000; i++)
+        rivit_.append({ QDate(2000,1,1).addDays( (i * 7919) % (30 * 365) ),
+                        1000 + ((i * 31) % 400) * 20,
+                        (i * 13) % 200 });
+}
+
+void LuetteloTesti::tilikausiPaivalle()
+{
+    for(QDate pvm(1999,12,1); pvm < QDate(2030,2,1); pvm = pvm.addDays(3)) {
+        const Tilikausi odotettu = kausiLapikaynnilla(kausilista_, pvm);
+        const Tilikausi kausi = kaudet_.tilikausiPaivalle(pvm);
+        QCOMPARE( kausi.alkaa(), odotettu.alkaa());
+        QCOMPARE( kausi.paattyy(), odotettu.paattyy());
+        QCOMPARE( kaudet_.onkoTilikautta(pvm), odotettu.alkaa().isValid());
+    }
+    QCOMPARE( kaudet_.tilikausiPaivalle(QDate(2000,1,1)).alkaa(), QDate(2000,1,1));
+    QCOMPARE( kaudet_.tilikausiPaivalle(QDate(2029,12,31)).alkaa(), QDate(2029,1,1));
+    QVERIFY( !kaudet_.tilikausiPaivalle(QDate(2030,1,1)).alkaa().isValid());
+}
+
+void LuetteloTesti::kelvotonPaiva()
+{
+    // Kelvoton päivä on aina osunut ensimmäiseen kauteen
+    QCOMPARE( kaudet_.indeksiPaivalle(QDate()), 0);
+    TilikausiModel tyhja;
+    QCOMPARE( tyhja.indeksiPaivalle(QDate()), -1);
+    QCOMPARE( tyhja.indeksiPaivalle(QDate(2020,1,1)), -1);
+}
+
+void LuetteloTesti::tiliNumerolla()
+{
+    for(int i=0; i < tilit_.rowCount(); i++) {
+        Tili* tili = tilit_.tiliPIndeksilla(i);
+        QCOMPARE( tilit_.tiliNumerolla(tili->numero()).nimi(), tili->nimi());
+    }
+    QCOMPARE( tilit_.tiliNumerolla(1001).numero(), 0);
+    QCOMPARE( tilit_.tiliNumerolla(0).numero(), 0);
+}
+
+void LuetteloTesti::tiliTyypilla()
+{
+    for(int i = tilit_.rowCount() - 1; i >= 0; i--) {
+        const QString koodi = tilit_.tiliPIndeksilla(i)->tyyppiKoodi();
+        int ensimmainen = 0;
+        for(int j=0; j < tilit_.rowCount() && !ensimmainen; j++)
+            if( tilit_.tiliPIndeksilla(j)->tyyppiKoodi() == koodi)
+                ensimmainen = tilit_.tiliPIndeksilla(j)->numero();
+        QCOMPARE( tilit_.tiliTyypilla(koodi).numero(), ensimmainen);
+    }
+    QCOMPARE( tilit_.tiliTyypilla(TiliLaji::PANKKITILI).tyyppiKoodi(), QString("ARP"));
+    QCOMPARE( tilit_.tiliTyypilla(TiliLaji::ALVVELKA).tyyppiKoodi(), QString("BL"));
+    QCOMPARE( tilit_.tiliTyypilla(TiliLaji::KATEINEN).numero(), 0);
+}
+
+void LuetteloTesti::tiliIbanilla()
+{
+    QCOMPARE( tilit_.tiliIbanilla("FI0000000000000057").numero(), 1000 + 57 * 20);
+    QCOMPARE( tilit_.tiliIbanilla("FI0000000000000058").numero(), 0);
+}
+
+void LuetteloTesti::kohdennus()
+{
+    for(int i=0; i < 200; i++) {
+        QCOMPARE( kohdennukset_.kohdennus(i).id(), i);
+        QCOMPARE( kohdennukset_.kohdennus(QString("Kohdennus %1").arg(i)).id(), i);
+    }
+    QCOMPARE( kohdennukset_.kohdennus(500).nimi(), QString());
+    QCOMPARE( kohdennukset_.kohdennus("Ei ole").id(), 0);
+}
+
+void LuetteloTesti::lisattyTili()
+{
+    TiliModel tilit;
+    tilit.lataa(QVariantList());
+    tilit.lisaaTili(1234, 0);
+    QCOMPARE( tilit.tiliNumerolla(1234).numero(), 1234);
+    QCOMPARE( tilit.tiliIbanilla(QString()).numero(), 1234);
+}
+
+void LuetteloTesti::raporttiHakemistoilla()
+{
+    qlonglong pituus = 0;
+    QBENCHMARK_ONCE {
+        for(const Rivi& rivi : qAsConst(rivit_)) {
+            pituus += kaudet_.tilikausiPaivalle(rivi.pvm).kausitunnus().length();
+            pituus += tilit_.tiliNumerolla(rivi.tili).nimi().length();
+            pituus += kohdennukset_.kohdennus(rivi.kohdennus).nimi().length();
+        }
+    }
+    QVERIFY( pituus > 0);
+}
+
+void LuetteloTesti::raporttiLapikaynnilla()
+{
+    // Hakemistoja edeltänyt tapa: luettelot käydään läpi jokaiselle riville
+    qlonglong pituus = 0;
+    const QList<Kohdennus> kohdennukset = kohdennukset_.kohdennukset();
+    QBENCHMARK_ONCE {
+        for(const Rivi& rivi : qAsConst(rivit_)) {
+            pituus += kausiLapikaynnilla(kausilista_, rivi.pvm).kausitunnus().length();
+            for(int i=0; i < tilit_.rowCount(); i++) {
+                Tili tili = tilit_.tiliIndeksilla(i);
+                if( tili.numero() == rivi.tili && tili.otsikkotaso() == 0) {
+                    pituus += tili.nimi().length();
+                    break;
+                }
+            }
+            foreach (Kohdennus kohdennus, kohdennukset) {
+                if( kohdennus.id() == rivi.kohdennus) {
+                    pituus += kohdennus.nimi().length();
+                    break;
+                }
+            }
+        }
+    }
+    QVERIFY( pituus > 0);
+}
+
+Tilikausi LuetteloTesti::kausiLapikaynnilla(const QList<Tilikausi> &kaudet, const QDate &pvm)
+{
+    foreach (Tilikausi kausi, kaudet) {
+        if( kausi.alkaa().daysTo(pvm) >= 0 && pvm.daysTo(kausi.paattyy()) >= 0)
+            return kausi;
+    }
+    return Tilikausi(QDate(), QDate());
+}
+
+QTEST_APPLESS_MAIN(LuetteloTesti)
+
+#include "tst_luettelotesti.moc"
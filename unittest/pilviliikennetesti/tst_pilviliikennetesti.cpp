@@ -0,0 +1,207 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+
+#include "pilvi/pilviliikenne.h"
+
+/**
+ * @brief Paikallinen palvelin, joka vastaa jokaiseen pyyntöön samalla rungolla
+ */
+class MockPalvelin : public QTcpServer
+{
+    Q_OBJECT
+public:
+    MockPalvelin(const QByteArray& vastaus) : vastaus_(vastaus) {
+        connect(this, &QTcpServer::newConnection, this, &MockPalvelin::yhteys);
+    }
+
+    QMap<QByteArray,QByteArray> otsakkeet;
+    QByteArray runko;
+
+signals:
+    void vastattu();
+
+private:
+    void yhteys() {
+        QTcpSocket* socket = nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] { lue(socket); });
+    }
+
+    void lue(QTcpSocket* socket) {
+        puskuri_.append(socket->readAll());
+        const int loppu = puskuri_.indexOf("\r\n\r\n");
+        if( loppu < 0)
+            return;
+
+        otsakkeet.clear();
+        const QList<QByteArray> rivit = puskuri_.left(loppu).split('\n');
+        for(int i=1; i < rivit.count(); i++) {
+            const int kaksoispiste = rivit.at(i).indexOf(':');
+            otsakkeet.insert( rivit.at(i).left(kaksoispiste).trimmed().toLower(),
+                              rivit.at(i).mid(kaksoispiste + 1).trimmed());
+        }
+        const int pituus = otsakkeet.value("content-length").toInt();
+        if( puskuri_.size() < loppu + 4 + pituus)
+            return;
+        runko = puskuri_.mid(loppu + 4, pituus);
+        puskuri_.clear();
+
+        const QByteArray pakattu = PilviLiikenne::tiivista(vastaus_);
+        socket->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: application/json\r\n"
+                      "Content-Encoding: deflate\r\n"
+                      "Connection: close\r\n"
+                      "Content-Length: " + QByteArray::number(pakattu.size()) + "\r\n\r\n");
+        socket->write(pakattu);
+        socket->disconnectFromHost();
+        emit vastattu();
+    }
+
+    QByteArray vastaus_;
+    QByteArray puskuri_;
+};
+
+class PilviLiikenneTesti : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanupTestCase();
+    void tiivistaJaPura();
+    void puraVirheellinen();
+    void pieniRunkoPakkaamatta();
+    void suuriRunkoPakattu();
+    void eiKaytossa();
+    void http2Sallittu();
+    void mockPalvelin();
+
+private:
+    static QByteArray suuriJson();
+};
+
+void PilviLiikenneTesti::init()
+{
+    PilviLiikenne::asetaKaytossa(true);
+}
+
+void PilviLiikenneTesti::cleanupTestCase()
+{
+    PilviLiikenne::asetaKaytossa(false);
+}
+
+QByteArray PilviLiikenneTesti::suuriJson()
+{
+    QVariantList viennit;
+    for(int i=0; i < 200; i++) {
+        QVariantMap vienti;
+        vienti.insert("tili", 1910);
+        vienti.insert("debet", 12.50 + i);
+        vienti.insert("selite", QString("Vienti %1").arg(i));
+        viennit.append(vienti);
+    }
+    return QJsonDocument::fromVariant(viennit).toJson(QJsonDocument::Compact);
+}
+
+void PilviLiikenneTesti::tiivistaJaPura()
+{
+    const QByteArray data = suuriJson();
+    const QByteArray pakattu = PilviLiikenne::tiivista(data);
+    QVERIFY(pakattu.size() < data.size());
+    // zlib-virran otsake
+    QCOMPARE(static_cast<quint8>(pakattu.at(0)), static_cast<quint8>(0x78));
+    QCOMPARE(PilviLiikenne::pura(pakattu), data);
+}
+
+void PilviLiikenneTesti::puraVirheellinen()
+{
+    QVERIFY(PilviLiikenne::pura(QByteArray()).isEmpty());
+    QVERIFY(PilviLiikenne::pura("ei pakattua dataa").isEmpty());
+}
+
+void PilviLiikenneTesti::pieniRunkoPakkaamatta()
+{
+    QNetworkRequest request;
+    const QByteArray data("{\"tili\":1910}");
+    QCOMPARE(PilviLiikenne::runko(request, data), data);
+    QVERIFY(!request.hasRawHeader("Content-Encoding"));
+}
+
+void PilviLiikenneTesti::suuriRunkoPakattu()
+{
+    QNetworkRequest request;
+    const QByteArray data = suuriJson();
+    const QByteArray runko = PilviLiikenne::runko(request, data);
+    QCOMPARE(request.rawHeader("Content-Encoding"), QByteArray("deflate"));
+    QVERIFY(runko.size() < data.size());
+    QCOMPARE(PilviLiikenne::pura(runko), data);
+}
+
+void PilviLiikenneTesti::eiKaytossa()
+{
+    PilviLiikenne::asetaKaytossa(false);
+    QNetworkRequest request;
+    const QByteArray data = suuriJson();
+    QCOMPARE(PilviLiikenne::runko(request, data), data);
+    QVERIFY(!request.hasRawHeader("Content-Encoding"));
+    PilviLiikenne::valmistele(request);
+    QVERIFY(!request.attribute(QNetworkRequest::Http2AllowedAttribute).toBool());
+}
+
+void PilviLiikenneTesti::http2Sallittu()
+{
+    QNetworkRequest request;
+    PilviLiikenne::valmistele(request);
+    QVERIFY(request.attribute(QNetworkRequest::Http2AllowedAttribute).toBool());
+}
+
+void PilviLiikenneTesti::mockPalvelin()
+{
+    const QByteArray vastaus = suuriJson();
+    MockPalvelin palvelin(vastaus);
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/viennit").arg(palvelin.serverPort())));
+    request.setRawHeader("Content-Type","application/json");
+    PilviLiikenne::valmistele(request);
+    const QByteArray data = suuriJson();
+
+    QNetworkReply* reply = manager.post(request, PilviLiikenne::runko(request, data));
+    QSignalSpy valmis(reply, &QNetworkReply::finished);
+    QVERIFY(valmis.wait(5000));
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    // Palvelin sai pakatun rungon
+    QCOMPARE(palvelin.otsakkeet.value("content-encoding"), QByteArray("deflate"));
+    QVERIFY(palvelin.runko.size() < data.size());
+    QCOMPARE(PilviLiikenne::pura(palvelin.runko), data);
+    // Pakattu vastaus purettiin
+    QVERIFY(palvelin.otsakkeet.value("accept-encoding").contains("gzip"));
+    QCOMPARE(reply->readAll(), vastaus);
+    reply->deleteLater();
+}
+
+QTEST_MAIN(PilviLiikenneTesti)
+
+#include "tst_pilviliikennetesti.moc"
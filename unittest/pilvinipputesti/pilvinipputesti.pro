@@ -0,0 +1,17 @@
+QT += testlib network
+QT -= gui
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../kitsas
+VPATH += $$PWD/../../kitsas
+
+SOURCES +=  tst_pilvinipputesti.cpp \
+    pilvi/pilvinippu.cpp \
+    pilvi/pilviliikenne.cpp
+
+HEADERS += pilvi/pilvinippu.h \
+    pilvi/pilviliikenne.h
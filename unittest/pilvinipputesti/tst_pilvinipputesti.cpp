@@ -0,0 +1,204 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+#include "pilvi/pilvinippu.h"
+
+/**
+ * @brief Paikallinen palvelin, joka vastaa pyynnön polulla
+ */
+class MockPalvelin : public QTcpServer
+{
+    Q_OBJECT
+public:
+    MockPalvelin() {
+        connect(this, &QTcpServer::newConnection, this, &MockPalvelin::yhteys);
+    }
+
+    QStringList pyynnot;
+
+private:
+    void yhteys() {
+        while( QTcpSocket* socket = nextPendingConnection()) {
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket] { lue(socket); });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    }
+
+    void lue(QTcpSocket* socket) {
+        QByteArray& puskuri = puskurit_[socket];
+        puskuri.append(socket->readAll());
+        const int loppu = puskuri.indexOf("\r\n\r\n");
+        if( loppu < 0)
+            return;
+        const QList<QByteArray> pyynto = puskuri.left(puskuri.indexOf("\r\n")).split(' ');
+        puskuri.remove(0, loppu + 4);
+
+        const QString polku = QString::fromLatin1( pyynto.value(1) );
+        pyynnot.append(pyynto.value(0) + " " + polku);
+        const QByteArray runko = "\"" + polku.toLatin1() + "\"";
+        socket->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: application/json\r\n"
+                      "Content-Length: " + QByteArray::number(runko.size()) + "\r\n\r\n");
+        socket->write(runko);
+    }
+
+    QHash<QTcpSocket*, QByteArray> puskurit_;
+};
+
+class PilviNippuTesti : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void lahetetaanKierroksenLopussa();
+    void samatHautYhdistetaan();
+    void muokkausKatkaisee();
+    void valmiiseenEiYhdisteta();
+    void poistetunOdottajaLahetetaan();
+
+private:
+    /**
+     * @brief Jonottaa kyselyn samoin kuin PilviKysely
+     */
+    QObject* kysy(const QByteArray& metodi, const QString& polku);
+    void odota(int vastauksia);
+
+    QNetworkAccessManager* manager_ = nullptr;
+    MockPalvelin* palvelin_ = nullptr;
+    PilviNippu* nippu_ = nullptr;
+    QHash<QObject*, QString> vastaukset_;
+};
+
+void PilviNippuTesti::init()
+{
+    palvelin_ = new MockPalvelin;
+    QVERIFY(palvelin_->listen(QHostAddress::LocalHost));
+    manager_ = new QNetworkAccessManager;
+    nippu_ = new PilviNippu;
+    vastaukset_.clear();
+}
+
+void PilviNippuTesti::cleanup()
+{
+    delete nippu_;
+    delete manager_;
+    delete palvelin_;
+}
+
+QObject *PilviNippuTesti::kysy(const QByteArray &metodi, const QString &polku)
+{
+    QObject* kysely = new QObject(nippu_);
+    const QString avain = metodi == "GET" ? polku : QString();
+    nippu_->jonota(kysely, avain, [this, kysely, metodi, polku] {
+        QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1%2").arg(palvelin_->serverPort()).arg(polku)));
+        QNetworkReply* reply = manager_->sendCustomRequest(request, metodi);
+        connect(reply, &QNetworkReply::finished, this, [this, kysely, reply] {
+            const QString vastaus = QString::fromUtf8(reply->readAll());
+            vastaukset_.insert(kysely, vastaus);
+            for(QObject* odottaja : nippu_->valmis(kysely))
+                vastaukset_.insert(odottaja, vastaus);
+            reply->deleteLater();
+        });
+    });
+    return kysely;
+}
+
+void PilviNippuTesti::odota(int vastauksia)
+{
+    QTRY_COMPARE_WITH_TIMEOUT(vastaukset_.count(), vastauksia, 5000);
+}
+
+void PilviNippuTesti::lahetetaanKierroksenLopussa()
+{
+    bool lahetetty = false;
+    QObject kysely;
+    nippu_->jonota(&kysely, "/tilikaudet", [&lahetetty] { lahetetty = true; });
+    QVERIFY(!lahetetty);
+    QCoreApplication::processEvents();
+    QVERIFY(lahetetty);
+    QCOMPARE(nippu_->tilasto().value("niput").toInt(), 1);
+    nippu_->valmis(&kysely);
+}
+
+void PilviNippuTesti::samatHautYhdistetaan()
+{
+    QObject* a = kysy("GET", "/saldot?pvm=2020-12-31");
+    QObject* b = kysy("GET", "/saldot?pvm=2020-12-31");
+    QObject* c = kysy("GET", "/erat");
+    QObject* d = kysy("GET", "/saldot?pvm=2020-12-31");
+    odota(4);
+
+    QCOMPARE(palvelin_->pyynnot.count(), 2);
+    QCOMPARE(vastaukset_.value(a), QString("\"/saldot?pvm=2020-12-31\""));
+    QCOMPARE(vastaukset_.value(b), vastaukset_.value(a));
+    QCOMPARE(vastaukset_.value(d), vastaukset_.value(a));
+    QCOMPARE(vastaukset_.value(c), QString("\"/erat\""));
+
+    const QVariantMap tilasto = nippu_->tilasto();
+    QCOMPARE(tilasto.value("niput").toInt(), 1);
+    QCOMPARE(tilasto.value("lahetetyt").toInt(), 2);
+    QCOMPARE(tilasto.value("yhdistetyt").toInt(), 2);
+    QCOMPARE(tilasto.value("kesken").toInt(), 0);
+}
+
+void PilviNippuTesti::muokkausKatkaisee()
+{
+    kysy("GET", "/saldot");
+    kysy("PUT", "/tositteet/1");
+    kysy("GET", "/saldot");
+    odota(3);
+
+    QCOMPARE(palvelin_->pyynnot.count(), 3);
+    QVERIFY(palvelin_->pyynnot.contains("PUT /tositteet/1"));
+    QCOMPARE(nippu_->tilasto().value("yhdistetyt").toInt(), 0);
+}
+
+void PilviNippuTesti::valmiiseenEiYhdisteta()
+{
+    kysy("GET", "/kumppanit");
+    odota(1);
+    kysy("GET", "/kumppanit");
+    odota(2);
+
+    QCOMPARE(palvelin_->pyynnot.count(), 2);
+    QCOMPARE(nippu_->tilasto().value("niput").toInt(), 2);
+}
+
+void PilviNippuTesti::poistetunOdottajaLahetetaan()
+{
+    QObject* a = kysy("GET", "/tilit");
+    QObject* b = kysy("GET", "/tilit");
+    QObject* c = kysy("GET", "/tilit");
+    delete a;
+    odota(2);
+
+    QCOMPARE(palvelin_->pyynnot.count(), 1);
+    QCOMPARE(vastaukset_.value(b), QString("\"/tilit\""));
+    QCOMPARE(vastaukset_.value(c), vastaukset_.value(b));
+    QCOMPARE(nippu_->tilasto().value("kesken").toInt(), 0);
+}
+
+QTEST_MAIN(PilviNippuTesti)
+
+#include "tst_pilvinipputesti.moc"
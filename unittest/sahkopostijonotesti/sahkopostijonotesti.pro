@@ -0,0 +1,41 @@
+QT += testlib network
+QT -= gui
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../kitsas
+VPATH += $$PWD/../../kitsas
+
+SOURCES +=  tst_sahkopostijonotesti.cpp \
+    laskutus/toimittaja/sahkopostiistunto.cpp \
+    laskutus/toimittaja/sahkopostijono.cpp \
+    smtpclient/emailaddress.cpp \
+    smtpclient/mimeattachment.cpp \
+    smtpclient/mimecontentformatter.cpp \
+    smtpclient/mimefile.cpp \
+    smtpclient/mimehtml.cpp \
+    smtpclient/mimeinlinefile.cpp \
+    smtpclient/mimemessage.cpp \
+    smtpclient/mimemultipart.cpp \
+    smtpclient/mimepart.cpp \
+    smtpclient/mimetext.cpp \
+    smtpclient/quotedprintable.cpp \
+    smtpclient/smtpclient.cpp
+
+HEADERS += laskutus/toimittaja/sahkopostiistunto.h \
+    laskutus/toimittaja/sahkopostijono.h \
+    smtpclient/emailaddress.h \
+    smtpclient/mimeattachment.h \
+    smtpclient/mimecontentformatter.h \
+    smtpclient/mimefile.h \
+    smtpclient/mimehtml.h \
+    smtpclient/mimeinlinefile.h \
+    smtpclient/mimemessage.h \
+    smtpclient/mimemultipart.h \
+    smtpclient/mimepart.h \
+    smtpclient/mimetext.h \
+    smtpclient/quotedprintable.h \
+    smtpclient/smtpclient.h
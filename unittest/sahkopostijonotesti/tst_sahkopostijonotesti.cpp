@@ -0,0 +1,316 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "laskutus/toimittaja/sahkopostijono.h"
+
+#include <atomic>
+
+/**
+ * @brief Paikallinen SMTP-palvelin, joka hyväksyy kaikki viestit
+ */
+class SmtpPalvelin : public QTcpServer
+{
+    Q_OBJECT
+public:
+    SmtpPalvelin() {
+        connect(this, &QTcpServer::newConnection, this, &SmtpPalvelin::yhteys);
+    }
+
+    int yhteyksia = 0;
+    int viesteja = 0;
+    int lopetuksia = 0;
+    int katkaiseJalkeen = 0;        // Katkaisee yhteyden joka n:nnen viestin jälkeen
+    bool katkaiseDatassa = false;   // Katkaisee yhteyden vastaamatta viestin sisältöön
+    QByteArray hylatty;             // Vastaanottaja, jolle ei lähetetä
+
+private:
+    void yhteys() {
+        QTcpSocket* socket = nextPendingConnection();
+        yhteyksia++;
+        datassa_.insert(socket, false);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] { lue(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+        socket->write("220 testi ESMTP\r\n");
+    }
+
+    void lue(QTcpSocket* socket) {
+        while( socket->canReadLine()) {
+            const QByteArray rivi = socket->readLine();
+            if( datassa_.value(socket)) {
+                if( rivi != ".\r\n")
+                    continue;
+                datassa_.insert(socket, false);
+                viesteja++;
+                if( katkaiseDatassa ) {
+                    socket->disconnectFromHost();
+                    continue;
+                }
+                socket->write("250 OK\r\n");
+                if( katkaiseJalkeen && viesteja % katkaiseJalkeen == 0)
+                    socket->disconnectFromHost();
+                continue;
+            }
+            const QByteArray komento = rivi.left(4).toUpper();
+            if( komento == "EHLO")
+                socket->write("250 testi\r\n");
+            else if( komento == "AUTH")
+                socket->write("235 OK\r\n");
+            else if( komento == "MAIL")
+                socket->write("250 OK\r\n");
+            else if( komento == "RCPT")
+                socket->write( !hylatty.isEmpty() && rivi.contains(hylatty) ? "550 Tuntematon vastaanottaja\r\n" : "250 OK\r\n");
+            else if( komento == "DATA") {
+                datassa_.insert(socket, true);
+                socket->write("354 Jatka\r\n");
+            } else if( komento == "QUIT") {
+                lopetuksia++;
+                socket->write("221 Hei\r\n");
+                socket->disconnectFromHost();
+            } else
+                socket->write("500 Tuntematon komento\r\n");
+        }
+    }
+
+    QHash<QTcpSocket*, bool> datassa_;
+};
+
+class SahkopostiJonoTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    SahkopostiJonoTesti();
+
+private:
+    SahkopostiIstunto::Asetukset asetukset(quint16 portti) const;
+    SahkopostiViesti viesti(int tunnus) const;
+    static SahkopostiJono::Liite liite();
+
+private slots:
+    void yksiYhteysErassa();
+    void katkennutYhteysAvataanUudelleen();
+    void hylattyVastaanottaja();
+    void vastaanotettuaEiLahetetaUudelleen();
+    void palvelinEiVastaa();
+    void ennakkoRajattu();
+    void liiteMuodostetaanJononSaikeessa();
+};
+
+SahkopostiJonoTesti::SahkopostiJonoTesti()
+{
+
+}
+
+SahkopostiIstunto::Asetukset SahkopostiJonoTesti::asetukset(quint16 portti) const
+{
+    SahkopostiIstunto::Asetukset asetukset;
+    asetukset.palvelin = "127.0.0.1";
+    asetukset.portti = portti;
+    asetukset.kayttaja = "testi";
+    asetukset.salasana = "salasana";
+    return asetukset;
+}
+
+SahkopostiViesti SahkopostiJonoTesti::viesti(int tunnus) const
+{
+    SahkopostiViesti viesti;
+    viesti.lahettajaNimi = "Laskuttaja";
+    viesti.lahettajaOsoite = "laskut@esimerkki.fi";
+    viesti.vastaanottajaNimi = QString("Asiakas %1").arg(tunnus);
+    viesti.vastaanottajaOsoite = QString("asiakas%1@esimerkki.fi").arg(tunnus);
+    viesti.otsikko = QString("Lasku %1").arg(tunnus);
+    viesti.teksti = "Liitteenä lasku";
+    viesti.liitteenNimi = QString("lasku%1.pdf").arg(tunnus);
+    return viesti;
+}
+
+SahkopostiJono::Liite SahkopostiJonoTesti::liite()
+{
+    return [] { return QByteArray("%PDF-1.4 testi"); };
+}
+
+void SahkopostiJonoTesti::yksiYhteysErassa()
+{
+    SmtpPalvelin palvelin;
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    SahkopostiJono jono(asetukset(palvelin.serverPort()));
+    QSignalSpy lahetetyt(&jono, &SahkopostiJono::lahetetty);
+    QSignalSpy edistyminen(&jono, &SahkopostiJono::edistyminen);
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    for(int i=1; i <= 10; i++)
+        jono.lisaa(i, viesti(i), liite());
+
+    QVERIFY(valmis.wait(10000));
+    QCOMPARE(lahetetyt.count(), 10);
+    QCOMPARE(palvelin.viesteja, 10);
+    QCOMPARE(palvelin.yhteyksia, 1);
+    QCOMPARE(edistyminen.count(), 10);
+    QCOMPARE(edistyminen.last().at(0).toInt(), 10);
+    QCOMPARE(edistyminen.last().at(1).toInt(), 10);
+    QVERIFY(jono.vapaa());
+
+    // Istunto lopetetaan, kun jono tyhjenee
+    QTRY_COMPARE(palvelin.lopetuksia, 1);
+}
+
+void SahkopostiJonoTesti::katkennutYhteysAvataanUudelleen()
+{
+    SmtpPalvelin palvelin;
+    palvelin.katkaiseJalkeen = 2;
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    SahkopostiJono jono(asetukset(palvelin.serverPort()));
+    QSignalSpy lahetetyt(&jono, &SahkopostiJono::lahetetty);
+    QSignalSpy virheet(&jono, &SahkopostiJono::epaonnistui);
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    for(int i=1; i <= 5; i++)
+        jono.lisaa(i, viesti(i), liite());
+
+    QVERIFY(valmis.wait(30000));
+    QCOMPARE(virheet.count(), 0);
+    QCOMPARE(lahetetyt.count(), 5);
+    QCOMPARE(palvelin.viesteja, 5);
+    QCOMPARE(palvelin.yhteyksia, 3);
+}
+
+void SahkopostiJonoTesti::hylattyVastaanottaja()
+{
+    SmtpPalvelin palvelin;
+    palvelin.hylatty = "asiakas2@";
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    SahkopostiJono jono(asetukset(palvelin.serverPort()));
+    QSignalSpy lahetetyt(&jono, &SahkopostiJono::lahetetty);
+    QSignalSpy virheet(&jono, &SahkopostiJono::epaonnistui);
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    for(int i=1; i <= 4; i++)
+        jono.lisaa(i, viesti(i), liite());
+
+    QVERIFY(valmis.wait(10000));
+    QCOMPARE(lahetetyt.count(), 3);
+    QCOMPARE(virheet.count(), 1);
+    QCOMPARE(virheet.first().at(0).toInt(), 2);
+    QVERIFY(virheet.first().at(1).toString().contains("asiakas2@esimerkki.fi"));
+    QCOMPARE(palvelin.viesteja, 3);
+}
+
+void SahkopostiJonoTesti::vastaanotettuaEiLahetetaUudelleen()
+{
+    SmtpPalvelin palvelin;
+    palvelin.katkaiseDatassa = true;
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    SahkopostiJono jono(asetukset(palvelin.serverPort()));
+    QSignalSpy lahetetyt(&jono, &SahkopostiJono::lahetetty);
+    QSignalSpy virheet(&jono, &SahkopostiJono::epaonnistui);
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    jono.lisaa(1, viesti(1), liite());
+
+    QVERIFY(valmis.wait(30000));
+    QCOMPARE(lahetetyt.count(), 0);
+    QCOMPARE(virheet.count(), 1);
+    QCOMPARE(palvelin.viesteja, 1);
+    QCOMPARE(palvelin.yhteyksia, 1);
+}
+
+void SahkopostiJonoTesti::palvelinEiVastaa()
+{
+    // Varataan portti ja vapautetaan se, jolloin yhteys torjutaan
+    quint16 portti = 0;
+    {
+        QTcpServer varaus;
+        QVERIFY(varaus.listen(QHostAddress::LocalHost));
+        portti = varaus.serverPort();
+    }
+
+    SahkopostiJono jono(asetukset(portti));
+    QSignalSpy lahetetyt(&jono, &SahkopostiJono::lahetetty);
+    QSignalSpy virheet(&jono, &SahkopostiJono::epaonnistui);
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    for(int i=1; i <= 3; i++)
+        jono.lisaa(i, viesti(i), liite());
+
+    QVERIFY(valmis.wait(30000));
+    QCOMPARE(lahetetyt.count(), 0);
+    QCOMPARE(virheet.count(), 3);
+    QVERIFY(virheet.first().at(1).toString().contains("127.0.0.1"));
+}
+
+void SahkopostiJonoTesti::ennakkoRajattu()
+{
+    SmtpPalvelin palvelin;
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    SahkopostiJono jono(asetukset(palvelin.serverPort()));
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    std::atomic_int matkalla(0);
+    std::atomic_int enintaan(0);
+    connect(&jono, &SahkopostiJono::lahetetty, this, [&matkalla] { matkalla--; });
+
+    for(int i=1; i <= 20; i++) {
+        jono.lisaa(i, viesti(i), [&matkalla, &enintaan] {
+            const int nyt = ++matkalla;
+            int edellinen = enintaan;
+            while( nyt > edellinen && !enintaan.compare_exchange_weak(edellinen, nyt)) {}
+            QThread::msleep(5);
+            return QByteArray("%PDF-1.4 testi");
+        });
+    }
+
+    QVERIFY(valmis.wait(30000));
+    QCOMPARE(palvelin.viesteja, 20);
+    QCOMPARE(matkalla.load(), 0);
+    QVERIFY(enintaan.load() >= 1);
+    QVERIFY(enintaan.load() <= SahkopostiJono::ENNAKKO);
+}
+
+void SahkopostiJonoTesti::liiteMuodostetaanJononSaikeessa()
+{
+    SmtpPalvelin palvelin;
+    QVERIFY(palvelin.listen(QHostAddress::LocalHost));
+
+    SahkopostiJono jono(asetukset(palvelin.serverPort()));
+    QSignalSpy valmis(&jono, &SahkopostiJono::valmis);
+
+    QThread* saie = QThread::currentThread();
+    int muualla = 0;
+    for(int i=1; i <= 3; i++) {
+        jono.lisaa(i, viesti(i), [saie, &muualla] {
+            if( QThread::currentThread() != saie)
+                muualla++;
+            return QByteArray("%PDF-1.4 testi");
+        });
+    }
+
+    QVERIFY(valmis.wait(30000));
+    QCOMPARE(palvelin.viesteja, 3);
+    QCOMPARE(muualla, 0);
+}
+
+QTEST_MAIN(SahkopostiJonoTesti)
+
+#include "tst_sahkopostijonotesti.moc"
@@ -0,0 +1,4 @@
+include(../apptest.pri)
+
+SOURCES += \
+    tst_taydennystesti.cpp
@@ -0,0 +1,237 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include "db/kirjanpito.h"
+#include "kieli/kielet.h"
+#include "sqlite/sqlitemodel.h"
+#include "sqlite/sqliteroute.h"
+
+/**
+ * @brief Testireitti, jolla päästään käsiksi vientien täydentämiseen
+ *
+ * Sisältää vertailua varten aiemman, vienti kerrallaan toimineen toteutuksen.
+ */
+class TaydennysReitti : public SQLiteRoute
+{
+public:
+    TaydennysReitti(SQLiteModel* model) : SQLiteRoute(model, "/testi") {}
+
+    QVariantList viennit(int maara) {
+        QSqlQuery kysely(db());
+        kysely.exec(QString("SELECT vienti.id AS id, vienti.pvm as pvm, vienti.tili as tili, debetsnt, kreditsnt, "
+                            "selite, eraid as era_id, vienti.tosite as tosite_id "
+                            "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id ORDER BY Vienti.id LIMIT %1").arg(maara));
+        return resultList(kysely);
+    }
+
+    void uusi(QVariantList& lista) { taydennaEratJaMerkkaukset(lista); }
+
+    void vanha(QVariantList& vientilista) {
+        QSqlQuery kysely(db());
+
+        for(int i=0; i < vientilista.count(); i++) {
+            QVariantMap map = vientilista.at(i).toMap();
+            if( map.contains("era")) {
+                QVariantMap eramap = map.value("era").toMap();
+                int eraid = eramap.value("id").toInt();
+                if( eraid ) {
+                    kysely.exec(QString("SELECT Vienti.id as id, Tosite.tunniste as tunniste, Tosite.sarja as sarja, Tosite.pvm as pvm, Tosite.tyyppi as tositetyyppi "
+                                        "FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id "
+                                        "WHERE Vienti.id=%1")
+                                .arg(eraid));
+                    eramap = resultMap(kysely);
+
+                    if( eramap.isEmpty()) {
+                        map.remove("era");
+                    } else {
+                        kysely.exec(QString("SELECT SUM(debetsnt) as debetit, SUM(kreditsnt) as kreditit FROM Vienti JOIN Tosite ON Vienti.tosite=Tosite.id WHERE eraid=%1 AND Tosite.tila >= 100 ").arg(eraid));
+                        if( kysely.next())
+                            eramap.insert("saldo", (kysely.value(0).toLongLong() - kysely.value(1).toLongLong()) / 100.0);
+                        map.insert("era", eramap);
+                    }
+                    vientilista[i] = map;
+                }
+            }
+
+            QVariantList merkkaukset;
+            kysely.exec(QString("SELECT kohdennus FROM Merkkaus WHERE vienti=%1").arg(map.value("id").toInt()));
+            while( kysely.next() )
+                merkkaukset.append( kysely.value(0).toInt() );
+            if( merkkaukset.count()) {
+                map.insert("merkkaukset", merkkaukset);
+                vientilista[i] = map;
+            }
+        }
+    }
+};
+
+class TaydennysTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    TaydennysTesti();
+    ~TaydennysTesti();
+
+private slots:
+    void initTestCase();
+    void vastaavuus();
+    void vanhaTaydennys();
+    void uusiTaydennys();
+    void cleanupTestCase();
+
+protected:
+    void luoKirjanpito(int vienteja);
+
+    TaydennysReitti* reitti_ = nullptr;
+};
+
+TaydennysTesti::TaydennysTesti()
+{
+}
+
+TaydennysTesti::~TaydennysTesti()
+{
+}
+
+void TaydennysTesti::initTestCase()
+{
+    char *argv[] = {"Test"};
+    int argc = 1;
+    new QApplication(argc, argv);
+    Kielet::alustaKielet(":/tr/tulkki.json");
+    kp()->asetaInstanssi(new Kirjanpito());
+
+    luoKirjanpito(100000);
+    reitti_ = new TaydennysReitti( kp()->sqlite() );
+}
+
+void TaydennysTesti::luoKirjanpito(int vienteja)
+{
+    const QString TIEDOSTO = "/tmp/taydennys_testi.kitsas";
+    QFile::remove(TIEDOSTO);
+
+    QSqlDatabase db = kp()->sqlite()->tietokanta();
+    db.setDatabaseName(TIEDOSTO);
+    QVERIFY( db.open() );
+    db.exec("PRAGMA SYNCHRONOUS = OFF");
+
+    QSqlQuery query(db);
+    QFile sqltiedosto(":/sqlite/luo.sql");
+    sqltiedosto.open(QIODevice::ReadOnly);
+    QTextStream in(&sqltiedosto);
+    in.setCodec("UTF-8");
+    QString sqluonti = in.readAll();
+    sqluonti.replace("\n","");
+    for(const QString& kysely : sqluonti.split(";")) {
+        if( !kysely.isEmpty())
+            query.exec(kysely);
+    }
+
+    db.transaction();
+    query.exec("INSERT INTO Tili(numero,tyyppi) VALUES (1700,'AS'),(2870,'BS'),(3000,'CT'),(4000,'DM')");
+    query.exec("INSERT INTO Kohdennus(id,tyyppi,json) VALUES (1,3,'{}'),(2,3,'{}')");
+
+    QSqlQuery tosite(db);
+    tosite.prepare("INSERT INTO Tosite(id,pvm,tyyppi,tila,tunniste,sarja) VALUES (?,?,100,?,?,'')");
+    QSqlQuery vienti(db);
+    vienti.prepare("INSERT INTO Vienti(id,rivi,tosite,pvm,tili,debetsnt,kreditsnt,eraid) VALUES (?,?,?,?,?,?,?,?)");
+    QSqlQuery merkkaus(db);
+    merkkaus.prepare("INSERT INTO Merkkaus(vienti,kohdennus) VALUES (?,?)");
+
+    const QDate alku(2020,1,1);
+    int vientiId = 1;
+    for(int tositeId = 1; vientiId <= vienteja; tositeId++) {
+        const QDate pvm = alku.addDays( tositeId % 365);
+        tosite.addBindValue(tositeId);
+        tosite.addBindValue(pvm);
+        tosite.addBindValue( tositeId % 50 ? 100 : 0 );
+        tosite.addBindValue(tositeId);
+        tosite.exec();
+
+        for(int rivi=1; rivi <= 4 && vientiId <= vienteja; rivi++, vientiId++) {
+            const qlonglong sentit = 1000 + vientiId % 997;
+            // Joka toinen vienti kuuluu erään, osa omaan ja osa aiempaan
+            int eraid = 0;
+            if( rivi % 2 == 0)
+                eraid = vientiId > 1000 && vientiId % 3 ? vientiId - 998 : vientiId;
+            vienti.addBindValue(vientiId);
+            vienti.addBindValue(rivi);
+            vienti.addBindValue(tositeId);
+            vienti.addBindValue(pvm);
+            vienti.addBindValue( rivi % 2 ? 3000 : 1700 );
+            vienti.addBindValue( rivi % 2 ? 0 : sentit );
+            vienti.addBindValue( rivi % 2 ? sentit : 0 );
+            vienti.addBindValue( eraid );
+            vienti.exec();
+
+            if( vientiId % 10 == 0) {
+                merkkaus.addBindValue(vientiId);
+                merkkaus.addBindValue(1 + vientiId % 20 / 10);
+                merkkaus.exec();
+            }
+        }
+    }
+    db.commit();
+}
+
+void TaydennysTesti::vastaavuus()
+{
+    QVariantList vanhat = reitti_->viennit(5000);
+    QVariantList uudet = vanhat;
+
+    reitti_->vanha(vanhat);
+    reitti_->uusi(uudet);
+
+    QCOMPARE( uudet.count(), vanhat.count());
+    for(int i=0; i < vanhat.count(); i++)
+        QCOMPARE( uudet.at(i).toMap(), vanhat.at(i).toMap());
+}
+
+void TaydennysTesti::vanhaTaydennys()
+{
+    const QVariantList viennit = reitti_->viennit(100000);
+    QBENCHMARK_ONCE {
+        QVariantList lista = viennit;
+        reitti_->vanha(lista);
+    }
+}
+
+void TaydennysTesti::uusiTaydennys()
+{
+    const QVariantList viennit = reitti_->viennit(100000);
+    QBENCHMARK_ONCE {
+        QVariantList lista = viennit;
+        reitti_->uusi(lista);
+    }
+}
+
+void TaydennysTesti::cleanupTestCase()
+{
+    delete reitti_;
+    kp()->sqlite()->tietokanta().close();
+}
+
+QTEST_APPLESS_MAIN(TaydennysTesti)
+
+#include "tst_taydennystesti.moc"
@@ -0,0 +1,363 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include "db/kirjanpito.h"
+#include "db/tositetyyppimodel.h"
+#include "kieli/kielet.h"
+#include "sqlite/sqlitemodel.h"
+#include "sqlite/routes/tuontitulkki.h"
+
+/**
+ * @brief Testireitti, jolla päästään käsiksi tiliotteen tulkintaan
+ */
+class TestiTulkki : public TuontiTulkki
+{
+public:
+    TestiTulkki(SQLiteModel* model) : TuontiTulkki(model) {}
+
+    QVariantList tulkitse(const QVariantList& tapahtumat) {
+        QVariantMap map;
+        map.insert("tyyppi", TositeTyyppi::TILIOTE);
+        map.insert("tapahtumat", tapahtumat);
+        return tiliote(map).toMap().value("tapahtumat").toList();
+    }
+
+    QVariantMap tulkitse(const QVariantMap& tapahtuma) {
+        return tulkitse( QVariantList() << tapahtuma ).value(0).toMap();
+    }
+
+    static bool vertaa(const QString& kuvio, const QString& teksti) { return like(kuvio, teksti); }
+};
+
+class TuontiTulkkiTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    TuontiTulkkiTesti();
+    ~TuontiTulkkiTesti();
+
+private slots:
+    void initTestCase();
+    void like_data();
+    void like();
+    void vakioviite();
+    void myyntiViitteella();
+    void myyntiSummalla();
+    void montaSopivaaEraa();
+    void nimenPalat();
+    void korkotulo();
+    void tuntematon();
+    void ostoViitteella();
+    void maksettuOsto();
+    void ostoSummalla();
+    void verohallinto();
+    void palvelumaksu();
+    void suuriTiliote();
+    void cleanupTestCase();
+
+protected:
+    void luoKirjanpito();
+    static QVariantMap tapahtuma(double euro, const QString& saajamaksaja,
+                                 const QString& viite = QString(), const QDate& pvm = QDate(2020,3,1));
+
+    TestiTulkki* tulkki_ = nullptr;
+};
+
+TuontiTulkkiTesti::TuontiTulkkiTesti()
+{
+}
+
+TuontiTulkkiTesti::~TuontiTulkkiTesti()
+{
+}
+
+void TuontiTulkkiTesti::initTestCase()
+{
+    char *argv[] = {"Test"};
+    int argc = 1;
+    new QApplication(argc, argv);
+    Kielet::alustaKielet(":/tr/tulkki.json");
+    kp()->asetaInstanssi(new Kirjanpito());
+
+    QVariantMap asetukset;
+    asetukset.insert("PankkiMaksettavakorko", 9150);
+    asetukset.insert("PankkiPalvelumaksutili", 7690);
+    asetukset.insert("Tuloveroennakkotili", 1820);
+    asetukset.insert("VeroOmaverotili", 2940);
+    asetukset.insert("VeroTuloViite", "00001234567");
+    kp()->asetukset()->lataa(asetukset);
+
+    luoKirjanpito();
+    tulkki_ = new TestiTulkki( kp()->sqlite() );
+}
+
+void TuontiTulkkiTesti::luoKirjanpito()
+{
+    const QString TIEDOSTO = "/tmp/tuontitulkki_testi.kitsas";
+    QFile::remove(TIEDOSTO);
+
+    QSqlDatabase db = kp()->sqlite()->tietokanta();
+    db.setDatabaseName(TIEDOSTO);
+    QVERIFY( db.open() );
+
+    QSqlQuery query(db);
+    QFile sqltiedosto(":/sqlite/luo.sql");
+    sqltiedosto.open(QIODevice::ReadOnly);
+    QTextStream in(&sqltiedosto);
+    in.setCodec("UTF-8");
+    QString sqluonti = in.readAll();
+    sqluonti.replace("\n","");
+    for(const QString& kysely : sqluonti.split(";")) {
+        if( !kysely.isEmpty())
+            query.exec(kysely);
+    }
+
+    db.transaction();
+    query.exec("INSERT INTO Tili(numero,tyyppi) VALUES (1700,'AS'),(1910,'ARP'),(2870,'BS'),(3000,'CT'),(3010,'CT'),(4000,'DM'),(4010,'DM')");
+    query.exec("INSERT INTO Kumppani(id,nimi) VALUES (101,'Oy Asiakas Ab'),(102,'Matti Meikäläinen'),(103,'Toimittaja Oy'),(104,'Kaksi Laskua Oy')");
+    query.exec("INSERT INTO KumppaniIban(iban,kumppani) VALUES ('FI2112345600000785',103)");
+    query.exec("INSERT INTO Vakioviite(viite,tili,kohdennus,otsikko) VALUES (1232,3010,0,'Jäsenmaksu')");
+
+    query.exec("INSERT INTO Tosite(id,pvm,tyyppi,tila,tunniste,sarja,viite) VALUES "
+               "(1,'2020-01-10',200,100,1,'MY','1009'),"
+               "(2,'2020-01-15',200,100,2,'MY',NULL),"
+               "(3,'2020-01-16',200,100,3,'MY',NULL),"
+               "(4,'2020-01-20',100,100,1,'OS','2012'),"
+               "(5,'2020-01-21',100,100,2,'OS','2025'),"
+               "(6,'2020-01-25',400,100,1,'',NULL),"
+               "(7,'2020-01-28',100,100,3,'OS',NULL)");
+
+    // Vastakirjausten tunnisteet ovat samalla erien tunnisteita
+    query.exec("INSERT INTO Vienti(id,rivi,tosite,tyyppi,pvm,tili,debetsnt,kreditsnt,eraid,kumppani,selite) VALUES "
+               "(1,1,1,202,'2020-01-10',1700,12400,NULL,1,101,'Lasku 1'),"
+               "(2,2,1,201,'2020-01-10',3000,NULL,12400,0,101,'Lasku 1'),"
+               "(3,1,2,202,'2020-01-15',1700,5000,NULL,3,102,'Lasku 2'),"
+               "(4,2,2,201,'2020-01-15',3000,NULL,5000,0,102,'Lasku 2'),"
+               "(5,1,3,202,'2020-01-16',1700,3000,NULL,5,104,'Lasku 3'),"
+               "(6,2,3,201,'2020-01-16',3000,NULL,3000,0,104,'Lasku 3'),"
+               "(7,3,3,202,'2020-01-16',1700,3000,NULL,7,104,'Lasku 4'),"
+               "(8,4,3,201,'2020-01-16',3000,NULL,3000,0,104,'Lasku 4'),"
+               "(9,5,3,201,'2020-01-16',3010,NULL,100,0,104,'Lasku 5'),"
+               "(10,6,3,202,'2020-01-16',1700,100,NULL,10,104,'Lasku 5'),"
+               "(11,1,4,102,'2020-01-20',2870,NULL,8000,11,103,'Ostolasku'),"
+               "(12,2,4,101,'2020-01-20',4000,8000,NULL,0,103,'Ostolasku'),"
+               "(13,1,5,102,'2020-01-21',2870,NULL,2000,13,103,'Maksettu'),"
+               "(14,2,5,101,'2020-01-21',4000,2000,NULL,0,103,'Maksettu'),"
+               "(15,1,6,0,'2020-01-25',2870,2000,NULL,13,103,'Maksu'),"
+               "(16,2,6,0,'2020-01-25',1910,NULL,2000,0,103,'Maksu'),"
+               "(17,1,7,102,'2020-01-28',2870,NULL,4500,17,103,'Viitteetön'),"
+               "(18,2,7,101,'2020-01-28',4010,4500,NULL,0,103,'Viitteetön')");
+    QVERIFY2( !query.lastError().isValid(), qPrintable(query.lastError().text()));
+    db.commit();
+}
+
+QVariantMap TuontiTulkkiTesti::tapahtuma(double euro, const QString &saajamaksaja, const QString &viite, const QDate &pvm)
+{
+    QVariantMap map;
+    map.insert("euro", euro);
+    map.insert("saajamaksaja", saajamaksaja);
+    map.insert("viite", viite);
+    map.insert("pvm", pvm);
+    return map;
+}
+
+void TuontiTulkkiTesti::like_data()
+{
+    QTest::addColumn<QString>("kuvio");
+    QTest::addColumn<QString>("teksti");
+    QTest::addColumn<bool>("tulos");
+
+    QTest::newRow("sama") << "Oy Asiakas Ab" << "Oy Asiakas Ab" << true;
+    QTest::newRow("kirjainkoko") << "OY ASIAKAS AB" << "Oy Asiakas Ab" << true;
+    QTest::newRow("skandit") << "MEIK_L_INEN" << "Meikäläinen" << true;
+    QTest::newRow("ei skandien kokoa") << "MEIKÄLÄINEN" << "Meikäläinen" << false;
+    QTest::newRow("alaviiva") << "Oy_Asiakas" << "OyXAsiakas" << true;
+    QTest::newRow("prosentti") << "%asiakas%" << "Oy Asiakas Ab" << true;
+    QTest::newRow("prosentti lopussa") << "Oy%" << "Oy Asiakas Ab" << true;
+    QTest::newRow("tyhjä osuma") << "%%" << "" << true;
+    QTest::newRow("paluu") << "%a%ab" << "Oy Asiakas Ab" << true;
+    QTest::newRow("liian lyhyt") << "Oy Asiaka" << "Oy Asiakas" << false;
+    QTest::newRow("liian pitkä") << "Oy Asiakas Ab" << "Oy Asiakas" << false;
+}
+
+void TuontiTulkkiTesti::like()
+{
+    QFETCH(QString, kuvio);
+    QFETCH(QString, teksti);
+    QFETCH(bool, tulos);
+
+    QCOMPARE( TestiTulkki::vertaa(kuvio, teksti), tulos);
+}
+
+void TuontiTulkkiTesti::vakioviite()
+{
+    const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(10.0, "Jäsen", "1232") );
+    QCOMPARE( rivi.value("tili").toInt(), 3010);
+    QCOMPARE( rivi.value("selite").toString(), QString("Jäsenmaksu"));
+    QVERIFY( !rivi.contains("era"));
+}
+
+void TuontiTulkkiTesti::myyntiViitteella()
+{
+    for(const QString& viite : QStringList() << "1009" << "RF181009") {
+        const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(124.0, "Joku muu", viite));
+        QCOMPARE( rivi.value("saajamaksajaid").toInt(), 101);
+        QCOMPARE( rivi.value("saajamaksaja").toString(), QString("Oy Asiakas Ab"));
+        QCOMPARE( rivi.value("tili").toInt(), 1700);
+        QCOMPARE( rivi.value("selite").toString(), QString("Lasku 1"));
+        QCOMPARE( rivi.value("era").toMap().value("id").toInt(), 1);
+        QCOMPARE( rivi.value("era").toMap().value("sarja").toString(), QString("MY"));
+    }
+}
+
+void TuontiTulkkiTesti::myyntiSummalla()
+{
+    // Viitteettömälle maksulle ei etsitä erää summan perusteella,
+    // vaan tili arvataan kumppanin kirjauksista
+    const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(50.0, "MATTI MEIKÄLÄINEN"));
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 102);
+    QCOMPARE( rivi.value("saajamaksaja").toString(), QString("Matti Meikäläinen"));
+    QVERIFY( !rivi.contains("era"));
+    QCOMPARE( rivi.value("tili").toInt(), 3000);
+}
+
+void TuontiTulkkiTesti::montaSopivaaEraa()
+{
+    // Tili on kumppanin vähiten käytetty tulotili
+    const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(30.0, "kaksi laskua oy"));
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 104);
+    QVERIFY( !rivi.contains("era"));
+    QCOMPARE( rivi.value("tili").toInt(), 3010);
+}
+
+void TuontiTulkkiTesti::nimenPalat()
+{
+    const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(12.0, "MEIKÄLÄINEN MATTI JUHANI"));
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 102);
+    QCOMPARE( rivi.value("tili").toInt(), 3000);
+}
+
+void TuontiTulkkiTesti::korkotulo()
+{
+    QVariantMap map = tapahtuma(1.5, "Pankki");
+    map.insert("ktokoodi", 750);
+    const QVariantMap rivi = tulkki_->tulkitse(map);
+    QCOMPARE( rivi.value("tili").toInt(), 9150);
+    QCOMPARE( rivi.value("saajamaksaja").toString(), QString("Pankki"));
+}
+
+void TuontiTulkkiTesti::tuntematon()
+{
+    const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(10.0, "Ei Tunnettu", "999"));
+    QCOMPARE( rivi.value("saajamaksaja").toString(), QString("Ei Tunnettu"));
+    QVERIFY( !rivi.contains("saajamaksajaid"));
+    QVERIFY( !rivi.contains("tili"));
+}
+
+void TuontiTulkkiTesti::ostoViitteella()
+{
+    QVariantMap map = tapahtuma(-80.0, "Toimittajan pankki", "2012");
+    map.insert("iban", "FI2112345600000785");
+    const QVariantMap rivi = tulkki_->tulkitse(map);
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 103);
+    QCOMPARE( rivi.value("saajamaksaja").toString(), QString("Toimittaja Oy"));
+    QCOMPARE( rivi.value("era").toMap().value("id").toInt(), 11);
+    QCOMPARE( rivi.value("tili").toInt(), 2870);
+    QCOMPARE( rivi.value("selite").toString(), QString("Ostolasku"));
+}
+
+void TuontiTulkkiTesti::maksettuOsto()
+{
+    // Jo maksettu lasku ei kelpaa, joten käytetään vähiten käytettyä menotiliä
+    QVariantMap map = tapahtuma(-20.0, "Toimittaja Oy", "2025");
+    map.insert("iban", "FI2112345600000785");
+    const QVariantMap rivi = tulkki_->tulkitse(map);
+    QVERIFY( !rivi.contains("era"));
+    QCOMPARE( rivi.value("tili").toInt(), 4010);
+}
+
+void TuontiTulkkiTesti::ostoSummalla()
+{
+    const QVariantMap rivi = tulkki_->tulkitse( tapahtuma(-45.0, "toimittaja oy"));
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 103);
+    QVERIFY( !rivi.contains("era"));
+    QCOMPARE( rivi.value("tili").toInt(), 4010);
+}
+
+void TuontiTulkkiTesti::verohallinto()
+{
+    // Ennakkoveron viite on tallennettu asetuksiin
+    QVariantMap map = tapahtuma(-100.0, "VERO", "1234567");
+    map.insert("iban", "FI6416603000117625");
+    QVariantMap rivi = tulkki_->tulkitse(map);
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 1);
+    QCOMPARE( rivi.value("saajamaksaja").toString(), QString("Verohallinto"));
+    QCOMPARE( rivi.value("tili").toInt(), 1820);
+
+    map = tapahtuma(-100.0, "Verohallinto", "7654321");
+    rivi = tulkki_->tulkitse(map);
+    QCOMPARE( rivi.value("saajamaksajaid").toInt(), 1);
+    QCOMPARE( rivi.value("tili").toInt(), 2940);
+}
+
+void TuontiTulkkiTesti::palvelumaksu()
+{
+    QVariantMap map = tapahtuma(-3.5, "Pankki");
+    map.insert("ktokoodi", 730);
+    const QVariantMap rivi = tulkki_->tulkitse(map);
+    QCOMPARE( rivi.value("tili").toInt(), 7690);
+}
+
+void TuontiTulkkiTesti::suuriTiliote()
+{
+    QVariantList tapahtumat;
+    for(int i=0; i < 3000; i++) {
+        switch (i % 5) {
+        case 0: tapahtumat.append( tapahtuma(124.0, "Asiakas", "1009")); break;
+        case 1: tapahtumat.append( tapahtuma(50.0, "Matti Meikäläinen")); break;
+        case 2: tapahtumat.append( tapahtuma(-45.0, "Toimittaja Oy")); break;
+        case 3: tapahtumat.append( tapahtuma(-10.0 - i, QString("Kauppa %1").arg(i % 200))); break;
+        default: tapahtumat.append( tapahtuma(i, QString("Maksaja %1 Oy").arg(i))); break;
+        }
+    }
+
+    QVariantList tulkitut;
+    QBENCHMARK_ONCE {
+        tulkitut = tulkki_->tulkitse(tapahtumat);
+    }
+    QCOMPARE( tulkitut.count(), tapahtumat.count());
+    QCOMPARE( tulkitut.at(0).toMap().value("era").toMap().value("id").toInt(), 1);
+    QCOMPARE( tulkitut.at(1).toMap().value("tili").toInt(), 3000);
+    QCOMPARE( tulkitut.at(2).toMap().value("tili").toInt(), 4010);
+}
+
+void TuontiTulkkiTesti::cleanupTestCase()
+{
+    delete tulkki_;
+    kp()->sqlite()->tietokanta().close();
+}
+
+QTEST_APPLESS_MAIN(TuontiTulkkiTesti)
+
+#include "tst_tuontitulkkitesti.moc"
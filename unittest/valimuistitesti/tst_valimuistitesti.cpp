@@ -0,0 +1,170 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+
+#include "db/yhteysmodel.h"
+#include "db/kpkysely.h"
+#include "db/vastausvalimuisti.h"
+
+/**
+ * @brief Kysely, joka vastaa vain välimuistista
+ */
+class TestiKysely : public KpKysely
+{
+    Q_OBJECT
+public:
+    TestiKysely(YhteysModel* parent, Metodi metodi, const QString& polku)
+        : KpKysely(parent, metodi, polku) {}
+
+    bool vastattiin = false;
+
+    void kysy(const QVariant& = QVariant()) override {
+        vastattiin = vastaaValimuistista();
+    }
+    void lahetaTiedosto(const QByteArray&, const QMap<QString,QString>& = QMap<QString,QString>()) override {}
+
+    void vastaa(const QVariant& tulos) {
+        vastaus_ = tulos;
+        kirjaaValimuistiin();
+    }
+    QVariant saatu() const { return vastaus_; }
+};
+
+class TestiYhteys : public YhteysModel
+{
+public:
+    int rowCount(const QModelIndex& = QModelIndex()) const override { return 0; }
+    QVariant data(const QModelIndex&, int = Qt::DisplayRole) const override { return QVariant(); }
+
+    KpKysely* kysely(const QString& polku, KpKysely::Metodi metodi) override {
+        return new TestiKysely(this, metodi, polku);
+    }
+    void sulje() override {}
+    qlonglong oikeudet() const override { return 0; }
+
+    TestiKysely* testikysely(const QString& polku, KpKysely::Metodi metodi = KpKysely::GET) {
+        return static_cast<TestiKysely*>( kysely(polku, metodi) );
+    }
+};
+
+class ValimuistiTesti : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void osuma();
+    void vanheneminen();
+    void muokkausMitatoi();
+    void vientiMitatoi();
+    void keskenOllutHakuEiTallennu();
+
+private:
+    /**
+     * @brief Kysyy polkua ja vastaa annetulla tuloksella, jos välimuisti ei vastannut
+     * @return Saatu vastaus
+     */
+    QVariant hae(const QString& polku, const QVariant& tulos);
+
+    TestiYhteys* yhteys_ = nullptr;
+};
+
+void ValimuistiTesti::init()
+{
+    yhteys_ = new TestiYhteys;
+    yhteys_->valimuisti()->asetaKaytossa(true);
+}
+
+void ValimuistiTesti::cleanup()
+{
+    delete yhteys_;
+    yhteys_ = nullptr;
+}
+
+QVariant ValimuistiTesti::hae(const QString &polku, const QVariant &tulos)
+{
+    TestiKysely* kysely = yhteys_->testikysely(polku);
+    kysely->kysy();
+    if( !kysely->vastattiin )
+        kysely->vastaa(tulos);
+    return kysely->saatu();
+}
+
+void ValimuistiTesti::osuma()
+{
+    QCOMPARE( hae("/saldot", 1).toInt(), 1);
+    QCOMPARE( hae("/saldot", 2).toInt(), 1);
+    QCOMPARE( yhteys_->valimuisti()->tilasto().value("osumat").toInt(), 1);
+
+    // Polkua ilman riippuvuuksia ei tallenneta
+    QCOMPARE( hae("/tositteet", 1).toInt(), 1);
+    QCOMPARE( hae("/tositteet", 2).toInt(), 2);
+}
+
+void ValimuistiTesti::vanheneminen()
+{
+    yhteys_->valimuisti()->asetaIka(10);
+    QCOMPARE( hae("/alv", 1).toInt(), 1);
+    QTest::qWait(30);
+    QCOMPARE( hae("/alv", 2).toInt(), 2);
+    QCOMPARE( yhteys_->valimuisti()->tilasto().value("vanhentuneet").toInt(), 1);
+}
+
+void ValimuistiTesti::muokkausMitatoi()
+{
+    QCOMPARE( hae("/saldot", 1).toInt(), 1);
+    QCOMPARE( hae("/budjetti/1", 1).toInt(), 1);
+
+    yhteys_->testikysely("/tilit", KpKysely::PUT)->vastaa(QVariant());
+
+    QCOMPARE( hae("/saldot", 2).toInt(), 2);
+    QCOMPARE( hae("/budjetti/1", 2).toInt(), 2);
+
+    // Kohdennus ei vaikuta alv-laskelmaan
+    QCOMPARE( hae("/alv", 3).toInt(), 3);
+    yhteys_->testikysely("/kohdennukset", KpKysely::POST)->vastaa(QVariant());
+    QCOMPARE( hae("/alv", 4).toInt(), 3);
+}
+
+void ValimuistiTesti::vientiMitatoi()
+{
+    QCOMPARE( hae("/erat", 1).toInt(), 1);
+    yhteys_->testikysely("/viennit/5", KpKysely::PATCH)->vastaa(QVariant());
+    QCOMPARE( hae("/erat", 2).toInt(), 2);
+
+    yhteys_->valimuisti()->mitatoi("vienti");
+    QCOMPARE( hae("/erat", 3).toInt(), 3);
+}
+
+void ValimuistiTesti::keskenOllutHakuEiTallennu()
+{
+    TestiKysely* kesken = yhteys_->testikysely("/saldot");
+    kesken->kysy();
+    QVERIFY( !kesken->vastattiin );
+
+    // Tosite tallennetaan ennen kuin haun vastaus saapuu
+    yhteys_->testikysely("/tositteet", KpKysely::POST)->vastaa(QVariant());
+    kesken->vastaa(1);
+
+    QCOMPARE( hae("/saldot", 2).toInt(), 2);
+    QCOMPARE( hae("/saldot", 3).toInt(), 2);
+}
+
+QTEST_MAIN(ValimuistiTesti)
+
+#include "tst_valimuistitesti.moc"
@@ -0,0 +1,215 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+
+#include "model/vientirivi.h"
+
+/**
+ * @brief Tyypitetyn vientirivin muunnokset ja lukunopeus
+ *
+ * Vertailuissa luetaan samat kentät sadoilta vienneiltä sekä
+ * QVariantMap-pohjaisesta TositeViennistä että VientiRivistä.
+ */
+class VientiRiviTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    VientiRiviTesti();
+
+private slots:
+    void initTestCase();
+    void kierros();
+    void verkosta();
+    void tyypitettyEuro();
+    void muutSailyvat();
+    void kelvotonArvo();
+
+    void lukuKartasta();
+    void lukuRivilta();
+    void muunnos();
+
+private:
+    static TositeVienti esimerkki(int i);
+
+    QList<TositeVienti> viennit_;
+    QVector<VientiRivi> rivit_;
+};
+
+VientiRiviTesti::VientiRiviTesti()
+{
+
+}
+
+void VientiRiviTesti::initTestCase()
+{
+    Euro::registerMetaType();
+    for(int i=0; i < 500; i++) {
+        viennit_.append( esimerkki(i) );
+        rivit_.append( VientiRivi(viennit_.last()) );
+    }
+}
+
+void VientiRiviTesti::kierros()
+{
+    for(const auto& vienti : qAsConst(viennit_)) {
+        VientiRivi rivi(vienti);
+        QCOMPARE( rivi.toMap(), static_cast<const QVariantMap&>(vienti) );
+        QCOMPARE( rivi.debetSnt(), vienti.debetSnt());
+        QCOMPARE( rivi.kreditSnt(), vienti.kreditSnt());
+        QCOMPARE( rivi.pvm(), vienti.pvm());
+        QCOMPARE( rivi.alvProsentti(), vienti.alvProsentti());
+        QCOMPARE( rivi.eraId(), vienti.eraId());
+        QCOMPARE( rivi.kumppaniNimi(), vienti.kumppaniNimi());
+        QCOMPARE( rivi.merkkaukset(), vienti.merkkaukset());
+    }
+}
+
+void VientiRiviTesti::verkosta()
+{
+    // JSON-muunnoksen jälkeen päivämäärät ovat merkkijonoja ja luvut doubleja
+    QVariantMap map;
+    map.insert("id", 12.0);
+    map.insert("pvm", "2020-03-15");
+    map.insert("tili", 3000.0);
+    map.insert("kredit", 124.5);
+    map.insert("alvkoodi", 11.0);
+    map.insert("alvprosentti", 24.0);
+    map.insert("selite", "Myynti");
+
+    TositeVienti vienti(map);
+    VientiRivi rivi(map);
+
+    QCOMPARE( rivi.id(), vienti.id());
+    QCOMPARE( rivi.pvm(), QDate(2020,3,15));
+    QCOMPARE( rivi.tili(), vienti.tili());
+    QCOMPARE( rivi.kreditSnt(), 12450ll);
+    QCOMPARE( rivi.debetSnt(), 0ll);
+    QVERIFY( !rivi.onko(TositeVienti::DEBET));
+    QCOMPARE( rivi.alvKoodi(), 11);
+    QCOMPARE( rivi.selite(), QString("Myynti"));
+
+    TositeVienti takaisin = rivi.vienti();
+    QCOMPARE( takaisin.kreditSnt(), vienti.kreditSnt());
+    QCOMPARE( takaisin.pvm(), vienti.pvm());
+    QCOMPARE( takaisin.alvProsentti(), vienti.alvProsentti());
+    QVERIFY( !takaisin.contains("debet"));
+}
+
+void VientiRiviTesti::tyypitettyEuro()
+{
+    QVariantMap map;
+    map.insert("debet", Euro(120599).toTypedVariant());
+    VientiRivi rivi(map);
+    QCOMPARE( rivi.debetSnt(), 120599ll);
+    QCOMPARE( rivi.toMap().value("debet").toString(), QString("1205.99"));
+}
+
+void VientiRiviTesti::muutSailyvat()
+{
+    QVariantMap map;
+    map.insert("tili", 1910);
+    map.insert("alkupviennit", QVariantList() << 1 << 2);
+    map.insert("tosite", QVariantMap({{"tunniste", 5}}));
+    VientiRivi rivi(map);
+
+    QCOMPARE( rivi.muut().count(), 2);
+    QVERIFY( !rivi.muut().contains("tili"));
+    QCOMPARE( rivi.toMap(), map);
+}
+
+void VientiRiviTesti::kelvotonArvo()
+{
+    // Jäsentymätön arvo säilyy sellaisenaan
+    QVariantMap map;
+    map.insert("pvm", "");
+    map.insert("kohdennus", QVariant());
+    map.insert("debet", "ei summa");
+    VientiRivi rivi(map);
+
+    QVERIFY( !rivi.onko(TositeVienti::PVM));
+    QVERIFY( !rivi.pvm().isValid());
+    QCOMPARE( rivi.kohdennus(), 0);
+    QCOMPARE( rivi.debetSnt(), 0ll);
+    QCOMPARE( rivi.toMap(), map);
+}
+
+void VientiRiviTesti::lukuKartasta()
+{
+    qlonglong summa = 0;
+    QBENCHMARK {
+        summa = 0;
+        for(const auto& vienti : qAsConst(viennit_)) {
+            if( vienti.pvm().isValid() && vienti.tili() && vienti.alvKoodi())
+                summa += qRound64( vienti.alvProsentti() * (vienti.kredit() - vienti.debet()) );
+            summa += vienti.eraId() + vienti.kohdennus() + vienti.selite().length();
+        }
+    }
+    QVERIFY( summa != 0 );
+}
+
+void VientiRiviTesti::lukuRivilta()
+{
+    qlonglong summa = 0;
+    QBENCHMARK {
+        summa = 0;
+        for(const auto& rivi : qAsConst(rivit_)) {
+            if( rivi.pvm().isValid() && rivi.tili() && rivi.alvKoodi())
+                summa += qRound64( rivi.alvProsentti() * (rivi.kredit() - rivi.debet()) );
+            summa += rivi.eraId() + rivi.kohdennus() + rivi.selite().length();
+        }
+    }
+    QVERIFY( summa != 0 );
+}
+
+void VientiRiviTesti::muunnos()
+{
+    // Rivin muodostaminen maksetaan kerran ladattaessa tai muokattaessa
+    QBENCHMARK {
+        for(const auto& vienti : qAsConst(viennit_)) {
+            const QVariantMap map = VientiRivi(vienti).toMap();
+            Q_UNUSED(map)
+        }
+    }
+}
+
+TositeVienti VientiRiviTesti::esimerkki(int i)
+{
+    TositeVienti vienti;
+    vienti.setId( i + 1);
+    vienti.setPvm( QDate(2020,1,1).addDays(i % 365));
+    vienti.setTili( 3000 + i % 7);
+    if( i % 2)
+        vienti.setDebet( qlonglong(1000 + i * 37) );
+    else
+        vienti.setKredit( qlonglong(2500 + i * 11) );
+    vienti.set( TositeVienti::ALVKOODI, 11 );
+    vienti.setAlvProsentti( 24.0 );
+    vienti.setSelite( QString("Vienti %1").arg(i));
+    vienti.setKohdennus( i % 3);
+    vienti.setKumppani( QString("Asiakas %1").arg(i % 10));
+    if( i % 5 == 0) {
+        vienti.setEra( i + 1);
+        vienti.setMerkkaukset( QVariantList() << 2 << 3 );
+    }
+    vienti.set( TositeVienti::AALV, "+-");
+    return vienti;
+}
+
+QTEST_APPLESS_MAIN(VientiRiviTesti)
+
+#include "tst_vientirivitesti.moc"